@@ -1,1892 +1,12264 @@
-#ifndef GMATH_H
-#define GMATH_H
-/*
-================================================================================
-
-Graphics Math Library version 1.1.2 (public domain)
-
- GMath is a single-header C++ library for vector, matrix, and quaternion math,
-primarily for use in graphics applications. As a C++ only library it uses
-operator overloading to implement math operations, which is a bit cleaner and
-more intuitive than C style function calls. SSE optimizations, along with
-some misc math/matrix functions are borrowed from the Handmade Math library
-(also public domain).
-
-Tested with MSVC compiler v15.9.11.
-
-================================================================================
-
-USAGE
-
-To use the library, you must place the following two lines:
-
-#define GMATH_IMPLEMENTATION
-#include "GMath.h"
-
-in exactly one C++ file. You can then include this header file wherever needed.
-
-There are several options which alter the definitions provided by the library,
-and so require you comment or remove a line in this file:
-
-If you would like to use the library without SSE intrinsics, you must comment or
- remove the following line:
-*/
-
-#define GMATH_USE_SSE
-
-/*
-If you would like to use the library without the GMath namespace, you must
- comment or remove the following line:
-*/
-
-#define GMATH_USE_NAMESPACE
-
-/*
-If you do not want the library to include <iostream>, and don't need the
-printing functions it provides, you must comment or remove the following line:
-*/
-
-#define GMATH_USE_IOSTREAM
-
-/*
-There are also several options which can be defined in the source file
-containing the GMATH_IMPLEMENTATION definition. They must be defined before you
-include the GMath.h header:
-
-If you would like to avoid including <math.h>, you'll need to define the
-following, substituting your own functions for my_x_function:
-
-#define GMATH_EXP my_exp_function
-#define GMATH_LOG my_log_function
-#define GMATH_SIN my_sin_function
-#define GMATH_COS my_cos_function
-#define GMATH_TAN my_tan_function
-#define GMATH_ACOS my_acos_function
-#define GMATH_ATAN my_atan_function
-#define GMATH_SQRT my_sqrt_function
-#define GMATH_ATAN2 my_atan2_function
-#define GMATH_IMPLEMENTATION
-#include "GMath.h"
-
-If you define all of these functions, then GMath will not include the <math.h>
-header. This is useful if you'd like to avoid depending on the CRT library.
-
-When creating a projection matrix, the default behavior for GMATH is to use the
-range [-1..1] for depth. If you'd like to use the range [0..1], you must define
-GMATH_DEPTH_ZERO_TO_ONE in the source file, like so:
-
-#define GMATH_DEPTH_ZERO_TO_ONE
-#define GMATH_IMPLEMENTATION
-#include "GMath.h"
-
-By default, projection and view matrix functions assume a left-handed coordinate
-system. If you would instead like to use a right-handed system, you must define
-GMATH_RIGHT_HANDED in the source file, like so:
-
-#define GMATH_RIGHT_HANDED
-#define GMATH_IMPLEMENTATION
-#include "GMath.h"
-
-================================================================================
-
-LICENSE
-
-This software is dual-licensed to the public domain and under the following
-license: you are granted a perpetual, irrevocable license to copy, modify,
-publish, and distribute this file as you see fit.
-
-================================================================================
-
-CREDITS
-
-Primary Author: Matthew McLaurin (matthew@matthewmclaurin.com)
-
-GMath includes parts of version 1.9.0 of the Handmade Math library, which you
-can find at the following link:
-
-https://github.com/HandmadeMath/Handmade-Math
-
-Handmade Math Credits:
-Primary Author: Zakary Strange (zak@strangedev.net && @strangezak)
-
-Functionality: Matt Mascarenhas (@miblo_), Aleph, FieryDrake (@fierydrake),
-Gingerbill (@TheGingerBill), Ben Visness (@bvisness),
-Trinton Bullard (@Peliex_Dev), @AntonDan
-
-Fixes: Jeroen van Rijn (@J_vanRijn), Kiljacken (@Kiljacken),
-Insofaras (@insofaras), Daniel Gibson (@DanielGibson)
-
-===============================================================================
-
-STILL TO DO
-
-- Split operators between the include and implementation guard, to make it
-easier to scan through the header portion and see all the types/functions.
-
-- Add an IVec4 type which makes use of intrinsics the same way that Vec4 does.
-
-- Add more helper functions, generally. Things like NearlyEqual and Distance
-for vectors, more matrix helpers, etc. Maybe quaternion functions that don't
-normalize, etc.
-
-- Write a nice little GitHub readme, or at the very least copy-paste this
-comment into the readme.
-
-================================================================================
-*/
-
-#ifdef _MSC_VER
-#pragma warning(disable:4201)
-#endif
-
-#ifdef __clang__
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wgnu-anonymous-struct"
-#endif
-
-#if defined(__GNUC__) && (__GNUC__ == 4 && __GNUC_MINOR__ < 8)
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wmissing-braces"
-#endif
-
-#ifdef GMATH_USE_SSE
-#undef GMATH_USE_SSE // We will redefine this if SSE is supported.
-#ifdef _MSC_VER
-// MSVC supports SSE in amd64 mode or _M_IX86_FP >= 1 (2 means SSE2).
-#if defined(_M_AMD64) || ( defined(_M_IX86_FP) && _M_IX86_FP >= 1 )
-#define GMATH_USE_SSE 1
-#endif // _M_AMD64 OR _M_IX86_FP >= 1
-#else // If not MSVC, check if SSE is supported anyway.
-#ifdef __SSE__
-#define GMATH_USE_SSE 1
-#endif // __SSE__
-#endif // _MSC_VER
-#endif // GMATH_USE_SSE
-
-#ifdef GMATH_USE_SSE
-#include <xmmintrin.h>
-#endif
-
-#ifdef GMATH_USE_IOSTREAM
-#include <iostream>
-#endif
-
-#if !defined(GMATH_SIN) || !defined(GMATH_COS) || !defined(GMATH_TAN) || \
-!defined(GMATH_SQRT) || !defined(GMATH_EXP) || !defined(GMATH_LOG) ||    \
-!defined(GMATH_ACOS) || !defined(GMATH_ATAN)|| !defined(GMATH_ATAN2)
-#include <math.h>
-#endif
-
-#ifndef GMATH_SIN
-#define GMATH_SIN sinf
-#endif
-
-#ifndef GMATH_COS
-#define GMATH_COS cosf
-#endif
-
-#ifndef GMATH_TAN
-#define GMATH_TAN tanf
-#endif
-
-#ifndef GMATH_SQRT
-#define GMATH_SQRT sqrtf
-#endif
-
-#ifndef GMATH_EXP
-#define GMATH_EXP expf
-#endif
-
-#ifndef GMATH_LOG
-#define GMATH_LOG logf
-#endif
-
-#ifndef GMATH_ACOS
-#define GMATH_ACOS acosf
-#endif
-
-#ifndef GMATH_ATAN
-#define GMATH_ATAN atanf
-#endif
-
-#ifndef GMATH_ATAN2
-#define GMATH_ATAN2 atan2f
-#endif
-
-#define GMATH_PI 3.14159265359f
-#define GMATH_HALF_PI 1.57079632679f
-#define GMATH_TWO_PI 6.28318530718f
-#define GMATH_E 2.71828182845f
-
-#define GMATH_MIN(a, b) (a) > (b) ? (b) : (a)
-#define GMATH_MAX(a, b) (a) < (b) ? (b) : (a)
-#define GMATH_ABS(a) ((a) > 0 ? (a) : -(a))
-#define GMATH_MOD(a, b) ((a) % (b)) >= 0 ? ((a) % (b)) : (((a) % (b)) + (b))
-
-#ifdef GMATH_USE_NAMESPACE
-namespace GMath
-{
-#endif
-    // Forward declarations for types.
-    struct IVec2;
-    struct IVec3;
-    struct Vec2;
-    struct Vec3;
-    struct Vec4;
-    struct Mat4;
-    struct Quat;
-    
-    // Integer vector types (two and three components).
-    struct IVec2
-    {
-        union
-        {
-            struct {int x, y;};
-            struct {int r, g;};
-            struct {int width, height;};
-            int data[2];
-        };
-        inline int& operator[](int i) {return data[i];}
-        inline const int& operator[](int i) const {return data[i];}
-        inline IVec2 operator-() const {return {-x, -y};}
-        inline IVec2& operator++()
-        {
-            ++x;++y;
-            return *this;
-        }
-        inline IVec2& operator--()
-        {
-            --x;
-            --y;
-            return *this;
-        }
-        inline IVec2& operator+=(IVec2 vec)
-        {
-            x += vec.x;
-            y += vec.y;
-            return *this;
-        }
-        inline IVec2& operator+=(int scalar)
-        {
-            x += scalar;
-            y += scalar;
-            return *this;
-        }
-        inline IVec2& operator-=(IVec2 vec)
-        {
-            x -= vec.x;
-            y -= vec.y;
-            return *this;
-        }
-        inline IVec2& operator-=(int scalar)
-        {
-            x -= scalar;
-            y -= scalar;
-            return *this;
-        }
-        inline operator Vec2() const;
-        const static IVec2 Zero;
-        const static IVec2 One;
-        const static IVec2 Right;
-        const static IVec2 Up;
-        const static IVec2 Left;
-        const static IVec2 Down;
-    };
-    inline IVec2 CreateIVec2() {return {};};
-    inline IVec2 CreateIVec2(int fill) {return {fill, fill};};
-    inline IVec2 CreateIVec2(int x, int y) {return {x, y};};
-    const IVec2 IVec2::Zero = {0, 0};
-    const IVec2 IVec2::One = {1, 1};
-    const IVec2 IVec2::Right = {1, 0};
-    const IVec2 IVec2::Up = {0, 1};
-    const IVec2 IVec2::Left = {-1, 0};
-    const IVec2 IVec2::Down = {0, -1};
-    
-    inline IVec2 operator*(int a, IVec2 b) {return {b.x * a, b.y * a};}
-    inline IVec2 operator*(IVec2 a, int b) {return {a.x * b, a.y * b};}
-    inline IVec2 operator/(int a, IVec2 b) {return {b.x / a, b.y / a};}
-    inline IVec2 operator/(IVec2 a, int b) {return {a.x / b, a.y / b};}
-    inline IVec2 operator+(int a, IVec2 b) {return {b.x + a, b.y + a};}
-    inline IVec2 operator+(IVec2 a, int b) {return {a.x + b, a.y + b};}
-    inline IVec2 operator-(int a, IVec2 b) {return {b.x - a, b.y - a};}
-    inline IVec2 operator-(IVec2 a, int b) {return {a.x - b, a.y - b};}
-    inline IVec2 operator*(IVec2 a, IVec2 b) {return {a.x * b.x, a.y};}
-    inline IVec2 operator/(IVec2 a, IVec2 b) {return {a.x / b.x, a.y / b.y};}
-    inline IVec2 operator+(IVec2 a, IVec2 b) {return {a.x + b.x, a.y + b.y};}
-    inline IVec2 operator-(IVec2 a, IVec2 b) {return {a.x - b.x, a.y - b.y};}
-    inline bool operator==(IVec2 a, IVec2 b) {return (a.x == b.x && a.y == b.y);}
-#ifdef GMATH_USE_IOSTREAM
-    std::ostream& operator<<(std::ostream& a, IVec2 b) {return a << "(" << b.x << ", " << b.y << ")";}
-#endif
-    struct IVec3
-    {
-        union
-        {
-            struct {int x, y, z;};
-            struct {int r, g, b;};
-            struct {int width, height, depth;};
-            struct {IVec2 xy; int ignored_0;};
-            struct {int ignored_1; IVec2 yz;};
-            struct {IVec2 rg; int ignored_2;};
-            struct {int ignored_3; IVec2 gb;};
-            int data[3];
-        };
-        inline int& operator[](int i) {return data[i];}
-        inline const int& operator[](int i) const {return data[i];}
-        inline IVec3 operator-() const {return {-x, -y, -z};}
-        inline IVec3& operator++()
-        {
-            ++x;
-            ++y;
-            ++z;
-            return *this;
-        }
-        inline IVec3& operator--()
-        {
-            --x;
-            --y;
-            --z;
-            return *this;
-        }
-        inline IVec3& operator+=(IVec3 vec)
-        {
-            x += vec.x;
-            y += vec.y;
-            z += vec.z;
-            return *this;
-        }
-        inline IVec3& operator+=(int scalar)
-        {
-            x += scalar;
-            y += scalar;
-            z += scalar;
-            return *this;
-        }
-        inline IVec3& operator-=(IVec3 vec)
-        {
-            x -= vec.x;
-            y -= vec.y;
-            z -= vec.z;
-            return *this;
-        }
-        inline IVec3& operator-=(int scalar)
-        {
-            x -= scalar;
-            y -= scalar;
-            z -= scalar;
-            return *this;
-        }
-        inline IVec3& operator*=(int scalar)
-        {
-            x *= scalar;
-            y *= scalar;
-            z *= scalar;
-            return *this;
-        }
-        inline IVec3& operator/=(int scalar)
-        {
-            x /= scalar;
-            y /= scalar;
-            z /= scalar;
-            return *this;
-        }
-        inline operator Vec3() const;
-        const static IVec3 Zero;
-        const static IVec3 One;
-        const static IVec3 Right;
-        const static IVec3 Up;
-        const static IVec3 Left;
-        const static IVec3 Down;
-        const static IVec3 Forward;
-        const static IVec3 Backward;
-    };
-    inline IVec3 CreateIVec3() {return {};};
-    inline IVec3 CreateIVec3(int fill) {return {fill, fill, fill};};
-    inline IVec3 CreateIVec3(IVec2 xy, int z) {return {xy.x, xy.y, z};};
-    inline IVec3 CreateIVec3(int x, IVec2 yz) {return {x, yz.x, yz.y};};
-    inline IVec3 CreateIVec3(int x, int y, int z) {return {x, y, z};};
-    const IVec3 IVec3::Zero = {0, 0, 0};
-    const IVec3 IVec3::One = {1, 1, 1};
-    const IVec3 IVec3::Right = {1, 0, 0};
-    const IVec3 IVec3::Up = {0, 1, 0};
-    const IVec3 IVec3::Left = {-1, 0, 0};
-    const IVec3 IVec3::Down = {0, -1, 0};
-    const IVec3 IVec3::Forward = {0, 0, -1};
-    const IVec3 IVec3::Backward = {0, 0, 1};
-    inline IVec3 operator*(int a, IVec3 b) {return {b.x * a, b.y * a, b.z * a};}
-    inline IVec3 operator*(IVec3 a, int b) {return {a.x * b, a.y * b, a.z * b};}
-    inline IVec3 operator/(int a, IVec3 b) {return {b.x / a, b.y / a, b.z / a};}
-    inline IVec3 operator/(IVec3 a, int b) {return {a.x / b, a.y / b, a.z / b};}
-    inline IVec3 operator+(int a, IVec3 b) {return {b.x + a, b.y + a, b.z + a};}
-    inline IVec3 operator+(IVec3 a, int b) {return {a.x + b, a.y + b, a.z + b};}
-    inline IVec3 operator-(int a, IVec3 b) {return {b.x - a, b.y - a, b.z - a};}
-    inline IVec3 operator-(IVec3 a, int b) {return {a.x - b, a.y - b, a.z - b};}
-    inline IVec3 operator*(IVec3 a, IVec3 b) {return {a.x * b.x, a.y * b.y, a.z * b.z};}
-    inline IVec3 operator/(IVec3 a, IVec3 b) {return {a.x / b.x, a.y / b.y, a.z / b.z};}
-    inline IVec3 operator+(IVec3 a, IVec3 b) {return {a.x + b.x, a.y + b.y, a.z + b.z};}
-    inline IVec3 operator-(IVec3 a, IVec3 b) {return {a.x - b.x, a.y - b.y, a.z - b.z};}
-    inline bool operator==(IVec3 a, IVec3 b) {return (a.x == b.x && a.y == b.y && a.z == b.z);}
-#ifdef GMATH_USE_IOSTREAM
-    std::ostream& operator<<(std::ostream& a, IVec3 b) {return a << "(" << b.x << ", " << b.y << ", " << b.z << ")";}
-#endif
-    
-    // Floating point vector types (two, three, and four components).
-    // Four component vector uses SSE optimizations if enabled.
-    struct Vec2
-    {
-        union
-        {
-            struct {float x, y;};
-            struct {float r, g;};
-            struct {float u, v;};
-            struct {float width, height;};
-            float data[2];
-        };
-        inline float& operator[](int i) {return data[i];}
-        inline const float& operator[](int i) const {return data[i];}
-        inline Vec2 operator-() const {return {-x, -y};}
-        inline Vec2& operator+=(Vec2 vec)
-        {
-            x += vec.x;
-            y += vec.y;
-            return *this;
-        }
-        inline Vec2& operator+=(float scalar)
-        {
-            x += scalar;
-            y += scalar;
-            return *this;
-        }
-        inline Vec2& operator-=(Vec2 vec)
-        {
-            x -= vec.x;
-            y -= vec.y;
-            return *this;
-        }
-        inline Vec2& operator-=(float scalar)
-        {
-            x -= scalar;
-            y -= scalar;
-            return *this;
-        }
-        inline Vec2& operator*=(float scalar)
-        {
-            x *= scalar;
-            y *= scalar;
-            return *this;
-        }
-        inline Vec2& operator/=(float scalar)
-        {
-            x /= scalar;
-            y /= scalar;
-            return *this;
-        }
-        inline operator IVec2() const;
-        const static Vec2 Zero;
-        const static Vec2 One;
-        const static Vec2 Right;
-        const static Vec2 Up;
-        const static Vec2 Left;
-        const static Vec2 Down;
-    };
-    inline Vec2 CreateVec2() {return {};};
-    inline Vec2 CreateVec2(float fill) {return {fill, fill};};
-    inline Vec2 CreateVec2(float x, float y) {return {x, y};};
-    const Vec2 Vec2::Zero = {0.0f, 0.0f};
-    const Vec2 Vec2::One = {1.0f, 1.0f};
-    const Vec2 Vec2::Right = {1.0f, 0.0f};
-    const Vec2 Vec2::Up = {0.0f, 1.0f};
-    const Vec2 Vec2::Left = {-1.0f, 0.0f};
-    const Vec2 Vec2::Down = {0.0f, -1.0f};
-    inline Vec2 operator*(float a, Vec2 b) {return {a * b.x, a * b.y};}
-    inline Vec2 operator*(Vec2 a, float b) {return {a.x * b, a.y * b};}
-    inline Vec2 operator/(float a, Vec2 b) {return {a / b.x, a / b.y};}
-    inline Vec2 operator/(Vec2 a, float b) {return {a.x / b, a.y / b};}
-    inline Vec2 operator+(float a, Vec2 b) {return {a + b.x, a + b.y};}
-    inline Vec2 operator+(Vec2 a, float b) {return {a.x + b, a.y + b};}
-    inline Vec2 operator-(float a, Vec2 b) {return {a - b.x, a - b.y};}
-    inline Vec2 operator-(Vec2 a, float b) {return {a.x - b, a.y - b};}
-    inline Vec2 operator*(Vec2 a, Vec2 b) {return {a.x * b.x, a.y * b.y};}
-    inline Vec2 operator/(Vec2 a, Vec2 b) {return {a.x / b.y, a.y / b.y};}
-    inline Vec2 operator+(Vec2 a, Vec2 b) {return {a.x + b.x, a.y + b.y};}
-    inline Vec2 operator-(Vec2 a, Vec2 b) {return {a.x - b.x, a.y - b.y};}
-    inline bool operator==(Vec2 a, Vec2 b) {return (a.x == b.x && a.y == b.y);}
-#ifdef GMATH_USE_IOSTREAM
-    std::ostream& operator<<(std::ostream& a, Vec2 b) {return a << "(" << b.x << ", " << b.y << ")";}
-#endif
-    struct Vec3
-    {
-        union
-        {
-            struct {float x, y, z;};
-            struct {float r, g, b;};
-            struct {float u, v, w;};
-            struct {float width, height, depth;};
-            float data[3];
-            
-            struct {Vec2 xy; float ignored_0;};
-            struct {float ignored_1; Vec2 yz;};
-            struct {Vec2 uv; float ignored_2;};
-            struct {float ignored_3; Vec2 vw;};
-            struct {Vec2 rg; float ignored_4;};
-            struct {float ignored_5; Vec2 gb;};
-        };
-        inline float& operator[](int i) {return data[i];}
-        inline const float& operator[](int i) const {return data[i];}
-        inline Vec3 operator-() const {return {-x, -y, -z};}
-        inline Vec3& operator+=(Vec3 vec)
-        {
-            x += vec.x;
-            y += vec.y;
-            z += vec.z;
-            return *this;
-        }
-        inline Vec3& operator+=(float scalar)
-        {
-            x += scalar;
-            y += scalar;
-            z += scalar;
-            return *this;
-        }
-        inline Vec3& operator-=(Vec3 vec)
-        {
-            x -= vec.x;
-            y -= vec.y;
-            z -= vec.z;
-            return *this;
-        }
-        inline Vec3& operator-=(float scalar)
-        {
-            x -= scalar;
-            y -= scalar;
-            z -= scalar;
-            return *this;
-        }
-        inline Vec3& operator*=(float scalar)
-        {
-            x *= scalar;
-            y *= scalar;
-            z *= scalar;
-            return *this;
-        }
-        inline Vec3& operator/=(float scalar)
-        {
-            x /= scalar;
-            y /= scalar;
-            z /= scalar;
-            return *this;
-        }
-        inline operator IVec3() const;
-        const static Vec3 Zero;
-        const static Vec3 One;
-        const static Vec3 Right;
-        const static Vec3 Up;
-        const static Vec3 Left;
-        const static Vec3 Down;
-        const static Vec3 Forward;
-        const static Vec3 Backward;
-        const static Vec3 Red;
-        const static Vec3 Green;
-        const static Vec3 Blue;
-        const static Vec3 Cyan;
-        const static Vec3 Yellow;
-        const static Vec3 Purple;
-        const static Vec3 Black;
-        const static Vec3 White;
-    };
-    inline Vec3 CreateVec3() {return {};};
-    inline Vec3 CreateVec3(float fill) {return {fill, fill, fill};};
-    inline Vec3 CreateVec3(Vec2 xy, float z) {return {xy.x, xy.y, z};};
-    inline Vec3 CreateVec3(float x, Vec2 yz) {return {x, yz.x, yz.y};};
-    inline Vec3 CreateVec3(float x, float y, float z) {return {x, y, z};};
-    const Vec3 Vec3::Zero = {0.0f, 0.0f, 0.0f};
-    const Vec3 Vec3::One = {1.0f, 1.0f, 1.0f};
-    const Vec3 Vec3::Right = {1.0f, 0.0f, 0.0f};
-    const Vec3 Vec3::Up = {0.0f, 1.0f, 0.0f};
-    const Vec3 Vec3::Left = {-1.0f, 0.0f, 0.0f};
-    const Vec3 Vec3::Down = {0.0f, -1.0f, 0.0f};
-    const Vec3 Vec3::Forward = {0.0f, 0.0f, -1.0f};
-    const Vec3 Vec3::Backward = {0.0f, 0.0f, 1.0f};
-    const Vec3 Vec3::Red = {1.0f, 0.0f, 0.0f};
-    const Vec3 Vec3::Green = {0.0f, 1.0f, 0.0f};
-    const Vec3 Vec3::Blue = {0.0f, 0.0f, 1.0f};
-    const Vec3 Vec3::Cyan = {0.0f, 1.0f, 1.0f};
-    const Vec3 Vec3::Yellow = {1.0f, 1.0f, 0.0f};
-    const Vec3 Vec3::Purple = {1.0f, 0.0f, 1.0f};
-    const Vec3 Vec3::Black = {0.0f, 0.0f, 0.0f};
-    const Vec3 Vec3::White = {1.0f, 1.0f, 1.0f};
-    inline Vec3 operator*(float a, Vec3 b) {return {b.x * a, b.y * a, b.z * a};}
-    inline Vec3 operator*(Vec3 a, float b) {return {a.x * b, a.y * b, a.z * b};}
-    inline Vec3 operator/(float a, Vec3 b) {return {b.x / a, b.y / a, b.z / a};}
-    inline Vec3 operator/(Vec3 a, float b) {return {a.x / b, a.y / b, a.z / b};}
-    inline Vec3 operator+(float a, Vec3 b) {return {b.x + a, b.y + a, b.z + a};}
-    inline Vec3 operator+(Vec3 a, float b) {return {a.x + b, a.y + b, a.z + b};}
-    inline Vec3 operator-(float a, Vec3 b) {return {b.x - a, b.y - a, b.z - a};}
-    inline Vec3 operator-(Vec3 a, float b) {return {a.x - b, a.y - b, a.z - b};}
-    inline Vec3 operator*(Vec3 a, Vec3 b) {return {a.x * b.x, a.y * b.y, a.z * b.z};}
-    inline Vec3 operator/(Vec3 a, Vec3 b) {return {a.x / b.x, a.y / b.y, a.z / b.z};}
-    inline Vec3 operator+(Vec3 a, Vec3 b) {return {a.x + b.x, a.y + b.y, a.z + b.z};}
-    inline Vec3 operator-(Vec3 a, Vec3 b) {return {a.x - b.x, a.y - b.y, a.z - b.z};}
-    inline bool operator==(Vec3 a, Vec3 b) {return (a.x == b.x && a.y == b.y && a.z == b.z);}
-#ifdef GMATH_USE_IOSTREAM
-    std::ostream& operator<<(std::ostream& a, Vec3 b)
-    {
-        return a << "(" << b.x << ", " << b.y << ", " << b.z << ")";
-    }
-#endif
-    
-    struct Vec4
-    {
-        union
-        {
-            float data[4];
-            struct
-            {
-                union
-                {
-                    Vec3 xyz;
-                    struct {float x, y, z;};
-                };
-                float w;
-            };
-            
-            struct
-            {
-                union
-                {
-                    Vec3 rgb;
-                    struct {float r, g, b;};
-                };
-                float a;
-            };
-            
-            struct
-            {
-                Vec2 xy;
-                float ignored_0;
-                float ignored_1;
-            };
-            
-            struct
-            {
-                float ignored_2;
-                Vec2 yz;
-                float ignored_3;
-            };
-            
-            struct
-            {
-                float ignored_4;
-                float ignored_5;
-                Vec2 zw;
-            };
-            
-            // SSE type (four packed single precision floats).
-#ifdef GMATH_USE_SSE
-            __m128 data_sse;
-#endif
-        };
-        inline float& operator[](int i) {return data[i];}
-        inline const float& operator[](int i) const {return data[i];}
-        inline Vec4 operator-() const {return {-x, -y, -z, -w};}
-        
-        // Almost all Vec4 operators/functions from this point forward have two
-        // implementations: One when SSE is enabled, and one for when it isn't.
-        inline Vec4& operator+=(Vec4 vec)
-        {
-#ifdef GMATH_USE_SSE
-            data_sse = _mm_add_ps(data_sse, vec.data_sse);
-#else
-            x += vec.x;
-            y += vec.y;
-            z += vec.z;
-            w += vec.w;
-#endif
-            return *this;
-        }
-        inline Vec4& operator+=(float val)
-        {
-#ifdef GMATH_USE_SSE
-            __m128 scalar = _mm_set1_ps(val);
-            data_sse = _mm_add_ps(data_sse, scalar);
-#else
-            x += val;
-            y += val;
-            z += val;
-            w += val;
-#endif
-            return *this;
-        }
-        inline Vec4& operator-=(Vec4& vec)
-        {
-#ifdef GMATH_USE_SSE
-            data_sse = _mm_sub_ps(data_sse, vec.data_sse);
-#else
-            x -= vec.x;
-            y -= vec.y;
-            z -= vec.z;
-            w -= vec.w;
-#endif
-            return *this;
-        }
-        inline Vec4& operator-=(float val)
-        {
-#ifdef GMATH_USE_SSE
-            __m128 scalar = _mm_set1_ps(val);
-            data_sse = _mm_sub_ps(data_sse, scalar);
-#else
-            x -= val;
-            y -= val;
-            z -= val;
-            w -= val;
-#endif
-            return *this;
-        }
-        inline Vec4& operator*=(float val)
-        {
-#ifdef GMATH_USE_SSE
-            __m128 scalar = _mm_set1_ps(val);
-            data_sse = _mm_mul_ps(data_sse, scalar);
-#else
-            x *= val;
-            y *= val;
-            z *= val;
-            w *= val;
-#endif
-            return *this;
-        }
-        inline Vec4& operator/=(float val)
-        {
-#ifdef GMATH_USE_SSE
-            __m128 scalar = _mm_set1_ps(val);
-            data_sse = _mm_div_ps(data_sse, scalar);
-#else
-            x /= val;
-            y /= val;
-            z /= val;
-            w /= val;
-#endif
-            return *this;
-        }
-        const static Vec4 Zero;
-        const static Vec4 One;
-        const static Vec4 Right;
-        const static Vec4 Up;
-        const static Vec4 Left;
-        const static Vec4 Down;
-        const static Vec4 Forward;
-        const static Vec4 Backward;
-        const static Vec4 Red;
-        const static Vec4 Green;
-        const static Vec4 Blue;
-        const static Vec4 Cyan;
-        const static Vec4 Yellow;
-        const static Vec4 Purple;
-        const static Vec4 Black;
-        const static Vec4 White;
-    };
-    inline Vec4 CreateVec4();
-    inline Vec4 CreateVec4(float fill);
-    inline Vec4 CreateVec4(Vec3 xyz, float w);
-    inline Vec4 CreateVec4(float x, float y, float z, float w);
-    const Vec4 Vec4::Zero = {0.0f, 0.0f, 0.0f, 0.0f};
-    const Vec4 Vec4::One = {1.0f, 1.0f, 1.0f, 1.0f};
-    const Vec4 Vec4::Right = {1.0f, 0.0f, 0.0f, 0.0f};
-    const Vec4 Vec4::Up = {0.0f, 1.0f, 0.0f, 0.0f};
-    const Vec4 Vec4::Left = {-1.0f, 0.0f, 0.0f, 0.0f};
-    const Vec4 Vec4::Down = {0.0f, -1.0f, 0.0f, 0.0f};
-    const Vec4 Vec4::Forward = {0.0f, 0.0f, -1.0f, 0.0f};
-    const Vec4 Vec4::Backward = {0.0f, 0.0f, 1.0f, 0.0f};
-    const Vec4 Vec4::Red = {1.0f, 0.0f, 0.0f, 1.0f};
-    const Vec4 Vec4::Green = {0.0f, 1.0f, 0.0f, 1.0f};
-    const Vec4 Vec4::Blue = {0.0f, 0.0f, 1.0f, 1.0f};
-    const Vec4 Vec4::Cyan = {0.0f, 1.0f, 1.0f, 1.0f};
-    const Vec4 Vec4::Yellow = {1.0f, 1.0f, 0.0f, 1.0f};
-    const Vec4 Vec4::Purple = {1.0f, 0.0f, 1.0f, 1.0f};
-    const Vec4 Vec4::Black = {0.0f, 0.0f, 0.0f, 0.0f};
-    const Vec4 Vec4::White = {1.0f, 1.0f, 1.0f, 1.0f};
-    
-    inline Vec4 operator*(float a, Vec4 b)
-    {
-        Vec4 result;
-#ifdef GMATH_USE_SSE
-        __m128 scalar = _mm_set1_ps(a);
-        result.data_sse = _mm_mul_ps(scalar, b.data_sse);
-#else
-        result =  {a * b.x, a * b.y, a * b.z, a * b.w};
-#endif
-        return result;
-    }
-    inline Vec4 operator*(Vec4 a, float b)
-    {
-        Vec4 result;
-#ifdef GMATH_USE_SSE
-        __m128 scalar = _mm_set1_ps(b);
-        result.data_sse = _mm_mul_ps(a.data_sse, scalar);
-#else
-        result =  {a.x * b, a.y * b, a.z * b, a.w * b};
-#endif
-        return result;
-    }
-    inline Vec4 operator/(float a, Vec4 b)
-    {
-        Vec4 result;
-#ifdef GMATH_USE_SSE
-        __m128 scalar = _mm_set1_ps(a);
-        result.data_sse = _mm_div_ps(scalar, b.data_sse);
-#else
-        result =  {a / b.x, a / b.y, a / b.z, a / b.w};
-#endif
-        return result;
-    }
-    inline Vec4 operator/(Vec4 a, float b)
-    {
-        Vec4 result;
-#ifdef GMATH_USE_SSE
-        __m128 scalar = _mm_set1_ps(b);
-        result.data_sse = _mm_div_ps(a.data_sse, scalar);
-#else
-        result =  {a.x / b, a.y / b, a.z / b, a.w / b};
-#endif
-        return result;
-    }
-    inline Vec4 operator+(float a, Vec4 b)
-    {
-        Vec4 result;
-#ifdef GMATH_USE_SSE
-        __m128 scalar = _mm_set1_ps(a);
-        result.data_sse = _mm_add_ps(scalar, b.data_sse);
-#else
-        result =  {a + b.x, a + b.y, a + b.z, a + b.w};
-#endif
-        return result;
-    }
-    inline Vec4 operator+(Vec4 a, float b)
-    {
-        Vec4 result;
-#ifdef GMATH_USE_SSE
-        __m128 scalar = _mm_set1_ps(b);
-        result.data_sse = _mm_add_ps(a.data_sse, scalar);
-#else
-        result =  {a.x + b, a.y + b, a.z + b, a.w + b};
-#endif
-        return result;
-    }
-    inline Vec4 operator-(float a, Vec4 b)
-    {
-        Vec4 result;
-#ifdef GMATH_USE_SSE
-        __m128 scalar = _mm_set1_ps(a);
-        result.data_sse = _mm_sub_ps(scalar, b.data_sse);
-#else
-        result =  {a - b.x, a - b.y, a - b.z, a - b.w};
-#endif
-        return result;
-    }
-    inline Vec4 operator-(Vec4 a, float b)
-    {
-        Vec4 result;
-#ifdef GMATH_USE_SSE
-        __m128 scalar = _mm_set1_ps(b);
-        result.data_sse = _mm_add_ps(a.data_sse, scalar);
-#else
-        result =  {a.x - b, a.y - b, a.z - b, a.w - b};
-#endif
-        return result;
-    }
-    inline Vec4 operator*(Vec4 a, Vec4 b)
-    {
-        Vec4 result;
-#ifdef GMATH_USE_SSE
-        result.data_sse = _mm_mul_ps(a.data_sse, b.data_sse);
-#else
-        result = {a.x * b.x, a.y * b.y, a.z * b.z, a.w * b.w};
-#endif
-        return result;
-    }
-    inline Vec4 operator/(Vec4 a, Vec4 b)
-    {
-        Vec4 result;
-#ifdef GMATH_USE_SSE
-        result.data_sse = _mm_div_ps(a.data_sse, b.data_sse);
-#else
-        result = {a.x / b.x, a.y / b.y, a.z / b.z, a.w / b.w};
-#endif
-        return result;
-    }
-    inline Vec4 operator+(Vec4 a, Vec4 b)
-    {
-        Vec4 result;
-#ifdef GMATH_USE_SSE
-        result.data_sse = _mm_add_ps(a.data_sse, b.data_sse);
-#else
-        result = {a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w};
-#endif
-        return result;
-    }
-    inline Vec4 operator-(Vec4 a, Vec4 b)
-    {
-        Vec4 result;
-#ifdef HANDMADE_MATH__USE_SSE
-        result.data_sse = _mm_sub_ps(a.data_sse, b.data_sse);
-#else
-        result = {a.x - b.x, a.y - b.y, a.z - b.z, a.w - b.w};
-#endif
-        return result;
-    }
-    inline bool operator==(Vec4 a, Vec4 b)
-    {
-        // TODO(Matt): SSE optimization?
-        return (a.x == b.x && a.y == b.y && a.z == b.z && a.w == b.w);
-    }
-#ifdef GMATH_USE_IOSTREAM
-    std::ostream& operator<<(std::ostream& a, Vec4 b)
-    {
-        return a << "(" << b.x << ", " << b.y << ", " << b.z << ", " << b.w << ")";
-    }
-#endif
-    
-    // 4x4 Matrix type, column major. Uses SSE if enabled.
-    
-    struct Mat4
-    {
-        union
-        {
-            Vec4 columns[4];
-            
-#ifdef GMATH_USE_SSE
-            __m128 data_sse[4];
-#endif
-        };
-        inline Vec4& operator[](int i) {return columns[i];}
-        inline const Vec4& operator[](int i) const {return columns[i];}
-        const static Mat4 Zero;
-        const static Mat4 Identity;
-    };
-    inline Mat4 CreateMat4() {return {};};
-    inline Mat4 CreateMat4(float diagonal)
-    {
-        Mat4 mat;
-        mat[0] = {1.0f, 0.0f, 0.0f, 0.0f};
-        mat[1] = {0.0f, 1.0f, 0.0f, 0.0f};
-        mat[2] = {0.0f, 0.0f, 1.0f, 0.0f};
-        mat[3] = {0.0f, 0.0f, 0.0f, 1.0f};
-        return mat;
-    };
-    inline Mat4 CreateMat4(Quat quat);
-    const Mat4 Mat4::Zero = {};
-    const Mat4 Mat4::Identity = CreateMat4(1.0f);
-    inline Mat4 operator+(Mat4 a, Mat4 b)
-    {
-        Mat4 result;
-        result[0] = a[0] + b[0];
-        result[1] = a[1] + b[1];
-        result[2] = a[2] + b[2];
-        result[3] = a[3] + b[3];
-        return result;
-    }
-    inline Mat4 operator-(Mat4 a, Mat4 b)
-    {
-        Mat4 result;
-        result[0] = a[0] - b[0];
-        result[1] = a[1] - b[1];
-        result[2] = a[2] - b[2];
-        result[3] = a[3] - b[3];
-        return result;
-    }
-    inline Mat4 operator*(Mat4 mat, float val)
-    {
-        Mat4 result;
-        result[0] = mat[0] * val;
-        result[1] = mat[1] * val;
-        result[2] = mat[2] * val;
-        result[3] = mat[3] * val;
-        return result;
-    }
-    inline Mat4 operator/(Mat4 mat, float val)
-    {
-        Mat4 result;
-        result[0] = mat[0] / val;
-        result[1] = mat[1] / val;
-        result[2] = mat[2] / val;
-        result[3] = mat[3] / val;
-        return result;
-    }
-    inline Vec4 operator*(Mat4 a, Vec4 b);
-    inline Mat4 operator*(Mat4 a, Mat4 b);
-#ifdef GMATH_USE_IOSTREAM
-    std::ostream& operator<<(std::ostream& a, Mat4 b)
-    {
-        for (int i = 0; i < 4; ++i)
-        {
-            a << "| " << b[0][i] << ", " << b[1][i] << ", " << b[2][i] << ", " << b[3][i] << " |" << std::endl;
-        }
-        return a;
-    }
-#endif
-    
-    // Quaternion type, uses SSE if enabled.
-    
-    struct Quat
-    {
-        union
-        {
-            float data[4];
-            struct
-            {
-                union
-                {
-                    Vec3 xyz;
-                    struct {float x, y, z;};
-                };
-                float w;
-            };
-#ifdef GMATH_USE_SSE
-            __m128 data_sse;
-#endif
-        };
-        const static Quat Zero;
-        const static Quat Identity;
-    };
-    inline Quat CreateQuat();
-    inline Quat CreateQuat(float fill);
-    inline Quat CreateQuat(Vec3 axis, float angle);
-    inline Quat CreateQuat(float x, float y, float z, float w);
-    inline Quat CreateQuat(Vec4 vec);
-    inline Quat CreateQuat(Mat4 mat);
-    const Quat Quat::Zero = {0.0f, 0.0f, 0.0f, 0.0f};
-    const Quat Quat::Identity = {0.0f, 0.0f, 0.0f, 1.0f};
-    inline Quat operator+(Quat a, Quat b)
-    {
-        Quat result;
-#ifdef GMATH_USE_SSE
-        result.data_sse = _mm_add_ps(a.data_sse, b.data_sse);
-#else
-        result.x = a.x + b.x;
-        result.y = a.y + b.y;
-        result.z = a.z + b.z;
-        result.w = a.w + b.w;
-#endif
-        return result;
-    }
-    inline Quat operator-(Quat a, Quat b)
-    {
-        Quat result;
-#ifdef GMATH_USE_SSE
-        result.data_sse = _mm_sub_ps(a.data_sse, b.data_sse);
-#else
-        result.x = a.x - b.x;
-        result.y = a.y - b.y;
-        result.z = a.z - b.z;
-        result.w = a.w - b.w;
-#endif
-        return result;
-    }
-    
-    inline Quat operator*(Quat a, Quat b)
-    {
-        Quat result;
-#ifdef GMATH_USE_SSE
-        __m128 result_one = _mm_xor_ps(_mm_shuffle_ps(a.data_sse, a.data_sse, _MM_SHUFFLE(0, 0, 0, 0)), _mm_setr_ps(0.0f, -0.0f, 0.0f, -0.0f));
-        __m128 result_two = _mm_shuffle_ps(b.data_sse, b.data_sse, _MM_SHUFFLE(0, 1, 2, 3));
-        __m128 result_three = _mm_mul_ps(result_two, result_one);
-        
-        result_one = _mm_xor_ps(_mm_shuffle_ps(a.data_sse, a.data_sse, _MM_SHUFFLE(1, 1, 1, 1)) , _mm_setr_ps(0.0f, 0.0f, -0.0f, -0.0f));
-        result_two = _mm_shuffle_ps(b.data_sse, b.data_sse, _MM_SHUFFLE(1, 0, 3, 2));
-        result_three = _mm_add_ps(result_three, _mm_mul_ps(result_two, result_one));
-        
-        result_one = _mm_xor_ps(_mm_shuffle_ps(a.data_sse, a.data_sse, _MM_SHUFFLE(2, 2, 2, 2)), _mm_setr_ps(-0.0f, 0.0f, 0.0f, -0.0f));
-        result_two = _mm_shuffle_ps(b.data_sse, b.data_sse, _MM_SHUFFLE(2, 3, 0, 1));
-        result_three = _mm_add_ps(result_three, _mm_mul_ps(result_two, result_one));
-        
-        result_one = _mm_shuffle_ps(a.data_sse, a.data_sse, _MM_SHUFFLE(3, 3, 3, 3));
-        result_two = _mm_shuffle_ps(b.data_sse, b.data_sse, _MM_SHUFFLE(3, 2, 1, 0));
-        result.data_sse = _mm_add_ps(result_three, _mm_mul_ps(result_two, result_one));
-#else
-        result.x = (a.x * b.w) + (a.y * b.z) - (a.z * b.y) + (a.w * b.x);
-        result.y = (-a.x * b.z) + (a.y * b.w) + (a.z * b.x) + (a.w * b.y);
-        result.z = (a.x * b.y) - (a.y * b.x) + (a.z * b.w) + (a.w * b.z);
-        result.w = (-a.x * b.x) - (a.y * b.y) - (a.z * b.z) + (a.w * b.w);
-#endif
-        return result;
-    }
-    
-    inline Quat operator*(Quat a, float b)
-    {
-        Quat result;
-#ifdef GMATH_USE_SSE
-        __m128 scalar = _mm_set1_ps(b);
-        result.data_sse = _mm_mul_ps(a.data_sse, scalar);
-#else
-        result = {a.x * b, a.y * b, a.z * b, a.w * b};
-#endif
-        return result;
-    }
-    
-    inline Quat operator*(float a, Quat b)
-    {
-        Quat result;
-#ifdef GMATH_USE_SSE
-        __m128 scalar = _mm_set1_ps(a);
-        result.data_sse = _mm_mul_ps(scalar, b.data_sse);
-#else
-        result = {a * b.x, a * b.y, a * b.z, a * b.w};
-#endif
-        return result;
-    }
-    inline Quat operator/(Quat a, float b)
-    {
-        Quat result;
-#ifdef GMATH_USE_SSE
-        __m128 scalar = _mm_set1_ps(b);
-        result.data_sse = _mm_div_ps(a.data_sse, scalar);
-#else
-        result = {a.x / b, a.y / b, a.z / b, a.w / b};
-#endif
-        return result;
-    }
-    
-    inline Quat operator/(float a, Quat b)
-    {
-        Quat result;
-#ifdef GMATH_USE_SSE
-        __m128 scalar = _mm_set1_ps(a);
-        result.data_sse = _mm_div_ps(scalar, b.data_sse);
-#else
-        result = {a / b.x, a / b.y, a / b.z, a / b.w};
-#endif
-        return result;
-    }
-    
-    
-#ifdef GMATH_USE_IOSTREAM
-    std::ostream& operator<<(std::ostream& a, Quat b)
-    {
-        return a << "(" << b.x << ", " << b.y << ", " << b.z << ", " << b.w << ")";
-    }
-#endif
-    
-    // Math function wrappers (inline, but enable compiler optimization if you
-    // care about these being fast).
-    inline float Sin(float radians);
-    inline float Cos(float radians);
-    inline float Tan(float radians);
-    inline float ACos(float cos);
-    inline float ATan(float tan);
-    inline float Exp(float val);
-    inline float Log(float val);
-    inline float ATan2(float y, float x);
-    inline float Pow(float val, float exp);
-    inline float Sqrt(float val);
-    inline float RSqrt(float val);
-    inline float Radians(float degrees);
-    inline float Degrees(float radians);
-    inline float Min(float a, float b);
-    inline float Max(float a, float b);
-    inline float Abs(float val);
-    inline int Mod(int a, int b);
-    inline float Pow(float base, int exponent);
-    
-    // Utility functions.
-    inline float Clamp(float val, float min, float max);
-    inline float Lerp(float a, float b, float alpha);
-    inline int Dot(IVec2 a, IVec2 b);
-    inline int Dot(IVec3 a, IVec3 b);
-    inline float Dot(Vec2 a, Vec2 b);
-    inline float Dot(Vec3 a, Vec3 b);
-    inline float Dot(Vec4 a, Vec4 b);
-    inline Vec3 Cross(Vec3 a, Vec3 b);
-    inline int LengthSquared(IVec2 vec);
-    inline int LengthSquared(IVec3 vec);
-    inline float LengthSquared(Vec2 vec);
-    inline float LengthSquared(Vec3 vec);
-    inline float LengthSquared(Vec4 vec);
-    inline float Length(Vec2 vec);
-    inline float Length(Vec3 vec);
-    inline float Length(Vec4 vec);
-    
-    // Normalize returns a zero vector in case of a divide-by-zero.
-    // FastNormalize uses an inverse square root, and does no divide-by-zero check.
-    // SafeNormalize returns a zero vector if length < tolerance.
-    inline Vec2 Normalize(Vec2 vec);
-    inline Vec2 FastNormalize(Vec2 vec);
-    inline Vec2 SafeNormalize(Vec2 vec, float tolerance = 0.001f);
-    inline Vec3 Normalize(Vec3 vec);
-    inline Vec3 FastNormalize(Vec3 vec);
-    inline Vec3 SafeNormalize(Vec3 vec, float tolerance = 0.001f);
-    inline Vec4 Normalize(Vec4 vec);
-    inline Vec4 FastNormalize(Vec4 vec);
-    inline Vec4 SafeNormalize(Vec4 vec, float tolerance = 0.001f);
-    
-    inline Vec2 ClampLength(Vec2 vec, float min, float max);
-    inline Vec3 ClampLength(Vec3 vec, float min, float max);
-    inline Vec4 ClampLength(Vec4 vec, float min, float max);
-    
-    // Matrix functions.
-    inline Mat4 Transpose(Mat4 mat);
-    inline Mat4 CreatePerspectiveMatrix(float fov, float aspect, float near, float far);
-    inline Mat4 CreateOrthoMatrix(float width, float height, float depth, float near_clip);
-    inline Mat4 CreateOrthoMatrix(Vec3 extent, float near_clip);
-    inline Mat4 CreateTranslationMatrix(Vec3 translation);
-    inline Mat4 CreateRotationMatrix(float angle, Vec3 axis);
-    inline Mat4 CreateScalingMatrix(Vec3 scale);
-    inline Mat4 CreateLookAtMatrix(Vec3 eye_location, Vec3 target, Vec3 world_up);
-    
-    // Quaternion functions.
-    inline float Dot(Quat a, Quat b);
-    inline Quat Normalize(Quat quat);
-    inline Quat Lerp(Quat a, Quat b, float alpha);
-    inline Quat Slerp(Quat a, Quat b, float alpha);
-    inline Quat Invert(Quat quat);
-    
-#ifdef GMATH_USE_NAMESPACE
-};
-#endif
-#endif // GMATH_H
-
-#ifdef GMATH_IMPLEMENTATION
-#ifdef GMATH_USE_NAMESPACE
-namespace GMath
-{
-#endif
-    // Math function definitions.
-    float Sin(float radians) {return GMATH_SIN(radians);}
-    float Cos(float radians) {return GMATH_COS(radians);}
-    float Tan(float radians) {return GMATH_TAN(radians);}
-    float ACos(float cos) {return GMATH_ACOS(cos);}
-    float ATan(float tan) {return GMATH_ATAN(tan);}
-    float Exp(float val) {return GMATH_EXP(val);}
-    float Log(float val) {return GMATH_LOG(val);}
-    float ATan2(float y, float x) {return GMATH_ATAN2(y, x);}
-    
-    float Pow(float val, float exp)
-    {
-        return GMATH_EXP(exp * GMATH_LOG(val));
-    }
-    
-    float Sqrt(float val)
-    {
-#ifdef GMATH_USE_SSE
-        __m128 in = _mm_set_ss(val);
-        __m128 out = _mm_sqrt_ss(in);
-        return _mm_cvtss_f32(out);
-#else
-        return GMATH_SQRT(val);
-#endif
-    }
-    
-    float RSqrt(float val)
-    {
-#ifdef GMATH_USE_SSE
-        __m128 in = _mm_set_ss(val);
-        __m128 out = _mm_rsqrt_ss(in);
-        return _mm_cvtss_f32(out);
-#else
-        return 1.0f / GMATH_SQRT(val);
-#endif
-    }
-    
-    float Radians(float degrees)
-    {
-        return degrees * (GMATH_PI / 180.0f);
-    }
-    
-    float Degrees(float radians)
-    {
-        return (radians * 180.0f) / GMATH_PI;
-    }
-    
-    float Min(float a, float b)
-    {
-        return GMATH_MIN(a, b);
-    }
-    
-    float Max(float a, float b)
-    {
-        return GMATH_MAX(a, b);
-    }
-    
-    float Abs(float val)
-    {
-        return GMATH_ABS(val);
-    }
-    
-    int Mod(int a, int b)
-    {
-        return GMATH_MOD(a, b);
-    }
-    
-    float Pow(float base, int exponent)
-    {
-        float result = 1.0f;
-        float mul = (exponent < 0) ? 1.0f / base : base;
-        int x = (exponent < 0) ? -exponent : exponent;
-        while (x)
-        {
-            if (x & 1)
-            {
-                result *= mul;
-            }
-            mul *= mul;
-            x >>= 1;
-        }
-        return result;
-    }
-    
-    float Clamp(float val, float min, float max)
-    {
-        return GMATH_MAX(min, GMATH_MIN(max, val));
-    }
-    
-    float Lerp(float a, float b, float alpha)
-    {
-        float clamped_alpha = Clamp(alpha, 0.0f, 1.0f);
-        return (1.0f - clamped_alpha) * a + clamped_alpha * b;
-    }
-    
-    int Dot(IVec2 a, IVec2 b) {return a.x * b.x + a.y * b.y;}
-    int Dot(IVec3 a, IVec3 b) {return a.x * b.x + a.y + b.y + a.z * b.z;}
-    float Dot(Vec2 a, Vec2 b) {return a.x * b.x + a.y * b.y;}
-    float Dot(Vec3 a, Vec3 b) {return a.x * b.x + a.y * b.y + a.z * b.z;}
-    float Dot(Vec4 a, Vec4 b)
-    {
-        float result;
-#ifdef GMATH_USE_SSE
-        __m128 result_one = _mm_mul_ps(a.data_sse, b.data_sse);
-        __m128 result_two = _mm_shuffle_ps(result_one, result_two, _MM_SHUFFLE(2, 3, 0, 1));
-        result_one = _mm_add_ps(result_one, result_two);
-        result_two = _mm_shuffle_ps(result_one, result_one, _MM_SHUFFLE(0, 1, 2, 3));
-        result_one = _mm_add_ps(result_one, result_two);
-        _mm_store_ss(&result, result_one);
-#else
-        result = (a.x * b.x) + (a.y * b.y) + (a.z * b.z) + (a.w * b.w);
-#endif
-        return result;
-    }
-    
-    Vec3 Cross(Vec3 a, Vec3 b)
-    {
-        return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
-    }
-    
-    int LengthSquared(IVec2 vec)
-    {
-        return Dot(vec, vec);
-    }
-    
-    int LengthSquared(IVec3 vec)
-    {
-        return Dot(vec, vec);
-    }
-    
-    float LengthSquared(Vec2 vec)
-    {
-        return Dot(vec, vec);
-    }
-    
-    float LengthSquared(Vec3 vec)
-    {
-        return Dot(vec, vec);
-    }
-    
-    float LengthSquared(Vec4 vec)
-    {
-        return Dot(vec, vec);
-    }
-    
-    float Length(Vec2 vec)
-    {
-        return Sqrt(LengthSquared(vec));
-    }
-    
-    float Length(Vec3 vec)
-    {
-        return Sqrt(LengthSquared(vec));
-    }
-    
-    float Length(Vec4 vec)
-    {
-        return Sqrt(LengthSquared(vec));
-    }
-    
-    Vec2 Normalize(Vec2 vec)
-    {
-        float length = Length(vec);
-        return (length == 0.0f) ? Vec2::Zero : vec / length;
-    }
-    
-    Vec2 FastNormalize(Vec2 vec)
-    {
-        return vec * RSqrt(Dot(vec, vec));
-    }
-    
-    Vec2 SafeNormalize(Vec2 vec, float tolerance)
-    {
-        float length = Length(vec);
-        return (length < tolerance) ? Vec2::Zero : vec / length;
-    }
-    
-    Vec3 Normalize(Vec3 vec)
-    {
-        float length = Length(vec);
-        return (length == 0.0f) ? Vec3::Zero : vec / length;
-    }
-    
-    Vec3 FastNormalize(Vec3 vec)
-    {
-        return vec * RSqrt(Dot(vec, vec));
-    }
-    
-    Vec3 SafeNormalize(Vec3 vec, float tolerance)
-    {
-        float length = Length(vec);
-        return (length < tolerance) ? Vec3::Zero : vec / length;
-    }
-    
-    
-    Vec4 Normalize(Vec4 vec)
-    {
-        float length = Length(vec);
-        return (length == 0.0f) ? Vec4::Zero : vec / length;
-    }
-    
-    Vec4 FastNormalize(Vec4 vec)
-    {
-        return vec * RSqrt(Dot(vec, vec));
-    }
-    
-    Vec4 SafeNormalize(Vec4 vec, float tolerance)
-    {
-        float length = Length(vec);
-        return (length < tolerance) ? Vec4::Zero : vec / length;
-    }
-    
-    Vec2 ClampLength(Vec2 vec, float min, float max)
-    {
-        float length = Length(vec);
-        if (length < min || length > max) vec = Normalize(vec) * Clamp(length, min, max);
-        return vec;
-    }
-    
-    Vec3 ClampLength(Vec3 vec, float min, float max)
-    {
-        float length = Length(vec);
-        if (length < min || length > max) vec = Normalize(vec) * Clamp(length, min, max);
-        return vec;
-    }
-    
-    Vec4 ClampLength(Vec4 vec, float min, float max)
-    {
-        float length = Length(vec);
-        if (length < min || length > max) vec = Normalize(vec) * Clamp(length, min, max);
-        return vec;
-    }
-    
-    // Type conversions.
-    IVec2::operator Vec2() const
-    {
-        return {(float)x, (float)y};
-    }
-    
-    Vec2::operator IVec2() const
-    {
-        return {(int)x, (int)y};
-    }
-    
-    IVec3::operator Vec3() const
-    {
-        return {(float)x, (float)y, (float)z};
-    }
-    
-    Vec3::operator IVec3() const
-    {
-        return {(int)x, (int)y, (int)z};
-    }
-    
-    // Vector math.
-    
-    Vec4 CreateVec4(float fill)
-    {
-        Vec4 vec;
-#ifdef GMATH_USE_SSE
-        vec.data_sse = _mm_set1_ps(1.0f);
-#else
-        vec = {x, y, z, w};
-#endif
-        return vec;
-    }
-    
-    Vec4 CreateVec4(Vec3 xyz, float w)
-    {
-        Vec4 vec;
-#ifdef GMATH_USE_SSE
-        vec.data_sse = _mm_setr_ps(xyz.x, xyz.y, xyz.z, w);
-#else
-        vec = {xyz,x, xyz.y, xyz.z, w};
-#endif
-        return vec;
-    }
-    
-    Vec4 CreateVec4(float x, float y, float z, float w)
-    {
-        Vec4 vec;
-#ifdef GMATH_USE_SSE
-        vec.data_sse = _mm_setr_ps(x, y, z, w);
-#else
-        vec = {x, y, z, w};
-#endif
-        return vec;
-    }
-    
-    // Matrix math.
-    
-    Mat4 Transpose(Mat4 mat)
-    {
-#ifdef GMATH_USE_SSE
-        _MM_TRANSPOSE4_PS(mat.data_sse[0], mat.data_sse[1], mat.data_sse[2], mat.data_sse[3]);
-#else
-        Vec4 row1 = {mat.columns[0].x, mat.columns[1].x, mat.columns[2].x, mat.columns[3].x};
-        Vec4 row2 = {mat.columns[0].y, mat.columns[1].y, mat.columns[2].y, mat.columns[3].y};
-        Vec4 row3 = {mat.columns[0].z, mat.columns[1].z, mat.columns[2].z, mat.columns[3].z};
-        Vec4 row4 = {mat.columns[0].w, mat.columns[1].w, mat.columns[2].w, mat.columns[3].w};
-        mat[0] = row1;
-        mat[1] = row2;
-        mat[3] = row3;
-        mat[4] = row4;
-#endif
-        return mat;
-    }
-    
-    Mat4 CreateOrthoMatrix(float width, float height, float depth, float near_clip)
-    {
-        Mat4 result = {};
-        result[0][0] = 2.0f / width;
-        result[1][1] = 2.0f / height;
-#ifdef GMATH_DEPTH_ZERO_TO_ONE
-        float numerator = 1.0f;
-#else
-        float numerator = 2.0f;
-#endif
-#ifdef GMATH_RIGHT_HANDED
-        result[2][2] = -numerator / depth;
-#else
-        result[2][2] = numerator / depth;
-#endif
-        result[3][3] = 1.0f;
-        return result;
-    }
-    
-    Mat4 CreateOrthoMatrix(Vec3 extent, float near_clip)
-    {
-        return CreateOrthoMatrix(extent.width, extent.height, extent.depth, near_clip);
-    }
-    
-    Mat4 CreatePerspectiveMatrix(float fov, float aspect, float near, float far)
-    {
-        Mat4 result = {};
-        float cotan = 1.0f / Tan(fov * (GMATH_PI / 360.f));
-        result[0][0] = cotan / aspect;
-        result[1][1] = cotan;
-#ifdef GMATH_DEPTH_ZERO_TO_ONE
-        float numerator = near * far;
-#else
-        float numerator = near * far * 2.0f;
-#endif
-#ifdef GMATH_RIGHT_HANDED
-        result[2][2] = far / (near - far);
-        result[2][3] = -1.0f;
-        result[3][2] = numerator / (near - far);
-#else
-        result[2][2] = far / (far - near);
-        result[2][3] = 1.0f;
-        result[3][2] = numerator / (far - near);
-#endif
-        return result;
-    }
-    
-    Mat4 CreateTranslationMatrix(Vec3 translation)
-    {
-        Mat4 result = CreateMat4(1.0f);
-        result[3] = CreateVec4(translation, 1.0f);
-        return result;
-    }
-    
-    
-    Mat4 CreateScalingMatrix(Vec3 scale)
-    {
-        Mat4 result = {};
-        result[0][0] = scale.x;
-        result[1][1] = scale.y;
-        result[2][2] = scale.z;
-        result[3][3] = 1.0f;
-        return result;
-    }
-    
-#ifdef GMATH_USE_SSE
-    static inline __m128 LinearCombineSSE(__m128 left, Mat4 right)
-    {
-        __m128 result;
-        result = _mm_mul_ps(_mm_shuffle_ps(left, left, 0x00), right.data_sse[0]);
-        result = _mm_add_ps(result, _mm_mul_ps(_mm_shuffle_ps(left, left, 0x55), right.data_sse[1]));
-        result = _mm_add_ps(result, _mm_mul_ps(_mm_shuffle_ps(left, left, 0xaa), right.data_sse[2]));
-        result = _mm_add_ps(result, _mm_mul_ps(_mm_shuffle_ps(left, left, 0xff), right.data_sse[3]));
-        return result;
-    }
-#endif
-    
-    Mat4 operator*(Mat4 a, Mat4 b)
-    {
-        Mat4 result;
-#ifdef GMATH_USE_SSE
-        result.data_sse[0] = LinearCombineSSE(b.data_sse[0], a);
-        result.data_sse[1] = LinearCombineSSE(b.data_sse[1], a);
-        result.data_sse[2] = LinearCombineSSE(b.data_sse[2], a);
-        result.data_sse[3] = LinearCombineSSE(b.data_sse[3], a);
-#else
-        for (int i = 0; i < 4; ++i)
-        {
-            for (int j = 0; j < 4; ++j)
-            {
-                result[i][j] = a[0][j] * b[i][0] + a[1][j] * b[i][1] + a[2][j] * b[i][2] + a[3][j] * b[i][3];
-            }
-        }
-#endif
-        return result;
-    }
-    
-    Vec4 operator*(Mat4 mat, Vec4 vec)
-    {
-        Vec4 result;
-#ifdef GMATH_USE_SSE
-        result.data_sse = LinearCombineSSE(vec.data_sse, mat);
-#else
-        for (int i = 0; i < 4; ++i)
-        {
-            result[i] = mat[0][i] * vec[0] + mat[1][i] * vec[1] + mat[2][i] * vec[2] + mat[3][i] * vec[3];
-        }
-#endif
-        return result;
-    }
-    
-    Mat4 CreateRotationMatrix(Vec3 axis, float angle)
-    {
-        Mat4 result = {};
-        axis = Normalize(axis);
-        
-        float sin = Sin(Radians(angle));
-        float cos = Cos(Radians(angle));
-        float cos_value = 1.0f - cos;
-        result[0][0] = (axis.x * axis.x * cos_value) + cos;
-        result[0][1] = (axis.x * axis.y * cos_value) + (axis.z * sin);
-        result[0][2] = (axis.x * axis.z * cos_value) - (axis.y * sin);
-        
-        result[1][0] = (axis.y * axis.x * cos_value) - (axis.z * sin);;
-        result[1][1] = (axis.y * axis.y * cos_value) + cos;
-        result[1][2] = (axis.y * axis.z * cos_value) + (axis.x - sin);
-        
-        result[2][0] = (axis.z * axis.x * cos_value) + (axis.y * sin);
-        result[2][1] = (axis.z * axis.y * cos_value) - (axis.x * sin);
-        result[2][2] = (axis.z * axis.z * cos_value) + cos;
-        result[3][3] = 1.0f;
-        return result;
-    }
-    
-    Mat4 CreateLookAtMatrix(Vec3 location, Vec3 target, Vec3 world_up)
-    {
-        Mat4 result;
-#ifdef GMATH_RIGHT_HANDED
-        Vec3 forward = Normalize(location - target);
-        Vec3 axis = -forward;
-#else
-        Vec3 forward = Normalize(target - location);
-        Vec3 axis = forward;
-#endif
-        Vec3 right = Normalize(Cross(world_up, forward));
-        Vec3 up = Cross(forward, right);
-        result[0] = {right.x, up.x, axis.x, 0.0f};
-        result[1] = {right.y, up.y, axis.y, 0.0f};
-        result[2] = {right.z, up.z, axis.z, 0.0f};
-        result[3] = {-Dot(right, location), -Dot(up, location), -Dot(forward, location), 1.0f};
-        return result;
-    }
-    
-    Mat4 CreateMat4(Quat quat)
-    {
-        Mat4 mat = {};
-        quat = Normalize(quat);
-        float xx = quat.x * quat.x;
-        float yy = quat.y * quat.y;
-        float zz = quat.z * quat.z;
-        float xy = quat.x * quat.y;
-        float xz = quat.x * quat.z;
-        float yz = quat.y * quat.z;
-        float wx = quat.w * quat.x;
-        float wy = quat.w * quat.y;
-        float wz = quat.w * quat.z;
-        mat[0][0] = 1.0f - 2.0f * (yy + zz);
-        mat[0][1] = 2.0f * (xy + wz);
-        mat[0][2] = 2.0f * (xz - wy);
-        mat[0][3] = 0.0f;
-        
-        mat[1][0] = 2.0f * (xy - wz);
-        mat[1][1] = 1.0f - 2.0f * (xx + zz);
-        mat[1][2] = 2.0f * (yz + wx);
-        mat[1][3] = 0.0f;
-        
-        mat[2][0] = 2.0f * (xz + wy);
-        mat[2][1] = 2.0f * (yz - wx);
-        mat[2][2] = 1.0f - 2.0f * (xx + yy);
-        mat[2][3] = 0.0f;
-        
-        mat[3][0] = 0.0f;
-        mat[3][1] = 0.0f;
-        mat[3][2] = 0.0f;
-        mat[3][3] = 1.0f;
-        return mat;
-    }
-    
-    // Quaternion math.
-    
-    Quat CreateQuat(float x, float y, float z, float w)
-    {
-        Quat quat;
-#ifdef GMATH_USE_SSE
-        quat.data_sse = _mm_setr_ps(x, y, z, w);
-#else
-        quat = {x, y, z, w};
-#endif
-        return quat;
-    }
-    
-    Quat CreateQuat(Vec4 vec)
-    {
-        Quat quat;
-#ifdef GMATH_USE_SSE
-        quat.data_sse = vec.data_sse;
-#else
-        quat = {vec.x, vec.y, vec.z, vec.w};
-#endif
-        return quat;
-    }
-    
-    Quat CreateQuat(float fill)
-    {
-        Quat quat;
-#ifdef GMATH_USE_SSE
-        quat.data_sse = _mm_set1_ps(fill);
-#else
-        quat = {fill, fill, fill, fill};
-#endif
-        return quat;
-    }
-    
-    Quat CreateQuat(Vec3 axis, float angle)
-    {
-        Quat result;
-        axis = Normalize(axis);
-        float sin = Sin(angle / 2.0f);
-        result.xyz = axis * sin;
-        result.w = Cos(angle / 2.0f);
-        return result;
-    }
-    
-    // This method taken from Mike Day at Insomniac Games.
-    // https://d3cw3dd2w32x2b.cloudfront.net/wp-content/uploads/2015/01/matrix-to-quat.pdf
-    //
-    // Note that as mentioned at the top of the paper, the paper assumes the matrix
-    // would be *post*-multiplied to a vector to rotate it, meaning the matrix is
-    // the transpose of what we're dealing with. But, because our matrices are
-    // stored in column-major order, the indices *appear* to match the paper.
-    Quat CreateQuat(Mat4 mat)
-    {
-        float t;
-        Quat q;
-        if (mat[2][2] < 0.0f)
-        {
-            if (mat[0][0] > mat[1][1])
-            {
-                t = 1.0f + mat[0][0] - mat[1][1] - mat[2][2];
-                q = {t, mat[0][1] + mat[1][0], mat[2][0] + mat[0][2], mat[1][2] - mat[2][1]};
-            }
-            else
-            {
-                t = 1.0f - mat[0][0] + mat[1][1] - mat[2][2];
-                q = {mat[0][1] + mat[1][0], t, mat[1][2] + mat[2][1], mat[2][0] - mat[0][2]};
-            }
-        }
-        else
-        {
-            if (mat[0][0] < -mat[1][1])
-            {
-                t = 1.0f - mat[0][0] - mat[1][1] + mat[2][2];
-                q = {mat[2][0] + mat[0][2], mat[1][2] + mat[2][1], t, mat[0][1] - mat[1][0]};
-            }
-            else
-            {
-                t = 1.0f + mat[0][0] + mat[1][1] + mat[2][2];
-                q = {mat[1][2] - mat[2][1], mat[2][0] - mat[0][2], mat[0][1] - mat[1][0], t};
-            }
-        }
-        
-        return q * (0.5f / Sqrt(t));
-    }
-    
-    float Dot(Quat a, Quat b)
-    {
-        float result;
-#ifdef GMATH_USE_SSE
-        __m128 result_one = _mm_mul_ps(a.data_sse, b.data_sse);
-        __m128 result_two = _mm_shuffle_ps(result_one, result_one, _MM_SHUFFLE(2, 3, 0, 1));
-        result_one = _mm_add_ps(result_one, result_two);
-        result_two = _mm_shuffle_ps(result_one, result_one, _MM_SHUFFLE(0, 1, 2, 3));
-        result_one = _mm_add_ps(result_one, result_two);
-        _mm_store_ss(&result, result_one);
-#else
-        result = a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
-#endif
-        return result;
-    }
-    
-    Quat Normalize(Quat quat)
-    {
-        float length = Sqrt(Dot(quat, quat));
-        return (length == 0.0f) ? Quat::Zero : quat / length;
-    }
-    
-    Quat Lerp(Quat a, Quat b, float alpha)
-    {
-        Quat result;
-#ifdef GMATH_USE_SSE
-        float clamped_alpha = Clamp(alpha, 0.0f, 1.0f);
-        __m128 a_scalar = _mm_set1_ps(1.0f - clamped_alpha);
-        __m128 b_scalar = _mm_set1_ps(clamped_alpha);
-        __m128 result_one = _mm_mul_ps(a.data_sse, a_scalar);
-        __m128 result_two = _mm_mul_ps(b.data_sse, b_scalar);
-        result.data_sse = _mm_add_ps(result_one, result_two);
-#else
-        result.x = Lerp(a.x, b.x, alpha);
-        result.y = Lerp(a.y, b.y, alpha);
-        result.z = Lerp(a.z, b.z, alpha);
-        result.w = Lerp(a.w, b.w, alpha);
-#endif
-        return Normalize(result);
-    }
-    
-    Quat Slerp(Quat a, Quat b, float alpha)
-    {
-        float clamped_alpha = Clamp(alpha, 0.0f, 1.0f);
-        float angle = ACos(Dot(a, b));
-        Quat left = a * Sin((1.0f - clamped_alpha) * angle);
-        Quat right = b * Sin(clamped_alpha * angle);
-        return (left + right) * (1.0f / Sin(angle));
-    }
-    
-    Quat Invert(Quat quat)
-    {
-        return CreateQuat(-quat.x, -quat.y, -quat.z, quat.w) / Dot(quat, quat);
-    }
-    
-#ifdef GMATH_USE_NAMESPACE
-};
-#endif
-#endif // GMATH_IMPLEMENTATION
+#ifndef GMATH_H
+#define GMATH_H
+/*
+================================================================================
+
+Graphics Math Library version 1.1.2 (public domain)
+
+ GMath is a single-header C++ library for vector, matrix, and quaternion math,
+primarily for use in graphics applications. As a C++ only library it uses
+operator overloading to implement math operations, which is a bit cleaner and
+more intuitive than C style function calls. SSE optimizations, along with
+some misc math/matrix functions are borrowed from the Handmade Math library
+(also public domain).
+
+Tested with MSVC compiler v15.9.11.
+
+================================================================================
+
+USAGE
+
+To use the library, you must place the following two lines:
+
+#define GMATH_IMPLEMENTATION
+#include "GMath.h"
+
+in exactly one C++ file. You can then include this header file wherever needed.
+gmath.cpp, next to this file, is such a file, for builds that would rather
+compile it on its own or into a static library.
+
+The small, frequently called functions (the operators, Dot, Normalize, Slerp,
+Inverse, the packet math and so on) are inline, and defined in every file
+including GMath.h, so they can be inlined at their call sites. The rest (the
+batch functions, frustum and camera setup, arenas, spatial hashes, baked files,
+thread pools and printing) is compiled only with GMATH_IMPLEMENTATION, so the
+other files don't parse it, or the headers it needs. Building with link time
+optimization (e.g. -flto) lets the compiler inline those across files too.
+
+Files that only need the types, such as headers declaring GMath members and
+parameters or a precompiled header shared by many files, can include
+GMathTypes.h instead, which stops short of the inline definitions. A file that
+calls an inline function must include GMath.h itself.
+
+There are several options which alter the definitions provided by the library,
+and so require you comment or remove a line in this file:
+
+If you would like to use the library without SSE intrinsics, you must comment or
+ remove the following line:
+*/
+
+#ifndef GMATH_NO_SIMD
+#define GMATH_USE_SSE
+#endif
+
+/*
+If SSE is enabled and the compiler targets AVX2 and FMA (e.g. -mavx2 -mfma or
+/arch:AVX2), GMath will also use fused multiply-adds and 256 bit registers. If
+you would like to stay on plain SSE regardless, you must comment or remove the
+following line (half precision conversions use F16C whenever the compiler
+targets it, with -mf16c or /arch:AVX2, either way):
+*/
+
+#ifndef GMATH_NO_SIMD
+#define GMATH_USE_AVX
+#endif
+
+/*
+On AArch64 targets (e.g. Apple Silicon, AWS Graviton) GMath uses ARM NEON
+intrinsics in place of SSE. If you would like to use the library without NEON
+intrinsics, you must comment or remove the following line:
+*/
+
+#ifndef GMATH_NO_SIMD
+#define GMATH_USE_NEON
+#endif
+
+/*
+Alternatively, defining GMATH_NO_SIMD before including the header disables all
+of the SIMD paths above without editing this file. The benchmarks in bench/ use
+this to build a scalar reference.
+
+If you would like to use the library without the GMath namespace, you must
+ comment or remove the following line:
+*/
+
+#define GMATH_USE_NAMESPACE
+
+/*
+If you do not want the library to include <iosfwd> (and <ostream>, in the
+GMATH_IMPLEMENTATION file), and don't need the printing functions it provides,
+you must comment or remove the following line:
+*/
+
+#define GMATH_USE_IOSTREAM
+
+/*
+Matrices, and the Vec4s and Quats taken by the functions defined with the
+implementation, are passed by const reference, so a call that isn't inlined
+doesn't copy them through the stack. With MSVC on x86 or x64 you can also
+define GMATH_USE_VECTORCALL, which declares those functions as __vectorcall,
+so SIMD values are passed and returned in XMM registers where the ABI allows.
+It changes how the functions are called, so it must be defined the same way in
+every file including GMath.h:
+
+#define GMATH_USE_VECTORCALL
+#include "GMath.h"
+
+There are also several options which must be defined before you include the
+GMath.h header. The arena, thread pool and dispatch options below only change
+the functions compiled with GMATH_IMPLEMENTATION, so they only need to be
+defined in that file. The others (the <math.h> replacements, depth range,
+handedness, GMATH_FAST_TRIG and GMATH_PROFILE) also change inline functions, so
+they must be defined the same way in every file including GMath.h, most easily
+on the compiler command line (e.g. -DGMATH_FAST_TRIG, or /DGMATH_FAST_TRIG with
+MSVC). The examples below show them as #defines in front of the include:
+
+If you would like to avoid including <math.h>, you'll need to define the
+following, substituting your own functions for my_x_function:
+
+#define GMATH_EXP my_exp_function
+#define GMATH_LOG my_log_function
+#define GMATH_SIN my_sin_function
+#define GMATH_COS my_cos_function
+#define GMATH_TAN my_tan_function
+#define GMATH_ACOS my_acos_function
+#define GMATH_ATAN my_atan_function
+#define GMATH_SQRT my_sqrt_function
+#define GMATH_DSQRT my_double_sqrt_function
+#define GMATH_ATAN2 my_atan2_function
+#include "GMath.h"
+
+If you define all of these functions, then GMath will not include the <math.h>
+header. This is useful if you'd like to avoid depending on the CRT library.
+
+Similarly, the arenas (see Arena) allocate their memory with malloc and free,
+from <stdlib.h>, unless you define both of the following:
+
+#define GMATH_MALLOC my_malloc_function
+#define GMATH_FREE my_free_function
+#define GMATH_IMPLEMENTATION
+#include "GMath.h"
+
+The size of each thread's arena (see GetThreadArena) can be set the same way,
+in bytes, with GMATH_THREAD_ARENA_SIZE. It defaults to one megabyte.
+
+The thread pool behind CreateThreadPool uses <thread>, <mutex>,
+<condition_variable> and <atomic>. If you define GMATH_NO_THREADS in the source
+file, GMath won't include them, and the pool runs everything on the calling
+thread instead. The smallest chunk the parallel batch functions hand to a
+thread, in elements, can be set with GMATH_PARALLEL_MIN_CHUNK (2048 by default).
+
+When creating a projection matrix, the default behavior for GMATH is to use the
+range [-1..1] for depth. If you'd like to use the range [0..1], you must define
+GMATH_DEPTH_ZERO_TO_ONE in every file including GMath.h, like so:
+
+#define GMATH_DEPTH_ZERO_TO_ONE
+#include "GMath.h"
+
+By default, projection and view matrix functions assume a left-handed coordinate
+system. If you would instead like to use a right-handed system, you must define
+GMATH_RIGHT_HANDED in every file including GMath.h, like so:
+
+#define GMATH_RIGHT_HANDED
+#include "GMath.h"
+
+GMath can replace the <math.h> Sin, Cos, Tan, ACos, ATan, ATan2, Exp and Log
+(and so Pow) with its own range-reduced polynomials, which avoid the call
+overhead and branches of the CRT functions. To use them, you must define
+GMATH_FAST_TRIG in every file including GMath.h, like so:
+
+#define GMATH_FAST_TRIG
+#include "GMath.h"
+
+There are two accuracy tiers. GMATH_FAST_TRIG on its own (or defined as 1) is
+close to <math.h>, while defining it as 2 drops a term from the Sin, Cos, Exp
+and Log polynomials, for uses like animation where ~1e-5 relative error is
+invisible. Measured maximum error against double precision, in ULPs:
+
+    Function     Tier 1    Tier 2    Domain
+    Sin, Cos     3         27        |radians| <= 8192 (larger angles use
+                                     GMATH_SIN and GMATH_COS)
+    Exp          2         70        [-87.3, 88.72] (+inf above and 0
+                                     below)
+    Log          1         210       positive normal floats (tier 2 is worst
+                                     near 1, ~1.3e-5 relative error)
+    ACos         2         2         inputs clamped to [-1, 1]
+    ATan, ATan2  3         3
+
+The four wide Vec4 versions (Sin(Vec4), SinCos(Vec4, ...), etc.) always use
+these polynomials, at the tier chosen here, whether or not GMATH_FAST_TRIG is
+defined. Scalar or four wide, NaN, infinite and signed zero inputs give the
+same results as <math.h>, except that ACos clamps (so ACos(inf) is 0, not NaN).
+Pow is Exp(exp * Log(val)) with or without GMATH_FAST_TRIG, so it is NaN for
+negative bases, and for 0^0, inf^0 and 1^inf.
+
+On x86, an SSE build can also carry AVX2/FMA/F16C versions of the batch kernels
+(TransformVec4s, TransformPoints, TransformDirections and their Aligned forms,
+NormalizeBatch, SafeNormalizeBatch, CullSpheres, CullAABBs, PackHalf4Batch,
+UnpackHalf4Batch and MakeRelativeBatch)
+and choose between them at run time, so a single binary gets the wider kernels
+on the CPUs that have them. To do so, you must define GMATH_USE_DISPATCH in the
+source file, like so:
+
+#define GMATH_USE_DISPATCH
+#define GMATH_IMPLEMENTATION
+#include "GMath.h"
+
+The CPU is checked once, on first use, and GetCPUFeatures reports the result.
+This needs GCC, Clang or MSVC, and changes nothing when the compiler already
+targets AVX2.
+
+Since most of GMath is inlined into its callers, a sampling profiler rarely
+shows which functions are hot. If you define GMATH_PROFILE in every file
+including GMath.h, e.g. with -DGMATH_PROFILE on the compiler command line, then
+the heavier functions (Mat4 products and Inverse, CreateQuat from a matrix,
+Slerp, Normalize, the <math.h> wrappers and the batch functions) count their
+calls, elements and time in per-thread counters, read with GetProfileSnapshot
+(see ProfileCounter). The counting reads the clock twice per call, which can
+cost several times a Mat4 product, so the times are for ranking call sites
+rather than absolute. Without GMATH_PROFILE the counters are never touched and
+the snapshot is all zeros. Since a file built without it would inline the
+uncounted versions, a program mixing files built with and without
+GMATH_PROFILE fails to link (with GCC, Clang and MSVC), rather than quietly
+reporting only some of the calls.
+
+================================================================================
+
+LICENSE
+
+This software is dual-licensed to the public domain and under the following
+license: you are granted a perpetual, irrevocable license to copy, modify,
+publish, and distribute this file as you see fit.
+
+================================================================================
+
+CREDITS
+
+Primary Author: Matthew McLaurin (matthew@matthewmclaurin.com)
+
+GMath includes parts of version 1.9.0 of the Handmade Math library, which you
+can find at the following link:
+
+https://github.com/HandmadeMath/Handmade-Math
+
+Handmade Math Credits:
+Primary Author: Zakary Strange (zak@strangedev.net && @strangezak)
+
+Functionality: Matt Mascarenhas (@miblo_), Aleph, FieryDrake (@fierydrake),
+Gingerbill (@TheGingerBill), Ben Visness (@bvisness),
+Trinton Bullard (@Peliex_Dev), @AntonDan
+
+Fixes: Jeroen van Rijn (@J_vanRijn), Kiljacken (@Kiljacken),
+Insofaras (@insofaras), Daniel Gibson (@DanielGibson)
+
+===============================================================================
+
+STILL TO DO
+
+- Split operators between the include and implementation guard, to make it
+easier to scan through the header portion and see all the types/functions.
+
+- Add more helper functions, generally. Things like NearlyEqual and Distance
+for vectors, more matrix helpers, etc. Maybe quaternion functions that don't
+normalize, etc.
+
+- Write a nice little GitHub readme, or at the very least copy-paste this
+comment into the readme.
+
+================================================================================
+*/
+
+#ifdef _MSC_VER
+#pragma warning(disable:4201)
+#endif
+
+#ifdef __clang__
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wgnu-anonymous-struct"
+#endif
+
+#if defined(__GNUC__) && (__GNUC__ == 4 && __GNUC_MINOR__ < 8)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmissing-braces"
+#endif
+
+#ifdef GMATH_USE_SSE
+#undef GMATH_USE_SSE // We will redefine this if SSE is supported.
+#ifdef _MSC_VER
+// MSVC supports SSE in amd64 mode or _M_IX86_FP >= 1 (2 means SSE2).
+#if defined(_M_AMD64) || ( defined(_M_IX86_FP) && _M_IX86_FP >= 1 )
+#define GMATH_USE_SSE 1
+#endif // _M_AMD64 OR _M_IX86_FP >= 1
+#else // If not MSVC, check if SSE is supported anyway.
+#ifdef __SSE__
+#define GMATH_USE_SSE 1
+#endif // __SSE__
+#endif // _MSC_VER
+#endif // GMATH_USE_SSE
+
+#ifdef GMATH_USE_AVX
+#undef GMATH_USE_AVX // We will redefine this if AVX2 and FMA are supported.
+#ifdef GMATH_USE_SSE
+#ifdef _MSC_VER
+// MSVC defines __AVX2__ for /arch:AVX2, which also permits FMA instructions.
+#ifdef __AVX2__
+#define GMATH_USE_AVX 1
+#endif // __AVX2__
+#else // If not MSVC, AVX2 and FMA are reported separately.
+#if defined(__AVX2__) && defined(__FMA__)
+#define GMATH_USE_AVX 1
+#endif // __AVX2__ AND __FMA__
+#endif // _MSC_VER
+#endif // GMATH_USE_SSE
+#endif // GMATH_USE_AVX
+
+// Half precision conversions use F16C where the compiler targets it. MSVC has
+// no macro for it, but every AVX2 CPU supports it.
+#ifdef GMATH_USE_SSE
+#if defined(__F16C__) || (defined(_MSC_VER) && defined(__AVX2__))
+#define GMATH_USE_F16C 1
+#endif // __F16C__ OR (_MSC_VER AND __AVX2__)
+#endif // GMATH_USE_SSE
+
+// With GMATH_USE_DISPATCH an SSE build also compiles the AVX2 kernels, which GCC
+// and Clang allow per function (see GMATH_TARGET_AVX). GMATH_AVX_KERNELS is set
+// whenever they exist, either way.
+#if defined(GMATH_USE_DISPATCH) && defined(GMATH_USE_SSE) && !defined(GMATH_USE_AVX)
+#if defined(__GNUC__) || defined(_MSC_VER)
+#define GMATH_DISPATCH_AVX 1
+#endif // __GNUC__ OR _MSC_VER
+#endif // GMATH_USE_DISPATCH AND GMATH_USE_SSE AND NOT GMATH_USE_AVX
+
+#if defined(GMATH_USE_AVX) || defined(GMATH_DISPATCH_AVX)
+#define GMATH_AVX_KERNELS 1
+#endif
+
+#ifdef GMATH_USE_NEON
+#undef GMATH_USE_NEON // We will redefine this if NEON is supported.
+#ifndef GMATH_USE_SSE
+// Only AArch64 is supported, since 32 bit ARM lacks vector divide and sqrt.
+#if defined(_M_ARM64) || (defined(__aarch64__) && defined(__ARM_NEON))
+#define GMATH_USE_NEON 1
+#endif // _M_ARM64 OR __aarch64__
+#endif // GMATH_USE_SSE
+#endif // GMATH_USE_NEON
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef GMATH_USE_SSE
+#include <xmmintrin.h>
+#include <emmintrin.h>
+#endif
+
+#if defined(GMATH_USE_AVX) || defined(GMATH_USE_F16C) || defined(GMATH_DISPATCH_AVX)
+#include <immintrin.h>
+#endif
+
+#ifdef GMATH_USE_NEON
+#include <arm_neon.h>
+#endif
+
+#ifdef GMATH_USE_IOSTREAM
+#include <iosfwd>
+#endif
+
+#if !defined(GMATH_SIN) || !defined(GMATH_COS) || !defined(GMATH_TAN) || \
+!defined(GMATH_SQRT) || !defined(GMATH_EXP) || !defined(GMATH_LOG) ||    \
+!defined(GMATH_ACOS) || !defined(GMATH_ATAN)|| !defined(GMATH_ATAN2) || \
+!defined(GMATH_DSQRT)
+#include <math.h>
+#endif
+
+#ifndef GMATH_SIN
+#define GMATH_SIN sinf
+#endif
+
+#ifndef GMATH_COS
+#define GMATH_COS cosf
+#endif
+
+#ifndef GMATH_TAN
+#define GMATH_TAN tanf
+#endif
+
+#ifndef GMATH_SQRT
+#define GMATH_SQRT sqrtf
+#endif
+
+#ifndef GMATH_DSQRT
+#define GMATH_DSQRT sqrt
+#endif
+
+#ifndef GMATH_EXP
+#define GMATH_EXP expf
+#endif
+
+#ifndef GMATH_LOG
+#define GMATH_LOG logf
+#endif
+
+#ifndef GMATH_ACOS
+#define GMATH_ACOS acosf
+#endif
+
+#ifndef GMATH_ATAN
+#define GMATH_ATAN atanf
+#endif
+
+#ifndef GMATH_ATAN2
+#define GMATH_ATAN2 atan2f
+#endif
+
+#define GMATH_PI 3.14159265359f
+#define GMATH_HALF_PI 1.57079632679f
+#define GMATH_TWO_PI 6.28318530718f
+#define GMATH_E 2.71828182845f
+
+#define GMATH_MIN(a, b) (a) > (b) ? (b) : (a)
+#define GMATH_MAX(a, b) (a) < (b) ? (b) : (a)
+#define GMATH_ABS(a) ((a) > 0 ? (a) : -(a))
+#define GMATH_MOD(a, b) ((a) % (b)) >= 0 ? ((a) % (b)) : (((a) % (b)) + (b))
+
+// From C++14 on, the scalar constructors and operators are constexpr, so tables
+// of vectors and transforms built from literals fold at compile time. (C++11
+// constexpr is too restrictive for them, so they're just inline there.)
+#if __cplusplus >= 201402L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201402L)
+#define GMATH_CONSTEXPR constexpr
+#else
+#define GMATH_CONSTEXPR inline
+#endif
+
+// Calling convention for the functions taking or returning SIMD types. Other
+// compilers and targets already pass vectors in registers by default.
+#if defined(GMATH_USE_VECTORCALL) && defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86)) && !defined(_M_ARM64EC)
+#define GMATH_CALL __vectorcall
+#else
+#define GMATH_CALL
+#endif
+
+// Enables AVX2, FMA and F16C for the kernels chosen at run time. MSVC accepts
+// the intrinsics anywhere, and AVX2 builds have them enabled already.
+#if defined(GMATH_DISPATCH_AVX) && defined(__GNUC__)
+#define GMATH_TARGET_AVX __attribute__((target("avx2,fma,f16c")))
+#else
+#define GMATH_TARGET_AVX
+#endif
+
+// Instruction sets reported by GetCPUFeatures. GMATH_CPU_AVX2 also means FMA,
+// and the AVX flags are only set if the OS saves the wider registers.
+#define GMATH_CPU_SSE2 0x01
+#define GMATH_CPU_SSE41 0x02
+#define GMATH_CPU_AVX2 0x04
+#define GMATH_CPU_F16C 0x08
+#define GMATH_CPU_AVX512 0x10
+
+// From C++17 on, constants (Vec3::Up, Mat4::Identity, ...) are inline constexpr
+// variables, with a single definition program wide. Before that they are only
+// defined in the GMATH_IMPLEMENTATION file, and declared everywhere else.
+#if __cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
+#define GMATH_CONSTANT inline constexpr
+#define GMATH_DEFINE_CONSTANTS
+#else
+#define GMATH_CONSTANT const
+#ifdef GMATH_IMPLEMENTATION
+#define GMATH_DEFINE_CONSTANTS
+#endif
+#endif
+
+#ifdef GMATH_USE_NAMESPACE
+namespace GMath
+{
+#endif
+    // Forward declarations for types.
+    struct IVec2;
+    struct IVec3;
+    struct IVec4;
+    struct Vec2;
+    struct Vec3;
+    struct Vec3A;
+    struct Vec4;
+    struct Mat4;
+    struct Quat;
+    
+#ifdef GMATH_USE_SSE
+    // Computes (a * b) + c, as a single fused instruction when AVX is enabled.
+    static inline __m128 MultiplyAddSSE(__m128 a, __m128 b, __m128 c)
+    {
+#ifdef GMATH_USE_AVX
+        return _mm_fmadd_ps(a, b, c);
+#else
+        return _mm_add_ps(_mm_mul_ps(a, b), c);
+#endif
+    }
+    
+    static inline __m128d MultiplyAddSSE(__m128d a, __m128d b, __m128d c)
+    {
+#ifdef GMATH_USE_AVX
+        return _mm_fmadd_pd(a, b, c);
+#else
+        return _mm_add_pd(_mm_mul_pd(a, b), c);
+#endif
+    }
+#endif
+    
+#ifdef GMATH_USE_NEON
+    // NEON has no direct equivalent of _mm_setr_ps.
+    static inline float32x4_t SetNEON(float x, float y, float z, float w)
+    {
+        float values[4] = {x, y, z, w};
+        return vld1q_f32(values);
+    }
+#endif
+    
+    // Integer vector types (two, three and four components).
+    struct IVec2
+    {
+        union
+        {
+            struct {int x, y;};
+            struct {int r, g;};
+            struct {int width, height;};
+            int data[2];
+        };
+        inline int& operator[](int i) {return data[i];}
+        inline const int& operator[](int i) const {return data[i];}
+        GMATH_CONSTEXPR IVec2 operator-() const {return {-x, -y};}
+        GMATH_CONSTEXPR IVec2& operator++()
+        {
+            ++x;++y;
+            return *this;
+        }
+        GMATH_CONSTEXPR IVec2& operator--()
+        {
+            --x;
+            --y;
+            return *this;
+        }
+        GMATH_CONSTEXPR IVec2& operator+=(IVec2 vec)
+        {
+            x += vec.x;
+            y += vec.y;
+            return *this;
+        }
+        GMATH_CONSTEXPR IVec2& operator+=(int scalar)
+        {
+            x += scalar;
+            y += scalar;
+            return *this;
+        }
+        GMATH_CONSTEXPR IVec2& operator-=(IVec2 vec)
+        {
+            x -= vec.x;
+            y -= vec.y;
+            return *this;
+        }
+        GMATH_CONSTEXPR IVec2& operator-=(int scalar)
+        {
+            x -= scalar;
+            y -= scalar;
+            return *this;
+        }
+        inline operator Vec2() const;
+        const static IVec2 Zero;
+        const static IVec2 One;
+        const static IVec2 Right;
+        const static IVec2 Up;
+        const static IVec2 Left;
+        const static IVec2 Down;
+    };
+    GMATH_CONSTEXPR IVec2 CreateIVec2() {return {};};
+    GMATH_CONSTEXPR IVec2 CreateIVec2(int fill) {return {fill, fill};};
+    GMATH_CONSTEXPR IVec2 CreateIVec2(int x, int y) {return {x, y};};
+#ifdef GMATH_DEFINE_CONSTANTS
+    GMATH_CONSTANT IVec2 IVec2::Zero = {0, 0};
+    GMATH_CONSTANT IVec2 IVec2::One = {1, 1};
+    GMATH_CONSTANT IVec2 IVec2::Right = {1, 0};
+    GMATH_CONSTANT IVec2 IVec2::Up = {0, 1};
+    GMATH_CONSTANT IVec2 IVec2::Left = {-1, 0};
+    GMATH_CONSTANT IVec2 IVec2::Down = {0, -1};
+#endif
+    
+    GMATH_CONSTEXPR IVec2 operator*(int a, IVec2 b) {return {b.x * a, b.y * a};}
+    GMATH_CONSTEXPR IVec2 operator*(IVec2 a, int b) {return {a.x * b, a.y * b};}
+    GMATH_CONSTEXPR IVec2 operator/(int a, IVec2 b) {return {a / b.x, a / b.y};}
+    GMATH_CONSTEXPR IVec2 operator/(IVec2 a, int b) {return {a.x / b, a.y / b};}
+    GMATH_CONSTEXPR IVec2 operator+(int a, IVec2 b) {return {b.x + a, b.y + a};}
+    GMATH_CONSTEXPR IVec2 operator+(IVec2 a, int b) {return {a.x + b, a.y + b};}
+    GMATH_CONSTEXPR IVec2 operator-(int a, IVec2 b) {return {a - b.x, a - b.y};}
+    GMATH_CONSTEXPR IVec2 operator-(IVec2 a, int b) {return {a.x - b, a.y - b};}
+    GMATH_CONSTEXPR IVec2 operator*(IVec2 a, IVec2 b) {return {a.x * b.x, a.y * b.y};}
+    GMATH_CONSTEXPR IVec2 operator/(IVec2 a, IVec2 b) {return {a.x / b.x, a.y / b.y};}
+    GMATH_CONSTEXPR IVec2 operator+(IVec2 a, IVec2 b) {return {a.x + b.x, a.y + b.y};}
+    GMATH_CONSTEXPR IVec2 operator-(IVec2 a, IVec2 b) {return {a.x - b.x, a.y - b.y};}
+    GMATH_CONSTEXPR bool operator==(IVec2 a, IVec2 b) {return (a.x == b.x && a.y == b.y);}
+#ifdef GMATH_USE_IOSTREAM
+    std::ostream& operator<<(std::ostream& a, IVec2 b);
+#endif
+    struct IVec3
+    {
+        union
+        {
+            struct {int x, y, z;};
+            struct {int r, g, b;};
+            struct {int width, height, depth;};
+            struct {IVec2 xy; int ignored_0;};
+            struct {int ignored_1; IVec2 yz;};
+            struct {IVec2 rg; int ignored_2;};
+            struct {int ignored_3; IVec2 gb;};
+            int data[3];
+        };
+        inline int& operator[](int i) {return data[i];}
+        inline const int& operator[](int i) const {return data[i];}
+        GMATH_CONSTEXPR IVec3 operator-() const {return {-x, -y, -z};}
+        GMATH_CONSTEXPR IVec3& operator++()
+        {
+            ++x;
+            ++y;
+            ++z;
+            return *this;
+        }
+        GMATH_CONSTEXPR IVec3& operator--()
+        {
+            --x;
+            --y;
+            --z;
+            return *this;
+        }
+        GMATH_CONSTEXPR IVec3& operator+=(IVec3 vec)
+        {
+            x += vec.x;
+            y += vec.y;
+            z += vec.z;
+            return *this;
+        }
+        GMATH_CONSTEXPR IVec3& operator+=(int scalar)
+        {
+            x += scalar;
+            y += scalar;
+            z += scalar;
+            return *this;
+        }
+        GMATH_CONSTEXPR IVec3& operator-=(IVec3 vec)
+        {
+            x -= vec.x;
+            y -= vec.y;
+            z -= vec.z;
+            return *this;
+        }
+        GMATH_CONSTEXPR IVec3& operator-=(int scalar)
+        {
+            x -= scalar;
+            y -= scalar;
+            z -= scalar;
+            return *this;
+        }
+        GMATH_CONSTEXPR IVec3& operator*=(int scalar)
+        {
+            x *= scalar;
+            y *= scalar;
+            z *= scalar;
+            return *this;
+        }
+        GMATH_CONSTEXPR IVec3& operator/=(int scalar)
+        {
+            x /= scalar;
+            y /= scalar;
+            z /= scalar;
+            return *this;
+        }
+        inline operator Vec3() const;
+        const static IVec3 Zero;
+        const static IVec3 One;
+        const static IVec3 Right;
+        const static IVec3 Up;
+        const static IVec3 Left;
+        const static IVec3 Down;
+        const static IVec3 Forward;
+        const static IVec3 Backward;
+    };
+    GMATH_CONSTEXPR IVec3 CreateIVec3() {return {};};
+    GMATH_CONSTEXPR IVec3 CreateIVec3(int fill) {return {fill, fill, fill};};
+    GMATH_CONSTEXPR IVec3 CreateIVec3(IVec2 xy, int z) {return {xy.x, xy.y, z};};
+    GMATH_CONSTEXPR IVec3 CreateIVec3(int x, IVec2 yz) {return {x, yz.x, yz.y};};
+    GMATH_CONSTEXPR IVec3 CreateIVec3(int x, int y, int z) {return {x, y, z};};
+#ifdef GMATH_DEFINE_CONSTANTS
+    GMATH_CONSTANT IVec3 IVec3::Zero = {0, 0, 0};
+    GMATH_CONSTANT IVec3 IVec3::One = {1, 1, 1};
+    GMATH_CONSTANT IVec3 IVec3::Right = {1, 0, 0};
+    GMATH_CONSTANT IVec3 IVec3::Up = {0, 1, 0};
+    GMATH_CONSTANT IVec3 IVec3::Left = {-1, 0, 0};
+    GMATH_CONSTANT IVec3 IVec3::Down = {0, -1, 0};
+    GMATH_CONSTANT IVec3 IVec3::Forward = {0, 0, -1};
+    GMATH_CONSTANT IVec3 IVec3::Backward = {0, 0, 1};
+#endif
+    GMATH_CONSTEXPR IVec3 operator*(int a, IVec3 b) {return {b.x * a, b.y * a, b.z * a};}
+    GMATH_CONSTEXPR IVec3 operator*(IVec3 a, int b) {return {a.x * b, a.y * b, a.z * b};}
+    GMATH_CONSTEXPR IVec3 operator/(int a, IVec3 b) {return {a / b.x, a / b.y, a / b.z};}
+    GMATH_CONSTEXPR IVec3 operator/(IVec3 a, int b) {return {a.x / b, a.y / b, a.z / b};}
+    GMATH_CONSTEXPR IVec3 operator+(int a, IVec3 b) {return {b.x + a, b.y + a, b.z + a};}
+    GMATH_CONSTEXPR IVec3 operator+(IVec3 a, int b) {return {a.x + b, a.y + b, a.z + b};}
+    GMATH_CONSTEXPR IVec3 operator-(int a, IVec3 b) {return {a - b.x, a - b.y, a - b.z};}
+    GMATH_CONSTEXPR IVec3 operator-(IVec3 a, int b) {return {a.x - b, a.y - b, a.z - b};}
+    GMATH_CONSTEXPR IVec3 operator*(IVec3 a, IVec3 b) {return {a.x * b.x, a.y * b.y, a.z * b.z};}
+    GMATH_CONSTEXPR IVec3 operator/(IVec3 a, IVec3 b) {return {a.x / b.x, a.y / b.y, a.z / b.z};}
+    GMATH_CONSTEXPR IVec3 operator+(IVec3 a, IVec3 b) {return {a.x + b.x, a.y + b.y, a.z + b.z};}
+    GMATH_CONSTEXPR IVec3 operator-(IVec3 a, IVec3 b) {return {a.x - b.x, a.y - b.y, a.z - b.z};}
+    GMATH_CONSTEXPR bool operator==(IVec3 a, IVec3 b) {return (a.x == b.x && a.y == b.y && a.z == b.z);}
+#ifdef GMATH_USE_IOSTREAM
+    std::ostream& operator<<(std::ostream& a, IVec3 b);
+#endif
+    
+    // IVec4 uses SSE2 or NEON if enabled, like Vec4, for grid and voxel
+    // coordinates. Its operators and functions are defined with the
+    // implementation. Shifts apply to every component, and >> is arithmetic.
+    struct IVec4
+    {
+        union
+        {
+            int data[4];
+            struct
+            {
+                union
+                {
+                    IVec3 xyz;
+                    struct {int x, y, z;};
+                };
+                int w;
+            };
+#ifdef GMATH_USE_SSE
+            __m128i data_sse;
+#endif
+#ifdef GMATH_USE_NEON
+            int32x4_t data_neon;
+#endif
+        };
+        GMATH_CONSTEXPR int& operator[](int i) {return data[i];}
+        GMATH_CONSTEXPR const int& operator[](int i) const {return data[i];}
+        const static IVec4 Zero;
+        const static IVec4 One;
+    };
+    inline IVec4 GMATH_CALL CreateIVec4(int fill);
+    inline IVec4 GMATH_CALL CreateIVec4(IVec3 xyz, int w);
+    inline IVec4 GMATH_CALL CreateIVec4(int x, int y, int z, int w);
+#ifdef GMATH_DEFINE_CONSTANTS
+    GMATH_CONSTANT IVec4 IVec4::Zero = {0, 0, 0, 0};
+    GMATH_CONSTANT IVec4 IVec4::One = {1, 1, 1, 1};
+#endif
+    inline IVec4 GMATH_CALL operator-(const IVec4& vec);
+    inline IVec4 GMATH_CALL operator+(const IVec4& a, const IVec4& b);
+    inline IVec4 GMATH_CALL operator-(const IVec4& a, const IVec4& b);
+    inline IVec4 GMATH_CALL operator*(const IVec4& a, const IVec4& b);
+    inline IVec4 GMATH_CALL operator+(const IVec4& a, int b);
+    inline IVec4 GMATH_CALL operator-(const IVec4& a, int b);
+    inline IVec4 GMATH_CALL operator*(const IVec4& a, int b);
+    inline IVec4 GMATH_CALL operator&(const IVec4& a, const IVec4& b);
+    inline IVec4 GMATH_CALL operator|(const IVec4& a, const IVec4& b);
+    inline IVec4 GMATH_CALL operator^(const IVec4& a, const IVec4& b);
+    inline IVec4 GMATH_CALL operator<<(const IVec4& a, int shift);
+    inline IVec4 GMATH_CALL operator>>(const IVec4& a, int shift);
+    inline bool GMATH_CALL operator==(const IVec4& a, const IVec4& b);
+#ifdef GMATH_USE_IOSTREAM
+    std::ostream& operator<<(std::ostream& a, const IVec4& b);
+#endif
+    
+    // Floating point vector types (two, three, and four components).
+    // Four component vector uses SSE or NEON optimizations if enabled.
+    struct Vec2
+    {
+        union
+        {
+            struct {float x, y;};
+            struct {float r, g;};
+            struct {float u, v;};
+            struct {float width, height;};
+            float data[2];
+        };
+        inline float& operator[](int i) {return data[i];}
+        inline const float& operator[](int i) const {return data[i];}
+        GMATH_CONSTEXPR Vec2 operator-() const {return {-x, -y};}
+        GMATH_CONSTEXPR Vec2& operator+=(Vec2 vec)
+        {
+            x += vec.x;
+            y += vec.y;
+            return *this;
+        }
+        GMATH_CONSTEXPR Vec2& operator+=(float scalar)
+        {
+            x += scalar;
+            y += scalar;
+            return *this;
+        }
+        GMATH_CONSTEXPR Vec2& operator-=(Vec2 vec)
+        {
+            x -= vec.x;
+            y -= vec.y;
+            return *this;
+        }
+        GMATH_CONSTEXPR Vec2& operator-=(float scalar)
+        {
+            x -= scalar;
+            y -= scalar;
+            return *this;
+        }
+        GMATH_CONSTEXPR Vec2& operator*=(float scalar)
+        {
+            x *= scalar;
+            y *= scalar;
+            return *this;
+        }
+        GMATH_CONSTEXPR Vec2& operator/=(float scalar)
+        {
+            x /= scalar;
+            y /= scalar;
+            return *this;
+        }
+        inline operator IVec2() const;
+        const static Vec2 Zero;
+        const static Vec2 One;
+        const static Vec2 Right;
+        const static Vec2 Up;
+        const static Vec2 Left;
+        const static Vec2 Down;
+    };
+    GMATH_CONSTEXPR Vec2 CreateVec2() {return {};};
+    GMATH_CONSTEXPR Vec2 CreateVec2(float fill) {return {fill, fill};};
+    GMATH_CONSTEXPR Vec2 CreateVec2(float x, float y) {return {x, y};};
+#ifdef GMATH_DEFINE_CONSTANTS
+    GMATH_CONSTANT Vec2 Vec2::Zero = {0.0f, 0.0f};
+    GMATH_CONSTANT Vec2 Vec2::One = {1.0f, 1.0f};
+    GMATH_CONSTANT Vec2 Vec2::Right = {1.0f, 0.0f};
+    GMATH_CONSTANT Vec2 Vec2::Up = {0.0f, 1.0f};
+    GMATH_CONSTANT Vec2 Vec2::Left = {-1.0f, 0.0f};
+    GMATH_CONSTANT Vec2 Vec2::Down = {0.0f, -1.0f};
+#endif
+    GMATH_CONSTEXPR Vec2 operator*(float a, Vec2 b) {return {a * b.x, a * b.y};}
+    GMATH_CONSTEXPR Vec2 operator*(Vec2 a, float b) {return {a.x * b, a.y * b};}
+    GMATH_CONSTEXPR Vec2 operator/(float a, Vec2 b) {return {a / b.x, a / b.y};}
+    GMATH_CONSTEXPR Vec2 operator/(Vec2 a, float b) {return {a.x / b, a.y / b};}
+    GMATH_CONSTEXPR Vec2 operator+(float a, Vec2 b) {return {a + b.x, a + b.y};}
+    GMATH_CONSTEXPR Vec2 operator+(Vec2 a, float b) {return {a.x + b, a.y + b};}
+    GMATH_CONSTEXPR Vec2 operator-(float a, Vec2 b) {return {a - b.x, a - b.y};}
+    GMATH_CONSTEXPR Vec2 operator-(Vec2 a, float b) {return {a.x - b, a.y - b};}
+    GMATH_CONSTEXPR Vec2 operator*(Vec2 a, Vec2 b) {return {a.x * b.x, a.y * b.y};}
+    GMATH_CONSTEXPR Vec2 operator/(Vec2 a, Vec2 b) {return {a.x / b.x, a.y / b.y};}
+    GMATH_CONSTEXPR Vec2 operator+(Vec2 a, Vec2 b) {return {a.x + b.x, a.y + b.y};}
+    GMATH_CONSTEXPR Vec2 operator-(Vec2 a, Vec2 b) {return {a.x - b.x, a.y - b.y};}
+    GMATH_CONSTEXPR bool operator==(Vec2 a, Vec2 b) {return (a.x == b.x && a.y == b.y);}
+#ifdef GMATH_USE_IOSTREAM
+    std::ostream& operator<<(std::ostream& a, Vec2 b);
+#endif
+    struct Vec3
+    {
+        union
+        {
+            struct {float x, y, z;};
+            struct {float r, g, b;};
+            struct {float u, v, w;};
+            struct {float width, height, depth;};
+            float data[3];
+            
+            struct {Vec2 xy; float ignored_0;};
+            struct {float ignored_1; Vec2 yz;};
+            struct {Vec2 uv; float ignored_2;};
+            struct {float ignored_3; Vec2 vw;};
+            struct {Vec2 rg; float ignored_4;};
+            struct {float ignored_5; Vec2 gb;};
+        };
+        inline float& operator[](int i) {return data[i];}
+        inline const float& operator[](int i) const {return data[i];}
+        GMATH_CONSTEXPR Vec3 operator-() const {return {-x, -y, -z};}
+        GMATH_CONSTEXPR Vec3& operator+=(Vec3 vec)
+        {
+            x += vec.x;
+            y += vec.y;
+            z += vec.z;
+            return *this;
+        }
+        GMATH_CONSTEXPR Vec3& operator+=(float scalar)
+        {
+            x += scalar;
+            y += scalar;
+            z += scalar;
+            return *this;
+        }
+        GMATH_CONSTEXPR Vec3& operator-=(Vec3 vec)
+        {
+            x -= vec.x;
+            y -= vec.y;
+            z -= vec.z;
+            return *this;
+        }
+        GMATH_CONSTEXPR Vec3& operator-=(float scalar)
+        {
+            x -= scalar;
+            y -= scalar;
+            z -= scalar;
+            return *this;
+        }
+        GMATH_CONSTEXPR Vec3& operator*=(float scalar)
+        {
+            x *= scalar;
+            y *= scalar;
+            z *= scalar;
+            return *this;
+        }
+        GMATH_CONSTEXPR Vec3& operator/=(float scalar)
+        {
+            x /= scalar;
+            y /= scalar;
+            z /= scalar;
+            return *this;
+        }
+        inline operator IVec3() const;
+        const static Vec3 Zero;
+        const static Vec3 One;
+        const static Vec3 Right;
+        const static Vec3 Up;
+        const static Vec3 Left;
+        const static Vec3 Down;
+        const static Vec3 Forward;
+        const static Vec3 Backward;
+        const static Vec3 Red;
+        const static Vec3 Green;
+        const static Vec3 Blue;
+        const static Vec3 Cyan;
+        const static Vec3 Yellow;
+        const static Vec3 Purple;
+        const static Vec3 Black;
+        const static Vec3 White;
+    };
+    GMATH_CONSTEXPR Vec3 CreateVec3() {return {};};
+    GMATH_CONSTEXPR Vec3 CreateVec3(float fill) {return {fill, fill, fill};};
+    GMATH_CONSTEXPR Vec3 CreateVec3(Vec2 xy, float z) {return {xy.x, xy.y, z};};
+    GMATH_CONSTEXPR Vec3 CreateVec3(float x, Vec2 yz) {return {x, yz.x, yz.y};};
+    GMATH_CONSTEXPR Vec3 CreateVec3(float x, float y, float z) {return {x, y, z};};
+#ifdef GMATH_DEFINE_CONSTANTS
+    GMATH_CONSTANT Vec3 Vec3::Zero = {0.0f, 0.0f, 0.0f};
+    GMATH_CONSTANT Vec3 Vec3::One = {1.0f, 1.0f, 1.0f};
+    GMATH_CONSTANT Vec3 Vec3::Right = {1.0f, 0.0f, 0.0f};
+    GMATH_CONSTANT Vec3 Vec3::Up = {0.0f, 1.0f, 0.0f};
+    GMATH_CONSTANT Vec3 Vec3::Left = {-1.0f, 0.0f, 0.0f};
+    GMATH_CONSTANT Vec3 Vec3::Down = {0.0f, -1.0f, 0.0f};
+    GMATH_CONSTANT Vec3 Vec3::Forward = {0.0f, 0.0f, -1.0f};
+    GMATH_CONSTANT Vec3 Vec3::Backward = {0.0f, 0.0f, 1.0f};
+    GMATH_CONSTANT Vec3 Vec3::Red = {1.0f, 0.0f, 0.0f};
+    GMATH_CONSTANT Vec3 Vec3::Green = {0.0f, 1.0f, 0.0f};
+    GMATH_CONSTANT Vec3 Vec3::Blue = {0.0f, 0.0f, 1.0f};
+    GMATH_CONSTANT Vec3 Vec3::Cyan = {0.0f, 1.0f, 1.0f};
+    GMATH_CONSTANT Vec3 Vec3::Yellow = {1.0f, 1.0f, 0.0f};
+    GMATH_CONSTANT Vec3 Vec3::Purple = {1.0f, 0.0f, 1.0f};
+    GMATH_CONSTANT Vec3 Vec3::Black = {0.0f, 0.0f, 0.0f};
+    GMATH_CONSTANT Vec3 Vec3::White = {1.0f, 1.0f, 1.0f};
+#endif
+    GMATH_CONSTEXPR Vec3 operator*(float a, Vec3 b) {return {b.x * a, b.y * a, b.z * a};}
+    GMATH_CONSTEXPR Vec3 operator*(Vec3 a, float b) {return {a.x * b, a.y * b, a.z * b};}
+    GMATH_CONSTEXPR Vec3 operator/(float a, Vec3 b) {return {b.x / a, b.y / a, b.z / a};}
+    GMATH_CONSTEXPR Vec3 operator/(Vec3 a, float b) {return {a.x / b, a.y / b, a.z / b};}
+    GMATH_CONSTEXPR Vec3 operator+(float a, Vec3 b) {return {b.x + a, b.y + a, b.z + a};}
+    GMATH_CONSTEXPR Vec3 operator+(Vec3 a, float b) {return {a.x + b, a.y + b, a.z + b};}
+    GMATH_CONSTEXPR Vec3 operator-(float a, Vec3 b) {return {b.x - a, b.y - a, b.z - a};}
+    GMATH_CONSTEXPR Vec3 operator-(Vec3 a, float b) {return {a.x - b, a.y - b, a.z - b};}
+    GMATH_CONSTEXPR Vec3 operator*(Vec3 a, Vec3 b) {return {a.x * b.x, a.y * b.y, a.z * b.z};}
+    GMATH_CONSTEXPR Vec3 operator/(Vec3 a, Vec3 b) {return {a.x / b.x, a.y / b.y, a.z / b.z};}
+    GMATH_CONSTEXPR Vec3 operator+(Vec3 a, Vec3 b) {return {a.x + b.x, a.y + b.y, a.z + b.z};}
+    GMATH_CONSTEXPR Vec3 operator-(Vec3 a, Vec3 b) {return {a.x - b.x, a.y - b.y, a.z - b.z};}
+    GMATH_CONSTEXPR bool operator==(Vec3 a, Vec3 b) {return (a.x == b.x && a.y == b.y && a.z == b.z);}
+#ifdef GMATH_USE_IOSTREAM
+    std::ostream& operator<<(std::ostream& a, Vec3 b);
+#endif
+    
+    struct Vec4
+    {
+        union
+        {
+            float data[4];
+            struct
+            {
+                union
+                {
+                    Vec3 xyz;
+                    struct {float x, y, z;};
+                };
+                float w;
+            };
+            
+            struct
+            {
+                union
+                {
+                    Vec3 rgb;
+                    struct {float r, g, b;};
+                };
+                float a;
+            };
+            
+            struct
+            {
+                Vec2 xy;
+                float ignored_0;
+                float ignored_1;
+            };
+            
+            struct
+            {
+                float ignored_2;
+                Vec2 yz;
+                float ignored_3;
+            };
+            
+            struct
+            {
+                float ignored_4;
+                float ignored_5;
+                Vec2 zw;
+            };
+            
+            // SSE type (four packed single precision floats).
+#ifdef GMATH_USE_SSE
+            __m128 data_sse;
+#endif
+            // NEON type (four packed single precision floats).
+#ifdef GMATH_USE_NEON
+            float32x4_t data_neon;
+#endif
+        };
+        GMATH_CONSTEXPR float& operator[](int i) {return data[i];}
+        GMATH_CONSTEXPR const float& operator[](int i) const {return data[i];}
+        inline Vec4 operator-() const {return {-x, -y, -z, -w};}
+        
+        // Almost all Vec4 operators/functions from this point forward have three
+        // implementations: One for SSE, one for NEON, and one for neither.
+        inline Vec4& operator+=(Vec4 vec)
+        {
+#ifdef GMATH_USE_SSE
+            data_sse = _mm_add_ps(data_sse, vec.data_sse);
+#elif defined(GMATH_USE_NEON)
+            data_neon = vaddq_f32(data_neon, vec.data_neon);
+#else
+            x += vec.x;
+            y += vec.y;
+            z += vec.z;
+            w += vec.w;
+#endif
+            return *this;
+        }
+        inline Vec4& operator+=(float val)
+        {
+#ifdef GMATH_USE_SSE
+            __m128 scalar = _mm_set1_ps(val);
+            data_sse = _mm_add_ps(data_sse, scalar);
+#elif defined(GMATH_USE_NEON)
+            float32x4_t scalar = vdupq_n_f32(val);
+            data_neon = vaddq_f32(data_neon, scalar);
+#else
+            x += val;
+            y += val;
+            z += val;
+            w += val;
+#endif
+            return *this;
+        }
+        inline Vec4& operator-=(Vec4& vec)
+        {
+#ifdef GMATH_USE_SSE
+            data_sse = _mm_sub_ps(data_sse, vec.data_sse);
+#elif defined(GMATH_USE_NEON)
+            data_neon = vsubq_f32(data_neon, vec.data_neon);
+#else
+            x -= vec.x;
+            y -= vec.y;
+            z -= vec.z;
+            w -= vec.w;
+#endif
+            return *this;
+        }
+        inline Vec4& operator-=(float val)
+        {
+#ifdef GMATH_USE_SSE
+            __m128 scalar = _mm_set1_ps(val);
+            data_sse = _mm_sub_ps(data_sse, scalar);
+#elif defined(GMATH_USE_NEON)
+            float32x4_t scalar = vdupq_n_f32(val);
+            data_neon = vsubq_f32(data_neon, scalar);
+#else
+            x -= val;
+            y -= val;
+            z -= val;
+            w -= val;
+#endif
+            return *this;
+        }
+        inline Vec4& operator*=(float val)
+        {
+#ifdef GMATH_USE_SSE
+            __m128 scalar = _mm_set1_ps(val);
+            data_sse = _mm_mul_ps(data_sse, scalar);
+#elif defined(GMATH_USE_NEON)
+            float32x4_t scalar = vdupq_n_f32(val);
+            data_neon = vmulq_f32(data_neon, scalar);
+#else
+            x *= val;
+            y *= val;
+            z *= val;
+            w *= val;
+#endif
+            return *this;
+        }
+        inline Vec4& operator/=(float val)
+        {
+#ifdef GMATH_USE_SSE
+            __m128 scalar = _mm_set1_ps(val);
+            data_sse = _mm_div_ps(data_sse, scalar);
+#elif defined(GMATH_USE_NEON)
+            float32x4_t scalar = vdupq_n_f32(val);
+            data_neon = vdivq_f32(data_neon, scalar);
+#else
+            x /= val;
+            y /= val;
+            z /= val;
+            w /= val;
+#endif
+            return *this;
+        }
+        const static Vec4 Zero;
+        const static Vec4 One;
+        const static Vec4 Right;
+        const static Vec4 Up;
+        const static Vec4 Left;
+        const static Vec4 Down;
+        const static Vec4 Forward;
+        const static Vec4 Backward;
+        const static Vec4 Red;
+        const static Vec4 Green;
+        const static Vec4 Blue;
+        const static Vec4 Cyan;
+        const static Vec4 Yellow;
+        const static Vec4 Purple;
+        const static Vec4 Black;
+        const static Vec4 White;
+    };
+    inline Vec4 CreateVec4();
+    inline Vec4 GMATH_CALL CreateVec4(float fill);
+    inline Vec4 GMATH_CALL CreateVec4(Vec3 xyz, float w);
+    inline Vec4 GMATH_CALL CreateVec4(float x, float y, float z, float w);
+#ifdef GMATH_DEFINE_CONSTANTS
+    GMATH_CONSTANT Vec4 Vec4::Zero = {0.0f, 0.0f, 0.0f, 0.0f};
+    GMATH_CONSTANT Vec4 Vec4::One = {1.0f, 1.0f, 1.0f, 1.0f};
+    GMATH_CONSTANT Vec4 Vec4::Right = {1.0f, 0.0f, 0.0f, 0.0f};
+    GMATH_CONSTANT Vec4 Vec4::Up = {0.0f, 1.0f, 0.0f, 0.0f};
+    GMATH_CONSTANT Vec4 Vec4::Left = {-1.0f, 0.0f, 0.0f, 0.0f};
+    GMATH_CONSTANT Vec4 Vec4::Down = {0.0f, -1.0f, 0.0f, 0.0f};
+    GMATH_CONSTANT Vec4 Vec4::Forward = {0.0f, 0.0f, -1.0f, 0.0f};
+    GMATH_CONSTANT Vec4 Vec4::Backward = {0.0f, 0.0f, 1.0f, 0.0f};
+    GMATH_CONSTANT Vec4 Vec4::Red = {1.0f, 0.0f, 0.0f, 1.0f};
+    GMATH_CONSTANT Vec4 Vec4::Green = {0.0f, 1.0f, 0.0f, 1.0f};
+    GMATH_CONSTANT Vec4 Vec4::Blue = {0.0f, 0.0f, 1.0f, 1.0f};
+    GMATH_CONSTANT Vec4 Vec4::Cyan = {0.0f, 1.0f, 1.0f, 1.0f};
+    GMATH_CONSTANT Vec4 Vec4::Yellow = {1.0f, 1.0f, 0.0f, 1.0f};
+    GMATH_CONSTANT Vec4 Vec4::Purple = {1.0f, 0.0f, 1.0f, 1.0f};
+    GMATH_CONSTANT Vec4 Vec4::Black = {0.0f, 0.0f, 0.0f, 0.0f};
+    GMATH_CONSTANT Vec4 Vec4::White = {1.0f, 1.0f, 1.0f, 1.0f};
+#endif
+    
+    inline Vec4 operator*(float a, Vec4 b)
+    {
+        Vec4 result;
+#ifdef GMATH_USE_SSE
+        __m128 scalar = _mm_set1_ps(a);
+        result.data_sse = _mm_mul_ps(scalar, b.data_sse);
+#elif defined(GMATH_USE_NEON)
+        float32x4_t scalar = vdupq_n_f32(a);
+        result.data_neon = vmulq_f32(scalar, b.data_neon);
+#else
+        result =  {a * b.x, a * b.y, a * b.z, a * b.w};
+#endif
+        return result;
+    }
+    inline Vec4 operator*(Vec4 a, float b)
+    {
+        Vec4 result;
+#ifdef GMATH_USE_SSE
+        __m128 scalar = _mm_set1_ps(b);
+        result.data_sse = _mm_mul_ps(a.data_sse, scalar);
+#elif defined(GMATH_USE_NEON)
+        float32x4_t scalar = vdupq_n_f32(b);
+        result.data_neon = vmulq_f32(a.data_neon, scalar);
+#else
+        result =  {a.x * b, a.y * b, a.z * b, a.w * b};
+#endif
+        return result;
+    }
+    inline Vec4 operator/(float a, Vec4 b)
+    {
+        Vec4 result;
+#ifdef GMATH_USE_SSE
+        __m128 scalar = _mm_set1_ps(a);
+        result.data_sse = _mm_div_ps(scalar, b.data_sse);
+#elif defined(GMATH_USE_NEON)
+        float32x4_t scalar = vdupq_n_f32(a);
+        result.data_neon = vdivq_f32(scalar, b.data_neon);
+#else
+        result =  {a / b.x, a / b.y, a / b.z, a / b.w};
+#endif
+        return result;
+    }
+    inline Vec4 operator/(Vec4 a, float b)
+    {
+        Vec4 result;
+#ifdef GMATH_USE_SSE
+        __m128 scalar = _mm_set1_ps(b);
+        result.data_sse = _mm_div_ps(a.data_sse, scalar);
+#elif defined(GMATH_USE_NEON)
+        float32x4_t scalar = vdupq_n_f32(b);
+        result.data_neon = vdivq_f32(a.data_neon, scalar);
+#else
+        result =  {a.x / b, a.y / b, a.z / b, a.w / b};
+#endif
+        return result;
+    }
+    inline Vec4 operator+(float a, Vec4 b)
+    {
+        Vec4 result;
+#ifdef GMATH_USE_SSE
+        __m128 scalar = _mm_set1_ps(a);
+        result.data_sse = _mm_add_ps(scalar, b.data_sse);
+#elif defined(GMATH_USE_NEON)
+        float32x4_t scalar = vdupq_n_f32(a);
+        result.data_neon = vaddq_f32(scalar, b.data_neon);
+#else
+        result =  {a + b.x, a + b.y, a + b.z, a + b.w};
+#endif
+        return result;
+    }
+    inline Vec4 operator+(Vec4 a, float b)
+    {
+        Vec4 result;
+#ifdef GMATH_USE_SSE
+        __m128 scalar = _mm_set1_ps(b);
+        result.data_sse = _mm_add_ps(a.data_sse, scalar);
+#elif defined(GMATH_USE_NEON)
+        float32x4_t scalar = vdupq_n_f32(b);
+        result.data_neon = vaddq_f32(a.data_neon, scalar);
+#else
+        result =  {a.x + b, a.y + b, a.z + b, a.w + b};
+#endif
+        return result;
+    }
+    inline Vec4 operator-(float a, Vec4 b)
+    {
+        Vec4 result;
+#ifdef GMATH_USE_SSE
+        __m128 scalar = _mm_set1_ps(a);
+        result.data_sse = _mm_sub_ps(scalar, b.data_sse);
+#elif defined(GMATH_USE_NEON)
+        float32x4_t scalar = vdupq_n_f32(a);
+        result.data_neon = vsubq_f32(scalar, b.data_neon);
+#else
+        result =  {a - b.x, a - b.y, a - b.z, a - b.w};
+#endif
+        return result;
+    }
+    inline Vec4 operator-(Vec4 a, float b)
+    {
+        Vec4 result;
+#ifdef GMATH_USE_SSE
+        __m128 scalar = _mm_set1_ps(b);
+        result.data_sse = _mm_sub_ps(a.data_sse, scalar);
+#elif defined(GMATH_USE_NEON)
+        float32x4_t scalar = vdupq_n_f32(b);
+        result.data_neon = vsubq_f32(a.data_neon, scalar);
+#else
+        result =  {a.x - b, a.y - b, a.z - b, a.w - b};
+#endif
+        return result;
+    }
+    inline Vec4 operator*(Vec4 a, Vec4 b)
+    {
+        Vec4 result;
+#ifdef GMATH_USE_SSE
+        result.data_sse = _mm_mul_ps(a.data_sse, b.data_sse);
+#elif defined(GMATH_USE_NEON)
+        result.data_neon = vmulq_f32(a.data_neon, b.data_neon);
+#else
+        result = {a.x * b.x, a.y * b.y, a.z * b.z, a.w * b.w};
+#endif
+        return result;
+    }
+    inline Vec4 operator/(Vec4 a, Vec4 b)
+    {
+        Vec4 result;
+#ifdef GMATH_USE_SSE
+        result.data_sse = _mm_div_ps(a.data_sse, b.data_sse);
+#elif defined(GMATH_USE_NEON)
+        result.data_neon = vdivq_f32(a.data_neon, b.data_neon);
+#else
+        result = {a.x / b.x, a.y / b.y, a.z / b.z, a.w / b.w};
+#endif
+        return result;
+    }
+    inline Vec4 operator+(Vec4 a, Vec4 b)
+    {
+        Vec4 result;
+#ifdef GMATH_USE_SSE
+        result.data_sse = _mm_add_ps(a.data_sse, b.data_sse);
+#elif defined(GMATH_USE_NEON)
+        result.data_neon = vaddq_f32(a.data_neon, b.data_neon);
+#else
+        result = {a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w};
+#endif
+        return result;
+    }
+    inline Vec4 operator-(Vec4 a, Vec4 b)
+    {
+        Vec4 result;
+#ifdef GMATH_USE_SSE
+        result.data_sse = _mm_sub_ps(a.data_sse, b.data_sse);
+#elif defined(GMATH_USE_NEON)
+        result.data_neon = vsubq_f32(a.data_neon, b.data_neon);
+#else
+        result = {a.x - b.x, a.y - b.y, a.z - b.z, a.w - b.w};
+#endif
+        return result;
+    }
+    inline bool operator==(Vec4 a, Vec4 b)
+    {
+        // TODO(Matt): SSE optimization?
+        return (a.x == b.x && a.y == b.y && a.z == b.z && a.w == b.w);
+    }
+#ifdef GMATH_USE_IOSTREAM
+    std::ostream& operator<<(std::ostream& a, Vec4 b);
+#endif
+    
+    // Three component vector padded to 16 bytes, for hot paths. It holds a
+    // whole SSE or NEON register like a Vec4, so its math is done four wide
+    // instead of component by component. The w lane is unspecified and is
+    // ignored by every function, which is what makes converting from a Vec4 or
+    // the xyz of a Quat free. Converting to a Vec3 is implicit.
+    
+    struct Vec3A
+    {
+        union
+        {
+            float data[4];
+            struct
+            {
+                union
+                {
+                    Vec3 xyz;
+                    struct {float x, y, z;};
+                };
+                float ignored_w;
+            };
+#ifdef GMATH_USE_SSE
+            __m128 data_sse;
+#endif
+#ifdef GMATH_USE_NEON
+            float32x4_t data_neon;
+#endif
+        };
+        Vec3A() = default;
+        inline float& operator[](int i) {return data[i];}
+        inline const float& operator[](int i) const {return data[i];}
+        inline operator Vec3() const {return xyz;}
+        inline Vec3A operator-() const
+        {
+            Vec3A result;
+#ifdef GMATH_USE_SSE
+            result.data_sse = _mm_xor_ps(data_sse, _mm_set1_ps(-0.0f));
+#elif defined(GMATH_USE_NEON)
+            result.data_neon = vnegq_f32(data_neon);
+#else
+            result = Vec3A(FromComponents(), -x, -y, -z);
+#endif
+            return result;
+        }
+        inline Vec3A& operator+=(Vec3A vec)
+        {
+#ifdef GMATH_USE_SSE
+            data_sse = _mm_add_ps(data_sse, vec.data_sse);
+#elif defined(GMATH_USE_NEON)
+            data_neon = vaddq_f32(data_neon, vec.data_neon);
+#else
+            x += vec.x;
+            y += vec.y;
+            z += vec.z;
+#endif
+            return *this;
+        }
+        inline Vec3A& operator-=(Vec3A vec)
+        {
+#ifdef GMATH_USE_SSE
+            data_sse = _mm_sub_ps(data_sse, vec.data_sse);
+#elif defined(GMATH_USE_NEON)
+            data_neon = vsubq_f32(data_neon, vec.data_neon);
+#else
+            x -= vec.x;
+            y -= vec.y;
+            z -= vec.z;
+#endif
+            return *this;
+        }
+        inline Vec3A& operator+=(float val)
+        {
+#ifdef GMATH_USE_SSE
+            __m128 scalar = _mm_set1_ps(val);
+            data_sse = _mm_add_ps(data_sse, scalar);
+#elif defined(GMATH_USE_NEON)
+            float32x4_t scalar = vdupq_n_f32(val);
+            data_neon = vaddq_f32(data_neon, scalar);
+#else
+            x += val;
+            y += val;
+            z += val;
+#endif
+            return *this;
+        }
+        inline Vec3A& operator-=(float val)
+        {
+#ifdef GMATH_USE_SSE
+            __m128 scalar = _mm_set1_ps(val);
+            data_sse = _mm_sub_ps(data_sse, scalar);
+#elif defined(GMATH_USE_NEON)
+            float32x4_t scalar = vdupq_n_f32(val);
+            data_neon = vsubq_f32(data_neon, scalar);
+#else
+            x -= val;
+            y -= val;
+            z -= val;
+#endif
+            return *this;
+        }
+        inline Vec3A& operator*=(float val)
+        {
+#ifdef GMATH_USE_SSE
+            __m128 scalar = _mm_set1_ps(val);
+            data_sse = _mm_mul_ps(data_sse, scalar);
+#elif defined(GMATH_USE_NEON)
+            float32x4_t scalar = vdupq_n_f32(val);
+            data_neon = vmulq_f32(data_neon, scalar);
+#else
+            x *= val;
+            y *= val;
+            z *= val;
+#endif
+            return *this;
+        }
+        inline Vec3A& operator/=(float val)
+        {
+#ifdef GMATH_USE_SSE
+            __m128 scalar = _mm_set1_ps(val);
+            data_sse = _mm_div_ps(data_sse, scalar);
+#elif defined(GMATH_USE_NEON)
+            float32x4_t scalar = vdupq_n_f32(val);
+            data_neon = vdivq_f32(data_neon, scalar);
+#else
+            x /= val;
+            y /= val;
+            z /= val;
+#endif
+            return *this;
+        }
+        const static Vec3A Zero;
+        const static Vec3A One;
+        const static Vec3A Right;
+        const static Vec3A Up;
+        const static Vec3A Left;
+        const static Vec3A Down;
+        const static Vec3A Forward;
+        const static Vec3A Backward;
+        
+    private:
+        // Vec3A isn't an aggregate, so a braced list of floats can't convert
+        // to it and make calls like Cross({1, 0, 0}, {0, 1, 0}) ambiguous. Use
+        // CreateVec3A instead. The constants are built with this constructor.
+        struct FromComponents {};
+        GMATH_CONSTEXPR Vec3A(FromComponents, float x_value, float y_value, float z_value) : data{x_value, y_value, z_value, 0.0f} {}
+    };
+    inline Vec3A CreateVec3A();
+    inline Vec3A GMATH_CALL CreateVec3A(float fill);
+    inline Vec3A GMATH_CALL CreateVec3A(float x, float y, float z);
+    inline Vec3A GMATH_CALL CreateVec3A(Vec3 vec);
+    inline Vec3A GMATH_CALL CreateVec3A(const Vec4& xyz);
+    inline Vec3A GMATH_CALL CreateVec3A(const Quat& xyz);
+    inline Vec4 GMATH_CALL CreateVec4(const Vec3A& xyz, float w);
+#ifdef GMATH_DEFINE_CONSTANTS
+    GMATH_CONSTANT Vec3A Vec3A::Zero = {FromComponents(), 0.0f, 0.0f, 0.0f};
+    GMATH_CONSTANT Vec3A Vec3A::One = {FromComponents(), 1.0f, 1.0f, 1.0f};
+    GMATH_CONSTANT Vec3A Vec3A::Right = {FromComponents(), 1.0f, 0.0f, 0.0f};
+    GMATH_CONSTANT Vec3A Vec3A::Up = {FromComponents(), 0.0f, 1.0f, 0.0f};
+    GMATH_CONSTANT Vec3A Vec3A::Left = {FromComponents(), -1.0f, 0.0f, 0.0f};
+    GMATH_CONSTANT Vec3A Vec3A::Down = {FromComponents(), 0.0f, -1.0f, 0.0f};
+    GMATH_CONSTANT Vec3A Vec3A::Forward = {FromComponents(), 0.0f, 0.0f, -1.0f};
+    GMATH_CONSTANT Vec3A Vec3A::Backward = {FromComponents(), 0.0f, 0.0f, 1.0f};
+#endif
+    
+    inline Vec3A operator*(float a, Vec3A b)
+    {
+        Vec3A result;
+#ifdef GMATH_USE_SSE
+        __m128 scalar = _mm_set1_ps(a);
+        result.data_sse = _mm_mul_ps(scalar, b.data_sse);
+#elif defined(GMATH_USE_NEON)
+        float32x4_t scalar = vdupq_n_f32(a);
+        result.data_neon = vmulq_f32(scalar, b.data_neon);
+#else
+        result = CreateVec3A(a * b.x, a * b.y, a * b.z);
+#endif
+        return result;
+    }
+    inline Vec3A operator*(Vec3A a, float b)
+    {
+        Vec3A result;
+#ifdef GMATH_USE_SSE
+        __m128 scalar = _mm_set1_ps(b);
+        result.data_sse = _mm_mul_ps(a.data_sse, scalar);
+#elif defined(GMATH_USE_NEON)
+        float32x4_t scalar = vdupq_n_f32(b);
+        result.data_neon = vmulq_f32(a.data_neon, scalar);
+#else
+        result = CreateVec3A(a.x * b, a.y * b, a.z * b);
+#endif
+        return result;
+    }
+    inline Vec3A operator/(float a, Vec3A b)
+    {
+        Vec3A result;
+#ifdef GMATH_USE_SSE
+        __m128 scalar = _mm_set1_ps(a);
+        result.data_sse = _mm_div_ps(scalar, b.data_sse);
+#elif defined(GMATH_USE_NEON)
+        float32x4_t scalar = vdupq_n_f32(a);
+        result.data_neon = vdivq_f32(scalar, b.data_neon);
+#else
+        result = CreateVec3A(a / b.x, a / b.y, a / b.z);
+#endif
+        return result;
+    }
+    inline Vec3A operator/(Vec3A a, float b)
+    {
+        Vec3A result;
+#ifdef GMATH_USE_SSE
+        __m128 scalar = _mm_set1_ps(b);
+        result.data_sse = _mm_div_ps(a.data_sse, scalar);
+#elif defined(GMATH_USE_NEON)
+        float32x4_t scalar = vdupq_n_f32(b);
+        result.data_neon = vdivq_f32(a.data_neon, scalar);
+#else
+        result = CreateVec3A(a.x / b, a.y / b, a.z / b);
+#endif
+        return result;
+    }
+    inline Vec3A operator+(float a, Vec3A b)
+    {
+        Vec3A result;
+#ifdef GMATH_USE_SSE
+        __m128 scalar = _mm_set1_ps(a);
+        result.data_sse = _mm_add_ps(scalar, b.data_sse);
+#elif defined(GMATH_USE_NEON)
+        float32x4_t scalar = vdupq_n_f32(a);
+        result.data_neon = vaddq_f32(scalar, b.data_neon);
+#else
+        result = CreateVec3A(a + b.x, a + b.y, a + b.z);
+#endif
+        return result;
+    }
+    inline Vec3A operator+(Vec3A a, float b)
+    {
+        Vec3A result;
+#ifdef GMATH_USE_SSE
+        __m128 scalar = _mm_set1_ps(b);
+        result.data_sse = _mm_add_ps(a.data_sse, scalar);
+#elif defined(GMATH_USE_NEON)
+        float32x4_t scalar = vdupq_n_f32(b);
+        result.data_neon = vaddq_f32(a.data_neon, scalar);
+#else
+        result = CreateVec3A(a.x + b, a.y + b, a.z + b);
+#endif
+        return result;
+    }
+    inline Vec3A operator-(float a, Vec3A b)
+    {
+        Vec3A result;
+#ifdef GMATH_USE_SSE
+        __m128 scalar = _mm_set1_ps(a);
+        result.data_sse = _mm_sub_ps(scalar, b.data_sse);
+#elif defined(GMATH_USE_NEON)
+        float32x4_t scalar = vdupq_n_f32(a);
+        result.data_neon = vsubq_f32(scalar, b.data_neon);
+#else
+        result = CreateVec3A(a - b.x, a - b.y, a - b.z);
+#endif
+        return result;
+    }
+    inline Vec3A operator-(Vec3A a, float b)
+    {
+        Vec3A result;
+#ifdef GMATH_USE_SSE
+        __m128 scalar = _mm_set1_ps(b);
+        result.data_sse = _mm_sub_ps(a.data_sse, scalar);
+#elif defined(GMATH_USE_NEON)
+        float32x4_t scalar = vdupq_n_f32(b);
+        result.data_neon = vsubq_f32(a.data_neon, scalar);
+#else
+        result = CreateVec3A(a.x - b, a.y - b, a.z - b);
+#endif
+        return result;
+    }
+    inline Vec3A operator*(Vec3A a, Vec3A b)
+    {
+        Vec3A result;
+#ifdef GMATH_USE_SSE
+        result.data_sse = _mm_mul_ps(a.data_sse, b.data_sse);
+#elif defined(GMATH_USE_NEON)
+        result.data_neon = vmulq_f32(a.data_neon, b.data_neon);
+#else
+        result = CreateVec3A(a.x * b.x, a.y * b.y, a.z * b.z);
+#endif
+        return result;
+    }
+    inline Vec3A operator/(Vec3A a, Vec3A b)
+    {
+        Vec3A result;
+#ifdef GMATH_USE_SSE
+        result.data_sse = _mm_div_ps(a.data_sse, b.data_sse);
+#elif defined(GMATH_USE_NEON)
+        result.data_neon = vdivq_f32(a.data_neon, b.data_neon);
+#else
+        result = CreateVec3A(a.x / b.x, a.y / b.y, a.z / b.z);
+#endif
+        return result;
+    }
+    inline Vec3A operator+(Vec3A a, Vec3A b)
+    {
+        Vec3A result;
+#ifdef GMATH_USE_SSE
+        result.data_sse = _mm_add_ps(a.data_sse, b.data_sse);
+#elif defined(GMATH_USE_NEON)
+        result.data_neon = vaddq_f32(a.data_neon, b.data_neon);
+#else
+        result = CreateVec3A(a.x + b.x, a.y + b.y, a.z + b.z);
+#endif
+        return result;
+    }
+    inline Vec3A operator-(Vec3A a, Vec3A b)
+    {
+        Vec3A result;
+#ifdef GMATH_USE_SSE
+        result.data_sse = _mm_sub_ps(a.data_sse, b.data_sse);
+#elif defined(GMATH_USE_NEON)
+        result.data_neon = vsubq_f32(a.data_neon, b.data_neon);
+#else
+        result = CreateVec3A(a.x - b.x, a.y - b.y, a.z - b.z);
+#endif
+        return result;
+    }
+    inline bool operator==(Vec3A a, Vec3A b)
+    {
+        return (a.x == b.x && a.y == b.y && a.z == b.z);
+    }
+#ifdef GMATH_USE_IOSTREAM
+    std::ostream& operator<<(std::ostream& a, Vec3A b);
+#endif
+    
+    // 4x4 Matrix type, column major. Uses SSE or NEON if enabled.
+    
+    struct Mat4
+    {
+        union
+        {
+            Vec4 columns[4];
+            
+#ifdef GMATH_USE_SSE
+            __m128 data_sse[4];
+#endif
+#ifdef GMATH_USE_NEON
+            float32x4_t data_neon[4];
+#endif
+        };
+        GMATH_CONSTEXPR Vec4& operator[](int i) {return columns[i];}
+        GMATH_CONSTEXPR const Vec4& operator[](int i) const {return columns[i];}
+        const static Mat4 Zero;
+        const static Mat4 Identity;
+    };
+    GMATH_CONSTEXPR Mat4 CreateMat4() {return {};};
+    GMATH_CONSTEXPR Mat4 CreateMat4(float diagonal)
+    {
+        return {{{{diagonal, 0.0f, 0.0f, 0.0f}, {0.0f, diagonal, 0.0f, 0.0f}, {0.0f, 0.0f, diagonal, 0.0f}, {0.0f, 0.0f, 0.0f, diagonal}}}};
+    };
+    inline Mat4 GMATH_CALL CreateMat4(const Quat& quat);
+#ifdef GMATH_DEFINE_CONSTANTS
+    GMATH_CONSTANT Mat4 Mat4::Zero = {};
+    GMATH_CONSTANT Mat4 Mat4::Identity = {{{{1.0f, 0.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 1.0f, 0.0f}, {0.0f, 0.0f, 0.0f, 1.0f}}}};
+#endif
+    
+    // Matrix constructors which don't need any transcendental functions are
+    // defined here rather than with the implementation, so they can be
+    // evaluated at compile time.
+    GMATH_CONSTEXPR Mat4 CreateOrthoMatrix(float width, float height, float depth, float near_clip)
+    {
+        Mat4 result = {};
+        result[0][0] = 2.0f / width;
+        result[1][1] = 2.0f / height;
+#ifdef GMATH_DEPTH_ZERO_TO_ONE
+        float numerator = 1.0f;
+#else
+        float numerator = 2.0f;
+#endif
+#ifdef GMATH_RIGHT_HANDED
+        result[2][2] = -numerator / depth;
+#else
+        result[2][2] = numerator / depth;
+#endif
+        result[3][3] = 1.0f;
+        return result;
+    }
+    
+    GMATH_CONSTEXPR Mat4 CreateOrthoMatrix(Vec3 extent, float near_clip)
+    {
+        return CreateOrthoMatrix(extent.x, extent.y, extent.z, near_clip);
+    }
+    
+    GMATH_CONSTEXPR Mat4 CreateTranslationMatrix(Vec3 translation)
+    {
+        Mat4 result = CreateMat4(1.0f);
+        result[3][0] = translation.x;
+        result[3][1] = translation.y;
+        result[3][2] = translation.z;
+        return result;
+    }
+    
+    GMATH_CONSTEXPR Mat4 CreateScalingMatrix(Vec3 scale)
+    {
+        Mat4 result = {};
+        result[0][0] = scale.x;
+        result[1][1] = scale.y;
+        result[2][2] = scale.z;
+        result[3][3] = 1.0f;
+        return result;
+    }
+    
+    // With AVX, the element-wise operators work on two columns per register.
+    // Mat4 is only 16 byte aligned, so they load and store it unaligned, which
+    // costs nothing extra when it happens to be 32 byte aligned.
+    inline Mat4 operator+(const Mat4& a, const Mat4& b)
+    {
+        Mat4 result;
+#ifdef GMATH_USE_AVX
+        _mm256_storeu_ps(result[0].data, _mm256_add_ps(_mm256_loadu_ps(a[0].data), _mm256_loadu_ps(b[0].data)));
+        _mm256_storeu_ps(result[2].data, _mm256_add_ps(_mm256_loadu_ps(a[2].data), _mm256_loadu_ps(b[2].data)));
+#else
+        result[0] = a[0] + b[0];
+        result[1] = a[1] + b[1];
+        result[2] = a[2] + b[2];
+        result[3] = a[3] + b[3];
+#endif
+        return result;
+    }
+    inline Mat4 operator-(const Mat4& a, const Mat4& b)
+    {
+        Mat4 result;
+#ifdef GMATH_USE_AVX
+        _mm256_storeu_ps(result[0].data, _mm256_sub_ps(_mm256_loadu_ps(a[0].data), _mm256_loadu_ps(b[0].data)));
+        _mm256_storeu_ps(result[2].data, _mm256_sub_ps(_mm256_loadu_ps(a[2].data), _mm256_loadu_ps(b[2].data)));
+#else
+        result[0] = a[0] - b[0];
+        result[1] = a[1] - b[1];
+        result[2] = a[2] - b[2];
+        result[3] = a[3] - b[3];
+#endif
+        return result;
+    }
+    inline Mat4 operator*(const Mat4& mat, float val)
+    {
+        Mat4 result;
+#ifdef GMATH_USE_AVX
+        __m256 scalar = _mm256_set1_ps(val);
+        _mm256_storeu_ps(result[0].data, _mm256_mul_ps(_mm256_loadu_ps(mat[0].data), scalar));
+        _mm256_storeu_ps(result[2].data, _mm256_mul_ps(_mm256_loadu_ps(mat[2].data), scalar));
+#else
+        result[0] = mat[0] * val;
+        result[1] = mat[1] * val;
+        result[2] = mat[2] * val;
+        result[3] = mat[3] * val;
+#endif
+        return result;
+    }
+    inline Mat4 operator/(const Mat4& mat, float val)
+    {
+        Mat4 result;
+#ifdef GMATH_USE_AVX
+        __m256 scalar = _mm256_set1_ps(val);
+        _mm256_storeu_ps(result[0].data, _mm256_div_ps(_mm256_loadu_ps(mat[0].data), scalar));
+        _mm256_storeu_ps(result[2].data, _mm256_div_ps(_mm256_loadu_ps(mat[2].data), scalar));
+#else
+        result[0] = mat[0] / val;
+        result[1] = mat[1] / val;
+        result[2] = mat[2] / val;
+        result[3] = mat[3] / val;
+#endif
+        return result;
+    }
+    inline Vec4 GMATH_CALL operator*(const Mat4& a, const Vec4& b);
+    inline Mat4 GMATH_CALL operator*(const Mat4& a, const Mat4& b);
+#ifdef GMATH_USE_IOSTREAM
+    std::ostream& operator<<(std::ostream& a, const Mat4& b);
+#endif
+    
+    // A lazily evaluated matrix product, for chains like proj * view * model * vec.
+    // Chain(proj) * view * model * vec applies model, view and proj to vec in
+    // turn, three matrix-vector products, rather than multiplying the matrices
+    // out first (two matrix-matrix products and a matrix-vector one, about
+    // three times the work). Evaluate gives the combined matrix. Each link
+    // points to its matrix and to the link before it, both of which may be
+    // temporaries, so a chain is only valid in the expression that builds it.
+    // Chains can't be copied and are only consumed as rvalues, so one saved in
+    // a variable can't be used afterwards.
+    struct Mat4Chain
+    {
+        const Mat4* mat;
+        const Mat4Chain* previous;
+        
+        Mat4Chain(const Mat4* link_mat, const Mat4Chain* link_previous) : mat(link_mat), previous(link_previous) {}
+        Mat4Chain(const Mat4Chain&) = delete;
+        Mat4Chain& operator=(const Mat4Chain&) = delete;
+    };
+    inline Mat4Chain Chain(const Mat4& mat) {return {&mat, 0};}
+    inline Mat4Chain operator*(Mat4Chain&& chain, const Mat4& mat) {return {&mat, &chain};}
+    inline Vec4 GMATH_CALL operator*(Mat4Chain&& chain, const Vec4& vec);
+    inline Mat4 GMATH_CALL Evaluate(Mat4Chain&& chain);
+    
+    // Quaternion type, uses SSE or NEON if enabled.
+    
+    struct Quat
+    {
+        union
+        {
+            float data[4];
+            struct
+            {
+                union
+                {
+                    Vec3 xyz;
+                    struct {float x, y, z;};
+                };
+                float w;
+            };
+#ifdef GMATH_USE_SSE
+            __m128 data_sse;
+#endif
+#ifdef GMATH_USE_NEON
+            float32x4_t data_neon;
+#endif
+        };
+        const static Quat Zero;
+        const static Quat Identity;
+    };
+    inline Quat CreateQuat();
+    inline Quat GMATH_CALL CreateQuat(float fill);
+    inline Quat GMATH_CALL CreateQuat(Vec3 axis, float angle);
+    inline Quat GMATH_CALL CreateQuat(float x, float y, float z, float w);
+    inline Quat GMATH_CALL CreateQuat(const Vec4& vec);
+    inline Quat GMATH_CALL CreateQuat(const Mat4& mat);
+#ifdef GMATH_DEFINE_CONSTANTS
+    GMATH_CONSTANT Quat Quat::Zero = {0.0f, 0.0f, 0.0f, 0.0f};
+    GMATH_CONSTANT Quat Quat::Identity = {0.0f, 0.0f, 0.0f, 1.0f};
+#endif
+    inline Quat operator+(Quat a, Quat b)
+    {
+        Quat result;
+#ifdef GMATH_USE_SSE
+        result.data_sse = _mm_add_ps(a.data_sse, b.data_sse);
+#elif defined(GMATH_USE_NEON)
+        result.data_neon = vaddq_f32(a.data_neon, b.data_neon);
+#else
+        result.x = a.x + b.x;
+        result.y = a.y + b.y;
+        result.z = a.z + b.z;
+        result.w = a.w + b.w;
+#endif
+        return result;
+    }
+    inline Quat operator-(Quat a, Quat b)
+    {
+        Quat result;
+#ifdef GMATH_USE_SSE
+        result.data_sse = _mm_sub_ps(a.data_sse, b.data_sse);
+#elif defined(GMATH_USE_NEON)
+        result.data_neon = vsubq_f32(a.data_neon, b.data_neon);
+#else
+        result.x = a.x - b.x;
+        result.y = a.y - b.y;
+        result.z = a.z - b.z;
+        result.w = a.w - b.w;
+#endif
+        return result;
+    }
+    
+    inline Quat operator*(Quat a, Quat b)
+    {
+        Quat result;
+#ifdef GMATH_USE_SSE
+        __m128 result_one = _mm_xor_ps(_mm_shuffle_ps(a.data_sse, a.data_sse, _MM_SHUFFLE(0, 0, 0, 0)), _mm_setr_ps(0.0f, -0.0f, 0.0f, -0.0f));
+        __m128 result_two = _mm_shuffle_ps(b.data_sse, b.data_sse, _MM_SHUFFLE(0, 1, 2, 3));
+        __m128 result_three = _mm_mul_ps(result_two, result_one);
+        
+        result_one = _mm_xor_ps(_mm_shuffle_ps(a.data_sse, a.data_sse, _MM_SHUFFLE(1, 1, 1, 1)) , _mm_setr_ps(0.0f, 0.0f, -0.0f, -0.0f));
+        result_two = _mm_shuffle_ps(b.data_sse, b.data_sse, _MM_SHUFFLE(1, 0, 3, 2));
+        result_three = MultiplyAddSSE(result_two, result_one, result_three);
+        
+        result_one = _mm_xor_ps(_mm_shuffle_ps(a.data_sse, a.data_sse, _MM_SHUFFLE(2, 2, 2, 2)), _mm_setr_ps(-0.0f, 0.0f, 0.0f, -0.0f));
+        result_two = _mm_shuffle_ps(b.data_sse, b.data_sse, _MM_SHUFFLE(2, 3, 0, 1));
+        result_three = MultiplyAddSSE(result_two, result_one, result_three);
+        
+        result_one = _mm_shuffle_ps(a.data_sse, a.data_sse, _MM_SHUFFLE(3, 3, 3, 3));
+        result_two = _mm_shuffle_ps(b.data_sse, b.data_sse, _MM_SHUFFLE(3, 2, 1, 0));
+        result.data_sse = MultiplyAddSSE(result_two, result_one, result_three);
+#elif defined(GMATH_USE_NEON)
+        // Same sign pattern as the SSE version; the shuffles map to rev64/ext.
+        float32x4_t b_yxwz = vrev64q_f32(b.data_neon);
+        float32x4_t b_zwxy = vextq_f32(b.data_neon, b.data_neon, 2);
+        float32x4_t b_wzyx = vextq_f32(b_yxwz, b_yxwz, 2);
+        float32x4_t result_one = vmulq_laneq_f32(SetNEON(1.0f, -1.0f, 1.0f, -1.0f), a.data_neon, 0);
+        float32x4_t result_three = vmulq_f32(b_wzyx, result_one);
+        result_one = vmulq_laneq_f32(SetNEON(1.0f, 1.0f, -1.0f, -1.0f), a.data_neon, 1);
+        result_three = vfmaq_f32(result_three, b_zwxy, result_one);
+        result_one = vmulq_laneq_f32(SetNEON(-1.0f, 1.0f, 1.0f, -1.0f), a.data_neon, 2);
+        result_three = vfmaq_f32(result_three, b_yxwz, result_one);
+        result.data_neon = vfmaq_laneq_f32(result_three, b.data_neon, a.data_neon, 3);
+#else
+        result.x = (a.x * b.w) + (a.y * b.z) - (a.z * b.y) + (a.w * b.x);
+        result.y = (-a.x * b.z) + (a.y * b.w) + (a.z * b.x) + (a.w * b.y);
+        result.z = (a.x * b.y) - (a.y * b.x) + (a.z * b.w) + (a.w * b.z);
+        result.w = (-a.x * b.x) - (a.y * b.y) - (a.z * b.z) + (a.w * b.w);
+#endif
+        return result;
+    }
+    
+    inline Quat operator*(Quat a, float b)
+    {
+        Quat result;
+#ifdef GMATH_USE_SSE
+        __m128 scalar = _mm_set1_ps(b);
+        result.data_sse = _mm_mul_ps(a.data_sse, scalar);
+#elif defined(GMATH_USE_NEON)
+        float32x4_t scalar = vdupq_n_f32(b);
+        result.data_neon = vmulq_f32(a.data_neon, scalar);
+#else
+        result = {a.x * b, a.y * b, a.z * b, a.w * b};
+#endif
+        return result;
+    }
+    
+    inline Quat operator*(float a, Quat b)
+    {
+        Quat result;
+#ifdef GMATH_USE_SSE
+        __m128 scalar = _mm_set1_ps(a);
+        result.data_sse = _mm_mul_ps(scalar, b.data_sse);
+#elif defined(GMATH_USE_NEON)
+        float32x4_t scalar = vdupq_n_f32(a);
+        result.data_neon = vmulq_f32(scalar, b.data_neon);
+#else
+        result = {a * b.x, a * b.y, a * b.z, a * b.w};
+#endif
+        return result;
+    }
+    inline Quat operator/(Quat a, float b)
+    {
+        Quat result;
+#ifdef GMATH_USE_SSE
+        __m128 scalar = _mm_set1_ps(b);
+        result.data_sse = _mm_div_ps(a.data_sse, scalar);
+#elif defined(GMATH_USE_NEON)
+        float32x4_t scalar = vdupq_n_f32(b);
+        result.data_neon = vdivq_f32(a.data_neon, scalar);
+#else
+        result = {a.x / b, a.y / b, a.z / b, a.w / b};
+#endif
+        return result;
+    }
+    
+    inline Quat operator/(float a, Quat b)
+    {
+        Quat result;
+#ifdef GMATH_USE_SSE
+        __m128 scalar = _mm_set1_ps(a);
+        result.data_sse = _mm_div_ps(scalar, b.data_sse);
+#elif defined(GMATH_USE_NEON)
+        float32x4_t scalar = vdupq_n_f32(a);
+        result.data_neon = vdivq_f32(scalar, b.data_neon);
+#else
+        result = {a / b.x, a / b.y, a / b.z, a / b.w};
+#endif
+        return result;
+    }
+    
+    
+#ifdef GMATH_USE_IOSTREAM
+    std::ostream& operator<<(std::ostream& a, Quat b);
+#endif
+    
+    // 3x4 affine transform type, row major. Each row holds three rotation/scale
+    // elements followed by a translation element, and the fourth row is always
+    // (0, 0, 0, 1), so it takes 48 bytes instead of 64. Note that indexing
+    // returns a row, where indexing a Mat4 returns a column. Uses SSE or NEON
+    // if enabled.
+    
+    struct Mat3x4
+    {
+        union
+        {
+            Vec4 rows[3];
+            
+#ifdef GMATH_USE_SSE
+            __m128 data_sse[3];
+#endif
+#ifdef GMATH_USE_NEON
+            float32x4_t data_neon[3];
+#endif
+        };
+        // Not an aggregate, so a braced list of floats can't convert to a
+        // Mat3x4 and make calls like CreateMat4({0, 0, 0, 1}) ambiguous.
+        Mat3x4() = default;
+        GMATH_CONSTEXPR Mat3x4(const Vec4& row_0, const Vec4& row_1, const Vec4& row_2) : rows{row_0, row_1, row_2} {}
+        inline Vec4& operator[](int i) {return rows[i];}
+        inline const Vec4& operator[](int i) const {return rows[i];}
+        const static Mat3x4 Identity;
+    };
+    inline Mat3x4 GMATH_CALL CreateMat3x4(const Mat4& mat);
+    inline Mat3x4 GMATH_CALL CreateMat3x4(const Quat& rotation);
+    inline Mat3x4 GMATH_CALL CreateMat3x4(const Quat& rotation, Vec3 translation);
+    inline Mat4 GMATH_CALL CreateMat4(const Mat3x4& affine);
+#ifdef GMATH_DEFINE_CONSTANTS
+    GMATH_CONSTANT Mat3x4 Mat3x4::Identity = {{1.0f, 0.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 1.0f, 0.0f}};
+#endif
+    inline Mat3x4 GMATH_CALL operator*(const Mat3x4& a, const Mat3x4& b);
+#ifdef GMATH_USE_IOSTREAM
+    std::ostream& operator<<(std::ostream& a, const Mat3x4& b);
+#endif
+    
+    // Dual quaternion type, for rigid transforms (rotation and translation) in
+    // 32 bytes. real is the rotation, and dual is half the translation (as a
+    // quaternion with w = 0) times the rotation. Multiplication composes like
+    // Mat4, so (a * b) applies b first. The operations work on the two Quats,
+    // so use SSE or NEON if enabled.
+    
+    struct DualQuat
+    {
+        Quat real;
+        Quat dual;
+        // Not an aggregate, so a braced list of floats can't convert to a
+        // DualQuat and make calls like CreateMat4({0, 0, 0, 1}) ambiguous.
+        DualQuat() = default;
+        GMATH_CONSTEXPR DualQuat(const Quat& real_part, const Quat& dual_part) : real(real_part), dual(dual_part) {}
+        const static DualQuat Identity;
+    };
+    inline DualQuat GMATH_CALL CreateDualQuat(const Quat& rotation, Vec3 translation);
+    inline DualQuat GMATH_CALL CreateDualQuat(const Mat4& rigid);
+    inline DualQuat GMATH_CALL CreateDualQuat(const Mat3x4& rigid);
+    inline Mat4 GMATH_CALL CreateMat4(const DualQuat& dual_quat);
+    inline Mat3x4 GMATH_CALL CreateMat3x4(const DualQuat& dual_quat);
+#ifdef GMATH_DEFINE_CONSTANTS
+    GMATH_CONSTANT DualQuat DualQuat::Identity = {{0.0f, 0.0f, 0.0f, 1.0f}, {0.0f, 0.0f, 0.0f, 0.0f}};
+#endif
+    inline DualQuat GMATH_CALL operator*(const DualQuat& a, const DualQuat& b);
+#ifdef GMATH_USE_IOSTREAM
+    std::ostream& operator<<(std::ostream& a, const DualQuat& b);
+#endif
+    
+    // Double precision types, for positions in worlds too large for float.
+    // DVec2 and DVec3 are plain structs like Vec2 and Vec3. DVec4, DQuat and
+    // DMat4 (column major, like Mat4) hold their values in two SSE2 or NEON
+    // registers per vector, or one with AVX. DQuat and DMat4 are built with
+    // CreateDQuat and CreateDMat4 (or CreateDTranslationMatrix). The usual way to render with them
+    // is camera relative: positions and transforms stay in double precision,
+    // and MakeRelative subtracts the camera position before rounding to float.
+    
+    struct DVec2
+    {
+        union
+        {
+            struct {double x, y;};
+            double data[2];
+        };
+        inline double& operator[](int i) {return data[i];}
+        inline const double& operator[](int i) const {return data[i];}
+        GMATH_CONSTEXPR DVec2 operator-() const {return {-x, -y};}
+        GMATH_CONSTEXPR DVec2& operator+=(DVec2 vec)
+        {
+            x += vec.x;
+            y += vec.y;
+            return *this;
+        }
+        GMATH_CONSTEXPR DVec2& operator-=(DVec2 vec)
+        {
+            x -= vec.x;
+            y -= vec.y;
+            return *this;
+        }
+        GMATH_CONSTEXPR DVec2& operator*=(double scalar)
+        {
+            x *= scalar;
+            y *= scalar;
+            return *this;
+        }
+        GMATH_CONSTEXPR DVec2& operator/=(double scalar)
+        {
+            x /= scalar;
+            y /= scalar;
+            return *this;
+        }
+    };
+    GMATH_CONSTEXPR DVec2 CreateDVec2() {return {};};
+    GMATH_CONSTEXPR DVec2 CreateDVec2(double fill) {return {fill, fill};};
+    GMATH_CONSTEXPR DVec2 CreateDVec2(double x, double y) {return {x, y};};
+    GMATH_CONSTEXPR DVec2 CreateDVec2(Vec2 vec) {return {vec.x, vec.y};};
+    GMATH_CONSTEXPR Vec2 CreateVec2(DVec2 vec) {return {(float)vec.x, (float)vec.y};};
+    GMATH_CONSTEXPR DVec2 operator*(double a, DVec2 b) {return {a * b.x, a * b.y};}
+    GMATH_CONSTEXPR DVec2 operator*(DVec2 a, double b) {return {a.x * b, a.y * b};}
+    GMATH_CONSTEXPR DVec2 operator/(DVec2 a, double b) {return {a.x / b, a.y / b};}
+    GMATH_CONSTEXPR DVec2 operator*(DVec2 a, DVec2 b) {return {a.x * b.x, a.y * b.y};}
+    GMATH_CONSTEXPR DVec2 operator/(DVec2 a, DVec2 b) {return {a.x / b.x, a.y / b.y};}
+    GMATH_CONSTEXPR DVec2 operator+(DVec2 a, DVec2 b) {return {a.x + b.x, a.y + b.y};}
+    GMATH_CONSTEXPR DVec2 operator-(DVec2 a, DVec2 b) {return {a.x - b.x, a.y - b.y};}
+    GMATH_CONSTEXPR bool operator==(DVec2 a, DVec2 b) {return (a.x == b.x && a.y == b.y);}
+#ifdef GMATH_USE_IOSTREAM
+    std::ostream& operator<<(std::ostream& a, DVec2 b);
+#endif
+    
+    struct DVec3
+    {
+        union
+        {
+            struct {double x, y, z;};
+            struct {DVec2 xy; double ignored_0;};
+            struct {double ignored_1; DVec2 yz;};
+            double data[3];
+        };
+        inline double& operator[](int i) {return data[i];}
+        inline const double& operator[](int i) const {return data[i];}
+        GMATH_CONSTEXPR DVec3 operator-() const {return {-x, -y, -z};}
+        GMATH_CONSTEXPR DVec3& operator+=(DVec3 vec)
+        {
+            x += vec.x;
+            y += vec.y;
+            z += vec.z;
+            return *this;
+        }
+        GMATH_CONSTEXPR DVec3& operator-=(DVec3 vec)
+        {
+            x -= vec.x;
+            y -= vec.y;
+            z -= vec.z;
+            return *this;
+        }
+        GMATH_CONSTEXPR DVec3& operator*=(double scalar)
+        {
+            x *= scalar;
+            y *= scalar;
+            z *= scalar;
+            return *this;
+        }
+        GMATH_CONSTEXPR DVec3& operator/=(double scalar)
+        {
+            x /= scalar;
+            y /= scalar;
+            z /= scalar;
+            return *this;
+        }
+    };
+    GMATH_CONSTEXPR DVec3 CreateDVec3() {return {};};
+    GMATH_CONSTEXPR DVec3 CreateDVec3(double fill) {return {fill, fill, fill};};
+    GMATH_CONSTEXPR DVec3 CreateDVec3(double x, double y, double z) {return {x, y, z};};
+    GMATH_CONSTEXPR DVec3 CreateDVec3(Vec3 vec) {return {vec.x, vec.y, vec.z};};
+    GMATH_CONSTEXPR Vec3 CreateVec3(DVec3 vec) {return {(float)vec.x, (float)vec.y, (float)vec.z};};
+    GMATH_CONSTEXPR DVec3 operator*(double a, DVec3 b) {return {a * b.x, a * b.y, a * b.z};}
+    GMATH_CONSTEXPR DVec3 operator*(DVec3 a, double b) {return {a.x * b, a.y * b, a.z * b};}
+    GMATH_CONSTEXPR DVec3 operator/(DVec3 a, double b) {return {a.x / b, a.y / b, a.z / b};}
+    GMATH_CONSTEXPR DVec3 operator*(DVec3 a, DVec3 b) {return {a.x * b.x, a.y * b.y, a.z * b.z};}
+    GMATH_CONSTEXPR DVec3 operator/(DVec3 a, DVec3 b) {return {a.x / b.x, a.y / b.y, a.z / b.z};}
+    GMATH_CONSTEXPR DVec3 operator+(DVec3 a, DVec3 b) {return {a.x + b.x, a.y + b.y, a.z + b.z};}
+    GMATH_CONSTEXPR DVec3 operator-(DVec3 a, DVec3 b) {return {a.x - b.x, a.y - b.y, a.z - b.z};}
+    GMATH_CONSTEXPR bool operator==(DVec3 a, DVec3 b) {return (a.x == b.x && a.y == b.y && a.z == b.z);}
+#ifdef GMATH_USE_IOSTREAM
+    std::ostream& operator<<(std::ostream& a, DVec3 b);
+#endif
+    
+    struct DVec4
+    {
+        union
+        {
+            double data[4];
+            struct
+            {
+                union
+                {
+                    DVec3 xyz;
+                    struct {double x, y, z;};
+                };
+                double w;
+            };
+#ifdef GMATH_USE_SSE
+            __m128d data_sse[2];
+#endif
+#ifdef GMATH_USE_NEON
+            float64x2_t data_neon[2];
+#endif
+        };
+        GMATH_CONSTEXPR double& operator[](int i) {return data[i];}
+        GMATH_CONSTEXPR const double& operator[](int i) const {return data[i];}
+    };
+    inline DVec4 GMATH_CALL CreateDVec4(double fill);
+    inline DVec4 GMATH_CALL CreateDVec4(DVec3 xyz, double w);
+    inline DVec4 GMATH_CALL CreateDVec4(double x, double y, double z, double w);
+    inline DVec4 GMATH_CALL CreateDVec4(const Vec4& vec);
+    inline Vec4 GMATH_CALL CreateVec4(const DVec4& vec);
+    inline DVec4 GMATH_CALL operator+(const DVec4& a, const DVec4& b);
+    inline DVec4 GMATH_CALL operator-(const DVec4& a, const DVec4& b);
+    inline DVec4 GMATH_CALL operator*(const DVec4& a, const DVec4& b);
+    inline DVec4 GMATH_CALL operator*(const DVec4& a, double b);
+    inline DVec4 GMATH_CALL operator*(double a, const DVec4& b);
+    inline DVec4 GMATH_CALL operator/(const DVec4& a, double b);
+#ifdef GMATH_USE_IOSTREAM
+    std::ostream& operator<<(std::ostream& a, const DVec4& b);
+#endif
+    
+    struct DQuat
+    {
+        union
+        {
+            double data[4];
+            struct
+            {
+                union
+                {
+                    DVec3 xyz;
+                    struct {double x, y, z;};
+                };
+                double w;
+            };
+#ifdef GMATH_USE_SSE
+            __m128d data_sse[2];
+#endif
+#ifdef GMATH_USE_NEON
+            float64x2_t data_neon[2];
+#endif
+        };
+        const static DQuat Identity;
+        DQuat() = default;
+        
+    private:
+        // DQuat isn't an aggregate, so a braced list of floats can't convert
+        // to it and make calls like Invert({0, 0, 0, 1}) ambiguous. Use
+        // CreateDQuat instead. The constants are built with this constructor.
+        struct FromComponents {};
+        GMATH_CONSTEXPR DQuat(FromComponents, double x_value, double y_value, double z_value, double w_value) : data{x_value, y_value, z_value, w_value} {}
+    };
+    inline DQuat GMATH_CALL CreateDQuat(double x, double y, double z, double w);
+    inline DQuat GMATH_CALL CreateDQuat(const Quat& quat);
+    inline Quat GMATH_CALL CreateQuat(const DQuat& quat);
+#ifdef GMATH_DEFINE_CONSTANTS
+    GMATH_CONSTANT DQuat DQuat::Identity = {FromComponents(), 0.0, 0.0, 0.0, 1.0};
+#endif
+    inline DQuat GMATH_CALL operator+(const DQuat& a, const DQuat& b);
+    inline DQuat GMATH_CALL operator-(const DQuat& a, const DQuat& b);
+    inline DQuat GMATH_CALL operator*(const DQuat& a, const DQuat& b);
+    inline DQuat GMATH_CALL operator*(const DQuat& a, double b);
+#ifdef GMATH_USE_IOSTREAM
+    std::ostream& operator<<(std::ostream& a, const DQuat& b);
+#endif
+    
+    struct DMat4
+    {
+        DVec4 columns[4];
+        // Not an aggregate, so a braced list of floats can't convert to a
+        // DMat4 and make calls like CreateMat4({0, 0, 0, 1}) ambiguous.
+        DMat4() = default;
+        GMATH_CONSTEXPR DMat4(const DVec4& column_0, const DVec4& column_1, const DVec4& column_2, const DVec4& column_3) : columns{column_0, column_1, column_2, column_3} {}
+        GMATH_CONSTEXPR DVec4& operator[](int i) {return columns[i];}
+        GMATH_CONSTEXPR const DVec4& operator[](int i) const {return columns[i];}
+        const static DMat4 Identity;
+    };
+    GMATH_CONSTEXPR DMat4 CreateDMat4(double diagonal)
+    {
+        return {{diagonal, 0.0, 0.0, 0.0}, {0.0, diagonal, 0.0, 0.0}, {0.0, 0.0, diagonal, 0.0}, {0.0, 0.0, 0.0, diagonal}};
+    };
+    GMATH_CONSTEXPR DMat4 CreateDTranslationMatrix(DVec3 translation)
+    {
+        DMat4 result = CreateDMat4(1.0);
+        result[3][0] = translation.x;
+        result[3][1] = translation.y;
+        result[3][2] = translation.z;
+        return result;
+    }
+    inline DMat4 GMATH_CALL CreateDMat4(const DQuat& quat);
+    inline DMat4 GMATH_CALL CreateDMat4(const Mat4& mat);
+    inline Mat4 GMATH_CALL CreateMat4(const DMat4& mat);
+#ifdef GMATH_DEFINE_CONSTANTS
+    GMATH_CONSTANT DMat4 DMat4::Identity = {{1.0, 0.0, 0.0, 0.0}, {0.0, 1.0, 0.0, 0.0}, {0.0, 0.0, 1.0, 0.0}, {0.0, 0.0, 0.0, 1.0}};
+#endif
+    inline DVec4 GMATH_CALL operator*(const DMat4& a, const DVec4& b);
+    inline DMat4 GMATH_CALL operator*(const DMat4& a, const DMat4& b);
+#ifdef GMATH_USE_IOSTREAM
+    std::ostream& operator<<(std::ostream& a, const DMat4& b);
+#endif
+    
+    // Structure-of-arrays packet types. Each holds four (or eight) Vec3s with
+    // one lane vector per component, so a single SSE instruction operates on
+    // every vector in the packet. Per-lane results (Dot, Length) come back as
+    // a Vec4 or Float8 with one value per vector.
+    
+    struct Float8
+    {
+        union
+        {
+            float data[8];
+            // No __m256 member: it would make alignof(Float8) 32 in AVX
+            // builds and 16 elsewhere, so the layout would depend on the
+            // flags each translation unit was compiled with.
+            Vec4 halves[2];
+        };
+        inline float& operator[](int i) {return data[i];}
+        inline const float& operator[](int i) const {return data[i];}
+    };
+    
+    struct Vec3x4
+    {
+        union
+        {
+            struct {Vec4 x, y, z;};
+            Vec4 data[3];
+        };
+        // Not an aggregate, so a braced list of floats can't convert to a
+        // packet and make calls like Cross({1, 0, 0}, {0, 1, 0}) ambiguous.
+        Vec3x4() = default;
+        inline Vec3x4(const Vec4& x_lanes, const Vec4& y_lanes, const Vec4& z_lanes)
+        {
+            x = x_lanes;
+            y = y_lanes;
+            z = z_lanes;
+        }
+        inline Vec3 Get(int i) const {return {x[i], y[i], z[i]};}
+        inline void Set(int i, Vec3 vec) {x[i] = vec.x; y[i] = vec.y; z[i] = vec.z;}
+    };
+    
+    struct IVec3x4
+    {
+        union
+        {
+            struct {IVec4 x, y, z;};
+            IVec4 data[3];
+        };
+        inline IVec3 Get(int i) const {return {x[i], y[i], z[i]};}
+        inline void Set(int i, IVec3 vec) {x[i] = vec.x; y[i] = vec.y; z[i] = vec.z;}
+    };
+    
+    struct Vec3x8
+    {
+        union
+        {
+            struct {Float8 x, y, z;};
+            Float8 data[3];
+        };
+        Vec3x8() = default;
+        inline Vec3x8(const Float8& x_lanes, const Float8& y_lanes, const Float8& z_lanes)
+        {
+            x = x_lanes;
+            y = y_lanes;
+            z = z_lanes;
+        }
+        inline Vec3 Get(int i) const {return {x[i], y[i], z[i]};}
+        inline void Set(int i, Vec3 vec) {x[i] = vec.x; y[i] = vec.y; z[i] = vec.z;}
+    };
+    
+    // Compressed storage types, see PackQuat48 and PackHalf4.
+    
+    struct Quat48
+    {
+        uint16_t data[3];
+    };
+    
+    struct Half4
+    {
+        uint16_t data[4];
+    };
+    
+    // Bounding volumes, and a view frustum to cull them against. The frustum is
+    // six planes (left, right, bottom, top, near, far), each a Vec4 (a, b, c, d)
+    // with a unit normal pointing inwards, so a point p is inside when
+    // a * p.x + b * p.y + c * p.z + d >= 0 for all six.
+    
+    struct Sphere
+    {
+        Vec3 center;
+        float radius;
+    };
+    
+    struct AABB
+    {
+        Vec3 min;
+        Vec3 max;
+    };
+    
+    struct Frustum
+    {
+        Vec4 planes[6];
+    };
+    
+    // Rays, and planes stored like the frustum's: a point p is in front of the
+    // plane when Dot(normal, p) + d > 0. The direction of a ray needn't be unit
+    // length; intersection distances are measured in multiples of it.
+    
+    struct Ray
+    {
+        Vec3 origin;
+        Vec3 direction;
+    };
+    
+    struct Plane
+    {
+        Vec3 normal;
+        float d;
+    };
+    
+    // Packets of four rays or boxes for BVH traversal, in the same SoA layout as
+    // Vec3x4.
+    
+    struct Rayx4
+    {
+        Vec3x4 origin;
+        Vec3x4 direction;
+    };
+    
+    struct AABBx4
+    {
+        Vec3x4 min;
+        Vec3x4 max;
+    };
+    
+    // Camera options, or'd together into Camera::options.
+#define GMATH_CAMERA_REVERSE_Z 0x1
+#define GMATH_CAMERA_INFINITE_FAR 0x2
+    
+    // A perspective camera which caches its matrices and frustum. The inputs
+    // are changed through the SetCamera functions, which note what they
+    // invalidate, and UpdateCamera recomputes just that: moving the camera
+    // redoes the view matrix but not the projection, a new aspect ratio the
+    // projection but not the Tan of the field of view, and so on. The results
+    // are read straight from the struct. far_clip is unused with
+    // GMATH_CAMERA_INFINITE_FAR.
+    struct Camera
+    {
+        Vec3 eye;
+        Vec3 target;
+        Vec3 up;
+        float fov;
+        float aspect;
+        float near_clip;
+        float far_clip;
+        uint32_t options;
+        
+        Mat4 view;
+        Mat4 projection;
+        Mat4 view_projection;
+        Mat4 inverse_view;
+        Mat4 inverse_projection;
+        Mat4 inverse_view_projection;
+        Frustum frustum;
+        
+        float cotan; // Of half the field of view, kept while fov is unchanged.
+        uint32_t dirty;
+    };
+    
+    // A bump allocator for per-frame scratch arrays. Allocations are carved off
+    // the front of one block in order, and released all at once by resetting
+    // (or rewinding) the arena, so the hot loop never touches the heap. peak
+    // records the most ever used, for sizing the block.
+    struct Arena
+    {
+        uint8_t* memory;
+        size_t capacity;
+        size_t used;
+        size_t peak;
+        void* allocation; // From GMATH_MALLOC, or 0 if the memory was supplied.
+    };
+    
+    // A spatial hash grid, from BuildSpatialHash. Each point is binned by the
+    // grid cell containing it, and each cell hashed to one of table_size
+    // buckets; the indices of the points in bucket b are indices[starts[b]] up
+    // to (not including) indices[starts[b + 1]], in increasing order.
+    struct SpatialHash
+    {
+        uint32_t* starts; // table_size + 1 entries.
+        uint32_t* indices; // capacity entries, the point indices by bucket.
+        uint32_t* buckets; // capacity entries, the bucket of each point.
+        float cell_size;
+        uint32_t table_size; // A power of two.
+        uint32_t capacity;
+        uint32_t count;
+        void* allocation;
+    };
+    
+    // Baked data, for transforms and animation tracks built offline and read in
+    // place (from a memory mapped file, say) with no parsing or conversion. A
+    // file is a BakedHeader, then section_count BakedSections, then each
+    // section's elements at its offset, a multiple of 64 bytes from the start.
+    // Elements are stored exactly as they are in memory: little endian IEEE
+    // floats, Vec3 as 12 bytes, Mat4 column major, Quat48 as three uint16_ts and
+    // so on. size is that of the whole file, and ids are the application's own.
+#define GMATH_BAKED_MAGIC 0x4B424D47 // "GMBK"
+#define GMATH_BAKED_VERSION 1
+#define GMATH_BAKED_ENDIAN_TAG 0x0102 // Reads as 0x0201 on the other endianness.
+#define GMATH_BAKED_ALIGNMENT 64
+    
+    // Section element types.
+#define GMATH_BAKED_BYTES 0
+#define GMATH_BAKED_FLOAT 1
+#define GMATH_BAKED_VEC3 2
+#define GMATH_BAKED_VEC4 3
+#define GMATH_BAKED_QUAT 4
+#define GMATH_BAKED_MAT4 5
+#define GMATH_BAKED_MAT3X4 6
+#define GMATH_BAKED_VEC3X4 7
+#define GMATH_BAKED_QUAT32 8
+#define GMATH_BAKED_QUAT48 9
+#define GMATH_BAKED_HALF4 10
+#define GMATH_BAKED_IVEC3 11
+    
+    struct BakedHeader
+    {
+        uint32_t magic;
+        uint16_t version;
+        uint16_t endian_tag;
+        uint32_t section_count;
+        uint32_t reserved;
+        uint64_t size;
+    };
+    
+    struct BakedSection
+    {
+        uint32_t id;
+        uint32_t type;
+        uint64_t offset;
+        uint64_t count;
+    };
+    
+    // A validated baked file. It points into the caller's memory, which must
+    // outlive it.
+    struct BakedFile
+    {
+        const uint8_t* data;
+        size_t size;
+        const BakedSection* sections;
+        uint32_t section_count;
+    };
+    
+    // Profiling counters, indexing ProfileSnapshot::counters (see
+    // GMATH_PROFILE). Each function is counted once per call, including calls
+    // GMath makes itself, e.g. Pow calling Exp and Log; NORMALIZE covers the
+    // Vec3, Vec4, Vec3A and Quat versions, and the batch counters the Aligned
+    // forms too.
+#define GMATH_PROFILE_MAT4_MULTIPLY 0
+#define GMATH_PROFILE_MAT4_INVERSE 1
+#define GMATH_PROFILE_CREATE_QUAT 2
+#define GMATH_PROFILE_SLERP 3
+#define GMATH_PROFILE_NORMALIZE 4
+#define GMATH_PROFILE_SIN 5
+#define GMATH_PROFILE_COS 6
+#define GMATH_PROFILE_TAN 7
+#define GMATH_PROFILE_SINCOS 8
+#define GMATH_PROFILE_ACOS 9
+#define GMATH_PROFILE_ATAN 10
+#define GMATH_PROFILE_ATAN2 11
+#define GMATH_PROFILE_EXP 12
+#define GMATH_PROFILE_LOG 13
+#define GMATH_PROFILE_POW 14
+#define GMATH_PROFILE_TRANSFORM_VEC4S 15
+#define GMATH_PROFILE_TRANSFORM_POINTS 16
+#define GMATH_PROFILE_TRANSFORM_DIRECTIONS 17
+#define GMATH_PROFILE_SLERP_BATCH 18
+#define GMATH_PROFILE_NLERP_BATCH 19
+#define GMATH_PROFILE_SKIN_VERTICES 20
+#define GMATH_PROFILE_UPDATE_WORLD_TRANSFORMS 21
+#define GMATH_PROFILE_CULL_SPHERES 22
+#define GMATH_PROFILE_CULL_AABBS 23
+#define GMATH_PROFILE_PACK_BATCH 24
+#define GMATH_PROFILE_UNPACK_BATCH 25
+#define GMATH_PROFILE_NORMALIZE_BATCH 26
+#define GMATH_PROFILE_COMPOSE_TRS_BATCH 27
+#define GMATH_PROFILE_DECOMPOSE 28
+#define GMATH_PROFILE_DECOMPOSE_BATCH 29
+#define GMATH_PROFILE_COUNT 30
+    
+    // elements is 1 per call, or the count for batch functions. ticks is the
+    // time spent inside, from the time stamp counter on x86 and the generic
+    // timer on AArch64 (0 elsewhere); nested calls count toward both.
+    struct ProfileCounter
+    {
+        uint64_t calls;
+        uint64_t elements;
+        uint64_t ticks;
+    };
+    
+    struct ProfileSnapshot
+    {
+        ProfileCounter counters[GMATH_PROFILE_COUNT];
+    };
+    
+    // A task system for the parallel batch functions. run(context, task,
+    // task_data, task_count) must call task(task_data, i) once for every i
+    // below task_count, on any threads and in any order, and return once all
+    // of the calls have. threads is how many it runs at once, which sets how
+    // finely the work is split. An Executor with run = 0 runs everything on
+    // the calling thread. Any task system can be wrapped this way, or see
+    // CreateThreadPool.
+    typedef void (*ParallelTask)(void* task_data, size_t index);
+    typedef void (*ParallelRange)(void* data, size_t begin, size_t end);
+    
+    struct Executor
+    {
+        void (*run)(void* context, ParallelTask task, void* task_data, size_t task_count);
+        void* context;
+        uint32_t threads;
+    };
+    
+    // Math function wrappers (inline, but enable compiler optimization if you
+    // care about these being fast).
+    inline float Sin(float radians);
+    inline float Cos(float radians);
+    inline float Tan(float radians);
+    inline float ACos(float cos);
+    inline float ATan(float tan);
+    inline float Exp(float val);
+    inline float Log(float val);
+    inline float ATan2(float y, float x);
+    inline float Pow(float val, float exp);
+    inline float Sqrt(float val);
+    inline float RSqrt(float val);
+    inline float Radians(float degrees);
+    inline float Degrees(float radians);
+    inline float Min(float a, float b);
+    inline float Max(float a, float b);
+    inline float Abs(float val);
+    inline int Mod(int a, int b);
+    inline float Pow(float base, int exponent);
+    
+    // Sine and cosine of the same angle, for about the cost of one of them.
+    inline void SinCos(float radians, float& sin, float& cos);
+    
+    // Four wide versions, applied to each lane of a Vec4. These always use the
+    // GMath polynomials (see GMATH_FAST_TRIG for their accuracy), so SoA and
+    // batch kernels can evaluate them without going through <math.h>.
+    inline void GMATH_CALL SinCos(const Vec4& radians, Vec4& sin, Vec4& cos);
+    inline Vec4 GMATH_CALL Sin(const Vec4& radians);
+    inline Vec4 GMATH_CALL Cos(const Vec4& radians);
+    inline Vec4 GMATH_CALL ACos(const Vec4& cos);
+    inline Vec4 GMATH_CALL ATan2(const Vec4& y, const Vec4& x);
+    inline Vec4 GMATH_CALL Exp(const Vec4& val);
+    inline Vec4 GMATH_CALL Log(const Vec4& val);
+    
+    // Utility functions.
+    inline float Clamp(float val, float min, float max);
+    inline float Lerp(float a, float b, float alpha);
+    inline int Dot(IVec2 a, IVec2 b);
+    inline int Dot(IVec3 a, IVec3 b);
+    inline float Dot(Vec2 a, Vec2 b);
+    inline float Dot(Vec3 a, Vec3 b);
+    inline float GMATH_CALL Dot(const Vec4& a, const Vec4& b);
+    inline float GMATH_CALL Dot(const Vec3A& a, const Vec3A& b);
+    inline Vec3 Cross(Vec3 a, Vec3 b);
+    inline Vec3A GMATH_CALL Cross(const Vec3A& a, const Vec3A& b);
+    inline int LengthSquared(IVec2 vec);
+    inline int LengthSquared(IVec3 vec);
+    inline float LengthSquared(Vec2 vec);
+    inline float LengthSquared(Vec3 vec);
+    inline float GMATH_CALL LengthSquared(const Vec4& vec);
+    inline float GMATH_CALL LengthSquared(const Vec3A& vec);
+    inline float Length(Vec2 vec);
+    inline float Length(Vec3 vec);
+    inline float GMATH_CALL Length(const Vec4& vec);
+    inline float GMATH_CALL Length(const Vec3A& vec);
+    
+    // Normalize returns a zero vector in case of a divide-by-zero.
+    // FastNormalize uses an inverse square root, and does no divide-by-zero check.
+    // SafeNormalize returns a zero vector if length < tolerance.
+    inline Vec2 Normalize(Vec2 vec);
+    inline Vec2 FastNormalize(Vec2 vec);
+    inline Vec2 SafeNormalize(Vec2 vec, float tolerance = 0.001f);
+    inline Vec3 Normalize(Vec3 vec);
+    inline Vec3 FastNormalize(Vec3 vec);
+    inline Vec3 SafeNormalize(Vec3 vec, float tolerance = 0.001f);
+    inline Vec4 GMATH_CALL Normalize(const Vec4& vec);
+    inline Vec4 GMATH_CALL FastNormalize(const Vec4& vec);
+    inline Vec4 GMATH_CALL SafeNormalize(const Vec4& vec, float tolerance = 0.001f);
+    inline Vec3A GMATH_CALL Normalize(const Vec3A& vec);
+    inline Vec3A GMATH_CALL FastNormalize(const Vec3A& vec);
+    inline Vec3A GMATH_CALL SafeNormalize(const Vec3A& vec, float tolerance = 0.001f);
+    
+    // Batch versions of Normalize and SafeNormalize, without a branch per
+    // vector. Four vectors are normalized per iteration in SoA form with SSE or
+    // NEON (eight with AVX). Zero length vectors always come out as zero, even
+    // with a tolerance of 0. in and out may be the same array, but must not
+    // otherwise overlap. accuracy is one of the following (which only choose
+    // between dividing and multiplying without SIMD):
+    //   GMATH_NORMALIZE_EXACT     the square root and divide Normalize does
+    //   GMATH_NORMALIZE_REFINED   the reciprocal square root estimate with a
+    //                             Newton-Raphson step, to within about 3e-7
+    //   GMATH_NORMALIZE_ESTIMATE  the estimate alone, like FastNormalize: to
+    //                             within 4e-4 with SSE, about 2e-5 on NEON
+    //                             (whose 8 bit estimate always gets one step)
+#define GMATH_NORMALIZE_EXACT 0
+#define GMATH_NORMALIZE_REFINED 1
+#define GMATH_NORMALIZE_ESTIMATE 2
+    void GMATH_CALL NormalizeBatch(const Vec2* in, Vec2* out, size_t count, int accuracy = GMATH_NORMALIZE_EXACT);
+    void GMATH_CALL NormalizeBatch(const Vec3* in, Vec3* out, size_t count, int accuracy = GMATH_NORMALIZE_EXACT);
+    void GMATH_CALL NormalizeBatch(const Vec4* in, Vec4* out, size_t count, int accuracy = GMATH_NORMALIZE_EXACT);
+    void GMATH_CALL NormalizeBatch(const Quat* in, Quat* out, size_t count, int accuracy = GMATH_NORMALIZE_EXACT);
+    void GMATH_CALL SafeNormalizeBatch(const Vec2* in, Vec2* out, size_t count, float tolerance = 0.001f, int accuracy = GMATH_NORMALIZE_EXACT);
+    void GMATH_CALL SafeNormalizeBatch(const Vec3* in, Vec3* out, size_t count, float tolerance = 0.001f, int accuracy = GMATH_NORMALIZE_EXACT);
+    void GMATH_CALL SafeNormalizeBatch(const Vec4* in, Vec4* out, size_t count, float tolerance = 0.001f, int accuracy = GMATH_NORMALIZE_EXACT);
+    void GMATH_CALL SafeNormalizeBatch(const Quat* in, Quat* out, size_t count, float tolerance = 0.001f, int accuracy = GMATH_NORMALIZE_EXACT);
+    
+    inline Vec2 ClampLength(Vec2 vec, float min, float max);
+    inline Vec3 ClampLength(Vec3 vec, float min, float max);
+    inline Vec4 GMATH_CALL ClampLength(const Vec4& vec, float min, float max);
+    inline Vec3A GMATH_CALL ClampLength(const Vec3A& vec, float min, float max);
+    
+    // a * b + c in one pass, as a fused multiply-add where the target has one
+    // (SSE with GMATH_USE_AVX, and NEON). Longer chains nest, so a * s + b * t - c
+    // is MultiplyAdd(a, s, MultiplyAdd(b, t, -c)). Vec3 has no SIMD form, and
+    // only fuses where the compiler contracts the expression itself.
+    inline Vec3 MultiplyAdd(Vec3 a, Vec3 b, Vec3 c);
+    inline Vec3 MultiplyAdd(Vec3 a, float b, Vec3 c);
+    inline Vec4 GMATH_CALL MultiplyAdd(const Vec4& a, const Vec4& b, const Vec4& c);
+    inline Vec4 GMATH_CALL MultiplyAdd(const Vec4& a, float b, const Vec4& c);
+    inline Vec3A GMATH_CALL MultiplyAdd(const Vec3A& a, const Vec3A& b, const Vec3A& c);
+    inline Vec3A GMATH_CALL MultiplyAdd(const Vec3A& a, float b, const Vec3A& c);
+    
+    // Matrix functions.
+    inline Mat4 GMATH_CALL Transpose(const Mat4& mat);
+    // fov is the vertical field of view in degrees. The ReverseZ versions map the
+    // near plane to the far end of the depth range and the far plane to the
+    // near one, which spreads float precision far more evenly over distance
+    // when the depth range is [0..1] (see GMATH_DEPTH_ZERO_TO_ONE). The
+    // Infinite versions put the far plane at infinity, which needs no far
+    // distance, and drops a divide.
+    Mat4 GMATH_CALL CreatePerspectiveMatrix(float fov, float aspect, float near, float far);
+    Mat4 GMATH_CALL CreatePerspectiveMatrixReverseZ(float fov, float aspect, float near, float far);
+    Mat4 GMATH_CALL CreatePerspectiveMatrixInfinite(float fov, float aspect, float near);
+    Mat4 GMATH_CALL CreatePerspectiveMatrixInfiniteReverseZ(float fov, float aspect, float near);
+    GMATH_CONSTEXPR Mat4 CreateOrthoMatrix(float width, float height, float depth, float near_clip);
+    GMATH_CONSTEXPR Mat4 CreateOrthoMatrix(Vec3 extent, float near_clip);
+    GMATH_CONSTEXPR Mat4 CreateTranslationMatrix(Vec3 translation);
+    inline Mat4 GMATH_CALL CreateRotationMatrix(Vec3 axis, float angle);
+    GMATH_CONSTEXPR Mat4 CreateScalingMatrix(Vec3 scale);
+    Mat4 GMATH_CALL CreateLookAtMatrix(Vec3 eye_location, Vec3 target, Vec3 world_up);
+    
+    // Inverse works on any invertible matrix. InverseAffine requires the last
+    // row to be (0, 0, 0, 1), and InverseRigid additionally requires the upper
+    // 3x3 to be a pure rotation, as produced by CreateTranslationMatrix,
+    // CreateRotationMatrix and CreateLookAtMatrix. None of them check for a
+    // singular matrix.
+    inline Mat4 GMATH_CALL Inverse(const Mat4& mat);
+    inline Mat4 GMATH_CALL InverseAffine(const Mat4& mat);
+    inline Mat4 GMATH_CALL InverseRigid(const Mat4& mat);
+    
+    // Batch transforms. These apply one matrix to a whole array, keeping the
+    // matrix in registers for the entire batch. TransformPoints treats each Vec3
+    // as a point (w = 1), TransformDirections as a direction (w = 0). The
+    // Aligned variants require in and out to be 16 byte aligned, the others
+    // accept any alignment. In and out may be the same array, but must not
+    // otherwise overlap.
+    void GMATH_CALL TransformVec4s(const Mat4& mat, const Vec4* in, Vec4* out, size_t count);
+    void GMATH_CALL TransformVec4sAligned(const Mat4& mat, const Vec4* in, Vec4* out, size_t count);
+    void GMATH_CALL TransformPoints(const Mat4& mat, const Vec3* in, Vec3* out, size_t count);
+    void GMATH_CALL TransformPointsAligned(const Mat4& mat, const Vec3* in, Vec3* out, size_t count);
+    void GMATH_CALL TransformDirections(const Mat4& mat, const Vec3* in, Vec3* out, size_t count);
+    void GMATH_CALL TransformDirectionsAligned(const Mat4& mat, const Vec3* in, Vec3* out, size_t count);
+    
+    // Affine transform functions. TransformPoint applies the translation,
+    // TransformDirection does not. CreateQuat assumes there is no scale.
+    inline Mat3x4 GMATH_CALL CreateTranslationMat3x4(Vec3 translation);
+    inline Mat3x4 GMATH_CALL CreateRotationMat3x4(Vec3 axis, float angle);
+    inline Mat3x4 GMATH_CALL CreateScalingMat3x4(Vec3 scale);
+    inline Quat GMATH_CALL CreateQuat(const Mat3x4& affine);
+    inline Vec3 GMATH_CALL TransformPoint(const Mat3x4& affine, Vec3 point);
+    inline Vec3 GMATH_CALL TransformDirection(const Mat3x4& affine, Vec3 direction);
+    
+    // Single vector transforms on Vec3A, which stays in a register throughout.
+    inline Vec3A GMATH_CALL TransformPoint(const Mat4& mat, const Vec3A& point);
+    inline Vec3A GMATH_CALL TransformDirection(const Mat4& mat, const Vec3A& direction);
+    inline Vec3A GMATH_CALL TransformPoint(const Mat3x4& affine, const Vec3A& point);
+    inline Vec3A GMATH_CALL TransformDirection(const Mat3x4& affine, const Vec3A& direction);
+    
+    // Translation, rotation and scale. ComposeTRS builds translation * rotation
+    // * scale directly, and expects a unit rotation (it doesn't normalize, which
+    // CreateMat4(Quat) does). Decompose splits a matrix back up, ignoring its
+    // last row: the scale is the length of each basis column, with x negated if
+    // the basis is mirrored, and the rotation is found without branches by
+    // picking the best conditioned of the four cases in CreateQuat(Mat4), and
+    // returned with w >= 0. Shear isn't recovered, and a zero scale leaves the
+    // rotation unspecified, but always a unit quaternion: the identity for a
+    // matrix whose basis is all zero. The Batch versions work on four
+    // transforms at a time in SoA form with SSE or NEON.
+    inline Mat4 GMATH_CALL ComposeTRS(Vec3 translation, const Quat& rotation, Vec3 scale);
+    inline Mat3x4 GMATH_CALL ComposeTRSMat3x4(Vec3 translation, const Quat& rotation, Vec3 scale);
+    inline void GMATH_CALL Decompose(const Mat4& mat, Vec3& translation, Quat& rotation, Vec3& scale);
+    inline void GMATH_CALL Decompose(const Mat3x4& affine, Vec3& translation, Quat& rotation, Vec3& scale);
+    void GMATH_CALL ComposeTRSBatch(const Vec3* translations, const Quat* rotations, const Vec3* scales, Mat4* out, size_t count);
+    void GMATH_CALL ComposeTRSBatch(const Vec3* translations, const Quat* rotations, const Vec3* scales, Mat3x4* out, size_t count);
+    void GMATH_CALL DecomposeBatch(const Mat4* mats, Vec3* translations, Quat* rotations, Vec3* scales, size_t count);
+    
+    // Transform hierarchies. Node i has local transform locals[i] and parent
+    // parents[i], or a negative parent for a root, and every parent must come
+    // before its children. UpdateWorldTransforms sets worlds[i] to
+    // worlds[parents[i]] * locals[i] (or locals[i] for a root) for the nodes in
+    // [begin, end), in order. With dirty non-null it only updates nodes which
+    // are dirty or whose parent is, and marks the latter dirty as well, so that
+    // afterwards dirty flags exactly the nodes whose world transform changed.
+    // For nodes stored breadth first, FindHierarchyLevels writes the first node
+    // of each depth level to level_starts, followed by count, and returns the
+    // number of levels; level_starts must hold count + 1 entries. No node in a
+    // level depends on another in the same level, so each level's range can be
+    // split across threads, provided each level finishes before the next
+    // starts (the overloads taking an Executor, below, do this). Dirty flags
+    // are bytes, so that threads never write to the same one.
+    size_t FindHierarchyLevels(const int32_t* parents, size_t count, size_t* level_starts);
+    void GMATH_CALL UpdateWorldTransforms(const int32_t* parents, const Mat4* locals, Mat4* worlds, uint8_t* dirty, size_t begin, size_t end);
+    void GMATH_CALL UpdateWorldTransforms(const int32_t* parents, const Mat3x4* locals, Mat3x4* worlds, uint8_t* dirty, size_t begin, size_t end);
+    
+    // SoA packet functions. Load/Store gather from and scatter to arrays of
+    // packed Vec3s (four or eight consecutive elements). Normalize returns a
+    // zero vector in any lane with zero length, matching Normalize(Vec3).
+    inline Vec3x4 GMATH_CALL CreateVec3x4(Vec3 fill);
+    inline Vec3x4 GMATH_CALL LoadVec3x4(const Vec3* in);
+    inline void GMATH_CALL StoreVec3x4(Vec3x4 packet, Vec3* out);
+    inline Vec3x4 GMATH_CALL operator+(Vec3x4 a, Vec3x4 b);
+    inline Vec3x4 GMATH_CALL operator-(Vec3x4 a, Vec3x4 b);
+    inline Vec3x4 GMATH_CALL operator*(Vec3x4 a, Vec3x4 b);
+    inline Vec3x4 GMATH_CALL operator*(Vec3x4 a, const Vec4& b);
+    inline Vec3x4 GMATH_CALL operator*(Vec3x4 a, float b);
+    inline Vec4 GMATH_CALL Dot(Vec3x4 a, Vec3x4 b);
+    inline Vec3x4 GMATH_CALL Cross(Vec3x4 a, Vec3x4 b);
+    inline Vec4 GMATH_CALL LengthSquared(Vec3x4 packet);
+    inline Vec4 GMATH_CALL Length(Vec3x4 packet);
+    inline Vec3x4 GMATH_CALL Normalize(Vec3x4 packet);
+    inline Vec3x4 GMATH_CALL Lerp(Vec3x4 a, Vec3x4 b, float alpha);
+    inline Vec3x4 GMATH_CALL Lerp(Vec3x4 a, Vec3x4 b, const Vec4& alpha);
+    inline Vec3x4 GMATH_CALL TransformPoints(const Mat4& mat, Vec3x4 points);
+    inline Vec3x4 GMATH_CALL TransformDirections(const Mat4& mat, Vec3x4 directions);
+    inline Vec3x4 GMATH_CALL TransformPoints(const Mat3x4& affine, Vec3x4 points);
+    inline Vec3x4 GMATH_CALL TransformDirections(const Mat3x4& affine, Vec3x4 directions);
+    
+    inline Vec3x8 GMATH_CALL CreateVec3x8(Vec3 fill);
+    inline Vec3x8 GMATH_CALL LoadVec3x8(const Vec3* in);
+    inline void GMATH_CALL StoreVec3x8(Vec3x8 packet, Vec3* out);
+    inline Vec3x8 GMATH_CALL operator+(Vec3x8 a, Vec3x8 b);
+    inline Vec3x8 GMATH_CALL operator-(Vec3x8 a, Vec3x8 b);
+    inline Vec3x8 GMATH_CALL operator*(Vec3x8 a, Vec3x8 b);
+    inline Vec3x8 GMATH_CALL operator*(Vec3x8 a, Float8 b);
+    inline Vec3x8 GMATH_CALL operator*(Vec3x8 a, float b);
+    inline Float8 GMATH_CALL Dot(Vec3x8 a, Vec3x8 b);
+    inline Vec3x8 GMATH_CALL Cross(Vec3x8 a, Vec3x8 b);
+    inline Float8 GMATH_CALL LengthSquared(Vec3x8 packet);
+    inline Float8 GMATH_CALL Length(Vec3x8 packet);
+    inline Vec3x8 GMATH_CALL Normalize(Vec3x8 packet);
+    inline Vec3x8 GMATH_CALL Lerp(Vec3x8 a, Vec3x8 b, float alpha);
+    inline Vec3x8 GMATH_CALL Lerp(Vec3x8 a, Vec3x8 b, Float8 alpha);
+    inline Vec3x8 GMATH_CALL TransformPoints(const Mat4& mat, Vec3x8 points);
+    inline Vec3x8 GMATH_CALL TransformDirections(const Mat4& mat, Vec3x8 directions);
+    
+    // Integer vector functions. Min, Max and Abs work per component. Mod is
+    // floor modulo like Mod(int, int), so its result has the sign of b (a
+    // negative coordinate wraps into [0, b) for positive b), and b must not be
+    // zero; unlike % it vectorizes, through exact double precision division,
+    // and Mod(INT_MIN, -1) is 0 rather than a trap.
+    // CreateIVec4 from a Vec4 truncates toward zero like a cast, where
+    // FloorToInt rounds down, which is what grid cells usually want. Unlike
+    // the cast, FloorToInt gives INT_MIN or INT_MAX for values past the int
+    // range, and 0 for NaN, the same with or without SIMD.
+    inline IVec4 GMATH_CALL Min(const IVec4& a, const IVec4& b);
+    inline IVec4 GMATH_CALL Max(const IVec4& a, const IVec4& b);
+    inline IVec4 GMATH_CALL Abs(const IVec4& vec);
+    inline IVec4 GMATH_CALL Mod(const IVec4& a, const IVec4& b);
+    inline IVec4 GMATH_CALL Mod(const IVec4& a, int b);
+    inline IVec4 GMATH_CALL CreateIVec4(const Vec4& vec);
+    inline Vec4 GMATH_CALL CreateVec4(const IVec4& vec);
+    inline IVec4 GMATH_CALL FloorToInt(const Vec4& vec);
+    
+    // IVec3 SoA packet functions, like the Vec3x4 ones.
+    inline IVec3x4 GMATH_CALL LoadIVec3x4(const IVec3* in);
+    inline void GMATH_CALL StoreIVec3x4(IVec3x4 packet, IVec3* out);
+    inline IVec3x4 GMATH_CALL operator+(IVec3x4 a, IVec3x4 b);
+    inline IVec3x4 GMATH_CALL operator-(IVec3x4 a, IVec3x4 b);
+    inline IVec3x4 GMATH_CALL operator*(IVec3x4 a, IVec3x4 b);
+    inline IVec3x4 GMATH_CALL operator*(IVec3x4 a, int b);
+    inline IVec3x4 GMATH_CALL Min(IVec3x4 a, IVec3x4 b);
+    inline IVec3x4 GMATH_CALL Max(IVec3x4 a, IVec3x4 b);
+    inline IVec3x4 GMATH_CALL Mod(IVec3x4 a, IVec3 b);
+    inline IVec3x4 GMATH_CALL CreateIVec3x4(Vec3x4 packet);
+    inline IVec3x4 GMATH_CALL FloorToInt(Vec3x4 packet);
+    inline Vec3x4 GMATH_CALL CreateVec3x4(IVec3x4 packet);
+    
+    // Morton codes (Z-order curve) interleave the bits of the coordinates, x
+    // in the lowest, so cells close together in space mostly get codes close
+    // together. The 3D versions use the low 10 bits of each component (a 30
+    // bit code) and the 2D versions the low 16, so offset negative coordinates
+    // into that range first. The packet and batch versions are 3D, and code
+    // four cells per iteration with SSE2 or NEON.
+    inline uint32_t EncodeMorton(IVec2 coords);
+    inline uint32_t EncodeMorton(IVec3 coords);
+    inline IVec2 DecodeMorton2(uint32_t code);
+    inline IVec3 DecodeMorton3(uint32_t code);
+    inline IVec4 GMATH_CALL EncodeMorton(IVec3x4 coords);
+    inline IVec3x4 GMATH_CALL DecodeMorton3(const IVec4& codes);
+    void GMATH_CALL EncodeMortonBatch(const IVec3* in, uint32_t* out, size_t count);
+    void GMATH_CALL DecodeMortonBatch(const uint32_t* in, IVec3* out, size_t count);
+    
+    // 63 bit Morton codes, from the low 21 bits of each component, for grids
+    // too fine for 30 bits. The batch versions code four cells per iteration
+    // with SSE2 or NEON, two to a register.
+    inline uint64_t EncodeMorton64(IVec3 coords);
+    inline IVec3 DecodeMorton64(uint64_t code);
+    void GMATH_CALL EncodeMorton64Batch(const IVec3* in, uint64_t* out, size_t count);
+    void GMATH_CALL DecodeMorton64Batch(const uint64_t* in, IVec3* out, size_t count);
+    
+    // Grid cells and sorting. GetGridCell returns the cell containing point of
+    // a grid of cell_size cubes with a corner at origin, rounding down so that
+    // negative coordinates work too. The batch version does four points per
+    // iteration with SSE or NEON; both multiply by the reciprocal of
+    // cell_size, so they agree on points right on a boundary, and saturate
+    // past the int range like FloorToInt.
+    // RadixSort sorts keys into increasing order, eight bits per pass and
+    // skipping the passes that would not move anything, and moves values (if
+    // not 0) along with them. It is stable. The scratch arrays must hold count
+    // entries each (scratch_values is unused without values), and the result
+    // ends up in keys and values either way.
+    // SortByMorton finds the order of positions along a Morton curve through
+    // bounds, at 10 bits per axis: laying particles or agents out in that
+    // order keeps ones close in space mostly close in memory, so the batch
+    // functions and any neighbour search over them stay in cache. order[i] is
+    // the index of the ith position in that order, and sorted, if not 0,
+    // receives the positions themselves. The scratch memory, 12 bytes per
+    // position, comes from the thread's arena (see GetThreadArena), or from
+    // GMATH_MALLOC when that has no room; it returns false if neither does.
+    inline IVec3 GetGridCell(Vec3 point, Vec3 origin, float cell_size);
+    void GMATH_CALL GetGridCellsBatch(const Vec3* in, IVec3* out, size_t count, Vec3 origin, float cell_size);
+    void RadixSort(uint32_t* keys, uint32_t* values, size_t count, uint32_t* scratch_keys, uint32_t* scratch_values);
+    void RadixSort(uint64_t* keys, uint32_t* values, size_t count, uint64_t* scratch_keys, uint32_t* scratch_values);
+    bool GMATH_CALL SortByMorton(const Vec3* positions, size_t count, const AABB& bounds, uint32_t* order, Vec3* sorted = 0);
+    
+    // Spatial hashing. CreateSpatialHash allocates room for capacity points in
+    // a table of table_size buckets, rounded up to a power of two (0 for the
+    // smallest that is at least capacity). BuildSpatialHash bins count
+    // positions (at most capacity, or it returns false) by their cells, as
+    // GetGridCell gives them with the origin at zero, and sorts the point
+    // indices by bucket with one counting sort, so rebuilding it every frame
+    // allocates nothing. HashCell is the bucket of a cell, and FindCell gives
+    // the range [begin, end) of hash.indices for the bucket of a cell. Cells
+    // sharing a bucket share the range, so test the points found against the
+    // query (to find the neighbours within cell_size of a point, look in the
+    // 27 cells around it and check the distances), and skip a bucket already
+    // seen when looking in several cells.
+    SpatialHash CreateSpatialHash(float cell_size, uint32_t capacity, uint32_t table_size = 0);
+    void DestroySpatialHash(SpatialHash& hash);
+    bool GMATH_CALL BuildSpatialHash(SpatialHash& hash, const Vec3* positions, size_t count);
+    inline uint32_t HashCell(IVec3 cell, uint32_t table_size);
+    inline void FindCell(const SpatialHash& hash, IVec3 cell, uint32_t& begin, uint32_t& end);
+    
+    // Frustum culling. CreateFrustum extracts the planes from a projection or
+    // view-projection matrix, for the clip space depth range selected by
+    // GMATH_DEPTH_ZERO_TO_ONE. The planes are in whatever space the matrix maps
+    // from (view space for a projection, world space for a view-projection), so
+    // GMATH_RIGHT_HANDED is already accounted for by the matrix. With an
+    // infinite far plane, the far plane never culls anything.
+    // The tests are conservative: a bound is culled only when it is entirely
+    // outside one of the planes, so a few near the frustum's edges pass while
+    // outside it. CullSpheres and CullAABBs set bit (i % 32) of visible[i / 32]
+    // for each bound which passes and clear it for each which doesn't, so
+    // visible must hold (count + 31) / 32 words. They test four bounds per
+    // iteration with SSE or NEON, and eight with AVX.
+    Frustum GMATH_CALL CreateFrustum(const Mat4& view_projection);
+    inline bool GMATH_CALL IsVisible(const Frustum& frustum, const Sphere& sphere);
+    inline bool GMATH_CALL IsVisible(const Frustum& frustum, const AABB& box);
+    void GMATH_CALL CullSpheres(const Frustum& frustum, const Sphere* spheres, size_t count, uint32_t* visible);
+    void GMATH_CALL CullAABBs(const Frustum& frustum, const AABB* boxes, size_t count, uint32_t* visible);
+    
+    // Cameras (see Camera). CreateCamera computes everything up front. The
+    // SetCamera functions only mark the results out of date when a value
+    // actually changes, so they can be called with the same values every frame.
+    // UpdateCamera returns whether it recomputed anything, e.g. to skip
+    // re-uploading shader constants.
+    Camera CreateCamera(Vec3 eye, Vec3 target, Vec3 up, float fov, float aspect, float near_clip, float far_clip, uint32_t options = 0);
+    void SetCameraLookAt(Camera& camera, Vec3 eye, Vec3 target, Vec3 up);
+    void SetCameraPerspective(Camera& camera, float fov, float aspect, float near_clip, float far_clip);
+    void SetCameraAspect(Camera& camera, float aspect);
+    void SetCameraOptions(Camera& camera, uint32_t options);
+    bool UpdateCamera(Camera& camera);
+    
+    // Geometry functions. CreatePlane from three points takes its normal from
+    // Normalize(Cross(b - a, c - a)); from a normal and a point, the normal
+    // must be unit length for Distance to be a true distance. TransformAABB
+    // returns the tightest box around the transformed box (Arvo's method), and
+    // expects an affine matrix.
+    inline Plane GMATH_CALL CreatePlane(Vec3 normal, Vec3 point);
+    inline Plane GMATH_CALL CreatePlane(Vec3 a, Vec3 b, Vec3 c);
+    inline float GMATH_CALL Distance(const Plane& plane, Vec3 point);
+    inline AABB GMATH_CALL TransformAABB(const Mat4& mat, const AABB& box);
+    inline AABB GMATH_CALL TransformAABB(const Mat3x4& affine, const AABB& box);
+    inline AABBx4 GMATH_CALL LoadAABBx4(const AABB* in);
+    inline Rayx4 GMATH_CALL LoadRayx4(const Ray* in);
+    
+    // Ray intersection. Each returns whether the ray hits at some t >= 0, and if
+    // so sets t to the nearest such distance (zero when the origin is inside a
+    // box or sphere). A ray parallel to a plane never hits it. The box tests are
+    // branchless slab tests; a ray which lies exactly in one of a box's faces
+    // may or may not hit it. The packet versions return a mask with bit i set
+    // if lane i hits; lanes of t which miss are left with unspecified values.
+    inline bool GMATH_CALL Intersect(const Ray& ray, const AABB& box, float& t);
+    inline bool GMATH_CALL Intersect(const Ray& ray, const Sphere& sphere, float& t);
+    inline bool GMATH_CALL Intersect(const Ray& ray, const Plane& plane, float& t);
+    inline int GMATH_CALL Intersect(const Ray& ray, const AABBx4& boxes, Vec4& t);
+    inline int GMATH_CALL Intersect(const Rayx4& rays, const AABB& box, Vec4& t);
+    
+    // Quaternion functions.
+    inline float GMATH_CALL Dot(const Quat& a, const Quat& b);
+    inline Quat GMATH_CALL Normalize(const Quat& quat);
+    inline Quat GMATH_CALL Lerp(const Quat& a, const Quat& b, float alpha);
+    inline Quat GMATH_CALL Nlerp(const Quat& a, const Quat& b, float alpha);
+    inline Quat GMATH_CALL Slerp(const Quat& a, const Quat& b, float alpha);
+    inline Quat GMATH_CALL Invert(const Quat& quat);
+    
+    // Batch blending for animation: out[i] = Slerp(a[i], b[i], t[i]), or Nlerp.
+    // Four quaternions are blended per iteration in SoA form, with the trig done
+    // by the four wide polynomials, so defining GMATH_FAST_TRIG as 2 makes
+    // SlerpBatch cheaper still.
+    void GMATH_CALL SlerpBatch(const Quat* a, const Quat* b, const float* t, Quat* out, size_t count);
+    void GMATH_CALL NlerpBatch(const Quat* a, const Quat* b, const float* t, Quat* out, size_t count);
+    
+    // Dual quaternion functions. CreateDualQuat from a matrix expects no scale.
+    // Normalize divides both parts by the length of the rotation, which is all
+    // a blend of unit dual quaternions needs.
+    inline DualQuat GMATH_CALL Normalize(const DualQuat& dual_quat);
+    inline Vec3 GMATH_CALL GetTranslation(const DualQuat& dual_quat);
+    inline Vec3 GMATH_CALL TransformPoint(const DualQuat& dual_quat, Vec3 point);
+    inline Vec3 GMATH_CALL TransformDirection(const DualQuat& dual_quat, Vec3 direction);
+    
+    // Dual quaternion skinning (Kavan et al.'s linear blend). Vertex i is
+    // influenced by palette[bones[i * 4 + j]] with weight weights[i][j], for j
+    // from zero to three; give unused influences a weight of zero. The weights
+    // needn't sum to one, since the blend is renormalized, but mustn't all be
+    // zero. Each influence is negated if needed to be in the same hemisphere
+    // as the first, so the blend never goes the long way around. normals and
+    // out_normals may be null to skin positions only. Four vertices are
+    // transformed per iteration in SoA form with SSE or NEON.
+    void GMATH_CALL SkinVertices(const DualQuat* palette, const uint16_t* bones, const Vec4* weights, const Vec3* positions, const Vec3* normals, Vec3* out_positions, Vec3* out_normals, size_t count);
+    
+    // Compressed storage, for animation clips and network snapshots.
+    // PackQuat32 and PackQuat48 use smallest three encoding: the largest
+    // component is dropped, and the other three are stored in 10 or 15 bits
+    // each along with its index. They expect unit quaternions, and may negate
+    // the result (the same rotation). The error per component is at most about
+    // 1.3e-3 for 32 bits and 5e-5 for 48. PackNormal stores a unit vector as
+    // two 16 bit fixed point values (octahedral encoding), to within about
+    // 6e-5.
+    // PackHalf converts to IEEE half precision, rounding to nearest even, with
+    // F16C or NEON if enabled. Quantize maps each component of a point from
+    // bounds to an integer from 0 to 2^bits - 1, for bits from 1 to 24, and
+    // clamps points outside the box. Up to 16 bits the components fit in a
+    // uint16_t each. Dequantize returns min + q * (max - min) / (2^bits - 1)
+    // to within half a float ULP. That is a fraction of a step unless the
+    // step is smaller than a float ULP of the points in the box: at 24 bits,
+    // the result is up to 2 steps off for a box from 2 to 3, and more for
+    // boxes further from the origin.
+    inline uint32_t GMATH_CALL PackQuat32(const Quat& quat);
+    inline Quat GMATH_CALL UnpackQuat32(uint32_t packed);
+    inline Quat48 GMATH_CALL PackQuat48(const Quat& quat);
+    inline Quat GMATH_CALL UnpackQuat48(Quat48 packed);
+    inline uint32_t PackNormal(Vec3 normal);
+    inline Vec3 UnpackNormal(uint32_t packed);
+    inline uint16_t PackHalf(float val);
+    inline float UnpackHalf(uint16_t packed);
+    inline Half4 GMATH_CALL PackHalf4(const Vec4& vec);
+    inline Vec4 GMATH_CALL UnpackHalf4(Half4 packed);
+    inline IVec3 Quantize(Vec3 point, const AABB& bounds, int bits);
+    inline Vec3 Dequantize(IVec3 quantized, const AABB& bounds, int bits);
+    
+    // Batch versions of the above, decoding straight into the unpacked types.
+    // They work on four values per iteration with SSE or NEON (eight halves
+    // with AVX and F16C).
+    void GMATH_CALL PackQuat32Batch(const Quat* in, uint32_t* out, size_t count);
+    void GMATH_CALL UnpackQuat32Batch(const uint32_t* in, Quat* out, size_t count);
+    void GMATH_CALL PackQuat48Batch(const Quat* in, Quat48* out, size_t count);
+    void GMATH_CALL UnpackQuat48Batch(const Quat48* in, Quat* out, size_t count);
+    void GMATH_CALL PackNormalBatch(const Vec3* in, uint32_t* out, size_t count);
+    void GMATH_CALL UnpackNormalBatch(const uint32_t* in, Vec3* out, size_t count);
+    void GMATH_CALL PackHalf4Batch(const Vec4* in, Half4* out, size_t count);
+    void GMATH_CALL UnpackHalf4Batch(const Half4* in, Vec4* out, size_t count);
+    void GMATH_CALL QuantizeBatch(const Vec3* in, IVec3* out, size_t count, const AABB& bounds, int bits);
+    void GMATH_CALL DequantizeBatch(const IVec3* in, Vec3* out, size_t count, const AABB& bounds, int bits);
+    
+    // Double precision functions, matching the float versions. TransformPoint
+    // applies the translation, TransformDirection does not. DCross (like
+    // CreateDTranslationMatrix) is named apart from the float version, since
+    // DVec3 can be built from a braced list too, which would make calls like
+    // Cross({1, 0, 0}, {0, 1, 0}) ambiguous.
+    inline double Dot(DVec3 a, DVec3 b);
+    inline DVec3 DCross(DVec3 a, DVec3 b);
+    inline double LengthSquared(DVec3 vec);
+    inline double Length(DVec3 vec);
+    inline DVec3 Normalize(DVec3 vec);
+    inline double GMATH_CALL Dot(const DVec4& a, const DVec4& b);
+    inline double GMATH_CALL Dot(const DQuat& a, const DQuat& b);
+    inline DQuat GMATH_CALL Normalize(const DQuat& quat);
+    inline DQuat GMATH_CALL Invert(const DQuat& quat);
+    inline DVec3 GMATH_CALL TransformPoint(const DMat4& mat, DVec3 point);
+    inline DVec3 GMATH_CALL TransformDirection(const DMat4& mat, DVec3 direction);
+    
+    // Camera relative rendering. MakeRelative subtracts origin (usually the
+    // camera position) in double precision and only then rounds to float, so
+    // the result keeps full float precision near the camera however far it is
+    // from the world origin. The matrix version does the same to the
+    // translation of a model matrix, whose result should be combined with a
+    // view matrix built with the camera at the origin. The batch version
+    // converts four points per iteration with SSE2, AVX or NEON.
+    inline Vec3 MakeRelative(DVec3 point, DVec3 origin);
+    inline Mat4 GMATH_CALL MakeRelative(const DMat4& transform, DVec3 origin);
+    void GMATH_CALL MakeRelativeBatch(const DVec3* points, DVec3 origin, Vec3* out, size_t count);
+    
+    // Arenas. CreateArena either allocates the block or uses memory the caller
+    // owns (which DestroyArena leaves alone). ArenaAllocate returns memory
+    // aligned to alignment, a power of two, or 0 once the arena is full; the
+    // default of 32 bytes suits the Aligned batch functions and 256 bit loads.
+    // GetArenaMark and RewindArena release everything allocated after the mark,
+    // and ResetArena everything (at the start of each frame, say). The typed
+    // versions allocate count elements, uninitialized.
+    // GetThreadArena returns the calling thread's own arena, created on first
+    // use with GMATH_THREAD_ARENA_SIZE bytes and freed when the thread exits.
+    // Each thread resets its own.
+    Arena CreateArena(size_t capacity);
+    Arena CreateArena(void* memory, size_t capacity);
+    void DestroyArena(Arena& arena);
+    void* ArenaAllocate(Arena& arena, size_t size, size_t alignment = 32);
+    size_t GetArenaMark(const Arena& arena);
+    void RewindArena(Arena& arena, size_t mark);
+    void ResetArena(Arena& arena);
+    Arena& GetThreadArena();
+    Vec3* AllocateVec3s(Arena& arena, size_t count);
+    Vec4* AllocateVec4s(Arena& arena, size_t count);
+    Quat* AllocateQuats(Arena& arena, size_t count);
+    Mat4* AllocateMat4s(Arena& arena, size_t count);
+    Mat3x4* AllocateMat3x4s(Arena& arena, size_t count);
+    Vec3x4* AllocateVec3x4s(Arena& arena, size_t count);
+    
+    // Baked data. WriteBaked lays out sections (whose offsets it ignores) with
+    // the elements from data[i], and copies all of it to out, returning the
+    // size of the file; with out = 0 it just returns the size, for allocating
+    // out. OpenBaked checks that data is a baked file of this version and
+    // endianness, 16 byte aligned (as a mapping always is), with every section
+    // inside it, and returns false otherwise. The GetBaked functions return the
+    // elements of the first section with a matching id, pointing straight into
+    // the file, and their count; or 0 if there is no such section or it holds
+    // a different type. GetBakedElementSize returns 0 for unknown types.
+    size_t GetBakedElementSize(uint32_t type);
+    size_t WriteBaked(void* out, const BakedSection* sections, const void* const* data, uint32_t section_count);
+    bool OpenBaked(BakedFile& file, const void* data, size_t size);
+    const BakedSection* FindBakedSection(const BakedFile& file, uint32_t id);
+    const void* GetBakedData(const BakedFile& file, uint32_t id, uint32_t type, size_t& count);
+    const float* GetBakedFloats(const BakedFile& file, uint32_t id, size_t& count);
+    const Vec3* GetBakedVec3s(const BakedFile& file, uint32_t id, size_t& count);
+    const Vec4* GetBakedVec4s(const BakedFile& file, uint32_t id, size_t& count);
+    const Quat* GetBakedQuats(const BakedFile& file, uint32_t id, size_t& count);
+    const Mat4* GetBakedMat4s(const BakedFile& file, uint32_t id, size_t& count);
+    const Mat3x4* GetBakedMat3x4s(const BakedFile& file, uint32_t id, size_t& count);
+    const Vec3x4* GetBakedVec3x4s(const BakedFile& file, uint32_t id, size_t& count);
+    const uint32_t* GetBakedQuat32s(const BakedFile& file, uint32_t id, size_t& count);
+    const Quat48* GetBakedQuat48s(const BakedFile& file, uint32_t id, size_t& count);
+    const Half4* GetBakedHalf4s(const BakedFile& file, uint32_t id, size_t& count);
+    const IVec3* GetBakedIVec3s(const BakedFile& file, uint32_t id, size_t& count);
+    
+    // Profiling. GetProfileSnapshot copies the calling thread's counters, and
+    // ResetProfile zeroes them; each thread reads and resets its own (a worker
+    // might report at the end of each job, say). GetProfileName returns the
+    // name of a GMATH_PROFILE_* counter, e.g. "TransformPoints".
+    ProfileSnapshot GetProfileSnapshot();
+    void ResetProfile();
+    const char* GetProfileName(int counter);
+    
+    // Parallel batch functions. CreateThreadPool starts a pool of threads - 1
+    // workers (threads = 0 for one thread per core), the calling thread making
+    // up the last, and returns an Executor running on it; DestroyThreadPool
+    // stops them. Calls on one pool from several threads take turns, and calls
+    // made from inside its own tasks just run on the calling thread.
+    // ParallelFor calls function(data, begin, end) for chunks of [0, count), in
+    // parallel. out is the array being written, of element_size byte elements:
+    // chunks begin on its cache lines, so no two threads write to the same line
+    // (as long as out is aligned for its elements), and each chunk but the
+    // first and last is a multiple of 8 elements long, keeping the SIMD loops
+    // out of their scalar tails. Arrays of up to GMATH_PARALLEL_MIN_CHUNK
+    // elements run on the calling thread.
+    // The overloads of the batch functions taking an Executor split the arrays
+    // the same way, and otherwise behave just like them, but for the odd last
+    // bit: the SIMD loops and their scalar tails split each chunk afresh.
+    Executor CreateThreadPool(uint32_t threads = 0);
+    void DestroyThreadPool(Executor& executor);
+    void ParallelFor(const Executor& executor, size_t count, const void* out, size_t element_size, ParallelRange function, void* data);
+    void GMATH_CALL TransformVec4s(const Executor& executor, const Mat4& mat, const Vec4* in, Vec4* out, size_t count);
+    void GMATH_CALL TransformPoints(const Executor& executor, const Mat4& mat, const Vec3* in, Vec3* out, size_t count);
+    void GMATH_CALL TransformDirections(const Executor& executor, const Mat4& mat, const Vec3* in, Vec3* out, size_t count);
+    void GMATH_CALL NormalizeBatch(const Executor& executor, const Vec2* in, Vec2* out, size_t count, int accuracy = GMATH_NORMALIZE_EXACT);
+    void GMATH_CALL NormalizeBatch(const Executor& executor, const Vec3* in, Vec3* out, size_t count, int accuracy = GMATH_NORMALIZE_EXACT);
+    void GMATH_CALL NormalizeBatch(const Executor& executor, const Vec4* in, Vec4* out, size_t count, int accuracy = GMATH_NORMALIZE_EXACT);
+    void GMATH_CALL NormalizeBatch(const Executor& executor, const Quat* in, Quat* out, size_t count, int accuracy = GMATH_NORMALIZE_EXACT);
+    void GMATH_CALL SafeNormalizeBatch(const Executor& executor, const Vec2* in, Vec2* out, size_t count, float tolerance = 0.001f, int accuracy = GMATH_NORMALIZE_EXACT);
+    void GMATH_CALL SafeNormalizeBatch(const Executor& executor, const Vec3* in, Vec3* out, size_t count, float tolerance = 0.001f, int accuracy = GMATH_NORMALIZE_EXACT);
+    void GMATH_CALL SafeNormalizeBatch(const Executor& executor, const Vec4* in, Vec4* out, size_t count, float tolerance = 0.001f, int accuracy = GMATH_NORMALIZE_EXACT);
+    void GMATH_CALL SafeNormalizeBatch(const Executor& executor, const Quat* in, Quat* out, size_t count, float tolerance = 0.001f, int accuracy = GMATH_NORMALIZE_EXACT);
+    void GMATH_CALL SlerpBatch(const Executor& executor, const Quat* a, const Quat* b, const float* t, Quat* out, size_t count);
+    void GMATH_CALL NlerpBatch(const Executor& executor, const Quat* a, const Quat* b, const float* t, Quat* out, size_t count);
+    void GMATH_CALL ComposeTRSBatch(const Executor& executor, const Vec3* translations, const Quat* rotations, const Vec3* scales, Mat4* out, size_t count);
+    void GMATH_CALL ComposeTRSBatch(const Executor& executor, const Vec3* translations, const Quat* rotations, const Vec3* scales, Mat3x4* out, size_t count);
+    void GMATH_CALL DecomposeBatch(const Executor& executor, const Mat4* mats, Vec3* translations, Quat* rotations, Vec3* scales, size_t count);
+    void GMATH_CALL SkinVertices(const Executor& executor, const DualQuat* palette, const uint16_t* bones, const Vec4* weights, const Vec3* positions, const Vec3* normals, Vec3* out_positions, Vec3* out_normals, size_t count);
+    void GMATH_CALL CullSpheres(const Executor& executor, const Frustum& frustum, const Sphere* spheres, size_t count, uint32_t* visible);
+    void GMATH_CALL CullAABBs(const Executor& executor, const Frustum& frustum, const AABB* boxes, size_t count, uint32_t* visible);
+    void GMATH_CALL PackQuat32Batch(const Executor& executor, const Quat* in, uint32_t* out, size_t count);
+    void GMATH_CALL UnpackQuat32Batch(const Executor& executor, const uint32_t* in, Quat* out, size_t count);
+    void GMATH_CALL PackQuat48Batch(const Executor& executor, const Quat* in, Quat48* out, size_t count);
+    void GMATH_CALL UnpackQuat48Batch(const Executor& executor, const Quat48* in, Quat* out, size_t count);
+    void GMATH_CALL PackNormalBatch(const Executor& executor, const Vec3* in, uint32_t* out, size_t count);
+    void GMATH_CALL UnpackNormalBatch(const Executor& executor, const uint32_t* in, Vec3* out, size_t count);
+    void GMATH_CALL PackHalf4Batch(const Executor& executor, const Vec4* in, Half4* out, size_t count);
+    void GMATH_CALL UnpackHalf4Batch(const Executor& executor, const Half4* in, Vec4* out, size_t count);
+    void GMATH_CALL QuantizeBatch(const Executor& executor, const Vec3* in, IVec3* out, size_t count, const AABB& bounds, int bits);
+    void GMATH_CALL DequantizeBatch(const Executor& executor, const IVec3* in, Vec3* out, size_t count, const AABB& bounds, int bits);
+    void GMATH_CALL EncodeMortonBatch(const Executor& executor, const IVec3* in, uint32_t* out, size_t count);
+    void GMATH_CALL DecodeMortonBatch(const Executor& executor, const uint32_t* in, IVec3* out, size_t count);
+    void GMATH_CALL EncodeMorton64Batch(const Executor& executor, const IVec3* in, uint64_t* out, size_t count);
+    void GMATH_CALL DecodeMorton64Batch(const Executor& executor, const uint64_t* in, IVec3* out, size_t count);
+    void GMATH_CALL GetGridCellsBatch(const Executor& executor, const Vec3* in, IVec3* out, size_t count, Vec3 origin, float cell_size);
+    void GMATH_CALL MakeRelativeBatch(const Executor& executor, const DVec3* points, DVec3 origin, Vec3* out, size_t count);
+    
+    // Updates every node of a breadth first hierarchy, given the levels from
+    // FindHierarchyLevels: one level after another, each split across threads.
+    void GMATH_CALL UpdateWorldTransforms(const Executor& executor, const int32_t* parents, const Mat4* locals, Mat4* worlds, uint8_t* dirty, const size_t* level_starts, size_t levels);
+    void GMATH_CALL UpdateWorldTransforms(const Executor& executor, const int32_t* parents, const Mat3x4* locals, Mat3x4* worlds, uint8_t* dirty, const size_t* level_starts, size_t levels);
+    
+    // Runtime CPU detection. GetCPUFeatures returns the GMATH_CPU_* flags the
+    // CPU and OS support, detected on the first call (0 on targets other than
+    // x86). GetDispatchFeatures is the part of that the GMATH_USE_DISPATCH
+    // kernels may use, which SetDispatchFeatures narrows to the flags given,
+    // e.g. to compare tiers in a benchmark. Call it before other threads run
+    // the kernels.
+    uint32_t GetCPUFeatures();
+    uint32_t GetDispatchFeatures();
+    void SetDispatchFeatures(uint32_t features);
+    
+#ifdef GMATH_USE_NAMESPACE
+};
+#endif
+#endif // GMATH_H
+
+// Everything below defines functions declared above: first the inline ones,
+// which every file including GMath.h compiles, and then, in the blocks under
+// GMATH_IMPLEMENTATION, the rest. GMathTypes.h (GMATH_TYPES_ONLY) stops before
+// the inline definitions.
+#if !defined(GMATH_INLINE_H) && (!defined(GMATH_TYPES_ONLY) || defined(GMATH_IMPLEMENTATION))
+#define GMATH_INLINE_H
+#ifdef GMATH_IMPLEMENTATION
+#if !defined(GMATH_MALLOC) || !defined(GMATH_FREE)
+#include <stdlib.h>
+#endif
+
+#ifndef GMATH_MALLOC
+#define GMATH_MALLOC malloc
+#endif
+
+#ifndef GMATH_FREE
+#define GMATH_FREE free
+#endif
+
+#ifndef GMATH_THREAD_ARENA_SIZE
+#define GMATH_THREAD_ARENA_SIZE (1 << 20)
+#endif
+
+#ifndef GMATH_PARALLEL_MIN_CHUNK
+#define GMATH_PARALLEL_MIN_CHUNK 2048
+#endif
+
+#ifndef GMATH_NO_THREADS
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+#if defined(GMATH_USE_SSE) && defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(GMATH_USE_SSE) && defined(__GNUC__)
+#include <cpuid.h>
+#endif
+
+#ifdef GMATH_USE_IOSTREAM
+#include <ostream>
+#endif
+#endif // GMATH_IMPLEMENTATION
+
+#ifdef GMATH_PROFILE
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#endif
+#endif
+
+#ifdef GMATH_USE_NAMESPACE
+namespace GMath
+{
+#endif
+    // Profiling.
+    
+#ifdef GMATH_PROFILE
+    // Defined with the implementation, so that every file counts into the
+    // same thread's snapshot.
+    extern thread_local ProfileSnapshot g_profile;
+    
+    static inline uint64_t ReadProfileTicks()
+    {
+#if (defined(_MSC_VER) || defined(__GNUC__)) && (defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__))
+        return __rdtsc();
+#elif defined(__GNUC__) && defined(__aarch64__)
+        uint64_t ticks;
+        __asm__ __volatile__("mrs %0, cntvct_el0" : "=r"(ticks));
+        return ticks;
+#else
+        return 0;
+#endif
+    }
+    
+    // Counts a call on construction, and the time until it goes out of scope.
+    struct ProfileScope
+    {
+        ProfileCounter& counter;
+        uint64_t start;
+        ProfileScope(int index, uint64_t elements) : counter(g_profile.counters[index])
+        {
+            counter.calls++;
+            counter.elements += elements;
+            start = ReadProfileTicks();
+        }
+        ~ProfileScope() {counter.ticks += ReadProfileTicks() - start;}
+    };
+#define GMATH_PROFILE_SCOPE(counter, elements) ProfileScope profile_scope(counter, (uint64_t)(elements))
+#else
+#define GMATH_PROFILE_SCOPE(counter, elements)
+#endif
+    
+    // Every file must agree on GMATH_PROFILE, or the inline functions in some
+    // of them go uncounted. MSVC compares the pragma's value between objects.
+    // Elsewhere each file references a symbol named for its own setting, and
+    // only the GMATH_IMPLEMENTATION file's setting is defined, so a mixed
+    // build fails to link with an undefined reference to it.
+#ifdef _MSC_VER
+#ifdef GMATH_PROFILE
+#pragma detect_mismatch("GMATH_PROFILE", "1")
+#else
+#pragma detect_mismatch("GMATH_PROFILE", "0")
+#endif
+#elif defined(__GNUC__)
+#ifdef GMATH_PROFILE
+#define GMATH_PROFILE_CHECK g_built_with_gmath_profile
+#else
+#define GMATH_PROFILE_CHECK g_built_without_gmath_profile
+#endif
+    extern const int GMATH_PROFILE_CHECK;
+#ifdef GMATH_IMPLEMENTATION
+    const int GMATH_PROFILE_CHECK = 1;
+#else
+    static const int* const g_profile_check __attribute__((used)) = &GMATH_PROFILE_CHECK;
+#endif
+#endif
+    
+#ifdef GMATH_IMPLEMENTATION
+#ifdef GMATH_PROFILE
+    thread_local ProfileSnapshot g_profile;
+#endif
+    
+    ProfileSnapshot GetProfileSnapshot()
+    {
+#ifdef GMATH_PROFILE
+        return g_profile;
+#else
+        ProfileSnapshot snapshot = {};
+        return snapshot;
+#endif
+    }
+    
+    void ResetProfile()
+    {
+#ifdef GMATH_PROFILE
+        g_profile = ProfileSnapshot();
+#endif
+    }
+    
+    const char* GetProfileName(int counter)
+    {
+        static const char* const names[GMATH_PROFILE_COUNT] =
+        {
+            "Mat4 * Mat4",
+            "Inverse(Mat4)",
+            "CreateQuat(Mat4)",
+            "Slerp",
+            "Normalize",
+            "Sin",
+            "Cos",
+            "Tan",
+            "SinCos",
+            "ACos",
+            "ATan",
+            "ATan2",
+            "Exp",
+            "Log",
+            "Pow",
+            "TransformVec4s",
+            "TransformPoints",
+            "TransformDirections",
+            "SlerpBatch",
+            "NlerpBatch",
+            "SkinVertices",
+            "UpdateWorldTransforms",
+            "CullSpheres",
+            "CullAABBs",
+            "Pack*Batch",
+            "Unpack*Batch",
+            "NormalizeBatch",
+            "ComposeTRSBatch",
+            "Decompose",
+            "DecomposeBatch"
+        };
+        return (counter >= 0 && counter < GMATH_PROFILE_COUNT) ? names[counter] : "";
+    }
+    
+    // CPU detection.
+    
+#if defined(GMATH_USE_SSE) && (defined(_MSC_VER) || defined(__GNUC__))
+#define GMATH_HAS_CPUID 1
+    static inline void ReadCPUID(uint32_t leaf, uint32_t regs[4])
+    {
+#ifdef _MSC_VER
+        int values[4];
+        __cpuidex(values, (int)leaf, 0);
+        for (int i = 0; i < 4; ++i) regs[i] = (uint32_t)values[i];
+#else
+        __cpuid_count(leaf, 0, regs[0], regs[1], regs[2], regs[3]);
+#endif
+    }
+    
+    // XCR0, the register state the OS saves on a context switch. Only valid
+    // if CPUID reports OSXSAVE.
+    static inline uint64_t ReadXCR0()
+    {
+#ifdef _MSC_VER
+        return _xgetbv(0);
+#else
+        uint32_t low, high;
+        __asm__ __volatile__("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+        return ((uint64_t)high << 32) | low;
+#endif
+    }
+    
+    // Leaf 1 reports SSE4.1 (ecx bit 19), FMA (12), OSXSAVE (27), AVX (28) and
+    // F16C (29), leaf 7 AVX2 (ebx bit 5) and AVX-512F (16). The AVX registers
+    // need XCR0 bits 1 and 2 (SSE and AVX state), AVX-512 also bits 5 to 7.
+    static uint32_t DetectCPUFeatures()
+    {
+        uint32_t features = GMATH_CPU_SSE2;
+        uint32_t regs[4];
+        ReadCPUID(0, regs);
+        uint32_t max_leaf = regs[0];
+        if (max_leaf < 1) return features;
+        ReadCPUID(1, regs);
+        uint32_t leaf_1_ecx = regs[2];
+        if (leaf_1_ecx & (1u << 19)) features |= GMATH_CPU_SSE41;
+        if (!(leaf_1_ecx & (1u << 27)) || !(leaf_1_ecx & (1u << 28))) return features;
+        uint64_t xcr0 = ReadXCR0();
+        if ((xcr0 & 0x06) != 0x06) return features;
+        if (leaf_1_ecx & (1u << 29)) features |= GMATH_CPU_F16C;
+        if (max_leaf < 7) return features;
+        ReadCPUID(7, regs);
+        if ((regs[1] & (1u << 5)) && (leaf_1_ecx & (1u << 12))) features |= GMATH_CPU_AVX2;
+        if ((regs[1] & (1u << 16)) && (xcr0 & 0xe6) == 0xe6) features |= GMATH_CPU_AVX512;
+        return features;
+    }
+#endif
+    
+    // Narrowed by SetDispatchFeatures. Constant initialized, so it's valid in
+    // code run by other static initializers.
+    static uint32_t g_dispatch_mask = 0xffffffffu;
+    
+    uint32_t GetCPUFeatures()
+    {
+#if defined(GMATH_HAS_CPUID)
+        static const uint32_t features = DetectCPUFeatures();
+        return features;
+#elif defined(GMATH_USE_SSE)
+        return GMATH_CPU_SSE2;
+#else
+        return 0;
+#endif
+    }
+    
+    uint32_t GetDispatchFeatures()
+    {
+        return GetCPUFeatures() & g_dispatch_mask;
+    }
+    
+    void SetDispatchFeatures(uint32_t features)
+    {
+        g_dispatch_mask = features;
+    }
+    
+#ifdef GMATH_AVX_KERNELS
+    // Whether the batch functions should run their AVX2 kernels: always when
+    // the compiler targets AVX2, otherwise when the CPU has it (with F16C,
+    // which every AVX2 CPU has, for the half precision kernels).
+    static inline bool UseAVX()
+    {
+#ifdef GMATH_USE_AVX
+        return true;
+#else
+        uint32_t required = GMATH_CPU_AVX2 | GMATH_CPU_F16C;
+        return (GetDispatchFeatures() & required) == required;
+#endif
+    }
+#endif
+#endif // GMATH_IMPLEMENTATION
+    
+    // Polynomial approximations, used by GMATH_FAST_TRIG and the four wide
+    // math functions. Tier 1 is the Cephes single precision polynomials, tier 2
+    // drops a term from each (refit for minimum max error).
+#if defined(GMATH_FAST_TRIG) && GMATH_FAST_TRIG + 0 == 2
+#define GMATH_POLY_TIER 2
+#else
+#define GMATH_POLY_TIER 1
+#endif
+    
+    // Pi / 2 split into four parts, so the sine and cosine range reduction
+    // stays exact for moderately large angles. The first three have at most
+    // 11 significant bits, so their products with the quadrant (below 2^13)
+    // are exact, and the results near a multiple of pi / 2 keep their
+    // precision.
+#define GMATH_PI_2_A 1.5703125f
+#define GMATH_PI_2_B 4.837512969970703125e-4f
+#define GMATH_PI_2_C 7.54953362047672271728515625e-8f
+#define GMATH_PI_2_D 2.5633440682570896e-12f
+    
+    // Beyond this the reduction loses accuracy (and the rounding in RoundToInt
+    // breaks down past 2^22), so larger angles, infinities and NaNs go to
+    // GMATH_SIN and GMATH_COS instead.
+#define GMATH_TRIG_RANGE 8192.0f
+    
+    // Log(2) split into two parts, for the same reason.
+#define GMATH_LN2_A 0.693359375f
+#define GMATH_LN2_B -2.12194440e-4f
+    
+#if GMATH_POLY_TIER == 2
+#define GMATH_SIN_1 -1.66633904e-1f
+#define GMATH_SIN_2 8.16328193e-3f
+#define GMATH_COS_1 4.16610713e-2f
+#define GMATH_COS_2 -1.36487143e-3f
+#define GMATH_EXP_1 5.00051160e-1f
+#define GMATH_EXP_2 1.67535139e-1f
+#define GMATH_EXP_3 4.12777471e-2f
+#define GMATH_LOG_1 3.32854710e-1f
+#define GMATH_LOG_2 -2.52449975e-1f
+#define GMATH_LOG_3 2.17765100e-1f
+#define GMATH_LOG_4 -1.45925151e-1f
+#else
+#define GMATH_SIN_1 -1.6666654611e-1f
+#define GMATH_SIN_2 8.3321608736e-3f
+#define GMATH_SIN_3 -1.9515295891e-4f
+#define GMATH_COS_1 4.166664568298827e-2f
+#define GMATH_COS_2 -1.388731625493765e-3f
+#define GMATH_COS_3 2.443315711809948e-5f
+#define GMATH_EXP_1 5.0000001201e-1f
+#define GMATH_EXP_2 1.6666665459e-1f
+#define GMATH_EXP_3 4.1665795894e-2f
+#define GMATH_EXP_4 8.3334519073e-3f
+#define GMATH_EXP_5 1.3981999507e-3f
+#define GMATH_EXP_6 1.9875691500e-4f
+#define GMATH_LOG_1 3.3333331174e-1f
+#define GMATH_LOG_2 -2.4999993993e-1f
+#define GMATH_LOG_3 2.0000714765e-1f
+#define GMATH_LOG_4 -1.6668057665e-1f
+#define GMATH_LOG_5 1.4249322787e-1f
+#define GMATH_LOG_6 -1.2420140846e-1f
+#define GMATH_LOG_7 1.1676998740e-1f
+#define GMATH_LOG_8 -1.1514610310e-1f
+#define GMATH_LOG_9 7.0376836292e-2f
+#endif
+    
+    // ACos and ATan2 have a single tier.
+#define GMATH_ASIN_1 1.6666752422e-1f
+#define GMATH_ASIN_2 7.4953002686e-2f
+#define GMATH_ASIN_3 4.5470025998e-2f
+#define GMATH_ASIN_4 2.4181311049e-2f
+#define GMATH_ASIN_5 4.2163199048e-2f
+#define GMATH_ATAN_1 -3.33329491539e-1f
+#define GMATH_ATAN_2 1.99777106478e-1f
+#define GMATH_ATAN_3 -1.38776856032e-1f
+#define GMATH_ATAN_4 8.05374449538e-2f
+#define GMATH_TAN_PI_8 0.414213562373095f
+    
+    // The scalar versions avoid branching on the input: the quadrant and
+    // mantissa range tests are unpredictable, and cost more than the math.
+    static inline unsigned FloatBits(float val)
+    {
+        union {float f; unsigned u;} bits;
+        bits.f = val;
+        return bits.u;
+    }
+    
+    static inline float BitsFloat(unsigned val)
+    {
+        union {float f; unsigned u;} bits;
+        bits.u = val;
+        return bits.f;
+    }
+    
+    static inline int RoundToInt(float val)
+    {
+        // Adding 1.5 * 2^23 pushes the fraction out of the mantissa, leaving
+        // val rounded to nearest in the low bits (for |val| < 2^22).
+        return (int)(FloatBits(val + 12582912.0f) & 0x007fffffu) - 0x00400000;
+    }
+    
+    static inline void SinCosPoly(float radians, float& sin, float& cos)
+    {
+        if (!(GMATH_ABS(radians) <= GMATH_TRIG_RANGE))
+        {
+            sin = GMATH_SIN(radians);
+            cos = GMATH_COS(radians);
+            return;
+        }
+        int quadrant = RoundToInt(radians * (2.0f / GMATH_PI));
+        float q = (float)quadrant;
+        float r = radians - q * GMATH_PI_2_A;
+        r = r - q * GMATH_PI_2_B;
+        r = r - q * GMATH_PI_2_C;
+        r = r - q * GMATH_PI_2_D;
+        float z = r * r;
+#if GMATH_POLY_TIER == 2
+        float s = r + r * z * (GMATH_SIN_1 + z * GMATH_SIN_2);
+        float c = 1.0f - 0.5f * z + z * z * (GMATH_COS_1 + z * GMATH_COS_2);
+#else
+        float s = r + r * z * (GMATH_SIN_1 + z * (GMATH_SIN_2 + z * GMATH_SIN_3));
+        float c = 1.0f - 0.5f * z + z * z * (GMATH_COS_1 + z * (GMATH_COS_2 + z * GMATH_COS_3));
+#endif
+        // The sum turns -0 into +0, and s always has the sign of r.
+        s = BitsFloat(FloatBits(s) | (FloatBits(r) & 0x80000000u));
+        // Odd quadrants swap sine and cosine, and the signs follow the circle.
+        unsigned swap = 0u - (unsigned)(quadrant & 1);
+        unsigned s_bits = FloatBits(s);
+        unsigned c_bits = FloatBits(c);
+        unsigned sin_sign = (unsigned)(quadrant & 2) << 30;
+        unsigned cos_sign = (unsigned)((quadrant + 1) & 2) << 30;
+        sin = BitsFloat(((s_bits & ~swap) | (c_bits & swap)) ^ sin_sign);
+        cos = BitsFloat(((c_bits & ~swap) | (s_bits & swap)) ^ cos_sign);
+    }
+    
+    static inline float ExpPoly(float val)
+    {
+        // NaN passes through, and results past the normal floats are +inf or 0.
+        if (!(val >= -87.3365448f && val <= 88.7228394f))
+        {
+            return val != val ? val : (val > 0.0f ? BitsFloat(0x7f800000u) : 0.0f);
+        }
+        int exponent = RoundToInt(val * 1.44269504f);
+        float n = (float)exponent;
+        float r = val - n * GMATH_LN2_A;
+        r = r - n * GMATH_LN2_B;
+        float z = r * r;
+#if GMATH_POLY_TIER == 2
+        float poly = GMATH_EXP_1 + r * (GMATH_EXP_2 + r * GMATH_EXP_3);
+#else
+        float poly = GMATH_EXP_1 + r * (GMATH_EXP_2 + r * (GMATH_EXP_3 + r * (GMATH_EXP_4 +
+                     r * (GMATH_EXP_5 + r * GMATH_EXP_6))));
+#endif
+        float result = 1.0f + r + z * poly;
+        // 2^128 (near the top of the range) isn't a float, so the scale is
+        // applied in two halves, each of which is.
+        int half = exponent >> 1;
+        result = result * BitsFloat((unsigned)(half + 127) << 23);
+        return result * BitsFloat((unsigned)(exponent - half + 127) << 23);
+    }
+    
+    static inline float LogPoly(float val)
+    {
+        if (!(val > 0.0f))
+        {
+            // -Infinity for zero, NaN for negative numbers and NaN.
+            return BitsFloat(val == 0.0f ? 0xff800000u : 0x7fc00000u);
+        }
+        if (val == BitsFloat(0x7f800000u))
+        {
+            return val;
+        }
+        // Split into a mantissa in [sqrt(0.5), sqrt(2)) and a power of two, by
+        // offsetting the bits so the exponent rolls over at sqrt(0.5).
+        unsigned bits = FloatBits(val);
+        unsigned offset = bits - 0x3f3504f3u;
+        float e = (float)((int)offset >> 23);
+        float m = BitsFloat(bits - (offset & 0xff800000u)) - 1.0f;
+        float z = m * m;
+#if GMATH_POLY_TIER == 2
+        float poly = GMATH_LOG_1 + m * (GMATH_LOG_2 + m * (GMATH_LOG_3 + m * GMATH_LOG_4));
+#else
+        float poly = GMATH_LOG_1 + m * (GMATH_LOG_2 + m * (GMATH_LOG_3 + m * (GMATH_LOG_4 +
+                     m * (GMATH_LOG_5 + m * (GMATH_LOG_6 + m * (GMATH_LOG_7 + m * (GMATH_LOG_8 +
+                     m * GMATH_LOG_9)))))));
+#endif
+        float y = poly * m * z + e * GMATH_LN2_B - 0.5f * z;
+        return m + y + e * GMATH_LN2_A;
+    }
+    
+    static inline float ACosPoly(float cos)
+    {
+        cos = Clamp(cos, -1.0f, 1.0f);
+        float a = cos < 0.0f ? -cos : cos;
+        // Near +-1, use acos(a) = 2 * asin(sqrt((1 - a) / 2)) to keep precision.
+        bool large = a > 0.5f;
+        float z = large ? 0.5f * (1.0f - a) : a * a;
+        float v = large ? Sqrt(z) : a;
+        float asin = v + v * z * (GMATH_ASIN_1 + z * (GMATH_ASIN_2 + z * (GMATH_ASIN_3 + z * (GMATH_ASIN_4 +
+                     z * GMATH_ASIN_5))));
+        if (large)
+        {
+            return cos < 0.0f ? GMATH_PI - 2.0f * asin : 2.0f * asin;
+        }
+        return cos < 0.0f ? GMATH_HALF_PI + asin : GMATH_HALF_PI - asin;
+    }
+    
+    static inline float ATan2Poly(float y, float x)
+    {
+        if (x != x || y != y)
+        {
+            return x + y;
+        }
+        float ax = x < 0.0f ? -x : x;
+        float ay = y < 0.0f ? -y : y;
+        float high = ay > ax ? ay : ax;
+        float low = ay > ax ? ax : ay;
+        // Two infinities give a diagonal, like x = y = 1, and near the top of
+        // the range both are scaled down so that low + high can't overflow.
+        bool infinite = low == BitsFloat(0x7f800000u);
+        float scale = high > BitsFloat(0x7e800000u) ? 0.25f : 1.0f;
+        high = infinite ? 1.0f : high * scale;
+        low = infinite ? 1.0f : low * scale;
+        // Above tan(pi / 8), reduce with atan(t) = pi / 4 + atan((t - 1) / (t + 1)).
+        bool reduce = low > GMATH_TAN_PI_8 * high;
+        float t = 0.0f;
+        if (high > 0.0f)
+        {
+            t = reduce ? (low - high) / (low + high) : low / high;
+        }
+        float z = t * t;
+        float angle = t + t * z * (GMATH_ATAN_1 + z * (GMATH_ATAN_2 + z * (GMATH_ATAN_3 + z * GMATH_ATAN_4)));
+        angle = reduce ? angle + GMATH_PI * 0.25f : angle;
+        angle = ay > ax ? GMATH_HALF_PI - angle : angle;
+        // The sign bit rather than x < 0, so that -0 gives +-pi.
+        angle = (FloatBits(x) & 0x80000000u) ? GMATH_PI - angle : angle;
+        return BitsFloat(FloatBits(angle) | (FloatBits(y) & 0x80000000u));
+    }
+    
+#ifdef GMATH_USE_SSE
+    // Picks a where the mask is set and b elsewhere.
+    static inline __m128 SelectSSE(__m128 mask, __m128 a, __m128 b)
+    {
+        return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+    }
+    
+    static inline __m128i SelectSSE(__m128i mask, __m128i a, __m128i b)
+    {
+        return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+    }
+    
+    static inline void SinCosSSE(__m128 radians, __m128& sin, __m128& cos)
+    {
+        __m128i quadrant = _mm_cvtps_epi32(_mm_mul_ps(radians, _mm_set1_ps(2.0f / GMATH_PI)));
+        __m128 q = _mm_cvtepi32_ps(quadrant);
+        __m128 r = MultiplyAddSSE(q, _mm_set1_ps(-GMATH_PI_2_A), radians);
+        r = MultiplyAddSSE(q, _mm_set1_ps(-GMATH_PI_2_B), r);
+        r = MultiplyAddSSE(q, _mm_set1_ps(-GMATH_PI_2_C), r);
+        r = MultiplyAddSSE(q, _mm_set1_ps(-GMATH_PI_2_D), r);
+        __m128 z = _mm_mul_ps(r, r);
+#if GMATH_POLY_TIER == 2
+        __m128 s = MultiplyAddSSE(z, _mm_set1_ps(GMATH_SIN_2), _mm_set1_ps(GMATH_SIN_1));
+        __m128 c = MultiplyAddSSE(z, _mm_set1_ps(GMATH_COS_2), _mm_set1_ps(GMATH_COS_1));
+#else
+        __m128 s = MultiplyAddSSE(z, _mm_set1_ps(GMATH_SIN_3), _mm_set1_ps(GMATH_SIN_2));
+        s = MultiplyAddSSE(z, s, _mm_set1_ps(GMATH_SIN_1));
+        __m128 c = MultiplyAddSSE(z, _mm_set1_ps(GMATH_COS_3), _mm_set1_ps(GMATH_COS_2));
+        c = MultiplyAddSSE(z, c, _mm_set1_ps(GMATH_COS_1));
+#endif
+        s = MultiplyAddSSE(_mm_mul_ps(r, z), s, r);
+        s = _mm_or_ps(s, _mm_and_ps(r, _mm_set1_ps(-0.0f)));
+        c = MultiplyAddSSE(_mm_mul_ps(z, z), c, MultiplyAddSSE(z, _mm_set1_ps(-0.5f), _mm_set1_ps(1.0f)));
+        __m128i one = _mm_set1_epi32(1);
+        __m128i two = _mm_set1_epi32(2);
+        __m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(quadrant, one), one));
+        __m128 sin_sign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(quadrant, two), 30));
+        __m128 cos_sign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(quadrant, one), two), 30));
+        sin = _mm_xor_ps(SelectSSE(swap, c, s), sin_sign);
+        cos = _mm_xor_ps(SelectSSE(swap, s, c), cos_sign);
+        // Lanes outside GMATH_TRIG_RANGE (or NaN) are redone one at a time.
+        __m128 abs_radians = _mm_andnot_ps(_mm_set1_ps(-0.0f), radians);
+        int outside = _mm_movemask_ps(_mm_cmpnle_ps(abs_radians, _mm_set1_ps(GMATH_TRIG_RANGE)));
+        if (outside != 0)
+        {
+            float in[4], sin_lanes[4], cos_lanes[4];
+            _mm_storeu_ps(in, radians);
+            _mm_storeu_ps(sin_lanes, sin);
+            _mm_storeu_ps(cos_lanes, cos);
+            for (int i = 0; i < 4; ++i)
+            {
+                if (outside & (1 << i))
+                {
+                    sin_lanes[i] = GMATH_SIN(in[i]);
+                    cos_lanes[i] = GMATH_COS(in[i]);
+                }
+            }
+            sin = _mm_loadu_ps(sin_lanes);
+            cos = _mm_loadu_ps(cos_lanes);
+        }
+    }
+    
+    static inline __m128 ExpSSE(__m128 val)
+    {
+        // See ExpPoly for the special cases.
+        __m128 nan = _mm_cmpunord_ps(val, val);
+        __m128 overflow = _mm_cmpgt_ps(val, _mm_set1_ps(88.7228394f));
+        __m128 underflow = _mm_cmplt_ps(val, _mm_set1_ps(-87.3365448f));
+        __m128 x = _mm_max_ps(_mm_min_ps(val, _mm_set1_ps(88.7228394f)), _mm_set1_ps(-87.3365448f));
+        __m128i exponent = _mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(1.44269504f)));
+        __m128 n = _mm_cvtepi32_ps(exponent);
+        __m128 r = MultiplyAddSSE(n, _mm_set1_ps(-GMATH_LN2_A), x);
+        r = MultiplyAddSSE(n, _mm_set1_ps(-GMATH_LN2_B), r);
+        __m128 z = _mm_mul_ps(r, r);
+#if GMATH_POLY_TIER == 2
+        __m128 poly = MultiplyAddSSE(r, _mm_set1_ps(GMATH_EXP_3), _mm_set1_ps(GMATH_EXP_2));
+#else
+        __m128 poly = MultiplyAddSSE(r, _mm_set1_ps(GMATH_EXP_6), _mm_set1_ps(GMATH_EXP_5));
+        poly = MultiplyAddSSE(r, poly, _mm_set1_ps(GMATH_EXP_4));
+        poly = MultiplyAddSSE(r, poly, _mm_set1_ps(GMATH_EXP_3));
+        poly = MultiplyAddSSE(r, poly, _mm_set1_ps(GMATH_EXP_2));
+#endif
+        poly = MultiplyAddSSE(r, poly, _mm_set1_ps(GMATH_EXP_1));
+        __m128 result = MultiplyAddSSE(z, poly, _mm_add_ps(r, _mm_set1_ps(1.0f)));
+        __m128i half = _mm_srai_epi32(exponent, 1);
+        __m128i scale = _mm_slli_epi32(_mm_add_epi32(half, _mm_set1_epi32(127)), 23);
+        result = _mm_mul_ps(result, _mm_castsi128_ps(scale));
+        scale = _mm_slli_epi32(_mm_add_epi32(_mm_sub_epi32(exponent, half), _mm_set1_epi32(127)), 23);
+        result = _mm_mul_ps(result, _mm_castsi128_ps(scale));
+        result = SelectSSE(overflow, _mm_castsi128_ps(_mm_set1_epi32(0x7f800000)), _mm_andnot_ps(underflow, result));
+        return SelectSSE(nan, val, result);
+    }
+    
+    static inline __m128 LogSSE(__m128 val)
+    {
+        __m128 zero = _mm_setzero_ps();
+        __m128 infinity = _mm_castsi128_ps(_mm_set1_epi32(0x7f800000));
+        __m128 invalid = _mm_cmpngt_ps(val, zero);
+        __m128 invalid_result = SelectSSE(_mm_cmpeq_ps(val, zero),
+                                          _mm_castsi128_ps(_mm_set1_epi32((int)0xff800000)),
+                                          _mm_castsi128_ps(_mm_set1_epi32(0x7fc00000)));
+        __m128i bits = _mm_castps_si128(val);
+        __m128i offset = _mm_sub_epi32(bits, _mm_set1_epi32(0x3f3504f3));
+        __m128 e = _mm_cvtepi32_ps(_mm_srai_epi32(offset, 23));
+        __m128i mantissa = _mm_sub_epi32(bits, _mm_and_si128(offset, _mm_set1_epi32((int)0xff800000)));
+        __m128 m = _mm_sub_ps(_mm_castsi128_ps(mantissa), _mm_set1_ps(1.0f));
+        __m128 z = _mm_mul_ps(m, m);
+#if GMATH_POLY_TIER == 2
+        __m128 poly = MultiplyAddSSE(m, _mm_set1_ps(GMATH_LOG_4), _mm_set1_ps(GMATH_LOG_3));
+#else
+        __m128 poly = MultiplyAddSSE(m, _mm_set1_ps(GMATH_LOG_9), _mm_set1_ps(GMATH_LOG_8));
+        poly = MultiplyAddSSE(m, poly, _mm_set1_ps(GMATH_LOG_7));
+        poly = MultiplyAddSSE(m, poly, _mm_set1_ps(GMATH_LOG_6));
+        poly = MultiplyAddSSE(m, poly, _mm_set1_ps(GMATH_LOG_5));
+        poly = MultiplyAddSSE(m, poly, _mm_set1_ps(GMATH_LOG_4));
+        poly = MultiplyAddSSE(m, poly, _mm_set1_ps(GMATH_LOG_3));
+#endif
+        poly = MultiplyAddSSE(m, poly, _mm_set1_ps(GMATH_LOG_2));
+        poly = MultiplyAddSSE(m, poly, _mm_set1_ps(GMATH_LOG_1));
+        __m128 y = MultiplyAddSSE(e, _mm_set1_ps(GMATH_LN2_B), _mm_mul_ps(z, _mm_set1_ps(-0.5f)));
+        y = MultiplyAddSSE(_mm_mul_ps(poly, m), z, y);
+        __m128 result = MultiplyAddSSE(e, _mm_set1_ps(GMATH_LN2_A), _mm_add_ps(m, y));
+        result = SelectSSE(_mm_cmpeq_ps(val, infinity), infinity, result);
+        return SelectSSE(invalid, invalid_result, result);
+    }
+    
+    static inline __m128 ACosSSE(__m128 cos)
+    {
+        __m128 one = _mm_set1_ps(1.0f);
+        __m128 sign_mask = _mm_set1_ps(-0.0f);
+        cos = _mm_max_ps(_mm_min_ps(cos, one), _mm_set1_ps(-1.0f));
+        __m128 a = _mm_andnot_ps(sign_mask, cos);
+        __m128 negative = _mm_cmplt_ps(cos, _mm_setzero_ps());
+        __m128 large = _mm_cmpgt_ps(a, _mm_set1_ps(0.5f));
+        __m128 z = SelectSSE(large, _mm_mul_ps(_mm_set1_ps(0.5f), _mm_sub_ps(one, a)), _mm_mul_ps(a, a));
+        __m128 v = SelectSSE(large, _mm_sqrt_ps(z), a);
+        __m128 poly = MultiplyAddSSE(z, _mm_set1_ps(GMATH_ASIN_5), _mm_set1_ps(GMATH_ASIN_4));
+        poly = MultiplyAddSSE(z, poly, _mm_set1_ps(GMATH_ASIN_3));
+        poly = MultiplyAddSSE(z, poly, _mm_set1_ps(GMATH_ASIN_2));
+        poly = MultiplyAddSSE(z, poly, _mm_set1_ps(GMATH_ASIN_1));
+        __m128 asin = MultiplyAddSSE(_mm_mul_ps(v, z), poly, v);
+        __m128 t = SelectSSE(large, _mm_add_ps(asin, asin), asin);
+        // The result is offset +- t, where the offset is pi / 2, or 0 or pi
+        // for large inputs, and t is subtracted when large matches negative.
+        t = _mm_xor_ps(t, _mm_andnot_ps(_mm_xor_ps(large, negative), sign_mask));
+        __m128 offset = SelectSSE(large, _mm_and_ps(negative, _mm_set1_ps(GMATH_PI)), _mm_set1_ps(GMATH_HALF_PI));
+        return _mm_add_ps(offset, t);
+    }
+    
+    static inline __m128 ATan2SSE(__m128 y, __m128 x)
+    {
+        __m128 zero = _mm_setzero_ps();
+        __m128 sign_mask = _mm_set1_ps(-0.0f);
+        __m128 ax = _mm_andnot_ps(sign_mask, x);
+        __m128 ay = _mm_andnot_ps(sign_mask, y);
+        __m128 swap = _mm_cmpgt_ps(ay, ax);
+        __m128 high = _mm_max_ps(ax, ay);
+        __m128 low = _mm_min_ps(ax, ay);
+        // See ATan2Poly for the special cases.
+        __m128 infinite = _mm_cmpeq_ps(low, _mm_castsi128_ps(_mm_set1_epi32(0x7f800000)));
+        __m128 scale = SelectSSE(_mm_cmpgt_ps(high, _mm_castsi128_ps(_mm_set1_epi32(0x7e800000))), _mm_set1_ps(0.25f), _mm_set1_ps(1.0f));
+        high = SelectSSE(infinite, _mm_set1_ps(1.0f), _mm_mul_ps(high, scale));
+        low = SelectSSE(infinite, _mm_set1_ps(1.0f), _mm_mul_ps(low, scale));
+        __m128 reduce = _mm_cmpgt_ps(low, _mm_mul_ps(_mm_set1_ps(GMATH_TAN_PI_8), high));
+        __m128 numerator = SelectSSE(reduce, _mm_sub_ps(low, high), low);
+        __m128 denominator = SelectSSE(reduce, _mm_add_ps(low, high), high);
+        __m128 t = _mm_and_ps(_mm_cmpgt_ps(high, zero), _mm_div_ps(numerator, denominator));
+        __m128 z = _mm_mul_ps(t, t);
+        __m128 poly = MultiplyAddSSE(z, _mm_set1_ps(GMATH_ATAN_4), _mm_set1_ps(GMATH_ATAN_3));
+        poly = MultiplyAddSSE(z, poly, _mm_set1_ps(GMATH_ATAN_2));
+        poly = MultiplyAddSSE(z, poly, _mm_set1_ps(GMATH_ATAN_1));
+        __m128 angle = MultiplyAddSSE(_mm_mul_ps(t, z), poly, t);
+        angle = _mm_add_ps(angle, _mm_and_ps(reduce, _mm_set1_ps(GMATH_PI * 0.25f)));
+        angle = SelectSSE(swap, _mm_sub_ps(_mm_set1_ps(GMATH_HALF_PI), angle), angle);
+        __m128 negative = _mm_castsi128_ps(_mm_srai_epi32(_mm_castps_si128(x), 31));
+        angle = SelectSSE(negative, _mm_sub_ps(_mm_set1_ps(GMATH_PI), angle), angle);
+        angle = _mm_or_ps(angle, _mm_and_ps(y, sign_mask));
+        return SelectSSE(_mm_cmpunord_ps(x, y), _mm_add_ps(x, y), angle);
+    }
+#endif
+    
+#ifdef GMATH_USE_NEON
+    static inline void SinCosNEON(float32x4_t radians, float32x4_t& sin, float32x4_t& cos)
+    {
+        int32x4_t quadrant = vcvtnq_s32_f32(vmulq_n_f32(radians, 2.0f / GMATH_PI));
+        float32x4_t q = vcvtq_f32_s32(quadrant);
+        float32x4_t r = vfmaq_n_f32(radians, q, -GMATH_PI_2_A);
+        r = vfmaq_n_f32(r, q, -GMATH_PI_2_B);
+        r = vfmaq_n_f32(r, q, -GMATH_PI_2_C);
+        r = vfmaq_n_f32(r, q, -GMATH_PI_2_D);
+        float32x4_t z = vmulq_f32(r, r);
+#if GMATH_POLY_TIER == 2
+        float32x4_t s = vfmaq_n_f32(vdupq_n_f32(GMATH_SIN_1), z, GMATH_SIN_2);
+        float32x4_t c = vfmaq_n_f32(vdupq_n_f32(GMATH_COS_1), z, GMATH_COS_2);
+#else
+        float32x4_t s = vfmaq_n_f32(vdupq_n_f32(GMATH_SIN_2), z, GMATH_SIN_3);
+        s = vfmaq_f32(vdupq_n_f32(GMATH_SIN_1), z, s);
+        float32x4_t c = vfmaq_n_f32(vdupq_n_f32(GMATH_COS_2), z, GMATH_COS_3);
+        c = vfmaq_f32(vdupq_n_f32(GMATH_COS_1), z, c);
+#endif
+        s = vfmaq_f32(r, vmulq_f32(r, z), s);
+        s = vreinterpretq_f32_u32(vorrq_u32(vreinterpretq_u32_f32(s), vandq_u32(vreinterpretq_u32_f32(r), vdupq_n_u32(0x80000000))));
+        c = vfmaq_f32(vfmaq_n_f32(vdupq_n_f32(1.0f), z, -0.5f), vmulq_f32(z, z), c);
+        uint32x4_t swap = vtstq_s32(quadrant, vdupq_n_s32(1));
+        uint32x4_t sin_sign = vreinterpretq_u32_s32(vshlq_n_s32(vandq_s32(quadrant, vdupq_n_s32(2)), 30));
+        uint32x4_t cos_sign = vreinterpretq_u32_s32(vshlq_n_s32(vandq_s32(vaddq_s32(quadrant, vdupq_n_s32(1)), vdupq_n_s32(2)), 30));
+        sin = vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(vbslq_f32(swap, c, s)), sin_sign));
+        cos = vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(vbslq_f32(swap, s, c)), cos_sign));
+        // See SinCosSSE.
+        uint32x4_t inside = vcleq_f32(vabsq_f32(radians), vdupq_n_f32(GMATH_TRIG_RANGE));
+        if (vminvq_u32(inside) == 0)
+        {
+            float in[4], sin_lanes[4], cos_lanes[4];
+            uint32_t lanes[4];
+            vst1q_f32(in, radians);
+            vst1q_f32(sin_lanes, sin);
+            vst1q_f32(cos_lanes, cos);
+            vst1q_u32(lanes, inside);
+            for (int i = 0; i < 4; ++i)
+            {
+                if (lanes[i] == 0)
+                {
+                    sin_lanes[i] = GMATH_SIN(in[i]);
+                    cos_lanes[i] = GMATH_COS(in[i]);
+                }
+            }
+            sin = vld1q_f32(sin_lanes);
+            cos = vld1q_f32(cos_lanes);
+        }
+    }
+    
+    static inline float32x4_t ExpNEON(float32x4_t val)
+    {
+        // See ExpPoly for the special cases.
+        uint32x4_t number = vceqq_f32(val, val);
+        uint32x4_t overflow = vcgtq_f32(val, vdupq_n_f32(88.7228394f));
+        uint32x4_t underflow = vcltq_f32(val, vdupq_n_f32(-87.3365448f));
+        float32x4_t x = vmaxq_f32(vminq_f32(val, vdupq_n_f32(88.7228394f)), vdupq_n_f32(-87.3365448f));
+        int32x4_t exponent = vcvtnq_s32_f32(vmulq_n_f32(x, 1.44269504f));
+        float32x4_t n = vcvtq_f32_s32(exponent);
+        float32x4_t r = vfmaq_n_f32(x, n, -GMATH_LN2_A);
+        r = vfmaq_n_f32(r, n, -GMATH_LN2_B);
+        float32x4_t z = vmulq_f32(r, r);
+#if GMATH_POLY_TIER == 2
+        float32x4_t poly = vfmaq_n_f32(vdupq_n_f32(GMATH_EXP_2), r, GMATH_EXP_3);
+#else
+        float32x4_t poly = vfmaq_n_f32(vdupq_n_f32(GMATH_EXP_5), r, GMATH_EXP_6);
+        poly = vfmaq_f32(vdupq_n_f32(GMATH_EXP_4), r, poly);
+        poly = vfmaq_f32(vdupq_n_f32(GMATH_EXP_3), r, poly);
+        poly = vfmaq_f32(vdupq_n_f32(GMATH_EXP_2), r, poly);
+#endif
+        poly = vfmaq_f32(vdupq_n_f32(GMATH_EXP_1), r, poly);
+        float32x4_t result = vfmaq_f32(vaddq_f32(r, vdupq_n_f32(1.0f)), z, poly);
+        int32x4_t half = vshrq_n_s32(exponent, 1);
+        int32x4_t scale = vshlq_n_s32(vaddq_s32(half, vdupq_n_s32(127)), 23);
+        result = vmulq_f32(result, vreinterpretq_f32_s32(scale));
+        scale = vshlq_n_s32(vaddq_s32(vsubq_s32(exponent, half), vdupq_n_s32(127)), 23);
+        result = vmulq_f32(result, vreinterpretq_f32_s32(scale));
+        result = vbslq_f32(underflow, vdupq_n_f32(0.0f), result);
+        result = vbslq_f32(overflow, vreinterpretq_f32_u32(vdupq_n_u32(0x7f800000)), result);
+        return vbslq_f32(number, result, val);
+    }
+    
+    static inline float32x4_t LogNEON(float32x4_t val)
+    {
+        float32x4_t infinity = vreinterpretq_f32_u32(vdupq_n_u32(0x7f800000));
+        uint32x4_t invalid = vmvnq_u32(vcgtq_f32(val, vdupq_n_f32(0.0f)));
+        float32x4_t invalid_result = vbslq_f32(vceqq_f32(val, vdupq_n_f32(0.0f)),
+                                               vreinterpretq_f32_u32(vdupq_n_u32(0xff800000)),
+                                               vreinterpretq_f32_u32(vdupq_n_u32(0x7fc00000)));
+        int32x4_t bits = vreinterpretq_s32_f32(val);
+        int32x4_t offset = vsubq_s32(bits, vdupq_n_s32(0x3f3504f3));
+        float32x4_t e = vcvtq_f32_s32(vshrq_n_s32(offset, 23));
+        int32x4_t mantissa = vsubq_s32(bits, vandq_s32(offset, vdupq_n_s32((int)0xff800000)));
+        float32x4_t m = vsubq_f32(vreinterpretq_f32_s32(mantissa), vdupq_n_f32(1.0f));
+        float32x4_t z = vmulq_f32(m, m);
+#if GMATH_POLY_TIER == 2
+        float32x4_t poly = vfmaq_n_f32(vdupq_n_f32(GMATH_LOG_3), m, GMATH_LOG_4);
+#else
+        float32x4_t poly = vfmaq_n_f32(vdupq_n_f32(GMATH_LOG_8), m, GMATH_LOG_9);
+        poly = vfmaq_f32(vdupq_n_f32(GMATH_LOG_7), m, poly);
+        poly = vfmaq_f32(vdupq_n_f32(GMATH_LOG_6), m, poly);
+        poly = vfmaq_f32(vdupq_n_f32(GMATH_LOG_5), m, poly);
+        poly = vfmaq_f32(vdupq_n_f32(GMATH_LOG_4), m, poly);
+        poly = vfmaq_f32(vdupq_n_f32(GMATH_LOG_3), m, poly);
+#endif
+        poly = vfmaq_f32(vdupq_n_f32(GMATH_LOG_2), m, poly);
+        poly = vfmaq_f32(vdupq_n_f32(GMATH_LOG_1), m, poly);
+        float32x4_t y = vfmaq_n_f32(vmulq_n_f32(z, -0.5f), e, GMATH_LN2_B);
+        y = vfmaq_f32(y, vmulq_f32(poly, m), z);
+        float32x4_t result = vfmaq_n_f32(vaddq_f32(m, y), e, GMATH_LN2_A);
+        result = vbslq_f32(vceqq_f32(val, infinity), infinity, result);
+        return vbslq_f32(invalid, invalid_result, result);
+    }
+    
+    static inline float32x4_t ACosNEON(float32x4_t cos)
+    {
+        float32x4_t one = vdupq_n_f32(1.0f);
+        cos = vmaxq_f32(vminq_f32(cos, one), vdupq_n_f32(-1.0f));
+        float32x4_t a = vabsq_f32(cos);
+        uint32x4_t negative = vcltq_f32(cos, vdupq_n_f32(0.0f));
+        uint32x4_t large = vcgtq_f32(a, vdupq_n_f32(0.5f));
+        float32x4_t z = vbslq_f32(large, vmulq_n_f32(vsubq_f32(one, a), 0.5f), vmulq_f32(a, a));
+        float32x4_t v = vbslq_f32(large, vsqrtq_f32(z), a);
+        float32x4_t poly = vfmaq_n_f32(vdupq_n_f32(GMATH_ASIN_4), z, GMATH_ASIN_5);
+        poly = vfmaq_f32(vdupq_n_f32(GMATH_ASIN_3), z, poly);
+        poly = vfmaq_f32(vdupq_n_f32(GMATH_ASIN_2), z, poly);
+        poly = vfmaq_f32(vdupq_n_f32(GMATH_ASIN_1), z, poly);
+        float32x4_t asin = vfmaq_f32(v, vmulq_f32(v, z), poly);
+        float32x4_t t = vbslq_f32(large, vaddq_f32(asin, asin), asin);
+        // See ACosSSE for how the offset and sign are chosen.
+        uint32x4_t flip = vandq_u32(vmvnq_u32(veorq_u32(large, negative)), vdupq_n_u32(0x80000000));
+        t = vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(t), flip));
+        float32x4_t offset = vbslq_f32(large, vbslq_f32(negative, vdupq_n_f32(GMATH_PI), vdupq_n_f32(0.0f)),
+                                       vdupq_n_f32(GMATH_HALF_PI));
+        return vaddq_f32(offset, t);
+    }
+    
+    static inline float32x4_t ATan2NEON(float32x4_t y, float32x4_t x)
+    {
+        float32x4_t zero = vdupq_n_f32(0.0f);
+        float32x4_t ax = vabsq_f32(x);
+        float32x4_t ay = vabsq_f32(y);
+        uint32x4_t swap = vcgtq_f32(ay, ax);
+        float32x4_t high = vmaxq_f32(ax, ay);
+        float32x4_t low = vminq_f32(ax, ay);
+        // See ATan2Poly for the special cases.
+        uint32x4_t infinite = vceqq_f32(low, vreinterpretq_f32_u32(vdupq_n_u32(0x7f800000)));
+        float32x4_t scale = vbslq_f32(vcgtq_f32(high, vreinterpretq_f32_u32(vdupq_n_u32(0x7e800000))), vdupq_n_f32(0.25f), vdupq_n_f32(1.0f));
+        high = vbslq_f32(infinite, vdupq_n_f32(1.0f), vmulq_f32(high, scale));
+        low = vbslq_f32(infinite, vdupq_n_f32(1.0f), vmulq_f32(low, scale));
+        uint32x4_t reduce = vcgtq_f32(low, vmulq_n_f32(high, GMATH_TAN_PI_8));
+        float32x4_t numerator = vbslq_f32(reduce, vsubq_f32(low, high), low);
+        float32x4_t denominator = vbslq_f32(reduce, vaddq_f32(low, high), high);
+        float32x4_t t = vbslq_f32(vcgtq_f32(high, zero), vdivq_f32(numerator, denominator), zero);
+        float32x4_t z = vmulq_f32(t, t);
+        float32x4_t poly = vfmaq_n_f32(vdupq_n_f32(GMATH_ATAN_3), z, GMATH_ATAN_4);
+        poly = vfmaq_f32(vdupq_n_f32(GMATH_ATAN_2), z, poly);
+        poly = vfmaq_f32(vdupq_n_f32(GMATH_ATAN_1), z, poly);
+        float32x4_t angle = vfmaq_f32(t, vmulq_f32(t, z), poly);
+        angle = vaddq_f32(angle, vbslq_f32(reduce, vdupq_n_f32(GMATH_PI * 0.25f), zero));
+        angle = vbslq_f32(swap, vsubq_f32(vdupq_n_f32(GMATH_HALF_PI), angle), angle);
+        uint32x4_t negative = vreinterpretq_u32_s32(vshrq_n_s32(vreinterpretq_s32_f32(x), 31));
+        angle = vbslq_f32(negative, vsubq_f32(vdupq_n_f32(GMATH_PI), angle), angle);
+        angle = vbslq_f32(vdupq_n_u32(0x80000000), y, angle);
+        return vbslq_f32(vandq_u32(vceqq_f32(x, x), vceqq_f32(y, y)), angle, vaddq_f32(x, y));
+    }
+#endif
+    
+    // Math function definitions.
+#ifdef GMATH_FAST_TRIG
+    float Sin(float radians) {GMATH_PROFILE_SCOPE(GMATH_PROFILE_SIN, 1); float sin, cos; SinCosPoly(radians, sin, cos); return sin;}
+    float Cos(float radians) {GMATH_PROFILE_SCOPE(GMATH_PROFILE_COS, 1); float sin, cos; SinCosPoly(radians, sin, cos); return cos;}
+    float Tan(float radians) {GMATH_PROFILE_SCOPE(GMATH_PROFILE_TAN, 1); float sin, cos; SinCosPoly(radians, sin, cos); return sin / cos;}
+    float ACos(float cos) {GMATH_PROFILE_SCOPE(GMATH_PROFILE_ACOS, 1); return ACosPoly(cos);}
+    float ATan(float tan) {GMATH_PROFILE_SCOPE(GMATH_PROFILE_ATAN, 1); return ATan2Poly(tan, 1.0f);}
+    float Exp(float val) {GMATH_PROFILE_SCOPE(GMATH_PROFILE_EXP, 1); return ExpPoly(val);}
+    float Log(float val) {GMATH_PROFILE_SCOPE(GMATH_PROFILE_LOG, 1); return LogPoly(val);}
+    float ATan2(float y, float x) {GMATH_PROFILE_SCOPE(GMATH_PROFILE_ATAN2, 1); return ATan2Poly(y, x);}
+    void SinCos(float radians, float& sin, float& cos) {GMATH_PROFILE_SCOPE(GMATH_PROFILE_SINCOS, 1); SinCosPoly(radians, sin, cos);}
+#else
+    float Sin(float radians) {GMATH_PROFILE_SCOPE(GMATH_PROFILE_SIN, 1); return GMATH_SIN(radians);}
+    float Cos(float radians) {GMATH_PROFILE_SCOPE(GMATH_PROFILE_COS, 1); return GMATH_COS(radians);}
+    float Tan(float radians) {GMATH_PROFILE_SCOPE(GMATH_PROFILE_TAN, 1); return GMATH_TAN(radians);}
+    float ACos(float cos) {GMATH_PROFILE_SCOPE(GMATH_PROFILE_ACOS, 1); return GMATH_ACOS(cos);}
+    float ATan(float tan) {GMATH_PROFILE_SCOPE(GMATH_PROFILE_ATAN, 1); return GMATH_ATAN(tan);}
+    float Exp(float val) {GMATH_PROFILE_SCOPE(GMATH_PROFILE_EXP, 1); return GMATH_EXP(val);}
+    float Log(float val) {GMATH_PROFILE_SCOPE(GMATH_PROFILE_LOG, 1); return GMATH_LOG(val);}
+    float ATan2(float y, float x) {GMATH_PROFILE_SCOPE(GMATH_PROFILE_ATAN2, 1); return GMATH_ATAN2(y, x);}
+    
+    void SinCos(float radians, float& sin, float& cos)
+    {
+        GMATH_PROFILE_SCOPE(GMATH_PROFILE_SINCOS, 1);
+        sin = GMATH_SIN(radians);
+        cos = GMATH_COS(radians);
+    }
+#endif
+    
+    float Pow(float val, float exp)
+    {
+        GMATH_PROFILE_SCOPE(GMATH_PROFILE_POW, 1);
+        return Exp(exp * Log(val));
+    }
+    
+    float Sqrt(float val)
+    {
+#ifdef GMATH_USE_SSE
+        __m128 in = _mm_set_ss(val);
+        __m128 out = _mm_sqrt_ss(in);
+        return _mm_cvtss_f32(out);
+#else
+        return GMATH_SQRT(val);
+#endif
+    }
+    
+    float RSqrt(float val)
+    {
+#ifdef GMATH_USE_SSE
+        __m128 in = _mm_set_ss(val);
+        __m128 out = _mm_rsqrt_ss(in);
+        return _mm_cvtss_f32(out);
+#elif defined(GMATH_USE_NEON)
+        // The NEON estimate is only ~8 bits, so refine it with one Newton step.
+        float32x2_t in = vdup_n_f32(val);
+        float32x2_t out = vrsqrte_f32(in);
+        out = vmul_f32(out, vrsqrts_f32(vmul_f32(in, out), out));
+        return vget_lane_f32(out, 0);
+#else
+        return 1.0f / GMATH_SQRT(val);
+#endif
+    }
+    
+    float Radians(float degrees)
+    {
+        return degrees * (GMATH_PI / 180.0f);
+    }
+    
+    float Degrees(float radians)
+    {
+        return (radians * 180.0f) / GMATH_PI;
+    }
+    
+    float Min(float a, float b)
+    {
+        return GMATH_MIN(a, b);
+    }
+    
+    float Max(float a, float b)
+    {
+        return GMATH_MAX(a, b);
+    }
+    
+    float Abs(float val)
+    {
+        return GMATH_ABS(val);
+    }
+    
+    int Mod(int a, int b)
+    {
+        // GMATH_MOD only handles a positive b; this is floor modulo for both.
+        // b = -1 always divides evenly, but INT_MIN % -1 overflows and traps.
+        int remainder = b == -1 ? 0 : a % b;
+        return (remainder != 0 && (remainder ^ b) < 0) ? remainder + b : remainder;
+    }
+    
+    float Pow(float base, int exponent)
+    {
+        float result = 1.0f;
+        float mul = (exponent < 0) ? 1.0f / base : base;
+        int x = (exponent < 0) ? -exponent : exponent;
+        while (x)
+        {
+            if (x & 1)
+            {
+                result *= mul;
+            }
+            mul *= mul;
+            x >>= 1;
+        }
+        return result;
+    }
+    
+    // Four wide math function definitions.
+    void GMATH_CALL SinCos(const Vec4& radians, Vec4& sin, Vec4& cos)
+    {
+#ifdef GMATH_USE_SSE
+        SinCosSSE(radians.data_sse, sin.data_sse, cos.data_sse);
+#elif defined(GMATH_USE_NEON)
+        SinCosNEON(radians.data_neon, sin.data_neon, cos.data_neon);
+#else
+        for (int i = 0; i < 4; ++i)
+        {
+            SinCosPoly(radians[i], sin[i], cos[i]);
+        }
+#endif
+    }
+    
+    Vec4 GMATH_CALL Sin(const Vec4& radians)
+    {
+        Vec4 sin, cos;
+        SinCos(radians, sin, cos);
+        return sin;
+    }
+    
+    Vec4 GMATH_CALL Cos(const Vec4& radians)
+    {
+        Vec4 sin, cos;
+        SinCos(radians, sin, cos);
+        return cos;
+    }
+    
+    Vec4 GMATH_CALL ACos(const Vec4& cos)
+    {
+        Vec4 result;
+#ifdef GMATH_USE_SSE
+        result.data_sse = ACosSSE(cos.data_sse);
+#elif defined(GMATH_USE_NEON)
+        result.data_neon = ACosNEON(cos.data_neon);
+#else
+        for (int i = 0; i < 4; ++i)
+        {
+            result[i] = ACosPoly(cos[i]);
+        }
+#endif
+        return result;
+    }
+    
+    Vec4 GMATH_CALL ATan2(const Vec4& y, const Vec4& x)
+    {
+        Vec4 result;
+#ifdef GMATH_USE_SSE
+        result.data_sse = ATan2SSE(y.data_sse, x.data_sse);
+#elif defined(GMATH_USE_NEON)
+        result.data_neon = ATan2NEON(y.data_neon, x.data_neon);
+#else
+        for (int i = 0; i < 4; ++i)
+        {
+            result[i] = ATan2Poly(y[i], x[i]);
+        }
+#endif
+        return result;
+    }
+    
+    Vec4 GMATH_CALL Exp(const Vec4& val)
+    {
+        Vec4 result;
+#ifdef GMATH_USE_SSE
+        result.data_sse = ExpSSE(val.data_sse);
+#elif defined(GMATH_USE_NEON)
+        result.data_neon = ExpNEON(val.data_neon);
+#else
+        for (int i = 0; i < 4; ++i)
+        {
+            result[i] = ExpPoly(val[i]);
+        }
+#endif
+        return result;
+    }
+    
+    Vec4 GMATH_CALL Log(const Vec4& val)
+    {
+        Vec4 result;
+#ifdef GMATH_USE_SSE
+        result.data_sse = LogSSE(val.data_sse);
+#elif defined(GMATH_USE_NEON)
+        result.data_neon = LogNEON(val.data_neon);
+#else
+        for (int i = 0; i < 4; ++i)
+        {
+            result[i] = LogPoly(val[i]);
+        }
+#endif
+        return result;
+    }
+    
+    float Clamp(float val, float min, float max)
+    {
+        return GMATH_MAX(min, GMATH_MIN(max, val));
+    }
+    
+    float Lerp(float a, float b, float alpha)
+    {
+        float clamped_alpha = Clamp(alpha, 0.0f, 1.0f);
+        return (1.0f - clamped_alpha) * a + clamped_alpha * b;
+    }
+    
+    int Dot(IVec2 a, IVec2 b) {return a.x * b.x + a.y * b.y;}
+    int Dot(IVec3 a, IVec3 b) {return a.x * b.x + a.y * b.y + a.z * b.z;}
+    float Dot(Vec2 a, Vec2 b) {return a.x * b.x + a.y * b.y;}
+    float Dot(Vec3 a, Vec3 b) {return a.x * b.x + a.y * b.y + a.z * b.z;}
+    float GMATH_CALL Dot(const Vec4& a, const Vec4& b)
+    {
+        float result;
+#ifdef GMATH_USE_SSE
+        __m128 result_one = _mm_mul_ps(a.data_sse, b.data_sse);
+        __m128 result_two = _mm_shuffle_ps(result_one, result_one, _MM_SHUFFLE(2, 3, 0, 1));
+        result_one = _mm_add_ps(result_one, result_two);
+        result_two = _mm_shuffle_ps(result_one, result_one, _MM_SHUFFLE(0, 1, 2, 3));
+        result_one = _mm_add_ps(result_one, result_two);
+        _mm_store_ss(&result, result_one);
+#elif defined(GMATH_USE_NEON)
+        result = vaddvq_f32(vmulq_f32(a.data_neon, b.data_neon));
+#else
+        result = (a.x * b.x) + (a.y * b.y) + (a.z * b.z) + (a.w * b.w);
+#endif
+        return result;
+    }
+    
+    Vec3 Cross(Vec3 a, Vec3 b)
+    {
+        return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+    }
+    
+    int LengthSquared(IVec2 vec)
+    {
+        return Dot(vec, vec);
+    }
+    
+    int LengthSquared(IVec3 vec)
+    {
+        return Dot(vec, vec);
+    }
+    
+    float LengthSquared(Vec2 vec)
+    {
+        return Dot(vec, vec);
+    }
+    
+    float LengthSquared(Vec3 vec)
+    {
+        return Dot(vec, vec);
+    }
+    
+    float GMATH_CALL LengthSquared(const Vec4& vec)
+    {
+        return Dot(vec, vec);
+    }
+    
+    float Length(Vec2 vec)
+    {
+        return Sqrt(LengthSquared(vec));
+    }
+    
+    float Length(Vec3 vec)
+    {
+        return Sqrt(LengthSquared(vec));
+    }
+    
+    float GMATH_CALL Length(const Vec4& vec)
+    {
+        return Sqrt(LengthSquared(vec));
+    }
+    
+    Vec2 Normalize(Vec2 vec)
+    {
+        float length = Length(vec);
+        return (length == 0.0f) ? Vec2::Zero : vec / length;
+    }
+    
+    Vec2 FastNormalize(Vec2 vec)
+    {
+        return vec * RSqrt(Dot(vec, vec));
+    }
+    
+    Vec2 SafeNormalize(Vec2 vec, float tolerance)
+    {
+        float length = Length(vec);
+        return (length < tolerance) ? Vec2::Zero : vec / length;
+    }
+    
+    Vec3 Normalize(Vec3 vec)
+    {
+        GMATH_PROFILE_SCOPE(GMATH_PROFILE_NORMALIZE, 1);
+        float length = Length(vec);
+        return (length == 0.0f) ? Vec3::Zero : vec / length;
+    }
+    
+    Vec3 FastNormalize(Vec3 vec)
+    {
+        return vec * RSqrt(Dot(vec, vec));
+    }
+    
+    Vec3 SafeNormalize(Vec3 vec, float tolerance)
+    {
+        float length = Length(vec);
+        return (length < tolerance) ? Vec3::Zero : vec / length;
+    }
+    
+    
+    Vec4 GMATH_CALL Normalize(const Vec4& vec)
+    {
+        GMATH_PROFILE_SCOPE(GMATH_PROFILE_NORMALIZE, 1);
+        float length = Length(vec);
+        return (length == 0.0f) ? Vec4::Zero : vec / length;
+    }
+    
+    Vec4 GMATH_CALL FastNormalize(const Vec4& vec)
+    {
+        return vec * RSqrt(Dot(vec, vec));
+    }
+    
+    Vec4 GMATH_CALL SafeNormalize(const Vec4& vec, float tolerance)
+    {
+        float length = Length(vec);
+        return (length < tolerance) ? Vec4::Zero : vec / length;
+    }
+    
+    Vec2 ClampLength(Vec2 vec, float min, float max)
+    {
+        float length = Length(vec);
+        if (length < min || length > max) vec = Normalize(vec) * Clamp(length, min, max);
+        return vec;
+    }
+    
+    Vec3 ClampLength(Vec3 vec, float min, float max)
+    {
+        float length = Length(vec);
+        if (length < min || length > max) vec = Normalize(vec) * Clamp(length, min, max);
+        return vec;
+    }
+    
+    Vec4 GMATH_CALL ClampLength(const Vec4& vec, float min, float max)
+    {
+        float length = Length(vec);
+        if (length < min || length > max) return Normalize(vec) * Clamp(length, min, max);
+        return vec;
+    }
+    
+    Vec3 MultiplyAdd(Vec3 a, Vec3 b, Vec3 c)
+    {
+        return {a.x * b.x + c.x, a.y * b.y + c.y, a.z * b.z + c.z};
+    }
+    
+    Vec3 MultiplyAdd(Vec3 a, float b, Vec3 c)
+    {
+        return {a.x * b + c.x, a.y * b + c.y, a.z * b + c.z};
+    }
+    
+    Vec4 GMATH_CALL MultiplyAdd(const Vec4& a, const Vec4& b, const Vec4& c)
+    {
+        Vec4 result;
+#ifdef GMATH_USE_SSE
+        result.data_sse = MultiplyAddSSE(a.data_sse, b.data_sse, c.data_sse);
+#elif defined(GMATH_USE_NEON)
+        result.data_neon = vfmaq_f32(c.data_neon, a.data_neon, b.data_neon);
+#else
+        result = {a.x * b.x + c.x, a.y * b.y + c.y, a.z * b.z + c.z, a.w * b.w + c.w};
+#endif
+        return result;
+    }
+    
+    Vec4 GMATH_CALL MultiplyAdd(const Vec4& a, float b, const Vec4& c)
+    {
+        Vec4 result;
+#ifdef GMATH_USE_SSE
+        result.data_sse = MultiplyAddSSE(a.data_sse, _mm_set1_ps(b), c.data_sse);
+#elif defined(GMATH_USE_NEON)
+        result.data_neon = vfmaq_n_f32(c.data_neon, a.data_neon, b);
+#else
+        result = {a.x * b + c.x, a.y * b + c.y, a.z * b + c.z, a.w * b + c.w};
+#endif
+        return result;
+    }
+    
+    // Type conversions.
+    IVec2::operator Vec2() const
+    {
+        return {(float)x, (float)y};
+    }
+    
+    Vec2::operator IVec2() const
+    {
+        return {(int)x, (int)y};
+    }
+    
+    IVec3::operator Vec3() const
+    {
+        return {(float)x, (float)y, (float)z};
+    }
+    
+    Vec3::operator IVec3() const
+    {
+        return {(int)x, (int)y, (int)z};
+    }
+    
+    // Vector math.
+    
+    Vec4 GMATH_CALL CreateVec4(float fill)
+    {
+        Vec4 vec;
+#ifdef GMATH_USE_SSE
+        vec.data_sse = _mm_set1_ps(fill);
+#elif defined(GMATH_USE_NEON)
+        vec.data_neon = vdupq_n_f32(fill);
+#else
+        vec = {fill, fill, fill, fill};
+#endif
+        return vec;
+    }
+    
+    Vec4 GMATH_CALL CreateVec4(Vec3 xyz, float w)
+    {
+        Vec4 vec;
+#ifdef GMATH_USE_SSE
+        vec.data_sse = _mm_setr_ps(xyz.x, xyz.y, xyz.z, w);
+#elif defined(GMATH_USE_NEON)
+        vec.data_neon = SetNEON(xyz.x, xyz.y, xyz.z, w);
+#else
+        vec = {xyz.x, xyz.y, xyz.z, w};
+#endif
+        return vec;
+    }
+    
+    Vec4 GMATH_CALL CreateVec4(float x, float y, float z, float w)
+    {
+        Vec4 vec;
+#ifdef GMATH_USE_SSE
+        vec.data_sse = _mm_setr_ps(x, y, z, w);
+#elif defined(GMATH_USE_NEON)
+        vec.data_neon = SetNEON(x, y, z, w);
+#else
+        vec = {x, y, z, w};
+#endif
+        return vec;
+    }
+    
+    // Vec3A math. The w lane of an input may hold anything, so the horizontal
+    // operations only ever read x, y and z.
+    
+#ifdef GMATH_USE_SSE
+    // Three component dot product, broadcast to every lane.
+    static inline __m128 Dot3SSE(__m128 a, __m128 b)
+    {
+        __m128 product = _mm_mul_ps(a, b);
+        __m128 sum = _mm_add_ps(_mm_shuffle_ps(product, product, 0x00), _mm_shuffle_ps(product, product, 0x55));
+        return _mm_add_ps(sum, _mm_shuffle_ps(product, product, 0xaa));
+    }
+    
+    // Three component cross product on packed vectors. The w lane of the
+    // result is zero for finite inputs.
+    static inline __m128 CrossSSE(__m128 a, __m128 b)
+    {
+        __m128 a_yzx = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1));
+        __m128 b_yzx = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1));
+        __m128 result = _mm_sub_ps(_mm_mul_ps(a, b_yzx), _mm_mul_ps(a_yzx, b));
+        return _mm_shuffle_ps(result, result, _MM_SHUFFLE(3, 0, 2, 1));
+    }
+#endif
+    
+#ifdef GMATH_USE_NEON
+    static inline float32x4_t Dot3NEON(float32x4_t a, float32x4_t b)
+    {
+        float32x4_t product = vsetq_lane_f32(0.0f, vmulq_f32(a, b), 3);
+        return vdupq_n_f32(vaddvq_f32(product));
+    }
+    
+    // Moves y, z, x into the first three lanes, since NEON has no general
+    // shuffle.
+    static inline float32x4_t SwizzleYZXNEON(float32x4_t vec)
+    {
+        float32x2_t low = vget_low_f32(vec);
+        return vcombine_f32(vext_f32(low, vget_high_f32(vec), 1), low);
+    }
+    
+    static inline float32x4_t CrossNEON(float32x4_t a, float32x4_t b)
+    {
+        float32x4_t result = vfmsq_f32(vmulq_f32(a, SwizzleYZXNEON(b)), SwizzleYZXNEON(a), b);
+        return SwizzleYZXNEON(result);
+    }
+#endif
+    
+    Vec3A CreateVec3A()
+    {
+        return Vec3A::Zero;
+    }
+    
+    Vec3A GMATH_CALL CreateVec3A(float fill)
+    {
+        Vec3A vec;
+#ifdef GMATH_USE_SSE
+        vec.data_sse = _mm_set1_ps(fill);
+#elif defined(GMATH_USE_NEON)
+        vec.data_neon = vdupq_n_f32(fill);
+#else
+        vec = CreateVec3A(fill, fill, fill);
+#endif
+        return vec;
+    }
+    
+    Vec3A GMATH_CALL CreateVec3A(float x, float y, float z)
+    {
+        Vec3A vec;
+#ifdef GMATH_USE_SSE
+        vec.data_sse = _mm_setr_ps(x, y, z, 0.0f);
+#elif defined(GMATH_USE_NEON)
+        vec.data_neon = SetNEON(x, y, z, 0.0f);
+#else
+        vec.x = x;
+        vec.y = y;
+        vec.z = z;
+        vec.ignored_w = 0.0f;
+#endif
+        return vec;
+    }
+    
+    Vec3A GMATH_CALL CreateVec3A(Vec3 vec)
+    {
+        return CreateVec3A(vec.x, vec.y, vec.z);
+    }
+    
+    // These two just reinterpret the register, keeping w as it is.
+    Vec3A GMATH_CALL CreateVec3A(const Vec4& xyz)
+    {
+        Vec3A vec;
+#ifdef GMATH_USE_SSE
+        vec.data_sse = xyz.data_sse;
+#elif defined(GMATH_USE_NEON)
+        vec.data_neon = xyz.data_neon;
+#else
+        vec.xyz = xyz.xyz;
+        vec.ignored_w = xyz.w;
+#endif
+        return vec;
+    }
+    
+    Vec3A GMATH_CALL CreateVec3A(const Quat& xyz)
+    {
+        Vec3A vec;
+#ifdef GMATH_USE_SSE
+        vec.data_sse = xyz.data_sse;
+#elif defined(GMATH_USE_NEON)
+        vec.data_neon = xyz.data_neon;
+#else
+        vec.xyz = xyz.xyz;
+        vec.ignored_w = xyz.w;
+#endif
+        return vec;
+    }
+    
+    Vec4 GMATH_CALL CreateVec4(const Vec3A& xyz, float w)
+    {
+        Vec4 vec;
+#ifdef GMATH_USE_SSE
+        // (z, w, _, w), then (x, y) from xyz and (z, w) from that.
+        __m128 z_w = _mm_unpackhi_ps(xyz.data_sse, _mm_set1_ps(w));
+        vec.data_sse = _mm_shuffle_ps(xyz.data_sse, z_w, _MM_SHUFFLE(1, 0, 1, 0));
+#elif defined(GMATH_USE_NEON)
+        vec.data_neon = vsetq_lane_f32(w, xyz.data_neon, 3);
+#else
+        vec = {xyz.x, xyz.y, xyz.z, w};
+#endif
+        return vec;
+    }
+    
+    float GMATH_CALL Dot(const Vec3A& a, const Vec3A& b)
+    {
+#ifdef GMATH_USE_SSE
+        return _mm_cvtss_f32(Dot3SSE(a.data_sse, b.data_sse));
+#elif defined(GMATH_USE_NEON)
+        return vaddvq_f32(vsetq_lane_f32(0.0f, vmulq_f32(a.data_neon, b.data_neon), 3));
+#else
+        return a.x * b.x + a.y * b.y + a.z * b.z;
+#endif
+    }
+    
+    Vec3A GMATH_CALL Cross(const Vec3A& a, const Vec3A& b)
+    {
+        Vec3A result;
+#ifdef GMATH_USE_SSE
+        result.data_sse = CrossSSE(a.data_sse, b.data_sse);
+#elif defined(GMATH_USE_NEON)
+        result.data_neon = CrossNEON(a.data_neon, b.data_neon);
+#else
+        result = CreateVec3A(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+#endif
+        return result;
+    }
+    
+    float GMATH_CALL LengthSquared(const Vec3A& vec)
+    {
+        return Dot(vec, vec);
+    }
+    
+    float GMATH_CALL Length(const Vec3A& vec)
+    {
+        return Sqrt(LengthSquared(vec));
+    }
+    
+    // The normalizes keep the length in every lane, so they never leave the
+    // vector registers.
+    Vec3A GMATH_CALL Normalize(const Vec3A& vec)
+    {
+        GMATH_PROFILE_SCOPE(GMATH_PROFILE_NORMALIZE, 1);
+        Vec3A result;
+#ifdef GMATH_USE_SSE
+        __m128 length_squared = Dot3SSE(vec.data_sse, vec.data_sse);
+        __m128 non_zero = _mm_cmpgt_ps(length_squared, _mm_setzero_ps());
+        result.data_sse = _mm_and_ps(non_zero, _mm_div_ps(vec.data_sse, _mm_sqrt_ps(length_squared)));
+#elif defined(GMATH_USE_NEON)
+        float32x4_t length_squared = Dot3NEON(vec.data_neon, vec.data_neon);
+        uint32x4_t non_zero = vcgtq_f32(length_squared, vdupq_n_f32(0.0f));
+        float32x4_t normalized = vdivq_f32(vec.data_neon, vsqrtq_f32(length_squared));
+        result.data_neon = vreinterpretq_f32_u32(vandq_u32(non_zero, vreinterpretq_u32_f32(normalized)));
+#else
+        float length = Length(vec);
+        result = (length == 0.0f) ? Vec3A::Zero : vec / length;
+#endif
+        return result;
+    }
+    
+    Vec3A GMATH_CALL FastNormalize(const Vec3A& vec)
+    {
+        Vec3A result;
+#ifdef GMATH_USE_SSE
+        __m128 length_squared = Dot3SSE(vec.data_sse, vec.data_sse);
+        result.data_sse = _mm_mul_ps(vec.data_sse, _mm_rsqrt_ps(length_squared));
+#elif defined(GMATH_USE_NEON)
+        // The NEON estimate is only ~8 bits, so refine it with one Newton step.
+        float32x4_t length_squared = Dot3NEON(vec.data_neon, vec.data_neon);
+        float32x4_t inv_length = vrsqrteq_f32(length_squared);
+        inv_length = vmulq_f32(inv_length, vrsqrtsq_f32(vmulq_f32(length_squared, inv_length), inv_length));
+        result.data_neon = vmulq_f32(vec.data_neon, inv_length);
+#else
+        result = vec * RSqrt(Dot(vec, vec));
+#endif
+        return result;
+    }
+    
+    Vec3A GMATH_CALL SafeNormalize(const Vec3A& vec, float tolerance)
+    {
+        Vec3A result;
+#ifdef GMATH_USE_SSE
+        __m128 length = _mm_sqrt_ps(Dot3SSE(vec.data_sse, vec.data_sse));
+        __m128 long_enough = _mm_cmpge_ps(length, _mm_set1_ps(tolerance));
+        result.data_sse = _mm_and_ps(long_enough, _mm_div_ps(vec.data_sse, length));
+#elif defined(GMATH_USE_NEON)
+        float32x4_t length = vsqrtq_f32(Dot3NEON(vec.data_neon, vec.data_neon));
+        uint32x4_t long_enough = vcgeq_f32(length, vdupq_n_f32(tolerance));
+        float32x4_t normalized = vdivq_f32(vec.data_neon, length);
+        result.data_neon = vreinterpretq_f32_u32(vandq_u32(long_enough, vreinterpretq_u32_f32(normalized)));
+#else
+        float length = Length(vec);
+        result = (length < tolerance) ? Vec3A::Zero : vec / length;
+#endif
+        return result;
+    }
+    
+    Vec3A GMATH_CALL ClampLength(const Vec3A& vec, float min, float max)
+    {
+        float length = Length(vec);
+        if (length < min || length > max) return Normalize(vec) * Clamp(length, min, max);
+        return vec;
+    }
+    
+    Vec3A GMATH_CALL MultiplyAdd(const Vec3A& a, const Vec3A& b, const Vec3A& c)
+    {
+        Vec3A result;
+#ifdef GMATH_USE_SSE
+        result.data_sse = MultiplyAddSSE(a.data_sse, b.data_sse, c.data_sse);
+#elif defined(GMATH_USE_NEON)
+        result.data_neon = vfmaq_f32(c.data_neon, a.data_neon, b.data_neon);
+#else
+        for (int i = 0; i < 4; ++i) result.data[i] = a.data[i] * b.data[i] + c.data[i];
+#endif
+        return result;
+    }
+    
+    Vec3A GMATH_CALL MultiplyAdd(const Vec3A& a, float b, const Vec3A& c)
+    {
+        Vec3A result;
+#ifdef GMATH_USE_SSE
+        result.data_sse = MultiplyAddSSE(a.data_sse, _mm_set1_ps(b), c.data_sse);
+#elif defined(GMATH_USE_NEON)
+        result.data_neon = vfmaq_n_f32(c.data_neon, a.data_neon, b);
+#else
+        for (int i = 0; i < 4; ++i) result.data[i] = a.data[i] * b + c.data[i];
+#endif
+        return result;
+    }
+    
+    // Matrix math.
+    
+    Mat4 GMATH_CALL Transpose(const Mat4& mat)
+    {
+        Mat4 result;
+#ifdef GMATH_USE_SSE
+        result = mat;
+        _MM_TRANSPOSE4_PS(result.data_sse[0], result.data_sse[1], result.data_sse[2], result.data_sse[3]);
+#elif defined(GMATH_USE_NEON)
+        // A de-interleaving load with stride four reads the rows directly.
+        float32x4x4_t rows = vld4q_f32(mat.columns[0].data);
+        result.data_neon[0] = rows.val[0];
+        result.data_neon[1] = rows.val[1];
+        result.data_neon[2] = rows.val[2];
+        result.data_neon[3] = rows.val[3];
+#else
+        result[0] = {mat.columns[0].x, mat.columns[1].x, mat.columns[2].x, mat.columns[3].x};
+        result[1] = {mat.columns[0].y, mat.columns[1].y, mat.columns[2].y, mat.columns[3].y};
+        result[2] = {mat.columns[0].z, mat.columns[1].z, mat.columns[2].z, mat.columns[3].z};
+        result[3] = {mat.columns[0].w, mat.columns[1].w, mat.columns[2].w, mat.columns[3].w};
+#endif
+        return result;
+    }
+    
+#ifdef GMATH_IMPLEMENTATION
+    // Clip space depth over w is m22 + m32 / z for a left handed matrix (w = z),
+    // and -m22 - m32 / z for a right handed one (w = -z). Solving that for
+    // near_depth at the near plane and far_depth at the far one gives m32 and
+    // m22, and their limits as far goes to infinity.
+    static inline Mat4 PerspectiveMatrix(float cotan, float aspect, float near, float far, uint32_t options)
+    {
+#ifdef GMATH_DEPTH_ZERO_TO_ONE
+        float near_depth = 0.0f;
+#else
+        float near_depth = -1.0f;
+#endif
+        float far_depth = 1.0f;
+        if (options & GMATH_CAMERA_REVERSE_Z)
+        {
+            float temp = near_depth;
+            near_depth = far_depth;
+            far_depth = temp;
+        }
+        float m22, m32;
+        if (options & GMATH_CAMERA_INFINITE_FAR)
+        {
+            m22 = far_depth;
+            m32 = (near_depth - far_depth) * near;
+        }
+        else
+        {
+            float scale = (near_depth - far_depth) * near / (far - near);
+            m22 = far_depth - scale;
+            m32 = scale * far;
+        }
+        Mat4 result = {};
+        result[0][0] = cotan / aspect;
+        result[1][1] = cotan;
+#ifdef GMATH_RIGHT_HANDED
+        result[2][2] = -m22;
+        result[2][3] = -1.0f;
+#else
+        result[2][2] = m22;
+        result[2][3] = 1.0f;
+#endif
+        result[3][2] = m32;
+        return result;
+    }
+    
+    static inline float PerspectiveCotan(float fov)
+    {
+        return 1.0f / Tan(fov * (GMATH_PI / 360.f));
+    }
+    
+    Mat4 GMATH_CALL CreatePerspectiveMatrix(float fov, float aspect, float near, float far)
+    {
+        return PerspectiveMatrix(PerspectiveCotan(fov), aspect, near, far, 0);
+    }
+    
+    Mat4 GMATH_CALL CreatePerspectiveMatrixReverseZ(float fov, float aspect, float near, float far)
+    {
+        return PerspectiveMatrix(PerspectiveCotan(fov), aspect, near, far, GMATH_CAMERA_REVERSE_Z);
+    }
+    
+    Mat4 GMATH_CALL CreatePerspectiveMatrixInfinite(float fov, float aspect, float near)
+    {
+        return PerspectiveMatrix(PerspectiveCotan(fov), aspect, near, 0.0f, GMATH_CAMERA_INFINITE_FAR);
+    }
+    
+    Mat4 GMATH_CALL CreatePerspectiveMatrixInfiniteReverseZ(float fov, float aspect, float near)
+    {
+        return PerspectiveMatrix(PerspectiveCotan(fov), aspect, near, 0.0f, GMATH_CAMERA_INFINITE_FAR | GMATH_CAMERA_REVERSE_Z);
+    }
+#endif // GMATH_IMPLEMENTATION
+    
+    
+#ifdef GMATH_USE_SSE
+    static inline __m128 LinearCombineSSE(__m128 left, const Mat4& right)
+    {
+        __m128 result;
+        result = _mm_mul_ps(_mm_shuffle_ps(left, left, 0x00), right.data_sse[0]);
+        result = MultiplyAddSSE(_mm_shuffle_ps(left, left, 0x55), right.data_sse[1], result);
+        result = MultiplyAddSSE(_mm_shuffle_ps(left, left, 0xaa), right.data_sse[2], result);
+        result = MultiplyAddSSE(_mm_shuffle_ps(left, left, 0xff), right.data_sse[3], result);
+        return result;
+    }
+#endif
+    
+#ifdef GMATH_USE_NEON
+    static inline float32x4_t LinearCombineNEON(float32x4_t left, const Mat4& right)
+    {
+        float32x4_t result;
+        result = vmulq_laneq_f32(right.data_neon[0], left, 0);
+        result = vfmaq_laneq_f32(result, right.data_neon[1], left, 1);
+        result = vfmaq_laneq_f32(result, right.data_neon[2], left, 2);
+        result = vfmaq_laneq_f32(result, right.data_neon[3], left, 3);
+        return result;
+    }
+#endif
+    
+    Mat4 GMATH_CALL operator*(const Mat4& a, const Mat4& b)
+    {
+        GMATH_PROFILE_SCOPE(GMATH_PROFILE_MAT4_MULTIPLY, 1);
+        Mat4 result;
+#ifdef GMATH_USE_SSE
+        result.data_sse[0] = LinearCombineSSE(b.data_sse[0], a);
+        result.data_sse[1] = LinearCombineSSE(b.data_sse[1], a);
+        result.data_sse[2] = LinearCombineSSE(b.data_sse[2], a);
+        result.data_sse[3] = LinearCombineSSE(b.data_sse[3], a);
+#elif defined(GMATH_USE_NEON)
+        result.data_neon[0] = LinearCombineNEON(b.data_neon[0], a);
+        result.data_neon[1] = LinearCombineNEON(b.data_neon[1], a);
+        result.data_neon[2] = LinearCombineNEON(b.data_neon[2], a);
+        result.data_neon[3] = LinearCombineNEON(b.data_neon[3], a);
+#else
+        for (int i = 0; i < 4; ++i)
+        {
+            for (int j = 0; j < 4; ++j)
+            {
+                result[i][j] = a[0][j] * b[i][0] + a[1][j] * b[i][1] + a[2][j] * b[i][2] + a[3][j] * b[i][3];
+            }
+        }
+#endif
+        return result;
+    }
+    
+    Vec4 GMATH_CALL operator*(const Mat4& mat, const Vec4& vec)
+    {
+        Vec4 result;
+#ifdef GMATH_USE_SSE
+        result.data_sse = LinearCombineSSE(vec.data_sse, mat);
+#elif defined(GMATH_USE_NEON)
+        result.data_neon = LinearCombineNEON(vec.data_neon, mat);
+#else
+        for (int i = 0; i < 4; ++i)
+        {
+            result[i] = mat[0][i] * vec[0] + mat[1][i] * vec[1] + mat[2][i] * vec[2] + mat[3][i] * vec[3];
+        }
+#endif
+        return result;
+    }
+    
+    Vec4 GMATH_CALL operator*(Mat4Chain&& chain, const Vec4& vec)
+    {
+        Vec4 result = *chain.mat * vec;
+        for (const Mat4Chain* link = chain.previous; link; link = link->previous) result = *link->mat * result;
+        return result;
+    }
+    
+    // Products are associative, so this can also run right to left.
+    Mat4 GMATH_CALL Evaluate(Mat4Chain&& chain)
+    {
+        Mat4 result = *chain.mat;
+        for (const Mat4Chain* link = chain.previous; link; link = link->previous) result = *link->mat * result;
+        return result;
+    }
+    
+    // Batch transforms.
+    
+#ifdef GMATH_USE_SSE
+    // Four packed Vec3s occupy three registers (x0 y0 z0 x1 | y1 z1 x2 y2 |
+    // z2 x3 y3 z3). These shuffle between that layout and one register per
+    // component, so the batch kernels can work on four vectors at once.
+    static inline void DeinterleaveVec3SSE(__m128 a, __m128 b, __m128 c, __m128& x, __m128& y, __m128& z)
+    {
+        __m128 temp_one = _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2));
+        x = _mm_shuffle_ps(a, temp_one, _MM_SHUFFLE(2, 0, 3, 0));
+        temp_one = _mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1));
+        __m128 temp_two = _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3));
+        y = _mm_shuffle_ps(temp_one, temp_two, _MM_SHUFFLE(2, 0, 2, 0));
+        temp_one = _mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2));
+        temp_two = _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0));
+        z = _mm_shuffle_ps(temp_one, temp_two, _MM_SHUFFLE(2, 0, 2, 0));
+    }
+    
+    static inline void InterleaveVec3SSE(__m128 x, __m128 y, __m128 z, __m128& a, __m128& b, __m128& c)
+    {
+        __m128 temp_one = _mm_shuffle_ps(x, y, _MM_SHUFFLE(0, 0, 0, 0));
+        __m128 temp_two = _mm_shuffle_ps(z, x, _MM_SHUFFLE(1, 1, 0, 0));
+        a = _mm_shuffle_ps(temp_one, temp_two, _MM_SHUFFLE(2, 0, 2, 0));
+        temp_one = _mm_shuffle_ps(y, z, _MM_SHUFFLE(1, 1, 1, 1));
+        temp_two = _mm_shuffle_ps(x, y, _MM_SHUFFLE(2, 2, 2, 2));
+        b = _mm_shuffle_ps(temp_one, temp_two, _MM_SHUFFLE(2, 0, 2, 0));
+        temp_one = _mm_shuffle_ps(z, x, _MM_SHUFFLE(3, 3, 2, 2));
+        temp_two = _mm_shuffle_ps(y, z, _MM_SHUFFLE(3, 3, 3, 3));
+        c = _mm_shuffle_ps(temp_one, temp_two, _MM_SHUFFLE(2, 0, 2, 0));
+    }
+#endif
+    
+#ifdef GMATH_IMPLEMENTATION
+#ifdef GMATH_USE_SSE
+    static inline void TransformVec4sSSE(const Mat4& mat, const Vec4* in, Vec4* out, size_t count, bool aligned)
+    {
+        __m128 column_0 = mat.data_sse[0];
+        __m128 column_1 = mat.data_sse[1];
+        __m128 column_2 = mat.data_sse[2];
+        __m128 column_3 = mat.data_sse[3];
+        const float* src = in->data;
+        float* dst = out->data;
+        for (size_t i = 0; i < count; ++i, src += 4, dst += 4)
+        {
+            __m128 vec = aligned ? _mm_load_ps(src) : _mm_loadu_ps(src);
+            __m128 result = _mm_mul_ps(_mm_shuffle_ps(vec, vec, 0x00), column_0);
+            result = MultiplyAddSSE(_mm_shuffle_ps(vec, vec, 0x55), column_1, result);
+            result = MultiplyAddSSE(_mm_shuffle_ps(vec, vec, 0xaa), column_2, result);
+            result = MultiplyAddSSE(_mm_shuffle_ps(vec, vec, 0xff), column_3, result);
+            if (aligned) _mm_store_ps(dst, result);
+            else _mm_storeu_ps(dst, result);
+        }
+    }
+    
+    // Works on blocks of four Vec3s. The matrix elements are broadcast once up
+    // front, and translation is only added when w is 1 (points).
+    static inline void TransformVec3sSSE(const Mat4& mat, const Vec3* in, Vec3* out, size_t count, float w, bool aligned)
+    {
+        __m128 m00 = _mm_set1_ps(mat[0][0]), m01 = _mm_set1_ps(mat[0][1]), m02 = _mm_set1_ps(mat[0][2]);
+        __m128 m10 = _mm_set1_ps(mat[1][0]), m11 = _mm_set1_ps(mat[1][1]), m12 = _mm_set1_ps(mat[1][2]);
+        __m128 m20 = _mm_set1_ps(mat[2][0]), m21 = _mm_set1_ps(mat[2][1]), m22 = _mm_set1_ps(mat[2][2]);
+        __m128 m30 = _mm_set1_ps(mat[3][0] * w), m31 = _mm_set1_ps(mat[3][1] * w), m32 = _mm_set1_ps(mat[3][2] * w);
+        const float* src = in->data;
+        float* dst = out->data;
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4, src += 12, dst += 12)
+        {
+            __m128 a, b, c;
+            if (aligned)
+            {
+                a = _mm_load_ps(src);
+                b = _mm_load_ps(src + 4);
+                c = _mm_load_ps(src + 8);
+            }
+            else
+            {
+                a = _mm_loadu_ps(src);
+                b = _mm_loadu_ps(src + 4);
+                c = _mm_loadu_ps(src + 8);
+            }
+            __m128 x, y, z;
+            DeinterleaveVec3SSE(a, b, c, x, y, z);
+            __m128 result_x = MultiplyAddSSE(m00, x, MultiplyAddSSE(m10, y, MultiplyAddSSE(m20, z, m30)));
+            __m128 result_y = MultiplyAddSSE(m01, x, MultiplyAddSSE(m11, y, MultiplyAddSSE(m21, z, m31)));
+            __m128 result_z = MultiplyAddSSE(m02, x, MultiplyAddSSE(m12, y, MultiplyAddSSE(m22, z, m32)));
+            InterleaveVec3SSE(result_x, result_y, result_z, a, b, c);
+            if (aligned)
+            {
+                _mm_store_ps(dst, a);
+                _mm_store_ps(dst + 4, b);
+                _mm_store_ps(dst + 8, c);
+            }
+            else
+            {
+                _mm_storeu_ps(dst, a);
+                _mm_storeu_ps(dst + 4, b);
+                _mm_storeu_ps(dst + 8, c);
+            }
+        }
+        for (; i < count; ++i, src += 3, dst += 3)
+        {
+            float x = src[0], y = src[1], z = src[2];
+            dst[0] = mat[0][0] * x + mat[1][0] * y + mat[2][0] * z + mat[3][0] * w;
+            dst[1] = mat[0][1] * x + mat[1][1] * y + mat[2][1] * z + mat[3][1] * w;
+            dst[2] = mat[0][2] * x + mat[1][2] * y + mat[2][2] * z + mat[3][2] * w;
+        }
+    }
+#endif
+    
+#ifdef GMATH_AVX_KERNELS
+    static inline GMATH_TARGET_AVX __m256 CombineHalvesAVX(__m128 low, __m128 high)
+    {
+        return _mm256_insertf128_ps(_mm256_castps128_ps256(low), high, 1);
+    }
+    
+    // Two Vec4s per register, each lane multiplied by the whole matrix. 32 byte
+    // alignment of pairs isn't guaranteed, so the loads are unaligned either
+    // way (which costs nothing on AVX hardware when the data is aligned).
+    static inline GMATH_TARGET_AVX void TransformVec4sAVX(const Mat4& mat, const Vec4* in, Vec4* out, size_t count)
+    {
+        __m256 column_0 = _mm256_broadcast_ps(&mat.data_sse[0]);
+        __m256 column_1 = _mm256_broadcast_ps(&mat.data_sse[1]);
+        __m256 column_2 = _mm256_broadcast_ps(&mat.data_sse[2]);
+        __m256 column_3 = _mm256_broadcast_ps(&mat.data_sse[3]);
+        const float* src = in->data;
+        float* dst = out->data;
+        size_t i = 0;
+        for (; i + 2 <= count; i += 2, src += 8, dst += 8)
+        {
+            __m256 vec = _mm256_loadu_ps(src);
+            __m256 result = _mm256_mul_ps(_mm256_permute_ps(vec, 0x00), column_0);
+            result = _mm256_fmadd_ps(_mm256_permute_ps(vec, 0x55), column_1, result);
+            result = _mm256_fmadd_ps(_mm256_permute_ps(vec, 0xaa), column_2, result);
+            result = _mm256_fmadd_ps(_mm256_permute_ps(vec, 0xff), column_3, result);
+            _mm256_storeu_ps(dst, result);
+        }
+        if (i < count)
+        {
+            __m128 vec = _mm_loadu_ps(src);
+            __m128 result = _mm_mul_ps(_mm_permute_ps(vec, 0x00), mat.data_sse[0]);
+            result = _mm_fmadd_ps(_mm_permute_ps(vec, 0x55), mat.data_sse[1], result);
+            result = _mm_fmadd_ps(_mm_permute_ps(vec, 0xaa), mat.data_sse[2], result);
+            result = _mm_fmadd_ps(_mm_permute_ps(vec, 0xff), mat.data_sse[3], result);
+            _mm_storeu_ps(dst, result);
+        }
+    }
+    
+    // DeinterleaveVec3SSE and InterleaveVec3SSE on both halves, with Vec3s
+    // zero to three in the low half and four to seven in the high half.
+    static inline GMATH_TARGET_AVX void DeinterleaveVec3AVX(__m256 a, __m256 b, __m256 c, __m256& x, __m256& y, __m256& z)
+    {
+        __m256 temp_one = _mm256_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2));
+        x = _mm256_shuffle_ps(a, temp_one, _MM_SHUFFLE(2, 0, 3, 0));
+        temp_one = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1));
+        __m256 temp_two = _mm256_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3));
+        y = _mm256_shuffle_ps(temp_one, temp_two, _MM_SHUFFLE(2, 0, 2, 0));
+        temp_one = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2));
+        temp_two = _mm256_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0));
+        z = _mm256_shuffle_ps(temp_one, temp_two, _MM_SHUFFLE(2, 0, 2, 0));
+    }
+    
+    static inline GMATH_TARGET_AVX void InterleaveVec3AVX(__m256 x, __m256 y, __m256 z, __m256& a, __m256& b, __m256& c)
+    {
+        __m256 temp_one = _mm256_shuffle_ps(x, y, _MM_SHUFFLE(0, 0, 0, 0));
+        __m256 temp_two = _mm256_shuffle_ps(z, x, _MM_SHUFFLE(1, 1, 0, 0));
+        a = _mm256_shuffle_ps(temp_one, temp_two, _MM_SHUFFLE(2, 0, 2, 0));
+        temp_one = _mm256_shuffle_ps(y, z, _MM_SHUFFLE(1, 1, 1, 1));
+        temp_two = _mm256_shuffle_ps(x, y, _MM_SHUFFLE(2, 2, 2, 2));
+        b = _mm256_shuffle_ps(temp_one, temp_two, _MM_SHUFFLE(2, 0, 2, 0));
+        temp_one = _mm256_shuffle_ps(z, x, _MM_SHUFFLE(3, 3, 2, 2));
+        temp_two = _mm256_shuffle_ps(y, z, _MM_SHUFFLE(3, 3, 3, 3));
+        c = _mm256_shuffle_ps(temp_one, temp_two, _MM_SHUFFLE(2, 0, 2, 0));
+    }
+    
+    // As TransformVec3sSSE, eight Vec3s at a time, leaving the rest to it.
+    static inline GMATH_TARGET_AVX void TransformVec3sAVX(const Mat4& mat, const Vec3* in, Vec3* out, size_t count, float w)
+    {
+        __m256 m00 = _mm256_set1_ps(mat[0][0]), m01 = _mm256_set1_ps(mat[0][1]), m02 = _mm256_set1_ps(mat[0][2]);
+        __m256 m10 = _mm256_set1_ps(mat[1][0]), m11 = _mm256_set1_ps(mat[1][1]), m12 = _mm256_set1_ps(mat[1][2]);
+        __m256 m20 = _mm256_set1_ps(mat[2][0]), m21 = _mm256_set1_ps(mat[2][1]), m22 = _mm256_set1_ps(mat[2][2]);
+        __m256 m30 = _mm256_set1_ps(mat[3][0] * w), m31 = _mm256_set1_ps(mat[3][1] * w), m32 = _mm256_set1_ps(mat[3][2] * w);
+        const float* src = in->data;
+        float* dst = out->data;
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8, src += 24, dst += 24)
+        {
+            __m256 a = CombineHalvesAVX(_mm_loadu_ps(src), _mm_loadu_ps(src + 12));
+            __m256 b = CombineHalvesAVX(_mm_loadu_ps(src + 4), _mm_loadu_ps(src + 16));
+            __m256 c = CombineHalvesAVX(_mm_loadu_ps(src + 8), _mm_loadu_ps(src + 20));
+            __m256 x, y, z;
+            DeinterleaveVec3AVX(a, b, c, x, y, z);
+            __m256 result_x = _mm256_fmadd_ps(m00, x, _mm256_fmadd_ps(m10, y, _mm256_fmadd_ps(m20, z, m30)));
+            __m256 result_y = _mm256_fmadd_ps(m01, x, _mm256_fmadd_ps(m11, y, _mm256_fmadd_ps(m21, z, m31)));
+            __m256 result_z = _mm256_fmadd_ps(m02, x, _mm256_fmadd_ps(m12, y, _mm256_fmadd_ps(m22, z, m32)));
+            InterleaveVec3AVX(result_x, result_y, result_z, a, b, c);
+            _mm_storeu_ps(dst, _mm256_castps256_ps128(a));
+            _mm_storeu_ps(dst + 4, _mm256_castps256_ps128(b));
+            _mm_storeu_ps(dst + 8, _mm256_castps256_ps128(c));
+            _mm_storeu_ps(dst + 12, _mm256_extractf128_ps(a, 1));
+            _mm_storeu_ps(dst + 16, _mm256_extractf128_ps(b, 1));
+            _mm_storeu_ps(dst + 20, _mm256_extractf128_ps(c, 1));
+        }
+        TransformVec3sSSE(mat, in + i, out + i, count - i, w, false);
+    }
+#endif
+    
+#ifndef GMATH_USE_SSE
+    static inline void TransformVec3sScalar(const Mat4& mat, const Vec3* in, Vec3* out, size_t count, float w)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            Vec3 vec = in[i];
+            for (int j = 0; j < 3; ++j)
+            {
+                out[i][j] = mat[0][j] * vec.x + mat[1][j] * vec.y + mat[2][j] * vec.z + mat[3][j] * w;
+            }
+        }
+    }
+#endif
+    
+    void GMATH_CALL TransformVec4s(const Mat4& mat, const Vec4* in, Vec4* out, size_t count)
+    {
+        GMATH_PROFILE_SCOPE(GMATH_PROFILE_TRANSFORM_VEC4S, count);
+#if defined(GMATH_AVX_KERNELS)
+        if (UseAVX()) TransformVec4sAVX(mat, in, out, count);
+        else TransformVec4sSSE(mat, in, out, count, false);
+#elif defined(GMATH_USE_SSE)
+        TransformVec4sSSE(mat, in, out, count, false);
+#else
+        for (size_t i = 0; i < count; ++i) out[i] = mat * in[i];
+#endif
+    }
+    
+    void GMATH_CALL TransformVec4sAligned(const Mat4& mat, const Vec4* in, Vec4* out, size_t count)
+    {
+        GMATH_PROFILE_SCOPE(GMATH_PROFILE_TRANSFORM_VEC4S, count);
+#if defined(GMATH_AVX_KERNELS)
+        if (UseAVX()) TransformVec4sAVX(mat, in, out, count);
+        else TransformVec4sSSE(mat, in, out, count, true);
+#elif defined(GMATH_USE_SSE)
+        TransformVec4sSSE(mat, in, out, count, true);
+#else
+        for (size_t i = 0; i < count; ++i) out[i] = mat * in[i];
+#endif
+    }
+    
+    void GMATH_CALL TransformPoints(const Mat4& mat, const Vec3* in, Vec3* out, size_t count)
+    {
+        GMATH_PROFILE_SCOPE(GMATH_PROFILE_TRANSFORM_POINTS, count);
+#if defined(GMATH_AVX_KERNELS)
+        if (UseAVX()) TransformVec3sAVX(mat, in, out, count, 1.0f);
+        else TransformVec3sSSE(mat, in, out, count, 1.0f, false);
+#elif defined(GMATH_USE_SSE)
+        TransformVec3sSSE(mat, in, out, count, 1.0f, false);
+#else
+        TransformVec3sScalar(mat, in, out, count, 1.0f);
+#endif
+    }
+    
+    void GMATH_CALL TransformPointsAligned(const Mat4& mat, const Vec3* in, Vec3* out, size_t count)
+    {
+        GMATH_PROFILE_SCOPE(GMATH_PROFILE_TRANSFORM_POINTS, count);
+#if defined(GMATH_AVX_KERNELS)
+        if (UseAVX()) TransformVec3sAVX(mat, in, out, count, 1.0f);
+        else TransformVec3sSSE(mat, in, out, count, 1.0f, true);
+#elif defined(GMATH_USE_SSE)
+        TransformVec3sSSE(mat, in, out, count, 1.0f, true);
+#else
+        TransformVec3sScalar(mat, in, out, count, 1.0f);
+#endif
+    }
+    
+    void GMATH_CALL TransformDirections(const Mat4& mat, const Vec3* in, Vec3* out, size_t count)
+    {
+        GMATH_PROFILE_SCOPE(GMATH_PROFILE_TRANSFORM_DIRECTIONS, count);
+#if defined(GMATH_AVX_KERNELS)
+        if (UseAVX()) TransformVec3sAVX(mat, in, out, count, 0.0f);
+        else TransformVec3sSSE(mat, in, out, count, 0.0f, false);
+#elif defined(GMATH_USE_SSE)
+        TransformVec3sSSE(mat, in, out, count, 0.0f, false);
+#else
+        TransformVec3sScalar(mat, in, out, count, 0.0f);
+#endif
+    }
+    
+    void GMATH_CALL TransformDirectionsAligned(const Mat4& mat, const Vec3* in, Vec3* out, size_t count)
+    {
+        GMATH_PROFILE_SCOPE(GMATH_PROFILE_TRANSFORM_DIRECTIONS, count);
+#if defined(GMATH_AVX_KERNELS)
+        if (UseAVX()) TransformVec3sAVX(mat, in, out, count, 0.0f);
+        else TransformVec3sSSE(mat, in, out, count, 0.0f, true);
+#elif defined(GMATH_USE_SSE)
+        TransformVec3sSSE(mat, in, out, count, 0.0f, true);
+#else
+        TransformVec3sScalar(mat, in, out, count, 0.0f);
+#endif
+    }
+    
+    // Batch normalization.
+    
+#ifdef GMATH_USE_SSE
+    // Normalizes four vectors held one component per register, zeroing the
+    // lanes shorter than tolerance or of zero length. The squares are summed in
+    // the same order as Dot, so unless the compiler fuses them into FMAs the
+    // exact version matches Normalize bit for bit.
+    static inline void NormalizeLanesSSE(__m128* lanes, int components, float tolerance, int accuracy)
+    {
+        __m128 length_squared = _mm_add_ps(_mm_mul_ps(lanes[0], lanes[0]), _mm_mul_ps(lanes[1], lanes[1]));
+        if (components == 3) length_squared = _mm_add_ps(length_squared, _mm_mul_ps(lanes[2], lanes[2]));
+        if (components == 4) length_squared = _mm_add_ps(length_squared, _mm_add_ps(_mm_mul_ps(lanes[2], lanes[2]), _mm_mul_ps(lanes[3], lanes[3])));
+        __m128 keep = _mm_cmpgt_ps(length_squared, _mm_setzero_ps());
+        if (accuracy == GMATH_NORMALIZE_EXACT)
+        {
+            __m128 length = _mm_sqrt_ps(length_squared);
+            keep = _mm_and_ps(keep, _mm_cmpge_ps(length, _mm_set1_ps(tolerance)));
+            for (int i = 0; i < components; ++i) lanes[i] = _mm_and_ps(keep, _mm_div_ps(lanes[i], length));
+            return;
+        }
+        __m128 inv_length = _mm_rsqrt_ps(length_squared);
+        if (accuracy == GMATH_NORMALIZE_REFINED)
+        {
+            // y * (1.5 - 0.5 * x * y * y).
+            __m128 half_x_y = _mm_mul_ps(_mm_mul_ps(length_squared, _mm_set1_ps(-0.5f)), inv_length);
+            inv_length = _mm_mul_ps(inv_length, MultiplyAddSSE(half_x_y, inv_length, _mm_set1_ps(1.5f)));
+        }
+        // The estimate is inf for a denormal squared length and 0 for one that
+        // overflowed (which the refinement turns into -inf and NaN), so those
+        // lanes divide by the exact length instead, as Normalize does.
+        __m128 out_of_range = _mm_and_ps(keep, _mm_or_ps(_mm_cmplt_ps(length_squared, _mm_castsi128_ps(_mm_set1_epi32(0x00800000))), _mm_cmpeq_ps(length_squared, _mm_castsi128_ps(_mm_set1_epi32(0x7f800000)))));
+        if (_mm_movemask_ps(out_of_range))
+        {
+            __m128 length = _mm_sqrt_ps(length_squared);
+            keep = SelectSSE(out_of_range, _mm_cmpge_ps(length, _mm_set1_ps(tolerance)), _mm_and_ps(keep, _mm_cmpge_ps(length_squared, _mm_set1_ps(tolerance * tolerance))));
+            for (int i = 0; i < components; ++i) lanes[i] = _mm_and_ps(keep, SelectSSE(out_of_range, _mm_div_ps(lanes[i], length), _mm_mul_ps(lanes[i], inv_length)));
+            return;
+        }
+        keep = _mm_and_ps(keep, _mm_cmpge_ps(length_squared, _mm_set1_ps(tolerance * tolerance)));
+        for (int i = 0; i < components; ++i) lanes[i] = _mm_and_ps(keep, _mm_mul_ps(lanes[i], inv_length));
+    }
+    
+    // The kernels below take a multiple of four count. Vec4s and Quats share
+    // one, on their floats.
+    static inline void NormalizeVec2sSSE(const Vec2* in, Vec2* out, size_t count, float tolerance, int accuracy)
+    {
+        const float* src = in->data;
+        float* dst = out->data;
+        for (size_t i = 0; i < count; i += 4, src += 8, dst += 8)
+        {
+            __m128 a = _mm_loadu_ps(src);
+            __m128 b = _mm_loadu_ps(src + 4);
+            __m128 lanes[2] = {_mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)), _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1))};
+            NormalizeLanesSSE(lanes, 2, tolerance, accuracy);
+            _mm_storeu_ps(dst, _mm_unpacklo_ps(lanes[0], lanes[1]));
+            _mm_storeu_ps(dst + 4, _mm_unpackhi_ps(lanes[0], lanes[1]));
+        }
+    }
+    
+    static inline void NormalizeVec3sSSE(const Vec3* in, Vec3* out, size_t count, float tolerance, int accuracy)
+    {
+        const float* src = in->data;
+        float* dst = out->data;
+        for (size_t i = 0; i < count; i += 4, src += 12, dst += 12)
+        {
+            __m128 lanes[3], a, b, c;
+            DeinterleaveVec3SSE(_mm_loadu_ps(src), _mm_loadu_ps(src + 4), _mm_loadu_ps(src + 8), lanes[0], lanes[1], lanes[2]);
+            NormalizeLanesSSE(lanes, 3, tolerance, accuracy);
+            InterleaveVec3SSE(lanes[0], lanes[1], lanes[2], a, b, c);
+            _mm_storeu_ps(dst, a);
+            _mm_storeu_ps(dst + 4, b);
+            _mm_storeu_ps(dst + 8, c);
+        }
+    }
+    
+    static inline void NormalizeVec4sSSE(const float* in, float* out, size_t count, float tolerance, int accuracy)
+    {
+        for (size_t i = 0; i < count; i += 4, in += 16, out += 16)
+        {
+            __m128 lanes[4] = {_mm_load_ps(in), _mm_load_ps(in + 4), _mm_load_ps(in + 8), _mm_load_ps(in + 12)};
+            _MM_TRANSPOSE4_PS(lanes[0], lanes[1], lanes[2], lanes[3]);
+            NormalizeLanesSSE(lanes, 4, tolerance, accuracy);
+            _MM_TRANSPOSE4_PS(lanes[0], lanes[1], lanes[2], lanes[3]);
+            for (int j = 0; j < 4; ++j) _mm_store_ps(out + 4 * j, lanes[j]);
+        }
+    }
+#endif
+    
+#ifdef GMATH_AVX_KERNELS
+    // As NormalizeLanesSSE, for eight vectors.
+    static inline GMATH_TARGET_AVX void NormalizeLanesAVX(__m256* lanes, int components, float tolerance, int accuracy)
+    {
+        __m256 length_squared = _mm256_add_ps(_mm256_mul_ps(lanes[0], lanes[0]), _mm256_mul_ps(lanes[1], lanes[1]));
+        if (components == 3) length_squared = _mm256_add_ps(length_squared, _mm256_mul_ps(lanes[2], lanes[2]));
+        if (components == 4) length_squared = _mm256_add_ps(length_squared, _mm256_add_ps(_mm256_mul_ps(lanes[2], lanes[2]), _mm256_mul_ps(lanes[3], lanes[3])));
+        __m256 keep = _mm256_cmp_ps(length_squared, _mm256_setzero_ps(), _CMP_GT_OQ);
+        if (accuracy == GMATH_NORMALIZE_EXACT)
+        {
+            __m256 length = _mm256_sqrt_ps(length_squared);
+            keep = _mm256_and_ps(keep, _mm256_cmp_ps(length, _mm256_set1_ps(tolerance), _CMP_GE_OQ));
+            for (int i = 0; i < components; ++i) lanes[i] = _mm256_and_ps(keep, _mm256_div_ps(lanes[i], length));
+            return;
+        }
+        __m256 inv_length = _mm256_rsqrt_ps(length_squared);
+        if (accuracy == GMATH_NORMALIZE_REFINED)
+        {
+            __m256 half_x_y = _mm256_mul_ps(_mm256_mul_ps(length_squared, _mm256_set1_ps(-0.5f)), inv_length);
+            inv_length = _mm256_mul_ps(inv_length, _mm256_fmadd_ps(half_x_y, inv_length, _mm256_set1_ps(1.5f)));
+        }
+        __m256 out_of_range = _mm256_and_ps(keep, _mm256_or_ps(_mm256_cmp_ps(length_squared, _mm256_castsi256_ps(_mm256_set1_epi32(0x00800000)), _CMP_LT_OQ), _mm256_cmp_ps(length_squared, _mm256_castsi256_ps(_mm256_set1_epi32(0x7f800000)), _CMP_EQ_OQ)));
+        if (_mm256_movemask_ps(out_of_range))
+        {
+            __m256 length = _mm256_sqrt_ps(length_squared);
+            keep = _mm256_blendv_ps(_mm256_and_ps(keep, _mm256_cmp_ps(length_squared, _mm256_set1_ps(tolerance * tolerance), _CMP_GE_OQ)), _mm256_cmp_ps(length, _mm256_set1_ps(tolerance), _CMP_GE_OQ), out_of_range);
+            for (int i = 0; i < components; ++i) lanes[i] = _mm256_and_ps(keep, _mm256_blendv_ps(_mm256_mul_ps(lanes[i], inv_length), _mm256_div_ps(lanes[i], length), out_of_range));
+            return;
+        }
+        keep = _mm256_and_ps(keep, _mm256_cmp_ps(length_squared, _mm256_set1_ps(tolerance * tolerance), _CMP_GE_OQ));
+        for (int i = 0; i < components; ++i) lanes[i] = _mm256_and_ps(keep, _mm256_mul_ps(lanes[i], inv_length));
+    }
+    
+    // These handle eight at a time and leave the last four, if any, to the SSE
+    // kernels. The shuffles work within each half, so the lanes come out of
+    // order, but go back to where they were.
+    static inline GMATH_TARGET_AVX void NormalizeVec2sAVX(const Vec2* in, Vec2* out, size_t count, float tolerance, int accuracy)
+    {
+        const float* src = in->data;
+        float* dst = out->data;
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8, src += 16, dst += 16)
+        {
+            __m256 a = _mm256_loadu_ps(src);
+            __m256 b = _mm256_loadu_ps(src + 8);
+            __m256 lanes[2] = {_mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)), _mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1))};
+            NormalizeLanesAVX(lanes, 2, tolerance, accuracy);
+            _mm256_storeu_ps(dst, _mm256_unpacklo_ps(lanes[0], lanes[1]));
+            _mm256_storeu_ps(dst + 8, _mm256_unpackhi_ps(lanes[0], lanes[1]));
+        }
+        NormalizeVec2sSSE(in + i, out + i, count - i, tolerance, accuracy);
+    }
+    
+    static inline GMATH_TARGET_AVX void NormalizeVec3sAVX(const Vec3* in, Vec3* out, size_t count, float tolerance, int accuracy)
+    {
+        const float* src = in->data;
+        float* dst = out->data;
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8, src += 24, dst += 24)
+        {
+            __m256 a = CombineHalvesAVX(_mm_loadu_ps(src), _mm_loadu_ps(src + 12));
+            __m256 b = CombineHalvesAVX(_mm_loadu_ps(src + 4), _mm_loadu_ps(src + 16));
+            __m256 c = CombineHalvesAVX(_mm_loadu_ps(src + 8), _mm_loadu_ps(src + 20));
+            __m256 lanes[3];
+            DeinterleaveVec3AVX(a, b, c, lanes[0], lanes[1], lanes[2]);
+            NormalizeLanesAVX(lanes, 3, tolerance, accuracy);
+            InterleaveVec3AVX(lanes[0], lanes[1], lanes[2], a, b, c);
+            _mm_storeu_ps(dst, _mm256_castps256_ps128(a));
+            _mm_storeu_ps(dst + 4, _mm256_castps256_ps128(b));
+            _mm_storeu_ps(dst + 8, _mm256_castps256_ps128(c));
+            _mm_storeu_ps(dst + 12, _mm256_extractf128_ps(a, 1));
+            _mm_storeu_ps(dst + 16, _mm256_extractf128_ps(b, 1));
+            _mm_storeu_ps(dst + 20, _mm256_extractf128_ps(c, 1));
+        }
+        NormalizeVec3sSSE(in + i, out + i, count - i, tolerance, accuracy);
+    }
+    
+    // _MM_TRANSPOSE4_PS on each half.
+    static inline GMATH_TARGET_AVX void TransposeHalvesAVX(__m256& a, __m256& b, __m256& c, __m256& d)
+    {
+        __m256 temp_0 = _mm256_unpacklo_ps(a, b);
+        __m256 temp_1 = _mm256_unpacklo_ps(c, d);
+        __m256 temp_2 = _mm256_unpackhi_ps(a, b);
+        __m256 temp_3 = _mm256_unpackhi_ps(c, d);
+        a = _mm256_shuffle_ps(temp_0, temp_1, _MM_SHUFFLE(1, 0, 1, 0));
+        b = _mm256_shuffle_ps(temp_0, temp_1, _MM_SHUFFLE(3, 2, 3, 2));
+        c = _mm256_shuffle_ps(temp_2, temp_3, _MM_SHUFFLE(1, 0, 1, 0));
+        d = _mm256_shuffle_ps(temp_2, temp_3, _MM_SHUFFLE(3, 2, 3, 2));
+    }
+    
+    static inline GMATH_TARGET_AVX void NormalizeVec4sAVX(const float* in, float* out, size_t count, float tolerance, int accuracy)
+    {
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8, in += 32, out += 32)
+        {
+            __m256 lanes[4] = {_mm256_loadu_ps(in), _mm256_loadu_ps(in + 8), _mm256_loadu_ps(in + 16), _mm256_loadu_ps(in + 24)};
+            TransposeHalvesAVX(lanes[0], lanes[1], lanes[2], lanes[3]);
+            NormalizeLanesAVX(lanes, 4, tolerance, accuracy);
+            TransposeHalvesAVX(lanes[0], lanes[1], lanes[2], lanes[3]);
+            for (int j = 0; j < 4; ++j) _mm256_storeu_ps(out + 8 * j, lanes[j]);
+        }
+        NormalizeVec4sSSE(in, out, count - i, tolerance, accuracy);
+    }
+#endif
+    
+#ifdef GMATH_USE_NEON
+    // See NormalizeLanesSSE. vld2q/vld3q/vld4q do the AoS to SoA transposes.
+    static inline void NormalizeLanesNEON(float32x4_t* lanes, int components, float tolerance, int accuracy)
+    {
+        float32x4_t length_squared = vaddq_f32(vmulq_f32(lanes[0], lanes[0]), vmulq_f32(lanes[1], lanes[1]));
+        if (components == 3) length_squared = vaddq_f32(length_squared, vmulq_f32(lanes[2], lanes[2]));
+        if (components == 4) length_squared = vaddq_f32(length_squared, vaddq_f32(vmulq_f32(lanes[2], lanes[2]), vmulq_f32(lanes[3], lanes[3])));
+        uint32x4_t keep = vcgtq_f32(length_squared, vdupq_n_f32(0.0f));
+        if (accuracy == GMATH_NORMALIZE_EXACT)
+        {
+            float32x4_t length = vsqrtq_f32(length_squared);
+            keep = vandq_u32(keep, vcgeq_f32(length, vdupq_n_f32(tolerance)));
+            for (int i = 0; i < components; ++i) lanes[i] = vreinterpretq_f32_u32(vandq_u32(keep, vreinterpretq_u32_f32(vdivq_f32(lanes[i], length))));
+            return;
+        }
+        float32x4_t inv_length = vrsqrteq_f32(length_squared);
+        inv_length = vmulq_f32(inv_length, vrsqrtsq_f32(vmulq_f32(length_squared, inv_length), inv_length));
+        if (accuracy == GMATH_NORMALIZE_REFINED) inv_length = vmulq_f32(inv_length, vrsqrtsq_f32(vmulq_f32(length_squared, inv_length), inv_length));
+        uint32x4_t out_of_range = vandq_u32(keep, vorrq_u32(vcltq_f32(length_squared, vreinterpretq_f32_u32(vdupq_n_u32(0x00800000))), vceqq_f32(length_squared, vreinterpretq_f32_u32(vdupq_n_u32(0x7f800000)))));
+        if (vmaxvq_u32(out_of_range))
+        {
+            float32x4_t length = vsqrtq_f32(length_squared);
+            keep = vbslq_u32(out_of_range, vcgeq_f32(length, vdupq_n_f32(tolerance)), vandq_u32(keep, vcgeq_f32(length_squared, vdupq_n_f32(tolerance * tolerance))));
+            for (int i = 0; i < components; ++i) lanes[i] = vreinterpretq_f32_u32(vandq_u32(keep, vreinterpretq_u32_f32(vbslq_f32(out_of_range, vdivq_f32(lanes[i], length), vmulq_f32(lanes[i], inv_length)))));
+            return;
+        }
+        keep = vandq_u32(keep, vcgeq_f32(length_squared, vdupq_n_f32(tolerance * tolerance)));
+        for (int i = 0; i < components; ++i) lanes[i] = vreinterpretq_f32_u32(vandq_u32(keep, vreinterpretq_u32_f32(vmulq_f32(lanes[i], inv_length))));
+    }
+    
+    static inline void NormalizeVec2sNEON(const Vec2* in, Vec2* out, size_t count, float tolerance, int accuracy)
+    {
+        for (size_t i = 0; i < count; i += 4)
+        {
+            float32x4x2_t vecs = vld2q_f32(in[i].data);
+            NormalizeLanesNEON(vecs.val, 2, tolerance, accuracy);
+            vst2q_f32(out[i].data, vecs);
+        }
+    }
+    
+    static inline void NormalizeVec3sNEON(const Vec3* in, Vec3* out, size_t count, float tolerance, int accuracy)
+    {
+        for (size_t i = 0; i < count; i += 4)
+        {
+            float32x4x3_t vecs = vld3q_f32(in[i].data);
+            NormalizeLanesNEON(vecs.val, 3, tolerance, accuracy);
+            vst3q_f32(out[i].data, vecs);
+        }
+    }
+    
+    static inline void NormalizeVec4sNEON(const float* in, float* out, size_t count, float tolerance, int accuracy)
+    {
+        for (size_t i = 0; i < count; i += 4, in += 16, out += 16)
+        {
+            float32x4x4_t vecs = vld4q_f32(in);
+            NormalizeLanesNEON(vecs.val, 4, tolerance, accuracy);
+            vst4q_f32(out, vecs);
+        }
+    }
+#endif
+    
+    // The reciprocal length for the tail of a batch (all of it without SIMD),
+    // with the same estimate and refinement as the kernels. 0 if the vector is
+    // shorter than tolerance or of zero length. Denormal and overflowed squared
+    // lengths, which the estimate can't handle, use the exact length instead.
+    static inline float BatchInverseLength(float length_squared, float tolerance, int accuracy)
+    {
+        if (!(length_squared > 0.0f)) return 0.0f;
+        if (length_squared < BitsFloat(0x00800000u) || length_squared == BitsFloat(0x7f800000u))
+        {
+            float length = Sqrt(length_squared);
+            return length < tolerance ? 0.0f : 1.0f / length;
+        }
+        if (length_squared < tolerance * tolerance) return 0.0f;
+        float inv_length = RSqrt(length_squared);
+        if (accuracy == GMATH_NORMALIZE_REFINED) inv_length *= 1.5f - 0.5f * length_squared * inv_length * inv_length;
+        return inv_length;
+    }
+    
+    void GMATH_CALL NormalizeBatch(const Vec2* in, Vec2* out, size_t count, int accuracy)
+    {
+        SafeNormalizeBatch(in, out, count, 0.0f, accuracy);
+    }
+    
+    void GMATH_CALL NormalizeBatch(const Vec3* in, Vec3* out, size_t count, int accuracy)
+    {
+        SafeNormalizeBatch(in, out, count, 0.0f, accuracy);
+    }
+    
+    void GMATH_CALL NormalizeBatch(const Vec4* in, Vec4* out, size_t count, int accuracy)
+    {
+        SafeNormalizeBatch(in, out, count, 0.0f, accuracy);
+    }
+    
+    void GMATH_CALL NormalizeBatch(const Quat* in, Quat* out, size_t count, int accuracy)
+    {
+        SafeNormalizeBatch(in, out, count, 0.0f, accuracy);
+    }
+    
+    void GMATH_CALL SafeNormalizeBatch(const Vec2* in, Vec2* out, size_t count, float tolerance, int accuracy)
+    {
+        GMATH_PROFILE_SCOPE(GMATH_PROFILE_NORMALIZE_BATCH, count);
+        size_t i = 0;
+#if defined(GMATH_AVX_KERNELS)
+        i = count & ~(size_t)3;
+        if (UseAVX()) NormalizeVec2sAVX(in, out, i, tolerance, accuracy);
+        else NormalizeVec2sSSE(in, out, i, tolerance, accuracy);
+#elif defined(GMATH_USE_SSE)
+        i = count & ~(size_t)3;
+        NormalizeVec2sSSE(in, out, i, tolerance, accuracy);
+#elif defined(GMATH_USE_NEON)
+        i = count & ~(size_t)3;
+        NormalizeVec2sNEON(in, out, i, tolerance, accuracy);
+#endif
+        for (; i < count; ++i)
+        {
+            Vec2 vec = in[i];
+            float length_squared = Dot(vec, vec);
+            if (accuracy != GMATH_NORMALIZE_EXACT)
+            {
+                out[i] = vec * BatchInverseLength(length_squared, tolerance, accuracy);
+                continue;
+            }
+            float length = Sqrt(length_squared);
+            out[i] = (length_squared > 0.0f && length >= tolerance) ? vec / length : Vec2::Zero;
+        }
+    }
+    
+    void GMATH_CALL SafeNormalizeBatch(const Vec3* in, Vec3* out, size_t count, float tolerance, int accuracy)
+    {
+        GMATH_PROFILE_SCOPE(GMATH_PROFILE_NORMALIZE_BATCH, count);
+        size_t i = 0;
+#if defined(GMATH_AVX_KERNELS)
+        i = count & ~(size_t)3;
+        if (UseAVX()) NormalizeVec3sAVX(in, out, i, tolerance, accuracy);
+        else NormalizeVec3sSSE(in, out, i, tolerance, accuracy);
+#elif defined(GMATH_USE_SSE)
+        i = count & ~(size_t)3;
+        NormalizeVec3sSSE(in, out, i, tolerance, accuracy);
+#elif defined(GMATH_USE_NEON)
+        i = count & ~(size_t)3;
+        NormalizeVec3sNEON(in, out, i, tolerance, accuracy);
+#endif
+        for (; i < count; ++i)
+        {
+            Vec3 vec = in[i];
+            float length_squared = Dot(vec, vec);
+            if (accuracy != GMATH_NORMALIZE_EXACT)
+            {
+                out[i] = vec * BatchInverseLength(length_squared, tolerance, accuracy);
+                continue;
+            }
+            float length = Sqrt(length_squared);
+            out[i] = (length_squared > 0.0f && length >= tolerance) ? vec / length : Vec3::Zero;
+        }
+    }
+    
+    void GMATH_CALL SafeNormalizeBatch(const Vec4* in, Vec4* out, size_t count, float tolerance, int accuracy)
+    {
+        GMATH_PROFILE_SCOPE(GMATH_PROFILE_NORMALIZE_BATCH, count);
+        size_t i = 0;
+#if defined(GMATH_AVX_KERNELS)
+        i = count & ~(size_t)3;
+        if (UseAVX()) NormalizeVec4sAVX(in->data, out->data, i, tolerance, accuracy);
+        else NormalizeVec4sSSE(in->data, out->data, i, tolerance, accuracy);
+#elif defined(GMATH_USE_SSE)
+        i = count & ~(size_t)3;
+        NormalizeVec4sSSE(in->data, out->data, i, tolerance, accuracy);
+#elif defined(GMATH_USE_NEON)
+        i = count & ~(size_t)3;
+        NormalizeVec4sNEON(in->data, out->data, i, tolerance, accuracy);
+#endif
+        for (; i < count; ++i)
+        {
+            Vec4 vec = in[i];
+            float length_squared = Dot(vec, vec);
+            if (accuracy != GMATH_NORMALIZE_EXACT)
+            {
+                out[i] = vec * BatchInverseLength(length_squared, tolerance, accuracy);
+                continue;
+            }
+            float length = Sqrt(length_squared);
+            out[i] = (length_squared > 0.0f && length >= tolerance) ? vec / length : Vec4::Zero;
+        }
+    }
+    
+    void GMATH_CALL SafeNormalizeBatch(const Quat* in, Quat* out, size_t count, float tolerance, int accuracy)
+    {
+        GMATH_PROFILE_SCOPE(GMATH_PROFILE_NORMALIZE_BATCH, count);
+        size_t i = 0;
+#if defined(GMATH_AVX_KERNELS)
+        i = count & ~(size_t)3;
+        if (UseAVX()) NormalizeVec4sAVX(in->data, out->data, i, tolerance, accuracy);
+        else NormalizeVec4sSSE(in->data, out->data, i, tolerance, accuracy);
+#elif defined(GMATH_USE_SSE)
+        i = count & ~(size_t)3;
+        NormalizeVec4sSSE(in->data, out->data, i, tolerance, accuracy);
+#elif defined(GMATH_USE_NEON)
+        i = count & ~(size_t)3;
+        NormalizeVec4sNEON(in->data, out->data, i, tolerance, accuracy);
+#endif
+        for (; i < count; ++i)
+        {
+            Quat quat = in[i];
+            float length_squared = Dot(quat, quat);
+            if (accuracy != GMATH_NORMALIZE_EXACT)
+            {
+                out[i] = quat * BatchInverseLength(length_squared, tolerance, accuracy);
+                continue;
+            }
+            float length = Sqrt(length_squared);
+            out[i] = (length_squared > 0.0f && length >= tolerance) ? quat / length : Quat::Zero;
+        }
+    }
+#endif // GMATH_IMPLEMENTATION
+    
+    Mat4 GMATH_CALL CreateRotationMatrix(Vec3 axis, float angle)
+    {
+        Mat4 result = {};
+        axis = Normalize(axis);
+        
+        float sin, cos;
+        SinCos(Radians(angle), sin, cos);
+        float cos_value = 1.0f - cos;
+        result[0][0] = (axis.x * axis.x * cos_value) + cos;
+        result[0][1] = (axis.x * axis.y * cos_value) + (axis.z * sin);
+        result[0][2] = (axis.x * axis.z * cos_value) - (axis.y * sin);
+        
+        result[1][0] = (axis.y * axis.x * cos_value) - (axis.z * sin);;
+        result[1][1] = (axis.y * axis.y * cos_value) + cos;
+        result[1][2] = (axis.y * axis.z * cos_value) + (axis.x * sin);
+        
+        result[2][0] = (axis.z * axis.x * cos_value) + (axis.y * sin);
+        result[2][1] = (axis.z * axis.y * cos_value) - (axis.x * sin);
+        result[2][2] = (axis.z * axis.z * cos_value) + cos;
+        result[3][3] = 1.0f;
+        return result;
+    }
+    
+#ifdef GMATH_IMPLEMENTATION
+    Mat4 GMATH_CALL CreateLookAtMatrix(Vec3 location, Vec3 target, Vec3 world_up)
+    {
+        Mat4 result;
+        // View space z points towards the target when left handed, and away
+        // from it when right handed.
+#ifdef GMATH_RIGHT_HANDED
+        Vec3 forward = Normalize(location - target);
+#else
+        Vec3 forward = Normalize(target - location);
+#endif
+        Vec3 right = Normalize(Cross(world_up, forward));
+        Vec3 up = Cross(forward, right);
+        result[0] = {right.x, up.x, forward.x, 0.0f};
+        result[1] = {right.y, up.y, forward.y, 0.0f};
+        result[2] = {right.z, up.z, forward.z, 0.0f};
+        result[3] = {-Dot(right, location), -Dot(up, location), -Dot(forward, location), 1.0f};
+        return result;
+    }
+#endif // GMATH_IMPLEMENTATION
+    
+    // General inverse, using the cross product form of the cofactor expansion:
+    // the 2x2 sub-determinants are built from pairs of columns, and the adjugate
+    // is assembled from them before a single divide by the determinant.
+    Mat4 GMATH_CALL Inverse(const Mat4& mat)
+    {
+        GMATH_PROFILE_SCOPE(GMATH_PROFILE_MAT4_INVERSE, 1);
+        Mat4 result;
+#ifdef GMATH_USE_SSE
+        __m128 w_0 = _mm_shuffle_ps(mat.data_sse[0], mat.data_sse[0], 0xff);
+        __m128 w_1 = _mm_shuffle_ps(mat.data_sse[1], mat.data_sse[1], 0xff);
+        __m128 w_2 = _mm_shuffle_ps(mat.data_sse[2], mat.data_sse[2], 0xff);
+        __m128 w_3 = _mm_shuffle_ps(mat.data_sse[3], mat.data_sse[3], 0xff);
+        __m128 c01 = CrossSSE(mat.data_sse[0], mat.data_sse[1]);
+        __m128 c23 = CrossSSE(mat.data_sse[2], mat.data_sse[3]);
+        __m128 b10 = _mm_sub_ps(_mm_mul_ps(mat.data_sse[0], w_1), _mm_mul_ps(mat.data_sse[1], w_0));
+        __m128 b32 = _mm_sub_ps(_mm_mul_ps(mat.data_sse[2], w_3), _mm_mul_ps(mat.data_sse[3], w_2));
+        
+        // Every w lane above is zero, so four wide dot products are safe here.
+        __m128 det = _mm_add_ps(_mm_mul_ps(c01, b32), _mm_mul_ps(c23, b10));
+        det = _mm_add_ps(det, _mm_shuffle_ps(det, det, _MM_SHUFFLE(2, 3, 0, 1)));
+        det = _mm_add_ps(det, _mm_shuffle_ps(det, det, _MM_SHUFFLE(0, 1, 2, 3)));
+        __m128 inv_det = _mm_div_ps(_mm_set1_ps(1.0f), det);
+        c01 = _mm_mul_ps(c01, inv_det);
+        c23 = _mm_mul_ps(c23, inv_det);
+        b10 = _mm_mul_ps(b10, inv_det);
+        b32 = _mm_mul_ps(b32, inv_det);
+        
+        // Rows of the inverse, without their last element.
+        __m128 row_0 = _mm_add_ps(CrossSSE(mat.data_sse[1], b32), _mm_mul_ps(c23, w_1));
+        __m128 row_1 = _mm_sub_ps(CrossSSE(b32, mat.data_sse[0]), _mm_mul_ps(c23, w_0));
+        __m128 row_2 = _mm_add_ps(CrossSSE(mat.data_sse[3], b10), _mm_mul_ps(c01, w_3));
+        __m128 row_3 = _mm_sub_ps(CrossSSE(b10, mat.data_sse[2]), _mm_mul_ps(c01, w_2));
+        _MM_TRANSPOSE4_PS(row_0, row_1, row_2, row_3);
+        
+        // The last column is four dot products, summed with a transpose.
+        __m128 dot_0 = _mm_mul_ps(mat.data_sse[1], c23);
+        __m128 dot_1 = _mm_mul_ps(mat.data_sse[0], c23);
+        __m128 dot_2 = _mm_mul_ps(mat.data_sse[3], c01);
+        __m128 dot_3 = _mm_mul_ps(mat.data_sse[2], c01);
+        _MM_TRANSPOSE4_PS(dot_0, dot_1, dot_2, dot_3);
+        __m128 last = _mm_add_ps(_mm_add_ps(dot_0, dot_1), dot_2);
+        last = _mm_xor_ps(last, _mm_setr_ps(-0.0f, 0.0f, -0.0f, 0.0f));
+        
+        result.data_sse[0] = row_0;
+        result.data_sse[1] = row_1;
+        result.data_sse[2] = row_2;
+        result.data_sse[3] = last;
+#else
+        Vec3 c01 = Cross(mat[0].xyz, mat[1].xyz);
+        Vec3 c23 = Cross(mat[2].xyz, mat[3].xyz);
+        Vec3 b10 = mat[0].xyz * mat[1].w - mat[1].xyz * mat[0].w;
+        Vec3 b32 = mat[2].xyz * mat[3].w - mat[3].xyz * mat[2].w;
+        float inv_det = 1.0f / (Dot(c01, b32) + Dot(c23, b10));
+        c01 *= inv_det;
+        c23 *= inv_det;
+        b10 *= inv_det;
+        b32 *= inv_det;
+        
+        Vec3 row_0 = Cross(mat[1].xyz, b32) + c23 * mat[1].w;
+        Vec3 row_1 = Cross(b32, mat[0].xyz) - c23 * mat[0].w;
+        Vec3 row_2 = Cross(mat[3].xyz, b10) + c01 * mat[3].w;
+        Vec3 row_3 = Cross(b10, mat[2].xyz) - c01 * mat[2].w;
+        result[0] = {row_0.x, row_1.x, row_2.x, row_3.x};
+        result[1] = {row_0.y, row_1.y, row_2.y, row_3.y};
+        result[2] = {row_0.z, row_1.z, row_2.z, row_3.z};
+        result[3] = {-Dot(mat[1].xyz, c23), Dot(mat[0].xyz, c23), -Dot(mat[3].xyz, c01), Dot(mat[2].xyz, c01)};
+#endif
+        return result;
+    }
+    
+    // The upper 3x3 is inverted through its adjugate (the rows of which are
+    // the cross products of pairs of columns), and the translation is rotated
+    // back through it.
+    Mat4 GMATH_CALL InverseAffine(const Mat4& mat)
+    {
+        Mat4 result;
+#ifdef GMATH_USE_SSE
+        __m128 row_0 = CrossSSE(mat.data_sse[1], mat.data_sse[2]);
+        __m128 row_1 = CrossSSE(mat.data_sse[2], mat.data_sse[0]);
+        __m128 row_2 = CrossSSE(mat.data_sse[0], mat.data_sse[1]);
+        __m128 det = _mm_mul_ps(mat.data_sse[0], row_0);
+        det = _mm_add_ps(det, _mm_shuffle_ps(det, det, _MM_SHUFFLE(2, 3, 0, 1)));
+        det = _mm_add_ps(det, _mm_shuffle_ps(det, det, _MM_SHUFFLE(0, 1, 2, 3)));
+        __m128 inv_det = _mm_div_ps(_mm_set1_ps(1.0f), det);
+        row_0 = _mm_mul_ps(row_0, inv_det);
+        row_1 = _mm_mul_ps(row_1, inv_det);
+        row_2 = _mm_mul_ps(row_2, inv_det);
+        __m128 row_3 = _mm_setzero_ps();
+        _MM_TRANSPOSE4_PS(row_0, row_1, row_2, row_3);
+        
+        __m128 translation = mat.data_sse[3];
+        __m128 offset = _mm_mul_ps(row_0, _mm_shuffle_ps(translation, translation, 0x00));
+        offset = MultiplyAddSSE(row_1, _mm_shuffle_ps(translation, translation, 0x55), offset);
+        offset = MultiplyAddSSE(row_2, _mm_shuffle_ps(translation, translation, 0xaa), offset);
+        result.data_sse[0] = row_0;
+        result.data_sse[1] = row_1;
+        result.data_sse[2] = row_2;
+        result.data_sse[3] = _mm_sub_ps(_mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f), offset);
+#else
+        Vec3 row_0 = Cross(mat[1].xyz, mat[2].xyz);
+        Vec3 row_1 = Cross(mat[2].xyz, mat[0].xyz);
+        Vec3 row_2 = Cross(mat[0].xyz, mat[1].xyz);
+        float inv_det = 1.0f / Dot(mat[0].xyz, row_0);
+        row_0 *= inv_det;
+        row_1 *= inv_det;
+        row_2 *= inv_det;
+        Vec3 translation = mat[3].xyz;
+        result[0] = {row_0.x, row_1.x, row_2.x, 0.0f};
+        result[1] = {row_0.y, row_1.y, row_2.y, 0.0f};
+        result[2] = {row_0.z, row_1.z, row_2.z, 0.0f};
+        result[3] = {-Dot(row_0, translation), -Dot(row_1, translation), -Dot(row_2, translation), 1.0f};
+#endif
+        return result;
+    }
+    
+    // For a rotation the inverse of the upper 3x3 is just its transpose.
+    Mat4 GMATH_CALL InverseRigid(const Mat4& mat)
+    {
+        Mat4 result;
+#ifdef GMATH_USE_SSE
+        __m128 column_0 = mat.data_sse[0];
+        __m128 column_1 = mat.data_sse[1];
+        __m128 column_2 = mat.data_sse[2];
+        __m128 column_3 = _mm_setzero_ps();
+        _MM_TRANSPOSE4_PS(column_0, column_1, column_2, column_3);
+        
+        __m128 translation = mat.data_sse[3];
+        __m128 offset = _mm_mul_ps(column_0, _mm_shuffle_ps(translation, translation, 0x00));
+        offset = MultiplyAddSSE(column_1, _mm_shuffle_ps(translation, translation, 0x55), offset);
+        offset = MultiplyAddSSE(column_2, _mm_shuffle_ps(translation, translation, 0xaa), offset);
+        result.data_sse[0] = column_0;
+        result.data_sse[1] = column_1;
+        result.data_sse[2] = column_2;
+        result.data_sse[3] = _mm_sub_ps(_mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f), offset);
+#else
+        Vec3 translation = mat[3].xyz;
+        result[0] = {mat[0].x, mat[1].x, mat[2].x, 0.0f};
+        result[1] = {mat[0].y, mat[1].y, mat[2].y, 0.0f};
+        result[2] = {mat[0].z, mat[1].z, mat[2].z, 0.0f};
+        result[3] = {-Dot(mat[0].xyz, translation), -Dot(mat[1].xyz, translation), -Dot(mat[2].xyz, translation), 1.0f};
+#endif
+        return result;
+    }
+    
+    Mat4 GMATH_CALL CreateMat4(const Quat& rotation)
+    {
+        return ComposeTRS(Vec3::Zero, Normalize(rotation), Vec3::One);
+    }
+    
+    // Quaternion math.
+    
+    Quat GMATH_CALL CreateQuat(float x, float y, float z, float w)
+    {
+        Quat quat;
+#ifdef GMATH_USE_SSE
+        quat.data_sse = _mm_setr_ps(x, y, z, w);
+#elif defined(GMATH_USE_NEON)
+        quat.data_neon = SetNEON(x, y, z, w);
+#else
+        quat = {x, y, z, w};
+#endif
+        return quat;
+    }
+    
+    Quat GMATH_CALL CreateQuat(const Vec4& vec)
+    {
+        Quat quat;
+#ifdef GMATH_USE_SSE
+        quat.data_sse = vec.data_sse;
+#elif defined(GMATH_USE_NEON)
+        quat.data_neon = vec.data_neon;
+#else
+        quat = {vec.x, vec.y, vec.z, vec.w};
+#endif
+        return quat;
+    }
+    
+    Quat GMATH_CALL CreateQuat(float fill)
+    {
+        Quat quat;
+#ifdef GMATH_USE_SSE
+        quat.data_sse = _mm_set1_ps(fill);
+#elif defined(GMATH_USE_NEON)
+        quat.data_neon = vdupq_n_f32(fill);
+#else
+        quat = {fill, fill, fill, fill};
+#endif
+        return quat;
+    }
+    
+    Quat GMATH_CALL CreateQuat(Vec3 axis, float angle)
+    {
+        Quat result;
+        axis = Normalize(axis);
+        float sin, cos;
+        SinCos(angle / 2.0f, sin, cos);
+        result.xyz = axis * sin;
+        result.w = cos;
+        return result;
+    }
+    
+    // This method taken from Mike Day at Insomniac Games.
+    // https://d3cw3dd2w32x2b.cloudfront.net/wp-content/uploads/2015/01/matrix-to-quat.pdf
+    //
+    // Note that as mentioned at the top of the paper, the paper assumes the matrix
+    // would be *post*-multiplied to a vector to rotate it, meaning the matrix is
+    // the transpose of what we're dealing with. But, because our matrices are
+    // stored in column-major order, the indices *appear* to match the paper.
+    Quat GMATH_CALL CreateQuat(const Mat4& mat)
+    {
+        GMATH_PROFILE_SCOPE(GMATH_PROFILE_CREATE_QUAT, 1);
+        float t;
+        Quat q;
+        if (mat[2][2] < 0.0f)
+        {
+            if (mat[0][0] > mat[1][1])
+            {
+                t = 1.0f + mat[0][0] - mat[1][1] - mat[2][2];
+                q = {t, mat[0][1] + mat[1][0], mat[2][0] + mat[0][2], mat[1][2] - mat[2][1]};
+            }
+            else
+            {
+                t = 1.0f - mat[0][0] + mat[1][1] - mat[2][2];
+                q = {mat[0][1] + mat[1][0], t, mat[1][2] + mat[2][1], mat[2][0] - mat[0][2]};
+            }
+        }
+        else
+        {
+            if (mat[0][0] < -mat[1][1])
+            {
+                t = 1.0f - mat[0][0] - mat[1][1] + mat[2][2];
+                q = {mat[2][0] + mat[0][2], mat[1][2] + mat[2][1], t, mat[0][1] - mat[1][0]};
+            }
+            else
+            {
+                t = 1.0f + mat[0][0] + mat[1][1] + mat[2][2];
+                q = {mat[1][2] - mat[2][1], mat[2][0] - mat[0][2], mat[0][1] - mat[1][0], t};
+            }
+        }
+        
+        return q * (0.5f / Sqrt(t));
+    }
+    
+    float GMATH_CALL Dot(const Quat& a, const Quat& b)
+    {
+        float result;
+#ifdef GMATH_USE_SSE
+        __m128 result_one = _mm_mul_ps(a.data_sse, b.data_sse);
+        __m128 result_two = _mm_shuffle_ps(result_one, result_one, _MM_SHUFFLE(2, 3, 0, 1));
+        result_one = _mm_add_ps(result_one, result_two);
+        result_two = _mm_shuffle_ps(result_one, result_one, _MM_SHUFFLE(0, 1, 2, 3));
+        result_one = _mm_add_ps(result_one, result_two);
+        _mm_store_ss(&result, result_one);
+#elif defined(GMATH_USE_NEON)
+        result = vaddvq_f32(vmulq_f32(a.data_neon, b.data_neon));
+#else
+        result = a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+#endif
+        return result;
+    }
+    
+    Quat GMATH_CALL Normalize(const Quat& quat)
+    {
+        GMATH_PROFILE_SCOPE(GMATH_PROFILE_NORMALIZE, 1);
+        float length = Sqrt(Dot(quat, quat));
+        return (length == 0.0f) ? Quat::Zero : quat / length;
+    }
+    
+    Quat GMATH_CALL Lerp(const Quat& a, const Quat& b, float alpha)
+    {
+        Quat result;
+#ifdef GMATH_USE_SSE
+        float clamped_alpha = Clamp(alpha, 0.0f, 1.0f);
+        __m128 a_scalar = _mm_set1_ps(1.0f - clamped_alpha);
+        __m128 b_scalar = _mm_set1_ps(clamped_alpha);
+        __m128 result_one = _mm_mul_ps(a.data_sse, a_scalar);
+        result.data_sse = MultiplyAddSSE(b.data_sse, b_scalar, result_one);
+#elif defined(GMATH_USE_NEON)
+        float clamped_alpha = Clamp(alpha, 0.0f, 1.0f);
+        float32x4_t result_one = vmulq_n_f32(a.data_neon, 1.0f - clamped_alpha);
+        result.data_neon = vfmaq_n_f32(result_one, b.data_neon, clamped_alpha);
+#else
+        result.x = Lerp(a.x, b.x, alpha);
+        result.y = Lerp(a.y, b.y, alpha);
+        result.z = Lerp(a.z, b.z, alpha);
+        result.w = Lerp(a.w, b.w, alpha);
+#endif
+        return Normalize(result);
+    }
+    
+    Quat GMATH_CALL Nlerp(const Quat& a, const Quat& b, float alpha)
+    {
+        // q and -q are the same rotation, so flip b to take the shorter arc.
+        return Lerp(a, (Dot(a, b) < 0.0f) ? b * -1.0f : b, alpha);
+    }
+    
+    // Above this cosine the quaternions are nearly parallel, so sin(angle) is
+    // close to zero and Slerp falls back to Nlerp, which is just as accurate.
+#define GMATH_SLERP_NLERP_COS 0.9995f
+    
+    Quat GMATH_CALL Slerp(const Quat& a, const Quat& b, float alpha)
+    {
+        GMATH_PROFILE_SCOPE(GMATH_PROFILE_SLERP, 1);
+        float clamped_alpha = Clamp(alpha, 0.0f, 1.0f);
+        float cos_angle = Dot(a, b);
+        Quat target = b;
+        if (cos_angle < 0.0f)
+        {
+            target = b * -1.0f;
+            cos_angle = -cos_angle;
+        }
+        if (cos_angle > GMATH_SLERP_NLERP_COS)
+        {
+            return Lerp(a, target, clamped_alpha);
+        }
+        float angle = ACos(cos_angle);
+        float sin_t, cos_t;
+        SinCos(clamped_alpha * angle, sin_t, cos_t);
+        // sin((1 - t) * angle) = sin(angle) * cos(t * angle) - cos(angle) * sin(t * angle),
+        // so both weights come from a single SinCos.
+        float weight_b = sin_t / Sqrt(1.0f - cos_angle * cos_angle);
+        float weight_a = cos_t - cos_angle * weight_b;
+        return a * weight_a + target * weight_b;
+    }
+    
+    Quat GMATH_CALL Invert(const Quat& quat)
+    {
+        return CreateQuat(-quat.x, -quat.y, -quat.z, quat.w) / Dot(quat, quat);
+    }
+    
+#ifdef GMATH_USE_SSE
+    // Loads four quaternions transposed, one component per register.
+    static inline void LoadQuatsSSE(const Quat* quats, __m128& x, __m128& y, __m128& z, __m128& w)
+    {
+        x = quats[0].data_sse;
+        y = quats[1].data_sse;
+        z = quats[2].data_sse;
+        w = quats[3].data_sse;
+        _MM_TRANSPOSE4_PS(x, y, z, w);
+    }
+#endif
+    
+#ifdef GMATH_IMPLEMENTATION
+#ifdef GMATH_USE_SSE
+    // Blends quaternions four at a time in SoA form, for a multiple of four
+    // count. With spherical set this is Slerp (with Nlerp for the nearly
+    // parallel lanes), otherwise Nlerp. The work is split into three passes
+    // over chunks of up to 64, because in a single loop the ACos -> SinCos
+    // dependency chain of one block is longer than the CPU can look ahead, and
+    // neighbouring blocks never overlap.
+    static inline void BlendQuatsSSE(const Quat* a, const Quat* b, const float* t, Quat* out, size_t count, bool spherical)
+    {
+        __m128 zero = _mm_setzero_ps();
+        __m128 one = _mm_set1_ps(1.0f);
+        __m128 cosines[16], weights_a[16], weights_b[16], renormalize[16];
+        for (size_t chunk = 0; chunk < count; chunk += 64, a += 64, b += 64, t += 64, out += 64)
+        {
+            size_t blocks = ((count - chunk < 64) ? count - chunk : 64) / 4;
+            for (size_t i = 0; i < blocks; ++i)
+            {
+                __m128 ax, ay, az, aw, bx, by, bz, bw;
+                LoadQuatsSSE(a + i * 4, ax, ay, az, aw);
+                LoadQuatsSSE(b + i * 4, bx, by, bz, bw);
+                __m128 cos_angle = _mm_mul_ps(ax, bx);
+                cos_angle = MultiplyAddSSE(ay, by, cos_angle);
+                cos_angle = MultiplyAddSSE(az, bz, cos_angle);
+                cosines[i] = MultiplyAddSSE(aw, bw, cos_angle);
+            }
+            for (size_t i = 0; i < blocks; ++i)
+            {
+                __m128 alpha = _mm_max_ps(_mm_min_ps(_mm_loadu_ps(t + i * 4), one), zero);
+                // q and -q are the same rotation, so negating b's weight when
+                // the cosine is negative takes the shorter arc.
+                __m128 flip = _mm_and_ps(cosines[i], _mm_set1_ps(-0.0f));
+                __m128 cos_angle = _mm_xor_ps(cosines[i], flip);
+                __m128 weight_a = _mm_sub_ps(one, alpha);
+                __m128 weight_b = alpha;
+                __m128 nlerp = _mm_cmpeq_ps(zero, zero);
+                if (spherical)
+                {
+                    nlerp = _mm_cmpgt_ps(cos_angle, _mm_set1_ps(GMATH_SLERP_NLERP_COS));
+                    __m128 angle = ACosSSE(cos_angle);
+                    __m128 sin_angle = _mm_sqrt_ps(MultiplyAddSSE(cos_angle, _mm_sub_ps(zero, cos_angle), one));
+                    __m128 sin_t, cos_t;
+                    SinCosSSE(_mm_mul_ps(alpha, angle), sin_t, cos_t);
+                    // sin((1 - t) * angle) = sin(angle) * cos(t * angle) - cos(angle) * sin(t * angle),
+                    // so both weights come from a single SinCos.
+                    __m128 slerp_b = _mm_div_ps(sin_t, sin_angle);
+                    __m128 slerp_a = _mm_sub_ps(cos_t, _mm_mul_ps(cos_angle, slerp_b));
+                    weight_a = SelectSSE(nlerp, weight_a, slerp_a);
+                    weight_b = SelectSSE(nlerp, weight_b, slerp_b);
+                }
+                weights_a[i] = weight_a;
+                weights_b[i] = _mm_xor_ps(weight_b, flip);
+                renormalize[i] = nlerp;
+            }
+            for (size_t i = 0; i < blocks; ++i)
+            {
+                __m128 ax, ay, az, aw, bx, by, bz, bw;
+                LoadQuatsSSE(a + i * 4, ax, ay, az, aw);
+                LoadQuatsSSE(b + i * 4, bx, by, bz, bw);
+                __m128 rx = MultiplyAddSSE(bx, weights_b[i], _mm_mul_ps(ax, weights_a[i]));
+                __m128 ry = MultiplyAddSSE(by, weights_b[i], _mm_mul_ps(ay, weights_a[i]));
+                __m128 rz = MultiplyAddSSE(bz, weights_b[i], _mm_mul_ps(az, weights_a[i]));
+                __m128 rw = MultiplyAddSSE(bw, weights_b[i], _mm_mul_ps(aw, weights_a[i]));
+                // Only the Nlerp lanes need renormalizing (Slerp keeps unit length).
+                __m128 length_squared = _mm_mul_ps(rx, rx);
+                length_squared = MultiplyAddSSE(ry, ry, length_squared);
+                length_squared = MultiplyAddSSE(rz, rz, length_squared);
+                length_squared = MultiplyAddSSE(rw, rw, length_squared);
+                __m128 inv_length = _mm_and_ps(_mm_cmpgt_ps(length_squared, zero), _mm_div_ps(one, _mm_sqrt_ps(length_squared)));
+                __m128 scale = SelectSSE(renormalize[i], inv_length, one);
+                rx = _mm_mul_ps(rx, scale);
+                ry = _mm_mul_ps(ry, scale);
+                rz = _mm_mul_ps(rz, scale);
+                rw = _mm_mul_ps(rw, scale);
+                _MM_TRANSPOSE4_PS(rx, ry, rz, rw);
+                out[i * 4 + 0].data_sse = rx;
+                out[i * 4 + 1].data_sse = ry;
+                out[i * 4 + 2].data_sse = rz;
+                out[i * 4 + 3].data_sse = rw;
+            }
+        }
+    }
+#endif
+    
+#ifdef GMATH_USE_NEON
+    // See BlendQuatsSSE. vld4q/vst4q do the AoS to SoA transposes for us.
+    static inline void BlendQuatsNEON(const Quat* a, const Quat* b, const float* t, Quat* out, size_t count, bool spherical)
+    {
+        float32x4_t zero = vdupq_n_f32(0.0f);
+        float32x4_t one = vdupq_n_f32(1.0f);
+        float32x4_t cosines[16], weights_a[16], weights_b[16];
+        uint32x4_t renormalize[16];
+        for (size_t chunk = 0; chunk < count; chunk += 64, a += 64, b += 64, t += 64, out += 64)
+        {
+            size_t blocks = ((count - chunk < 64) ? count - chunk : 64) / 4;
+            for (size_t i = 0; i < blocks; ++i)
+            {
+                float32x4x4_t qa = vld4q_f32(a[i * 4].data);
+                float32x4x4_t qb = vld4q_f32(b[i * 4].data);
+                float32x4_t cos_angle = vmulq_f32(qa.val[0], qb.val[0]);
+                cos_angle = vfmaq_f32(cos_angle, qa.val[1], qb.val[1]);
+                cos_angle = vfmaq_f32(cos_angle, qa.val[2], qb.val[2]);
+                cosines[i] = vfmaq_f32(cos_angle, qa.val[3], qb.val[3]);
+            }
+            for (size_t i = 0; i < blocks; ++i)
+            {
+                float32x4_t alpha = vmaxq_f32(vminq_f32(vld1q_f32(t + i * 4), one), zero);
+                uint32x4_t flip = vandq_u32(vreinterpretq_u32_f32(cosines[i]), vdupq_n_u32(0x80000000));
+                float32x4_t cos_angle = vabsq_f32(cosines[i]);
+                float32x4_t weight_a = vsubq_f32(one, alpha);
+                float32x4_t weight_b = alpha;
+                uint32x4_t nlerp = vdupq_n_u32(0xffffffff);
+                if (spherical)
+                {
+                    nlerp = vcgtq_f32(cos_angle, vdupq_n_f32(GMATH_SLERP_NLERP_COS));
+                    float32x4_t angle = ACosNEON(cos_angle);
+                    float32x4_t sin_angle = vsqrtq_f32(vfmsq_f32(one, cos_angle, cos_angle));
+                    float32x4_t sin_t, cos_t;
+                    SinCosNEON(vmulq_f32(alpha, angle), sin_t, cos_t);
+                    float32x4_t slerp_b = vdivq_f32(sin_t, sin_angle);
+                    float32x4_t slerp_a = vfmsq_f32(cos_t, cos_angle, slerp_b);
+                    weight_a = vbslq_f32(nlerp, weight_a, slerp_a);
+                    weight_b = vbslq_f32(nlerp, weight_b, slerp_b);
+                }
+                weights_a[i] = weight_a;
+                weights_b[i] = vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(weight_b), flip));
+                renormalize[i] = nlerp;
+            }
+            for (size_t i = 0; i < blocks; ++i)
+            {
+                float32x4x4_t qa = vld4q_f32(a[i * 4].data);
+                float32x4x4_t qb = vld4q_f32(b[i * 4].data);
+                float32x4x4_t result;
+                float32x4_t length_squared = zero;
+                for (int j = 0; j < 4; ++j)
+                {
+                    result.val[j] = vfmaq_f32(vmulq_f32(qa.val[j], weights_a[i]), qb.val[j], weights_b[i]);
+                    length_squared = vfmaq_f32(length_squared, result.val[j], result.val[j]);
+                }
+                float32x4_t inv_length = vbslq_f32(vcgtq_f32(length_squared, zero),
+                                                   vdivq_f32(one, vsqrtq_f32(length_squared)), zero);
+                float32x4_t scale = vbslq_f32(renormalize[i], inv_length, one);
+                for (int j = 0; j < 4; ++j)
+                {
+                    result.val[j] = vmulq_f32(result.val[j], scale);
+                }
+                vst4q_f32(out[i * 4].data, result);
+            }
+        }
+    }
+#endif
+    
+    void GMATH_CALL SlerpBatch(const Quat* a, const Quat* b, const float* t, Quat* out, size_t count)
+    {
+        GMATH_PROFILE_SCOPE(GMATH_PROFILE_SLERP_BATCH, count);
+        size_t i = 0;
+#ifdef GMATH_USE_SSE
+        i = count & ~(size_t)3;
+        BlendQuatsSSE(a, b, t, out, i, true);
+#elif defined(GMATH_USE_NEON)
+        i = count & ~(size_t)3;
+        BlendQuatsNEON(a, b, t, out, i, true);
+#endif
+        for (; i < count; ++i)
+        {
+            out[i] = Slerp(a[i], b[i], t[i]);
+        }
+    }
+    
+    void GMATH_CALL NlerpBatch(const Quat* a, const Quat* b, const float* t, Quat* out, size_t count)
+    {
+        GMATH_PROFILE_SCOPE(GMATH_PROFILE_NLERP_BATCH, count);
+        size_t i = 0;
+#ifdef GMATH_USE_SSE
+        i = count & ~(size_t)3;
+        BlendQuatsSSE(a, b, t, out, i, false);
+#elif defined(GMATH_USE_NEON)
+        i = count & ~(size_t)3;
+        BlendQuatsNEON(a, b, t, out, i, false);
+#endif
+        for (; i < count; ++i)
+        {
+            out[i] = Nlerp(a[i], b[i], t[i]);
+        }
+    }
+#endif // GMATH_IMPLEMENTATION
+    
+    // SoA packet math. Lerp clamps alpha to [0..1] like the scalar Lerp.
+    
+    Vec3x4 GMATH_CALL CreateVec3x4(Vec3 fill)
+    {
+        Vec3x4 result;
+        result.x = CreateVec4(fill.x);
+        result.y = CreateVec4(fill.y);
+        result.z = CreateVec4(fill.z);
+        return result;
+    }
+    
+    Vec3x4 GMATH_CALL LoadVec3x4(const Vec3* in)
+    {
+        Vec3x4 result;
+#ifdef GMATH_USE_SSE
+        __m128 a = _mm_loadu_ps(in->data);
+        __m128 b = _mm_loadu_ps(in->data + 4);
+        __m128 c = _mm_loadu_ps(in->data + 8);
+        DeinterleaveVec3SSE(a, b, c, result.x.data_sse, result.y.data_sse, result.z.data_sse);
+#else
+        for (int i = 0; i < 4; ++i) result.Set(i, in[i]);
+#endif
+        return result;
+    }
+    
+    void GMATH_CALL StoreVec3x4(Vec3x4 packet, Vec3* out)
+    {
+#ifdef GMATH_USE_SSE
+        __m128 a, b, c;
+        InterleaveVec3SSE(packet.x.data_sse, packet.y.data_sse, packet.z.data_sse, a, b, c);
+        _mm_storeu_ps(out->data, a);
+        _mm_storeu_ps(out->data + 4, b);
+        _mm_storeu_ps(out->data + 8, c);
+#else
+        for (int i = 0; i < 4; ++i) out[i] = packet.Get(i);
+#endif
+    }
+    
+    Vec3x4 GMATH_CALL operator+(Vec3x4 a, Vec3x4 b)
+    {
+        Vec3x4 result;
+        for (int i = 0; i < 3; ++i)
+        {
+#ifdef GMATH_USE_SSE
+            result.data[i].data_sse = _mm_add_ps(a.data[i].data_sse, b.data[i].data_sse);
+#else
+            result.data[i] = a.data[i] + b.data[i];
+#endif
+        }
+        return result;
+    }
+    
+    Vec3x4 GMATH_CALL operator-(Vec3x4 a, Vec3x4 b)
+    {
+        Vec3x4 result;
+        for (int i = 0; i < 3; ++i)
+        {
+#ifdef GMATH_USE_SSE
+            result.data[i].data_sse = _mm_sub_ps(a.data[i].data_sse, b.data[i].data_sse);
+#else
+            result.data[i] = a.data[i] - b.data[i];
+#endif
+        }
+        return result;
+    }
+    
+    Vec3x4 GMATH_CALL operator*(Vec3x4 a, Vec3x4 b)
+    {
+        Vec3x4 result;
+        for (int i = 0; i < 3; ++i)
+        {
+#ifdef GMATH_USE_SSE
+            result.data[i].data_sse = _mm_mul_ps(a.data[i].data_sse, b.data[i].data_sse);
+#else
+            result.data[i] = a.data[i] * b.data[i];
+#endif
+        }
+        return result;
+    }
+    
+    Vec3x4 GMATH_CALL operator*(Vec3x4 a, const Vec4& b)
+    {
+        Vec3x4 result;
+        for (int i = 0; i < 3; ++i)
+        {
+#ifdef GMATH_USE_SSE
+            result.data[i].data_sse = _mm_mul_ps(a.data[i].data_sse, b.data_sse);
+#else
+            result.data[i] = a.data[i] * b;
+#endif
+        }
+        return result;
+    }
+    
+    Vec3x4 GMATH_CALL operator*(Vec3x4 a, float b)
+    {
+        return a * CreateVec4(b);
+    }
+    
+    Vec4 GMATH_CALL Dot(Vec3x4 a, Vec3x4 b)
+    {
+        Vec4 result;
+#ifdef GMATH_USE_SSE
+        result.data_sse = _mm_mul_ps(a.x.data_sse, b.x.data_sse);
+        result.data_sse = MultiplyAddSSE(a.y.data_sse, b.y.data_sse, result.data_sse);
+        result.data_sse = MultiplyAddSSE(a.z.data_sse, b.z.data_sse, result.data_sse);
+#else
+        result = a.x * b.x + a.y * b.y + a.z * b.z;
+#endif
+        return result;
+    }
+    
+    Vec3x4 GMATH_CALL Cross(Vec3x4 a, Vec3x4 b)
+    {
+        Vec3x4 result;
+#ifdef GMATH_USE_SSE
+        result.x.data_sse = _mm_sub_ps(_mm_mul_ps(a.y.data_sse, b.z.data_sse), _mm_mul_ps(a.z.data_sse, b.y.data_sse));
+        result.y.data_sse = _mm_sub_ps(_mm_mul_ps(a.z.data_sse, b.x.data_sse), _mm_mul_ps(a.x.data_sse, b.z.data_sse));
+        result.z.data_sse = _mm_sub_ps(_mm_mul_ps(a.x.data_sse, b.y.data_sse), _mm_mul_ps(a.y.data_sse, b.x.data_sse));
+#else
+        result.x = a.y * b.z - a.z * b.y;
+        result.y = a.z * b.x - a.x * b.z;
+        result.z = a.x * b.y - a.y * b.x;
+#endif
+        return result;
+    }
+    
+    Vec4 GMATH_CALL LengthSquared(Vec3x4 packet)
+    {
+        return Dot(packet, packet);
+    }
+    
+    Vec4 GMATH_CALL Length(Vec3x4 packet)
+    {
+        Vec4 result = LengthSquared(packet);
+#ifdef GMATH_USE_SSE
+        result.data_sse = _mm_sqrt_ps(result.data_sse);
+#else
+        for (int i = 0; i < 4; ++i) result[i] = Sqrt(result[i]);
+#endif
+        return result;
+    }
+    
+    Vec3x4 GMATH_CALL Normalize(Vec3x4 packet)
+    {
+        Vec4 length = Length(packet);
+#ifdef GMATH_USE_SSE
+        // Divide unconditionally, then mask out the lanes that were zero.
+        __m128 mask = _mm_cmpneq_ps(length.data_sse, _mm_setzero_ps());
+        for (int i = 0; i < 3; ++i)
+        {
+            __m128 scaled = _mm_div_ps(packet.data[i].data_sse, length.data_sse);
+            packet.data[i].data_sse = _mm_and_ps(scaled, mask);
+        }
+#else
+        for (int i = 0; i < 4; ++i)
+        {
+            packet.Set(i, (length[i] == 0.0f) ? Vec3::Zero : packet.Get(i) / length[i]);
+        }
+#endif
+        return packet;
+    }
+    
+    Vec3x4 GMATH_CALL Lerp(Vec3x4 a, Vec3x4 b, float alpha)
+    {
+        return Lerp(a, b, CreateVec4(alpha));
+    }
+    
+    Vec3x4 GMATH_CALL Lerp(Vec3x4 a, Vec3x4 b, const Vec4& alpha)
+    {
+        Vec3x4 result;
+#ifdef GMATH_USE_SSE
+        __m128 clamped_alpha = _mm_min_ps(_mm_max_ps(alpha.data_sse, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+        for (int i = 0; i < 3; ++i)
+        {
+            __m128 delta = _mm_sub_ps(b.data[i].data_sse, a.data[i].data_sse);
+            result.data[i].data_sse = MultiplyAddSSE(delta, clamped_alpha, a.data[i].data_sse);
+        }
+#else
+        for (int i = 0; i < 4; ++i)
+        {
+            result.x[i] = Lerp(a.x[i], b.x[i], alpha[i]);
+            result.y[i] = Lerp(a.y[i], b.y[i], alpha[i]);
+            result.z[i] = Lerp(a.z[i], b.z[i], alpha[i]);
+        }
+#endif
+        return result;
+    }
+    
+    static inline Vec3x4 TransformVec3x4(const Mat4& mat, Vec3x4 packet, float w)
+    {
+        Vec3x4 result;
+#ifdef GMATH_USE_SSE
+        for (int i = 0; i < 3; ++i)
+        {
+            __m128 lane = _mm_set1_ps(mat[3][i] * w);
+            lane = MultiplyAddSSE(_mm_set1_ps(mat[0][i]), packet.x.data_sse, lane);
+            lane = MultiplyAddSSE(_mm_set1_ps(mat[1][i]), packet.y.data_sse, lane);
+            lane = MultiplyAddSSE(_mm_set1_ps(mat[2][i]), packet.z.data_sse, lane);
+            result.data[i].data_sse = lane;
+        }
+#else
+        for (int i = 0; i < 3; ++i)
+        {
+            result.data[i] = mat[0][i] * packet.x + mat[1][i] * packet.y + mat[2][i] * packet.z + CreateVec4(mat[3][i] * w);
+        }
+#endif
+        return result;
+    }
+    
+    Vec3x4 GMATH_CALL TransformPoints(const Mat4& mat, Vec3x4 points)
+    {
+        return TransformVec3x4(mat, points, 1.0f);
+    }
+    
+    Vec3x4 GMATH_CALL TransformDirections(const Mat4& mat, Vec3x4 directions)
+    {
+        return TransformVec3x4(mat, directions, 0.0f);
+    }
+    
+    static inline Vec3x4 TransformVec3x4(const Mat3x4& affine, Vec3x4 packet, float w)
+    {
+        Vec3x4 result;
+        for (int i = 0; i < 3; ++i)
+        {
+            Vec4 row = affine[i];
+#ifdef GMATH_USE_SSE
+            __m128 lane = _mm_set1_ps(row.w * w);
+            lane = MultiplyAddSSE(_mm_set1_ps(row.x), packet.x.data_sse, lane);
+            lane = MultiplyAddSSE(_mm_set1_ps(row.y), packet.y.data_sse, lane);
+            lane = MultiplyAddSSE(_mm_set1_ps(row.z), packet.z.data_sse, lane);
+            result.data[i].data_sse = lane;
+#else
+            result.data[i] = row.x * packet.x + row.y * packet.y + row.z * packet.z + CreateVec4(row.w * w);
+#endif
+        }
+        return result;
+    }
+    
+    Vec3x4 GMATH_CALL TransformPoints(const Mat3x4& affine, Vec3x4 points)
+    {
+        return TransformVec3x4(affine, points, 1.0f);
+    }
+    
+    Vec3x4 GMATH_CALL TransformDirections(const Mat3x4& affine, Vec3x4 directions)
+    {
+        return TransformVec3x4(affine, directions, 0.0f);
+    }
+    
+    // Without AVX, the eight wide packets are processed as two four wide halves.
+    // Loads and stores always go through the halves, since the gather shuffles
+    // work within 128 bit lanes anyway.
+    
+#ifdef GMATH_USE_AVX
+    // With AVX, a Float8 is moved in and out of registers with unaligned loads
+    // and stores, since it's only guaranteed 16 byte alignment.
+    
+    static inline __m256 LoadFloat8AVX(const Float8& lanes)
+    {
+        return _mm256_loadu_ps(lanes.data);
+    }
+    
+    static inline void StoreFloat8AVX(Float8& lanes, __m256 value)
+    {
+        _mm256_storeu_ps(lanes.data, value);
+    }
+#endif
+    
+    static inline Vec3x4 GetVec3x8Half(const Vec3x8& packet, int half)
+    {
+        Vec3x4 result;
+        result.x = packet.x.halves[half];
+        result.y = packet.y.halves[half];
+        result.z = packet.z.halves[half];
+        return result;
+    }
+    
+    static inline void SetVec3x8Half(Vec3x8& packet, int half, Vec3x4 value)
+    {
+        packet.x.halves[half] = value.x;
+        packet.y.halves[half] = value.y;
+        packet.z.halves[half] = value.z;
+    }
+    
+    Vec3x8 GMATH_CALL CreateVec3x8(Vec3 fill)
+    {
+        Vec3x8 result;
+        Vec3x4 half = CreateVec3x4(fill);
+        SetVec3x8Half(result, 0, half);
+        SetVec3x8Half(result, 1, half);
+        return result;
+    }
+    
+    Vec3x8 GMATH_CALL LoadVec3x8(const Vec3* in)
+    {
+        Vec3x8 result;
+        SetVec3x8Half(result, 0, LoadVec3x4(in));
+        SetVec3x8Half(result, 1, LoadVec3x4(in + 4));
+        return result;
+    }
+    
+    void GMATH_CALL StoreVec3x8(Vec3x8 packet, Vec3* out)
+    {
+        StoreVec3x4(GetVec3x8Half(packet, 0), out);
+        StoreVec3x4(GetVec3x8Half(packet, 1), out + 4);
+    }
+    
+    Vec3x8 GMATH_CALL operator+(Vec3x8 a, Vec3x8 b)
+    {
+        Vec3x8 result;
+#ifdef GMATH_USE_AVX
+        for (int i = 0; i < 3; ++i) StoreFloat8AVX(result.data[i], _mm256_add_ps(LoadFloat8AVX(a.data[i]), LoadFloat8AVX(b.data[i])));
+#else
+        for (int i = 0; i < 2; ++i) SetVec3x8Half(result, i, GetVec3x8Half(a, i) + GetVec3x8Half(b, i));
+#endif
+        return result;
+    }
+    
+    Vec3x8 GMATH_CALL operator-(Vec3x8 a, Vec3x8 b)
+    {
+        Vec3x8 result;
+#ifdef GMATH_USE_AVX
+        for (int i = 0; i < 3; ++i) StoreFloat8AVX(result.data[i], _mm256_sub_ps(LoadFloat8AVX(a.data[i]), LoadFloat8AVX(b.data[i])));
+#else
+        for (int i = 0; i < 2; ++i) SetVec3x8Half(result, i, GetVec3x8Half(a, i) - GetVec3x8Half(b, i));
+#endif
+        return result;
+    }
+    
+    Vec3x8 GMATH_CALL operator*(Vec3x8 a, Vec3x8 b)
+    {
+        Vec3x8 result;
+#ifdef GMATH_USE_AVX
+        for (int i = 0; i < 3; ++i) StoreFloat8AVX(result.data[i], _mm256_mul_ps(LoadFloat8AVX(a.data[i]), LoadFloat8AVX(b.data[i])));
+#else
+        for (int i = 0; i < 2; ++i) SetVec3x8Half(result, i, GetVec3x8Half(a, i) * GetVec3x8Half(b, i));
+#endif
+        return result;
+    }
+    
+    Vec3x8 GMATH_CALL operator*(Vec3x8 a, Float8 b)
+    {
+        Vec3x8 result;
+#ifdef GMATH_USE_AVX
+        for (int i = 0; i < 3; ++i) StoreFloat8AVX(result.data[i], _mm256_mul_ps(LoadFloat8AVX(a.data[i]), LoadFloat8AVX(b)));
+#else
+        for (int i = 0; i < 2; ++i) SetVec3x8Half(result, i, GetVec3x8Half(a, i) * b.halves[i]);
+#endif
+        return result;
+    }
+    
+    Vec3x8 GMATH_CALL operator*(Vec3x8 a, float b)
+    {
+        Vec3x8 result;
+#ifdef GMATH_USE_AVX
+        __m256 scalar = _mm256_set1_ps(b);
+        for (int i = 0; i < 3; ++i) StoreFloat8AVX(result.data[i], _mm256_mul_ps(LoadFloat8AVX(a.data[i]), scalar));
+#else
+        for (int i = 0; i < 2; ++i) SetVec3x8Half(result, i, GetVec3x8Half(a, i) * b);
+#endif
+        return result;
+    }
+    
+    Float8 GMATH_CALL Dot(Vec3x8 a, Vec3x8 b)
+    {
+        Float8 result;
+#ifdef GMATH_USE_AVX
+        __m256 sum = _mm256_mul_ps(LoadFloat8AVX(a.x), LoadFloat8AVX(b.x));
+        sum = _mm256_fmadd_ps(LoadFloat8AVX(a.y), LoadFloat8AVX(b.y), sum);
+        sum = _mm256_fmadd_ps(LoadFloat8AVX(a.z), LoadFloat8AVX(b.z), sum);
+        StoreFloat8AVX(result, sum);
+#else
+        for (int i = 0; i < 2; ++i) result.halves[i] = Dot(GetVec3x8Half(a, i), GetVec3x8Half(b, i));
+#endif
+        return result;
+    }
+    
+    Vec3x8 GMATH_CALL Cross(Vec3x8 a, Vec3x8 b)
+    {
+        Vec3x8 result;
+#ifdef GMATH_USE_AVX
+        StoreFloat8AVX(result.x, _mm256_fmsub_ps(LoadFloat8AVX(a.y), LoadFloat8AVX(b.z), _mm256_mul_ps(LoadFloat8AVX(a.z), LoadFloat8AVX(b.y))));
+        StoreFloat8AVX(result.y, _mm256_fmsub_ps(LoadFloat8AVX(a.z), LoadFloat8AVX(b.x), _mm256_mul_ps(LoadFloat8AVX(a.x), LoadFloat8AVX(b.z))));
+        StoreFloat8AVX(result.z, _mm256_fmsub_ps(LoadFloat8AVX(a.x), LoadFloat8AVX(b.y), _mm256_mul_ps(LoadFloat8AVX(a.y), LoadFloat8AVX(b.x))));
+#else
+        for (int i = 0; i < 2; ++i) SetVec3x8Half(result, i, Cross(GetVec3x8Half(a, i), GetVec3x8Half(b, i)));
+#endif
+        return result;
+    }
+    
+    Float8 GMATH_CALL LengthSquared(Vec3x8 packet)
+    {
+        return Dot(packet, packet);
+    }
+    
+    Float8 GMATH_CALL Length(Vec3x8 packet)
+    {
+        Float8 result;
+#ifdef GMATH_USE_AVX
+        StoreFloat8AVX(result, _mm256_sqrt_ps(LoadFloat8AVX(LengthSquared(packet))));
+#else
+        for (int i = 0; i < 2; ++i) result.halves[i] = Length(GetVec3x8Half(packet, i));
+#endif
+        return result;
+    }
+    
+    Vec3x8 GMATH_CALL Normalize(Vec3x8 packet)
+    {
+        Vec3x8 result;
+#ifdef GMATH_USE_AVX
+        __m256 length = LoadFloat8AVX(Length(packet));
+        __m256 mask = _mm256_cmp_ps(length, _mm256_setzero_ps(), _CMP_NEQ_UQ);
+        for (int i = 0; i < 3; ++i)
+        {
+            StoreFloat8AVX(result.data[i], _mm256_and_ps(_mm256_div_ps(LoadFloat8AVX(packet.data[i]), length), mask));
+        }
+#else
+        for (int i = 0; i < 2; ++i) SetVec3x8Half(result, i, Normalize(GetVec3x8Half(packet, i)));
+#endif
+        return result;
+    }
+    
+    Vec3x8 GMATH_CALL Lerp(Vec3x8 a, Vec3x8 b, float alpha)
+    {
+        Float8 alpha_lanes;
+        alpha_lanes.halves[0] = CreateVec4(alpha);
+        alpha_lanes.halves[1] = alpha_lanes.halves[0];
+        return Lerp(a, b, alpha_lanes);
+    }
+    
+    Vec3x8 GMATH_CALL Lerp(Vec3x8 a, Vec3x8 b, Float8 alpha)
+    {
+        Vec3x8 result;
+#ifdef GMATH_USE_AVX
+        __m256 clamped_alpha = _mm256_min_ps(_mm256_max_ps(LoadFloat8AVX(alpha), _mm256_setzero_ps()), _mm256_set1_ps(1.0f));
+        for (int i = 0; i < 3; ++i)
+        {
+            __m256 delta = _mm256_sub_ps(LoadFloat8AVX(b.data[i]), LoadFloat8AVX(a.data[i]));
+            StoreFloat8AVX(result.data[i], _mm256_fmadd_ps(delta, clamped_alpha, LoadFloat8AVX(a.data[i])));
+        }
+#else
+        for (int i = 0; i < 2; ++i) SetVec3x8Half(result, i, Lerp(GetVec3x8Half(a, i), GetVec3x8Half(b, i), alpha.halves[i]));
+#endif
+        return result;
+    }
+    
+    static inline Vec3x8 TransformVec3x8(const Mat4& mat, Vec3x8 packet, float w)
+    {
+        Vec3x8 result;
+#ifdef GMATH_USE_AVX
+        for (int i = 0; i < 3; ++i)
+        {
+            __m256 lane = _mm256_set1_ps(mat[3][i] * w);
+            lane = _mm256_fmadd_ps(_mm256_set1_ps(mat[0][i]), LoadFloat8AVX(packet.x), lane);
+            lane = _mm256_fmadd_ps(_mm256_set1_ps(mat[1][i]), LoadFloat8AVX(packet.y), lane);
+            lane = _mm256_fmadd_ps(_mm256_set1_ps(mat[2][i]), LoadFloat8AVX(packet.z), lane);
+            StoreFloat8AVX(result.data[i], lane);
+        }
+#else
+        for (int i = 0; i < 2; ++i) SetVec3x8Half(result, i, TransformVec3x4(mat, GetVec3x8Half(packet, i), w));
+#endif
+        return result;
+    }
+    
+    Vec3x8 GMATH_CALL TransformPoints(const Mat4& mat, Vec3x8 points)
+    {
+        return TransformVec3x8(mat, points, 1.0f);
+    }
+    
+    Vec3x8 GMATH_CALL TransformDirections(const Mat4& mat, Vec3x8 directions)
+    {
+        return TransformVec3x8(mat, directions, 0.0f);
+    }
+    
+    // Affine transform math.
+    
+    Mat3x4 GMATH_CALL CreateMat3x4(const Mat4& mat)
+    {
+        Mat3x4 result;
+#ifdef GMATH_USE_SSE
+        __m128 row_0 = mat.data_sse[0];
+        __m128 row_1 = mat.data_sse[1];
+        __m128 row_2 = mat.data_sse[2];
+        __m128 row_3 = mat.data_sse[3];
+        _MM_TRANSPOSE4_PS(row_0, row_1, row_2, row_3);
+        result.data_sse[0] = row_0;
+        result.data_sse[1] = row_1;
+        result.data_sse[2] = row_2;
+#else
+        Mat4 rows = Transpose(mat);
+        result[0] = rows[0];
+        result[1] = rows[1];
+        result[2] = rows[2];
+#endif
+        return result;
+    }
+    
+    Mat4 GMATH_CALL CreateMat4(const Mat3x4& affine)
+    {
+        Mat4 result;
+#ifdef GMATH_USE_SSE
+        result.data_sse[0] = affine.data_sse[0];
+        result.data_sse[1] = affine.data_sse[1];
+        result.data_sse[2] = affine.data_sse[2];
+        result.data_sse[3] = _mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f);
+        _MM_TRANSPOSE4_PS(result.data_sse[0], result.data_sse[1], result.data_sse[2], result.data_sse[3]);
+#else
+        result[0] = affine[0];
+        result[1] = affine[1];
+        result[2] = affine[2];
+        result[3] = {0.0f, 0.0f, 0.0f, 1.0f};
+        result = Transpose(result);
+#endif
+        return result;
+    }
+    
+    Mat3x4 GMATH_CALL CreateMat3x4(const Quat& rotation)
+    {
+        return CreateMat3x4(rotation, Vec3::Zero);
+    }
+    
+    Mat3x4 GMATH_CALL CreateMat3x4(const Quat& rotation, Vec3 translation)
+    {
+        return ComposeTRSMat3x4(translation, Normalize(rotation), Vec3::One);
+    }
+    
+    Mat3x4 GMATH_CALL CreateTranslationMat3x4(Vec3 translation)
+    {
+        Mat3x4 result = Mat3x4::Identity;
+        result[0][3] = translation.x;
+        result[1][3] = translation.y;
+        result[2][3] = translation.z;
+        return result;
+    }
+    
+    Mat3x4 GMATH_CALL CreateRotationMat3x4(Vec3 axis, float angle)
+    {
+        return CreateMat3x4(CreateRotationMatrix(axis, angle));
+    }
+    
+    Mat3x4 GMATH_CALL CreateScalingMat3x4(Vec3 scale)
+    {
+        Mat3x4 result = {};
+        result[0][0] = scale.x;
+        result[1][1] = scale.y;
+        result[2][2] = scale.z;
+        return result;
+    }
+    
+    Quat GMATH_CALL CreateQuat(const Mat3x4& affine)
+    {
+        return CreateQuat(CreateMat4(affine));
+    }
+    
+    // Each row of the result is a combination of the rows of b, weighted by the
+    // matching row of a. The translation element of a only reaches the w lane,
+    // since the implied last row of b is (0, 0, 0, 1).
+    Mat3x4 GMATH_CALL operator*(const Mat3x4& a, const Mat3x4& b)
+    {
+        Mat3x4 result;
+#ifdef GMATH_USE_SSE
+        __m128 unit_w = _mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f);
+        for (int i = 0; i < 3; ++i)
+        {
+            __m128 row = a.data_sse[i];
+            __m128 sum = _mm_mul_ps(row, unit_w);
+            sum = MultiplyAddSSE(_mm_shuffle_ps(row, row, 0x00), b.data_sse[0], sum);
+            sum = MultiplyAddSSE(_mm_shuffle_ps(row, row, 0x55), b.data_sse[1], sum);
+            sum = MultiplyAddSSE(_mm_shuffle_ps(row, row, 0xaa), b.data_sse[2], sum);
+            result.data_sse[i] = sum;
+        }
+#elif defined(GMATH_USE_NEON)
+        float32x4_t unit_w = SetNEON(0.0f, 0.0f, 0.0f, 1.0f);
+        for (int i = 0; i < 3; ++i)
+        {
+            float32x4_t row = a.data_neon[i];
+            float32x4_t sum = vmulq_f32(row, unit_w);
+            sum = vfmaq_laneq_f32(sum, b.data_neon[0], row, 0);
+            sum = vfmaq_laneq_f32(sum, b.data_neon[1], row, 1);
+            sum = vfmaq_laneq_f32(sum, b.data_neon[2], row, 2);
+            result.data_neon[i] = sum;
+        }
+#else
+        for (int i = 0; i < 3; ++i)
+        {
+            for (int j = 0; j < 4; ++j)
+            {
+                result[i][j] = a[i][0] * b[0][j] + a[i][1] * b[1][j] + a[i][2] * b[2][j];
+            }
+            result[i][3] += a[i][3];
+        }
+#endif
+        return result;
+    }
+    
+#ifdef GMATH_USE_SSE
+    static inline Vec3A TransformAffineSSE(const Mat3x4& affine, __m128 in)
+    {
+        // Multiply every row by the vector, then sum each row with a transpose.
+        __m128 row_0 = _mm_mul_ps(affine.data_sse[0], in);
+        __m128 row_1 = _mm_mul_ps(affine.data_sse[1], in);
+        __m128 row_2 = _mm_mul_ps(affine.data_sse[2], in);
+        __m128 row_3 = _mm_setzero_ps();
+        _MM_TRANSPOSE4_PS(row_0, row_1, row_2, row_3);
+        Vec3A result;
+        result.data_sse = _mm_add_ps(_mm_add_ps(row_0, row_1), _mm_add_ps(row_2, row_3));
+        return result;
+    }
+#endif
+    
+#ifdef GMATH_USE_NEON
+    static inline Vec3A TransformAffineNEON(const Mat3x4& affine, float32x4_t in)
+    {
+        // Two rounds of pairwise adds sum each row into its own lane.
+        float32x4_t rows_01 = vpaddq_f32(vmulq_f32(affine.data_neon[0], in), vmulq_f32(affine.data_neon[1], in));
+        float32x4_t rows_2 = vpaddq_f32(vmulq_f32(affine.data_neon[2], in), vdupq_n_f32(0.0f));
+        Vec3A result;
+        result.data_neon = vpaddq_f32(rows_01, rows_2);
+        return result;
+    }
+#endif
+    
+    static inline Vec3 TransformAffine(const Mat3x4& affine, Vec3 vec, float w)
+    {
+#ifdef GMATH_USE_SSE
+        return TransformAffineSSE(affine, _mm_setr_ps(vec.x, vec.y, vec.z, w)).xyz;
+#elif defined(GMATH_USE_NEON)
+        return TransformAffineNEON(affine, SetNEON(vec.x, vec.y, vec.z, w)).xyz;
+#else
+        Vec3 result;
+        for (int i = 0; i < 3; ++i)
+        {
+            result[i] = affine[i][0] * vec.x + affine[i][1] * vec.y + affine[i][2] * vec.z + affine[i][3] * w;
+        }
+        return result;
+#endif
+    }
+    
+    Vec3 GMATH_CALL TransformPoint(const Mat3x4& affine, Vec3 point)
+    {
+        return TransformAffine(affine, point, 1.0f);
+    }
+    
+    Vec3 GMATH_CALL TransformDirection(const Mat3x4& affine, Vec3 direction)
+    {
+        return TransformAffine(affine, direction, 0.0f);
+    }
+    
+    Vec3A GMATH_CALL TransformPoint(const Mat4& mat, const Vec3A& point)
+    {
+        Vec3A result;
+#ifdef GMATH_USE_SSE
+        __m128 in = point.data_sse;
+        __m128 sum = MultiplyAddSSE(_mm_shuffle_ps(in, in, 0x00), mat.data_sse[0], mat.data_sse[3]);
+        sum = MultiplyAddSSE(_mm_shuffle_ps(in, in, 0x55), mat.data_sse[1], sum);
+        result.data_sse = MultiplyAddSSE(_mm_shuffle_ps(in, in, 0xaa), mat.data_sse[2], sum);
+#elif defined(GMATH_USE_NEON)
+        float32x4_t sum = vfmaq_laneq_f32(mat.data_neon[3], mat.data_neon[0], point.data_neon, 0);
+        sum = vfmaq_laneq_f32(sum, mat.data_neon[1], point.data_neon, 1);
+        result.data_neon = vfmaq_laneq_f32(sum, mat.data_neon[2], point.data_neon, 2);
+#else
+        Vec4 sum = mat * CreateVec4(point, 1.0f);
+        result = CreateVec3A(sum.xyz);
+#endif
+        return result;
+    }
+    
+    Vec3A GMATH_CALL TransformDirection(const Mat4& mat, const Vec3A& direction)
+    {
+        Vec3A result;
+#ifdef GMATH_USE_SSE
+        __m128 in = direction.data_sse;
+        __m128 sum = _mm_mul_ps(_mm_shuffle_ps(in, in, 0x00), mat.data_sse[0]);
+        sum = MultiplyAddSSE(_mm_shuffle_ps(in, in, 0x55), mat.data_sse[1], sum);
+        result.data_sse = MultiplyAddSSE(_mm_shuffle_ps(in, in, 0xaa), mat.data_sse[2], sum);
+#elif defined(GMATH_USE_NEON)
+        float32x4_t sum = vmulq_laneq_f32(mat.data_neon[0], direction.data_neon, 0);
+        sum = vfmaq_laneq_f32(sum, mat.data_neon[1], direction.data_neon, 1);
+        result.data_neon = vfmaq_laneq_f32(sum, mat.data_neon[2], direction.data_neon, 2);
+#else
+        Vec4 sum = mat * CreateVec4(direction, 0.0f);
+        result = CreateVec3A(sum.xyz);
+#endif
+        return result;
+    }
+    
+    Vec3A GMATH_CALL TransformPoint(const Mat3x4& affine, const Vec3A& point)
+    {
+#ifdef GMATH_USE_SSE
+        return TransformAffineSSE(affine, CreateVec4(point, 1.0f).data_sse);
+#elif defined(GMATH_USE_NEON)
+        return TransformAffineNEON(affine, CreateVec4(point, 1.0f).data_neon);
+#else
+        return CreateVec3A(TransformPoint(affine, point.xyz));
+#endif
+    }
+    
+    Vec3A GMATH_CALL TransformDirection(const Mat3x4& affine, const Vec3A& direction)
+    {
+#ifdef GMATH_USE_SSE
+        return TransformAffineSSE(affine, CreateVec4(direction, 0.0f).data_sse);
+#elif defined(GMATH_USE_NEON)
+        return TransformAffineNEON(affine, CreateVec4(direction, 0.0f).data_neon);
+#else
+        return CreateVec3A(TransformDirection(affine, direction.xyz));
+#endif
+    }
+    
+    // Frustum culling.
+    
+#ifdef GMATH_IMPLEMENTATION
+    // Gribb and Hartmann: each plane is the sum or difference of the fourth row
+    // of the matrix and one of the others, taken from the clip space
+    // inequalities -w <= x <= w, -w <= y <= w and -w (or 0) <= z <= w.
+    // Column i of the matrix holds component i of every row, so the planes are
+    // built four at a time, one Vec4 per component, and normalized together
+    // before being transposed back. The second set holds the near and far
+    // planes and two unused lanes. An infinite far plane comes out as
+    // (0, 0, 0, d), with d > 0, and is replaced by one every point is in front
+    // of.
+    Frustum GMATH_CALL CreateFrustum(const Mat4& view_projection)
+    {
+        Mat4 components[2];
+        for (int i = 0; i < 4; ++i)
+        {
+            Vec4 column = view_projection[i];
+#ifdef GMATH_DEPTH_ZERO_TO_ONE
+            float near = column.z;
+#else
+            float near = column.w + column.z;
+#endif
+            components[0][i] = CreateVec4(column.w + column.x, column.w - column.x, column.w + column.y, column.w - column.y);
+            components[1][i] = CreateVec4(near, column.w - column.z, 1.0f, 1.0f);
+        }
+        Frustum frustum;
+        for (int i = 0; i < 2; ++i)
+        {
+            Mat4& set = components[i];
+            Vec4 length_squared = set[0] * set[0] + set[1] * set[1] + set[2] * set[2];
+            Vec4 scale;
+#ifdef GMATH_USE_SSE
+            scale.data_sse = _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(length_squared.data_sse));
+#elif defined(GMATH_USE_NEON)
+            scale.data_neon = vdivq_f32(vdupq_n_f32(1.0f), vsqrtq_f32(length_squared.data_neon));
+#else
+            for (int j = 0; j < 4; ++j) scale[j] = 1.0f / Sqrt(length_squared[j]);
+#endif
+            for (int j = 0; j < 4; ++j) set[j] = set[j] * scale;
+            Mat4 planes = Transpose(set);
+            for (int j = 0; j < (i == 0 ? 4 : 2); ++j)
+            {
+                frustum.planes[i * 4 + j] = (length_squared[j] > 0.0f) ? planes[j] : CreateVec4(0.0f, 0.0f, 0.0f, 1.0f);
+            }
+        }
+        return frustum;
+    }
+#endif // GMATH_IMPLEMENTATION
+    
+    bool GMATH_CALL IsVisible(const Frustum& frustum, const Sphere& sphere)
+    {
+        for (int i = 0; i < 6; ++i)
+        {
+            const Vec4& plane = frustum.planes[i];
+            if (Dot(plane.xyz, sphere.center) + plane.w < -sphere.radius) return false;
+        }
+        return true;
+    }
+    
+    // A box is outside a plane when its center is further behind it than the
+    // box reaches along the normal.
+    bool GMATH_CALL IsVisible(const Frustum& frustum, const AABB& box)
+    {
+        Vec3 center = (box.max + box.min) * 0.5f;
+        Vec3 extent = (box.max - box.min) * 0.5f;
+        for (int i = 0; i < 6; ++i)
+        {
+            const Vec4& plane = frustum.planes[i];
+            Vec3 reach = {Abs(plane.x) * extent.x, Abs(plane.y) * extent.y, Abs(plane.z) * extent.z};
+            if (Dot(plane.xyz, center) + plane.w < -(reach.x + reach.y + reach.z)) return false;
+        }
+        return true;
+    }
+    
+    // The kernels below fill whole words of the visibility mask, 32 bounds at a
+    // time. Each plane component (and its absolute value, for the boxes) is
+    // broadcast to its own register up front.
+    
+#ifdef GMATH_USE_SSE
+    static inline void BroadcastPlanesSSE(const Frustum& frustum, __m128 planes[6][4], __m128 abs_normals[6][3])
+    {
+        for (int i = 0; i < 6; ++i)
+        {
+            for (int j = 0; j < 4; ++j) planes[i][j] = _mm_set1_ps(frustum.planes[i][j]);
+            for (int j = 0; j < 3; ++j) abs_normals[i][j] = _mm_set1_ps(Abs(frustum.planes[i][j]));
+        }
+    }
+    
+    // All ones in the lanes whose sphere (or box, with reach as the extent
+    // along each normal) isn't entirely behind any plane.
+    static inline __m128 InsideFrustumSSE(__m128 planes[6][4], __m128 x, __m128 y, __m128 z, __m128 radius)
+    {
+        __m128 inside = _mm_cmpeq_ps(x, x);
+        for (int i = 0; i < 6; ++i)
+        {
+            __m128 distance = MultiplyAddSSE(planes[i][0], x, planes[i][3]);
+            distance = MultiplyAddSSE(planes[i][1], y, distance);
+            distance = MultiplyAddSSE(planes[i][2], z, distance);
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(distance, radius), _mm_setzero_ps()));
+        }
+        return inside;
+    }
+    
+    static inline __m128 InsideFrustumSSE(__m128 planes[6][4], __m128 abs_normals[6][3], __m128 center[3], __m128 extent[3])
+    {
+        __m128 inside = _mm_cmpeq_ps(center[0], center[0]);
+        for (int i = 0; i < 6; ++i)
+        {
+            __m128 distance = MultiplyAddSSE(planes[i][0], center[0], planes[i][3]);
+            distance = MultiplyAddSSE(planes[i][1], center[1], distance);
+            distance = MultiplyAddSSE(planes[i][2], center[2], distance);
+            distance = MultiplyAddSSE(abs_normals[i][0], extent[0], distance);
+            distance = MultiplyAddSSE(abs_normals[i][1], extent[1], distance);
+            distance = MultiplyAddSSE(abs_normals[i][2], extent[2], distance);
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, _mm_setzero_ps()));
+        }
+        return inside;
+    }
+    
+    // Loads four pairs of packed Vec3s (the min and max of a box, or the origin
+    // and direction of a ray) as SoA. Each deinterleave gives the first and
+    // second of two pairs in alternate lanes.
+    static inline void LoadVec3PairsSSE(const float* in, __m128 first[3], __m128 second[3])
+    {
+        __m128 low[3], high[3];
+        DeinterleaveVec3SSE(_mm_loadu_ps(in), _mm_loadu_ps(in + 4), _mm_loadu_ps(in + 8), low[0], low[1], low[2]);
+        DeinterleaveVec3SSE(_mm_loadu_ps(in + 12), _mm_loadu_ps(in + 16), _mm_loadu_ps(in + 20), high[0], high[1], high[2]);
+        for (int i = 0; i < 3; ++i)
+        {
+            first[i] = _mm_shuffle_ps(low[i], high[i], _MM_SHUFFLE(2, 0, 2, 0));
+            second[i] = _mm_shuffle_ps(low[i], high[i], _MM_SHUFFLE(3, 1, 3, 1));
+        }
+    }
+    
+    static inline void LoadAABBsSSE(const AABB* boxes, __m128 center[3], __m128 extent[3])
+    {
+        __m128 min[3], max[3];
+        LoadVec3PairsSSE(boxes->min.data, min, max);
+        __m128 half = _mm_set1_ps(0.5f);
+        for (int i = 0; i < 3; ++i)
+        {
+            center[i] = _mm_mul_ps(_mm_add_ps(max[i], min[i]), half);
+            extent[i] = _mm_mul_ps(_mm_sub_ps(max[i], min[i]), half);
+        }
+    }
+    
+    // Loads or stores a single pair of packed Vec3s with two overlapping
+    // accesses, so neither reaches past the pair. The w lanes of first and
+    // second hold copies of other components when loaded, and are ignored
+    // when stored.
+    static inline void LoadVec3PairSSE(const float* in, __m128& first, __m128& second)
+    {
+        first = _mm_loadu_ps(in);
+        second = _mm_loadu_ps(in + 2);
+        second = _mm_shuffle_ps(second, second, _MM_SHUFFLE(3, 3, 2, 1));
+    }
+    
+    static inline void StoreVec3PairSSE(__m128 first, __m128 second, float* out)
+    {
+        __m128 z_x = _mm_shuffle_ps(first, second, _MM_SHUFFLE(0, 0, 2, 2));
+        _mm_storeu_ps(out, first);
+        _mm_storeu_ps(out + 2, _mm_shuffle_ps(z_x, second, _MM_SHUFFLE(2, 1, 2, 0)));
+    }
+#endif
+    
+#ifdef GMATH_IMPLEMENTATION
+#ifdef GMATH_USE_SSE
+    static inline void CullSpheresSSE(const Frustum& frustum, const Sphere* spheres, size_t words, uint32_t* visible)
+    {
+        __m128 planes[6][4], abs_normals[6][3];
+        BroadcastPlanesSSE(frustum, planes, abs_normals);
+        for (size_t word = 0; word < words; ++word)
+        {
+            uint32_t mask = 0;
+            for (int i = 0; i < 32; i += 4, spheres += 4)
+            {
+                __m128 x = _mm_loadu_ps(spheres[0].center.data);
+                __m128 y = _mm_loadu_ps(spheres[1].center.data);
+                __m128 z = _mm_loadu_ps(spheres[2].center.data);
+                __m128 radius = _mm_loadu_ps(spheres[3].center.data);
+                _MM_TRANSPOSE4_PS(x, y, z, radius);
+                mask |= (uint32_t)_mm_movemask_ps(InsideFrustumSSE(planes, x, y, z, radius)) << i;
+            }
+            visible[word] = mask;
+        }
+    }
+    
+    static inline void CullAABBsSSE(const Frustum& frustum, const AABB* boxes, size_t words, uint32_t* visible)
+    {
+        __m128 planes[6][4], abs_normals[6][3];
+        BroadcastPlanesSSE(frustum, planes, abs_normals);
+        for (size_t word = 0; word < words; ++word)
+        {
+            uint32_t mask = 0;
+            for (int i = 0; i < 32; i += 4, boxes += 4)
+            {
+                __m128 center[3], extent[3];
+                LoadAABBsSSE(boxes, center, extent);
+                mask |= (uint32_t)_mm_movemask_ps(InsideFrustumSSE(planes, abs_normals, center, extent)) << i;
+            }
+            visible[word] = mask;
+        }
+    }
+#endif
+    
+#ifdef GMATH_AVX_KERNELS
+    // Eight bounds at a time. The low half of each register holds bounds zero
+    // to three and the high half four to seven, so the in-lane SSE shuffles
+    // still apply, and the movemask comes out in order.
+    static inline GMATH_TARGET_AVX void BroadcastPlanesAVX(const Frustum& frustum, __m256 planes[6][4], __m256 abs_normals[6][3])
+    {
+        for (int i = 0; i < 6; ++i)
+        {
+            for (int j = 0; j < 4; ++j) planes[i][j] = _mm256_set1_ps(frustum.planes[i][j]);
+            for (int j = 0; j < 3; ++j) abs_normals[i][j] = _mm256_set1_ps(Abs(frustum.planes[i][j]));
+        }
+    }
+    
+    static inline GMATH_TARGET_AVX void CullSpheresAVX(const Frustum& frustum, const Sphere* spheres, size_t words, uint32_t* visible)
+    {
+        __m256 planes[6][4], abs_normals[6][3];
+        BroadcastPlanesAVX(frustum, planes, abs_normals);
+        __m256 zero = _mm256_setzero_ps();
+        for (size_t word = 0; word < words; ++word)
+        {
+            uint32_t mask = 0;
+            for (int i = 0; i < 32; i += 8, spheres += 8)
+            {
+                __m256 row_0 = CombineHalvesAVX(_mm_loadu_ps(spheres[0].center.data), _mm_loadu_ps(spheres[4].center.data));
+                __m256 row_1 = CombineHalvesAVX(_mm_loadu_ps(spheres[1].center.data), _mm_loadu_ps(spheres[5].center.data));
+                __m256 row_2 = CombineHalvesAVX(_mm_loadu_ps(spheres[2].center.data), _mm_loadu_ps(spheres[6].center.data));
+                __m256 row_3 = CombineHalvesAVX(_mm_loadu_ps(spheres[3].center.data), _mm_loadu_ps(spheres[7].center.data));
+                __m256 xy_01 = _mm256_unpacklo_ps(row_0, row_1);
+                __m256 xy_23 = _mm256_unpacklo_ps(row_2, row_3);
+                __m256 zr_01 = _mm256_unpackhi_ps(row_0, row_1);
+                __m256 zr_23 = _mm256_unpackhi_ps(row_2, row_3);
+                __m256 x = _mm256_shuffle_ps(xy_01, xy_23, _MM_SHUFFLE(1, 0, 1, 0));
+                __m256 y = _mm256_shuffle_ps(xy_01, xy_23, _MM_SHUFFLE(3, 2, 3, 2));
+                __m256 z = _mm256_shuffle_ps(zr_01, zr_23, _MM_SHUFFLE(1, 0, 1, 0));
+                __m256 radius = _mm256_shuffle_ps(zr_01, zr_23, _MM_SHUFFLE(3, 2, 3, 2));
+                __m256 inside = _mm256_cmp_ps(x, x, _CMP_EQ_OQ);
+                for (int j = 0; j < 6; ++j)
+                {
+                    __m256 distance = _mm256_fmadd_ps(planes[j][0], x, planes[j][3]);
+                    distance = _mm256_fmadd_ps(planes[j][1], y, distance);
+                    distance = _mm256_fmadd_ps(planes[j][2], z, distance);
+                    inside = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_add_ps(distance, radius), zero, _CMP_GE_OQ));
+                }
+                mask |= (uint32_t)_mm256_movemask_ps(inside) << i;
+            }
+            visible[word] = mask;
+        }
+    }
+    
+    static inline GMATH_TARGET_AVX void CullAABBsAVX(const Frustum& frustum, const AABB* boxes, size_t words, uint32_t* visible)
+    {
+        __m256 planes[6][4], abs_normals[6][3];
+        BroadcastPlanesAVX(frustum, planes, abs_normals);
+        __m256 zero = _mm256_setzero_ps();
+        for (size_t word = 0; word < words; ++word)
+        {
+            uint32_t mask = 0;
+            for (int i = 0; i < 32; i += 8, boxes += 8)
+            {
+                __m128 low_center[3], low_extent[3], high_center[3], high_extent[3];
+                LoadAABBsSSE(boxes, low_center, low_extent);
+                LoadAABBsSSE(boxes + 4, high_center, high_extent);
+                __m256 center[3], extent[3];
+                for (int j = 0; j < 3; ++j)
+                {
+                    center[j] = CombineHalvesAVX(low_center[j], high_center[j]);
+                    extent[j] = CombineHalvesAVX(low_extent[j], high_extent[j]);
+                }
+                __m256 inside = _mm256_cmp_ps(center[0], center[0], _CMP_EQ_OQ);
+                for (int j = 0; j < 6; ++j)
+                {
+                    __m256 distance = _mm256_fmadd_ps(planes[j][0], center[0], planes[j][3]);
+                    distance = _mm256_fmadd_ps(planes[j][1], center[1], distance);
+                    distance = _mm256_fmadd_ps(planes[j][2], center[2], distance);
+                    distance = _mm256_fmadd_ps(abs_normals[j][0], extent[0], distance);
+                    distance = _mm256_fmadd_ps(abs_normals[j][1], extent[1], distance);
+                    distance = _mm256_fmadd_ps(abs_normals[j][2], extent[2], distance);
+                    inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, zero, _CMP_GE_OQ));
+                }
+                mask |= (uint32_t)_mm256_movemask_ps(inside) << i;
+            }
+            visible[word] = mask;
+        }
+    }
+#endif
+#endif // GMATH_IMPLEMENTATION
+    
+#ifdef GMATH_USE_NEON
+    static inline void BroadcastPlanesNEON(const Frustum& frustum, float32x4_t planes[6][4], float32x4_t abs_normals[6][3])
+    {
+        for (int i = 0; i < 6; ++i)
+        {
+            for (int j = 0; j < 4; ++j) planes[i][j] = vdupq_n_f32(frustum.planes[i][j]);
+            for (int j = 0; j < 3; ++j) abs_normals[i][j] = vdupq_n_f32(Abs(frustum.planes[i][j]));
+        }
+    }
+    
+    // NEON has no movemask, so weight each lane's bit and add them up.
+    static inline uint32_t MoveMaskNEON(uint32x4_t mask)
+    {
+        uint32_t bits[4] = {1, 2, 4, 8};
+        return vaddvq_u32(vandq_u32(mask, vld1q_u32(bits)));
+    }
+    
+    // As LoadVec3PairsSSE. Two de-interleaving loads give the first and second
+    // of two pairs each in alternate lanes, which the unzips separate.
+    static inline void LoadVec3PairsNEON(const float* in, float32x4_t first[3], float32x4_t second[3])
+    {
+        float32x4x3_t low = vld3q_f32(in);
+        float32x4x3_t high = vld3q_f32(in + 12);
+        for (int i = 0; i < 3; ++i)
+        {
+            first[i] = vuzp1q_f32(low.val[i], high.val[i]);
+            second[i] = vuzp2q_f32(low.val[i], high.val[i]);
+        }
+    }
+#endif
+    
+#ifdef GMATH_IMPLEMENTATION
+#ifdef GMATH_USE_NEON
+    static inline void CullSpheresNEON(const Frustum& frustum, const Sphere* spheres, size_t words, uint32_t* visible)
+    {
+        float32x4_t planes[6][4], abs_normals[6][3];
+        BroadcastPlanesNEON(frustum, planes, abs_normals);
+        float32x4_t zero = vdupq_n_f32(0.0f);
+        for (size_t word = 0; word < words; ++word)
+        {
+            uint32_t mask = 0;
+            for (int i = 0; i < 32; i += 4, spheres += 4)
+            {
+                // x, y, z, radius.
+                float32x4x4_t bounds = vld4q_f32(spheres->center.data);
+                uint32x4_t inside = vdupq_n_u32(0xffffffff);
+                for (int j = 0; j < 6; ++j)
+                {
+                    float32x4_t distance = vfmaq_f32(planes[j][3], planes[j][0], bounds.val[0]);
+                    distance = vfmaq_f32(distance, planes[j][1], bounds.val[1]);
+                    distance = vfmaq_f32(distance, planes[j][2], bounds.val[2]);
+                    inside = vandq_u32(inside, vcgeq_f32(vaddq_f32(distance, bounds.val[3]), zero));
+                }
+                mask |= MoveMaskNEON(inside) << i;
+            }
+            visible[word] = mask;
+        }
+    }
+    
+    static inline void CullAABBsNEON(const Frustum& frustum, const AABB* boxes, size_t words, uint32_t* visible)
+    {
+        float32x4_t planes[6][4], abs_normals[6][3];
+        BroadcastPlanesNEON(frustum, planes, abs_normals);
+        float32x4_t zero = vdupq_n_f32(0.0f);
+        float32x4_t half = vdupq_n_f32(0.5f);
+        for (size_t word = 0; word < words; ++word)
+        {
+            uint32_t mask = 0;
+            for (int i = 0; i < 32; i += 4, boxes += 4)
+            {
+                float32x4_t min[3], max[3], center[3], extent[3];
+                LoadVec3PairsNEON(boxes->min.data, min, max);
+                for (int j = 0; j < 3; ++j)
+                {
+                    center[j] = vmulq_f32(vaddq_f32(max[j], min[j]), half);
+                    extent[j] = vmulq_f32(vsubq_f32(max[j], min[j]), half);
+                }
+                uint32x4_t inside = vdupq_n_u32(0xffffffff);
+                for (int j = 0; j < 6; ++j)
+                {
+                    float32x4_t distance = vfmaq_f32(planes[j][3], planes[j][0], center[0]);
+                    distance = vfmaq_f32(distance, planes[j][1], center[1]);
+                    distance = vfmaq_f32(distance, planes[j][2], center[2]);
+                    distance = vfmaq_f32(distance, abs_normals[j][0], extent[0]);
+                    distance = vfmaq_f32(distance, abs_normals[j][1], extent[1]);
+                    distance = vfmaq_f32(distance, abs_normals[j][2], extent[2]);
+                    inside = vandq_u32(inside, vcgeq_f32(distance, zero));
+                }
+                mask |= MoveMaskNEON(inside) << i;
+            }
+            visible[word] = mask;
+        }
+    }
+#endif
+    
+    void GMATH_CALL CullSpheres(const Frustum& frustum, const Sphere* spheres, size_t count, uint32_t* visible)
+    {
+        GMATH_PROFILE_SCOPE(GMATH_PROFILE_CULL_SPHERES, count);
+        size_t words = count / 32;
+#if defined(GMATH_AVX_KERNELS)
+        if (UseAVX()) CullSpheresAVX(frustum, spheres, words, visible);
+        else CullSpheresSSE(frustum, spheres, words, visible);
+#elif defined(GMATH_USE_SSE)
+        CullSpheresSSE(frustum, spheres, words, visible);
+#elif defined(GMATH_USE_NEON)
+        CullSpheresNEON(frustum, spheres, words, visible);
+#else
+        words = 0;
+#endif
+        for (size_t i = words * 32; i < count; ++i)
+        {
+            if (i % 32 == 0) visible[i / 32] = 0;
+            if (IsVisible(frustum, spheres[i])) visible[i / 32] |= 1u << (i % 32);
+        }
+    }
+    
+    void GMATH_CALL CullAABBs(const Frustum& frustum, const AABB* boxes, size_t count, uint32_t* visible)
+    {
+        GMATH_PROFILE_SCOPE(GMATH_PROFILE_CULL_AABBS, count);
+        size_t words = count / 32;
+#if defined(GMATH_AVX_KERNELS)
+        if (UseAVX()) CullAABBsAVX(frustum, boxes, words, visible);
+        else CullAABBsSSE(frustum, boxes, words, visible);
+#elif defined(GMATH_USE_SSE)
+        CullAABBsSSE(frustum, boxes, words, visible);
+#elif defined(GMATH_USE_NEON)
+        CullAABBsNEON(frustum, boxes, words, visible);
+#else
+        words = 0;
+#endif
+        for (size_t i = words * 32; i < count; ++i)
+        {
+            if (i % 32 == 0) visible[i / 32] = 0;
+            if (IsVisible(frustum, boxes[i])) visible[i / 32] |= 1u << (i % 32);
+        }
+    }
+    
+    // Cameras.
+    
+#define GMATH_CAMERA_VIEW_DIRTY 0x1
+#define GMATH_CAMERA_FOV_DIRTY 0x2
+#define GMATH_CAMERA_PROJECTION_DIRTY 0x4
+    
+    // Projections from PerspectiveMatrix only scale x and y and mix z and w,
+    // so the inverse has a closed form: x / m00, y / m11, z = m23 w' (m23 being
+    // 1 or -1), and w = (z' - m22 z) / m32.
+    static inline Mat4 InversePerspectiveMatrix(const Mat4& projection)
+    {
+        Mat4 result = {};
+        float side = projection[2][3];
+        result[0][0] = 1.0f / projection[0][0];
+        result[1][1] = 1.0f / projection[1][1];
+        result[2][3] = 1.0f / projection[3][2];
+        result[3][2] = side;
+        result[3][3] = -projection[2][2] * side * result[2][3];
+        return result;
+    }
+    
+    Camera CreateCamera(Vec3 eye, Vec3 target, Vec3 up, float fov, float aspect, float near_clip, float far_clip, uint32_t options)
+    {
+        Camera camera;
+        camera.eye = eye;
+        camera.target = target;
+        camera.up = up;
+        camera.fov = fov;
+        camera.aspect = aspect;
+        camera.near_clip = near_clip;
+        camera.far_clip = far_clip;
+        camera.options = options;
+        camera.dirty = GMATH_CAMERA_VIEW_DIRTY | GMATH_CAMERA_FOV_DIRTY | GMATH_CAMERA_PROJECTION_DIRTY;
+        UpdateCamera(camera);
+        return camera;
+    }
+    
+    void SetCameraLookAt(Camera& camera, Vec3 eye, Vec3 target, Vec3 up)
+    {
+        if (eye == camera.eye && target == camera.target && up == camera.up) return;
+        camera.eye = eye;
+        camera.target = target;
+        camera.up = up;
+        camera.dirty |= GMATH_CAMERA_VIEW_DIRTY;
+    }
+    
+    void SetCameraPerspective(Camera& camera, float fov, float aspect, float near_clip, float far_clip)
+    {
+        if (fov != camera.fov)
+        {
+            camera.fov = fov;
+            camera.dirty |= GMATH_CAMERA_FOV_DIRTY;
+        }
+        if (aspect != camera.aspect || near_clip != camera.near_clip || far_clip != camera.far_clip)
+        {
+            camera.aspect = aspect;
+            camera.near_clip = near_clip;
+            camera.far_clip = far_clip;
+            camera.dirty |= GMATH_CAMERA_PROJECTION_DIRTY;
+        }
+    }
+    
+    void SetCameraAspect(Camera& camera, float aspect)
+    {
+        SetCameraPerspective(camera, camera.fov, aspect, camera.near_clip, camera.far_clip);
+    }
+    
+    void SetCameraOptions(Camera& camera, uint32_t options)
+    {
+        if (options == camera.options) return;
+        camera.options = options;
+        camera.dirty |= GMATH_CAMERA_PROJECTION_DIRTY;
+    }
+    
+    bool UpdateCamera(Camera& camera)
+    {
+        uint32_t dirty = camera.dirty;
+        if (!dirty) return false;
+        if (dirty & GMATH_CAMERA_VIEW_DIRTY)
+        {
+            camera.view = CreateLookAtMatrix(camera.eye, camera.target, camera.up);
+            camera.inverse_view = InverseRigid(camera.view);
+        }
+        if (dirty & GMATH_CAMERA_FOV_DIRTY) camera.cotan = PerspectiveCotan(camera.fov);
+        if (dirty & (GMATH_CAMERA_FOV_DIRTY | GMATH_CAMERA_PROJECTION_DIRTY))
+        {
+            camera.projection = PerspectiveMatrix(camera.cotan, camera.aspect, camera.near_clip, camera.far_clip, camera.options);
+            camera.inverse_projection = InversePerspectiveMatrix(camera.projection);
+        }
+        camera.view_projection = camera.projection * camera.view;
+        camera.inverse_view_projection = camera.inverse_view * camera.inverse_projection;
+        camera.frustum = CreateFrustum(camera.view_projection);
+        camera.dirty = 0;
+        return true;
+    }
+#endif // GMATH_IMPLEMENTATION
+    
+    // Geometry.
+    
+    Plane GMATH_CALL CreatePlane(Vec3 normal, Vec3 point)
+    {
+        return {normal, -Dot(normal, point)};
+    }
+    
+    Plane GMATH_CALL CreatePlane(Vec3 a, Vec3 b, Vec3 c)
+    {
+        return CreatePlane(Normalize(Cross(b - a, c - a)), a);
+    }
+    
+    float GMATH_CALL Distance(const Plane& plane, Vec3 point)
+    {
+        return Dot(plane.normal, point) + plane.d;
+    }
+    
+    // Arvo's method, in center and extent form: the center transforms as a
+    // point, and each axis of the new extent sums the old extent scaled by the
+    // absolute values of the matching row.
+    AABB GMATH_CALL TransformAABB(const Mat4& mat, const AABB& box)
+    {
+#ifdef GMATH_USE_SSE
+        __m128 min, max;
+        LoadVec3PairSSE(box.min.data, min, max);
+        __m128 half = _mm_set1_ps(0.5f);
+        __m128 sign = _mm_set1_ps(-0.0f);
+        __m128 center = _mm_mul_ps(_mm_add_ps(max, min), half);
+        __m128 extent = _mm_mul_ps(_mm_sub_ps(max, min), half);
+        __m128 new_center = MultiplyAddSSE(_mm_shuffle_ps(center, center, 0x00), mat.data_sse[0], mat.data_sse[3]);
+        new_center = MultiplyAddSSE(_mm_shuffle_ps(center, center, 0x55), mat.data_sse[1], new_center);
+        new_center = MultiplyAddSSE(_mm_shuffle_ps(center, center, 0xaa), mat.data_sse[2], new_center);
+        __m128 new_extent = _mm_mul_ps(_mm_shuffle_ps(extent, extent, 0x00), _mm_andnot_ps(sign, mat.data_sse[0]));
+        new_extent = MultiplyAddSSE(_mm_shuffle_ps(extent, extent, 0x55), _mm_andnot_ps(sign, mat.data_sse[1]), new_extent);
+        new_extent = MultiplyAddSSE(_mm_shuffle_ps(extent, extent, 0xaa), _mm_andnot_ps(sign, mat.data_sse[2]), new_extent);
+        AABB result;
+        StoreVec3PairSSE(_mm_sub_ps(new_center, new_extent), _mm_add_ps(new_center, new_extent), result.min.data);
+        return result;
+#else
+        Mat4 abs_mat;
+        for (int i = 0; i < 4; ++i)
+        {
+#ifdef GMATH_USE_NEON
+            abs_mat.data_neon[i] = vabsq_f32(mat.data_neon[i]);
+#else
+            for (int j = 0; j < 4; ++j) abs_mat[i][j] = Abs(mat[i][j]);
+#endif
+        }
+        Vec3A center = TransformPoint(mat, CreateVec3A((box.max + box.min) * 0.5f));
+        Vec3A extent = TransformDirection(abs_mat, CreateVec3A((box.max - box.min) * 0.5f));
+        return {center - extent, center + extent};
+#endif
+    }
+    
+    AABB GMATH_CALL TransformAABB(const Mat3x4& affine, const AABB& box)
+    {
+#ifdef GMATH_USE_SSE
+        __m128 min, max;
+        LoadVec3PairSSE(box.min.data, min, max);
+        __m128 half = _mm_set1_ps(0.5f);
+        __m128 sign = _mm_set1_ps(-0.0f);
+        __m128 center = _mm_mul_ps(_mm_add_ps(max, min), half);
+        __m128 extent = _mm_mul_ps(_mm_sub_ps(max, min), half);
+        // The center needs a w of one to pick up the translation, and the
+        // extent a w of zero to leave it out.
+        center = _mm_shuffle_ps(center, _mm_unpackhi_ps(center, _mm_set1_ps(1.0f)), _MM_SHUFFLE(1, 0, 1, 0));
+        extent = _mm_shuffle_ps(extent, _mm_unpackhi_ps(extent, _mm_setzero_ps()), _MM_SHUFFLE(1, 0, 1, 0));
+        Mat3x4 abs_affine;
+        for (int i = 0; i < 3; ++i) abs_affine.data_sse[i] = _mm_andnot_ps(sign, affine.data_sse[i]);
+        __m128 new_center = TransformAffineSSE(affine, center).data_sse;
+        __m128 new_extent = TransformAffineSSE(abs_affine, extent).data_sse;
+        AABB result;
+        StoreVec3PairSSE(_mm_sub_ps(new_center, new_extent), _mm_add_ps(new_center, new_extent), result.min.data);
+        return result;
+#else
+        Mat3x4 abs_affine;
+        for (int i = 0; i < 3; ++i)
+        {
+#ifdef GMATH_USE_NEON
+            abs_affine.data_neon[i] = vabsq_f32(affine.data_neon[i]);
+#else
+            for (int j = 0; j < 4; ++j) abs_affine[i][j] = Abs(affine[i][j]);
+#endif
+        }
+        Vec3 center = TransformAffine(affine, (box.max + box.min) * 0.5f, 1.0f);
+        Vec3 extent = TransformAffine(abs_affine, (box.max - box.min) * 0.5f, 0.0f);
+        return {center - extent, center + extent};
+#endif
+    }
+    
+    AABBx4 GMATH_CALL LoadAABBx4(const AABB* in)
+    {
+        AABBx4 result;
+#ifdef GMATH_USE_SSE
+        __m128 min[3], max[3];
+        LoadVec3PairsSSE(in->min.data, min, max);
+        for (int i = 0; i < 3; ++i)
+        {
+            result.min.data[i].data_sse = min[i];
+            result.max.data[i].data_sse = max[i];
+        }
+#elif defined(GMATH_USE_NEON)
+        float32x4_t min[3], max[3];
+        LoadVec3PairsNEON(in->min.data, min, max);
+        for (int i = 0; i < 3; ++i)
+        {
+            result.min.data[i].data_neon = min[i];
+            result.max.data[i].data_neon = max[i];
+        }
+#else
+        for (int i = 0; i < 4; ++i)
+        {
+            result.min.Set(i, in[i].min);
+            result.max.Set(i, in[i].max);
+        }
+#endif
+        return result;
+    }
+    
+    Rayx4 GMATH_CALL LoadRayx4(const Ray* in)
+    {
+        Rayx4 result;
+#ifdef GMATH_USE_SSE
+        __m128 origin[3], direction[3];
+        LoadVec3PairsSSE(in->origin.data, origin, direction);
+        for (int i = 0; i < 3; ++i)
+        {
+            result.origin.data[i].data_sse = origin[i];
+            result.direction.data[i].data_sse = direction[i];
+        }
+#elif defined(GMATH_USE_NEON)
+        float32x4_t origin[3], direction[3];
+        LoadVec3PairsNEON(in->origin.data, origin, direction);
+        for (int i = 0; i < 3; ++i)
+        {
+            result.origin.data[i].data_neon = origin[i];
+            result.direction.data[i].data_neon = direction[i];
+        }
+#else
+        for (int i = 0; i < 4; ++i)
+        {
+            result.origin.Set(i, in[i].origin);
+            result.direction.Set(i, in[i].direction);
+        }
+#endif
+        return result;
+    }
+    
+    // The slab tests clip the ray to the range of t between each pair of
+    // opposite faces, and it hits if the three ranges overlap at or past its
+    // origin. An axis the ray is parallel to gives a range of -inf to inf if
+    // the origin is between those faces, and an empty one otherwise.
+    bool GMATH_CALL Intersect(const Ray& ray, const AABB& box, float& t)
+    {
+#ifdef GMATH_USE_SSE
+        // Only the x, y and z lanes reach the result.
+        __m128 origin, direction, min, max;
+        LoadVec3PairSSE(ray.origin.data, origin, direction);
+        LoadVec3PairSSE(box.min.data, min, max);
+        __m128 inverse = _mm_div_ps(_mm_set1_ps(1.0f), direction);
+        __m128 t_0 = _mm_mul_ps(_mm_sub_ps(min, origin), inverse);
+        __m128 t_1 = _mm_mul_ps(_mm_sub_ps(max, origin), inverse);
+        __m128 near = _mm_min_ps(t_0, t_1);
+        __m128 far = _mm_max_ps(t_0, t_1);
+        near = _mm_max_ps(near, _mm_max_ps(_mm_shuffle_ps(near, near, _MM_SHUFFLE(3, 0, 2, 1)), _mm_shuffle_ps(near, near, _MM_SHUFFLE(3, 1, 0, 2))));
+        far = _mm_min_ps(far, _mm_min_ps(_mm_shuffle_ps(far, far, _MM_SHUFFLE(3, 0, 2, 1)), _mm_shuffle_ps(far, far, _MM_SHUFFLE(3, 1, 0, 2))));
+        near = _mm_max_ss(near, _mm_setzero_ps());
+        t = _mm_cvtss_f32(near);
+        return (_mm_movemask_ps(_mm_cmple_ss(near, far)) & 1) != 0;
+#else
+        Vec4 near, far;
+#ifdef GMATH_USE_NEON
+        float32x4_t origin = CreateVec4(ray.origin, 0.0f).data_neon;
+        float32x4_t inverse = vdivq_f32(vdupq_n_f32(1.0f), CreateVec4(ray.direction, 1.0f).data_neon);
+        float32x4_t t_0 = vmulq_f32(vsubq_f32(CreateVec4(box.min, 0.0f).data_neon, origin), inverse);
+        float32x4_t t_1 = vmulq_f32(vsubq_f32(CreateVec4(box.max, 0.0f).data_neon, origin), inverse);
+        near.data_neon = vminq_f32(t_0, t_1);
+        far.data_neon = vmaxq_f32(t_0, t_1);
+#else
+        for (int i = 0; i < 3; ++i)
+        {
+            float inverse = 1.0f / ray.direction[i];
+            float t_0 = (box.min[i] - ray.origin[i]) * inverse;
+            float t_1 = (box.max[i] - ray.origin[i]) * inverse;
+            near[i] = Min(t_0, t_1);
+            far[i] = Max(t_0, t_1);
+        }
+#endif
+        float t_near = Max(Max(near.x, near.y), Max(near.z, 0.0f));
+        float t_far = Min(Min(far.x, far.y), far.z);
+        t = t_near;
+        return t_near <= t_far;
+#endif
+    }
+    
+    // Solves |origin + t * direction - center| = radius, with b halved.
+    bool GMATH_CALL Intersect(const Ray& ray, const Sphere& sphere, float& t)
+    {
+        Vec3 offset = ray.origin - sphere.center;
+        float a = Dot(ray.direction, ray.direction);
+        float b = Dot(offset, ray.direction);
+        float c = Dot(offset, offset) - sphere.radius * sphere.radius;
+        // Starting outside and pointing away.
+        if (c > 0.0f && b > 0.0f) return false;
+        float discriminant = b * b - a * c;
+        if (discriminant < 0.0f) return false;
+        t = Max((-b - Sqrt(discriminant)) / a, 0.0f);
+        return true;
+    }
+    
+    bool GMATH_CALL Intersect(const Ray& ray, const Plane& plane, float& t)
+    {
+        float denominator = Dot(plane.normal, ray.direction);
+        if (denominator == 0.0f) return false;
+        float hit = -Distance(plane, ray.origin) / denominator;
+        if (hit < 0.0f) return false;
+        t = hit;
+        return true;
+    }
+    
+    // The packet slab tests, on one component per register.
+    
+#ifdef GMATH_USE_SSE
+    static inline int SlabTestSSE(const __m128 origin[3], const __m128 inverse[3], const __m128 min[3], const __m128 max[3], __m128& t)
+    {
+        __m128 near = _mm_setzero_ps();
+        __m128 far;
+        for (int i = 0; i < 3; ++i)
+        {
+            __m128 t_0 = _mm_mul_ps(_mm_sub_ps(min[i], origin[i]), inverse[i]);
+            __m128 t_1 = _mm_mul_ps(_mm_sub_ps(max[i], origin[i]), inverse[i]);
+            near = _mm_max_ps(near, _mm_min_ps(t_0, t_1));
+            far = i == 0 ? _mm_max_ps(t_0, t_1) : _mm_min_ps(far, _mm_max_ps(t_0, t_1));
+        }
+        t = near;
+        return _mm_movemask_ps(_mm_cmple_ps(near, far));
+    }
+#endif
+    
+#ifdef GMATH_USE_NEON
+    static inline int SlabTestNEON(const float32x4_t origin[3], const float32x4_t inverse[3], const float32x4_t min[3], const float32x4_t max[3], float32x4_t& t)
+    {
+        float32x4_t near = vdupq_n_f32(0.0f);
+        float32x4_t far;
+        for (int i = 0; i < 3; ++i)
+        {
+            float32x4_t t_0 = vmulq_f32(vsubq_f32(min[i], origin[i]), inverse[i]);
+            float32x4_t t_1 = vmulq_f32(vsubq_f32(max[i], origin[i]), inverse[i]);
+            near = vmaxq_f32(near, vminq_f32(t_0, t_1));
+            far = i == 0 ? vmaxq_f32(t_0, t_1) : vminq_f32(far, vmaxq_f32(t_0, t_1));
+        }
+        t = near;
+        return (int)MoveMaskNEON(vcleq_f32(near, far));
+    }
+#endif
+    
+    int GMATH_CALL Intersect(const Ray& ray, const AABBx4& boxes, Vec4& t)
+    {
+#ifdef GMATH_USE_SSE
+        __m128 inverse = _mm_div_ps(_mm_set1_ps(1.0f), CreateVec4(ray.direction, 1.0f).data_sse);
+        __m128 origins[3], inverses[3], min[3], max[3];
+        origins[0] = _mm_set1_ps(ray.origin.x);
+        origins[1] = _mm_set1_ps(ray.origin.y);
+        origins[2] = _mm_set1_ps(ray.origin.z);
+        inverses[0] = _mm_shuffle_ps(inverse, inverse, 0x00);
+        inverses[1] = _mm_shuffle_ps(inverse, inverse, 0x55);
+        inverses[2] = _mm_shuffle_ps(inverse, inverse, 0xaa);
+        for (int i = 0; i < 3; ++i)
+        {
+            min[i] = boxes.min.data[i].data_sse;
+            max[i] = boxes.max.data[i].data_sse;
+        }
+        return SlabTestSSE(origins, inverses, min, max, t.data_sse);
+#elif defined(GMATH_USE_NEON)
+        float32x4_t inverse = vdivq_f32(vdupq_n_f32(1.0f), CreateVec4(ray.direction, 1.0f).data_neon);
+        float32x4_t origins[3], inverses[3], min[3], max[3];
+        origins[0] = vdupq_n_f32(ray.origin.x);
+        origins[1] = vdupq_n_f32(ray.origin.y);
+        origins[2] = vdupq_n_f32(ray.origin.z);
+        inverses[0] = vdupq_laneq_f32(inverse, 0);
+        inverses[1] = vdupq_laneq_f32(inverse, 1);
+        inverses[2] = vdupq_laneq_f32(inverse, 2);
+        for (int i = 0; i < 3; ++i)
+        {
+            min[i] = boxes.min.data[i].data_neon;
+            max[i] = boxes.max.data[i].data_neon;
+        }
+        return SlabTestNEON(origins, inverses, min, max, t.data_neon);
+#else
+        int mask = 0;
+        for (int i = 0; i < 4; ++i)
+        {
+            AABB box = {boxes.min.Get(i), boxes.max.Get(i)};
+            if (Intersect(ray, box, t[i])) mask |= 1 << i;
+        }
+        return mask;
+#endif
+    }
+    
+    int GMATH_CALL Intersect(const Rayx4& rays, const AABB& box, Vec4& t)
+    {
+#ifdef GMATH_USE_SSE
+        __m128 one = _mm_set1_ps(1.0f);
+        __m128 origins[3], inverses[3], min[3], max[3];
+        for (int i = 0; i < 3; ++i)
+        {
+            origins[i] = rays.origin.data[i].data_sse;
+            inverses[i] = _mm_div_ps(one, rays.direction.data[i].data_sse);
+            min[i] = _mm_set1_ps(box.min[i]);
+            max[i] = _mm_set1_ps(box.max[i]);
+        }
+        return SlabTestSSE(origins, inverses, min, max, t.data_sse);
+#elif defined(GMATH_USE_NEON)
+        float32x4_t one = vdupq_n_f32(1.0f);
+        float32x4_t origins[3], inverses[3], min[3], max[3];
+        for (int i = 0; i < 3; ++i)
+        {
+            origins[i] = rays.origin.data[i].data_neon;
+            inverses[i] = vdivq_f32(one, rays.direction.data[i].data_neon);
+            min[i] = vdupq_n_f32(box.min[i]);
+            max[i] = vdupq_n_f32(box.max[i]);
+        }
+        return SlabTestNEON(origins, inverses, min, max, t.data_neon);
+#else
+        int mask = 0;
+        for (int i = 0; i < 4; ++i)
+        {
+            Ray ray = {rays.origin.Get(i), rays.direction.Get(i)};
+            if (Intersect(ray, box, t[i])) mask |= 1 << i;
+        }
+        return mask;
+#endif
+    }
+    
+    // Translation, rotation and scale.
+    
+#ifdef GMATH_USE_SSE
+    // The rotation's basis columns (w = 0) multiplied by the scale lanes. Each
+    // element is 1 or 0 plus two products of a component of the quaternion and
+    // one of its double, so each column is two multiplies of swizzles, with the
+    // signs folded into the constants.
+    static inline void ComposeColumnsSSE(__m128 quat, __m128 scale, __m128* columns)
+    {
+        __m128 twice = _mm_add_ps(quat, quat);
+        __m128 product_one = _mm_mul_ps(_mm_shuffle_ps(quat, quat, _MM_SHUFFLE(3, 0, 0, 1)), _mm_shuffle_ps(twice, twice, _MM_SHUFFLE(3, 2, 1, 1)));
+        __m128 product_two = _mm_mul_ps(_mm_shuffle_ps(quat, quat, _MM_SHUFFLE(3, 1, 2, 2)), _mm_shuffle_ps(twice, twice, _MM_SHUFFLE(3, 3, 3, 2)));
+        columns[0] = MultiplyAddSSE(product_one, _mm_setr_ps(-1.0f, 1.0f, 1.0f, 0.0f), MultiplyAddSSE(product_two, _mm_setr_ps(-1.0f, 1.0f, -1.0f, 0.0f), _mm_setr_ps(1.0f, 0.0f, 0.0f, 0.0f)));
+        product_one = _mm_mul_ps(_mm_shuffle_ps(quat, quat, _MM_SHUFFLE(3, 1, 0, 0)), _mm_shuffle_ps(twice, twice, _MM_SHUFFLE(3, 2, 0, 1)));
+        product_two = _mm_mul_ps(_mm_shuffle_ps(quat, quat, _MM_SHUFFLE(3, 3, 2, 3)), _mm_shuffle_ps(twice, twice, _MM_SHUFFLE(3, 0, 2, 2)));
+        columns[1] = MultiplyAddSSE(product_one, _mm_setr_ps(1.0f, -1.0f, 1.0f, 0.0f), MultiplyAddSSE(product_two, _mm_setr_ps(-1.0f, -1.0f, 1.0f, 0.0f), _mm_setr_ps(0.0f, 1.0f, 0.0f, 0.0f)));
+        product_one = _mm_mul_ps(_mm_shuffle_ps(quat, quat, _MM_SHUFFLE(3, 0, 1, 0)), _mm_shuffle_ps(twice, twice, _MM_SHUFFLE(3, 0, 2, 2)));
+        product_two = _mm_mul_ps(_mm_shuffle_ps(quat, quat, _MM_SHUFFLE(3, 1, 3, 3)), _mm_shuffle_ps(twice, twice, _MM_SHUFFLE(3, 1, 0, 1)));
+        columns[2] = MultiplyAddSSE(product_one, _mm_setr_ps(1.0f, 1.0f, -1.0f, 0.0f), MultiplyAddSSE(product_two, _mm_setr_ps(1.0f, -1.0f, -1.0f, 0.0f), _mm_setr_ps(0.0f, 0.0f, 1.0f, 0.0f)));
+        columns[0] = _mm_mul_ps(columns[0], _mm_shuffle_ps(scale, scale, _MM_SHUFFLE(0, 0, 0, 0)));
+        columns[1] = _mm_mul_ps(columns[1], _mm_shuffle_ps(scale, scale, _MM_SHUFFLE(1, 1, 1, 1)));
+        columns[2] = _mm_mul_ps(columns[2], _mm_shuffle_ps(scale, scale, _MM_SHUFFLE(2, 2, 2, 2)));
+    }
+    
+    // (a[1], b[2], c[0], c[0]), gathering the elements of a symmetric or skew
+    // 3x3 matrix off the diagonal: with the columns as a, b and c, element
+    // (1, 2), (2, 0) and (0, 1).
+    static inline __m128 GatherOffDiagonalSSE(__m128 a, __m128 b, __m128 c)
+    {
+        __m128 temp = _mm_shuffle_ps(b, c, _MM_SHUFFLE(0, 0, 2, 2));
+        return _mm_shuffle_ps(temp, a, _MM_SHUFFLE(1, 1, 2, 0));
+    }
+    
+    // Lane-wise versions for the batches, one transform per lane: m[c][r] is
+    // row r of column c.
+    static inline void ComposeLanesSSE(const __m128* quat, const __m128* scale, __m128 (*m)[3])
+    {
+        __m128 one = _mm_set1_ps(1.0f);
+        __m128 x2 = _mm_add_ps(quat[0], quat[0]);
+        __m128 y2 = _mm_add_ps(quat[1], quat[1]);
+        __m128 z2 = _mm_add_ps(quat[2], quat[2]);
+        __m128 xx = _mm_mul_ps(quat[0], x2);
+        __m128 yy = _mm_mul_ps(quat[1], y2);
+        __m128 zz = _mm_mul_ps(quat[2], z2);
+        __m128 xy = _mm_mul_ps(quat[0], y2);
+        __m128 xz = _mm_mul_ps(quat[0], z2);
+        __m128 yz = _mm_mul_ps(quat[1], z2);
+        __m128 wx = _mm_mul_ps(quat[3], x2);
+        __m128 wy = _mm_mul_ps(quat[3], y2);
+        __m128 wz = _mm_mul_ps(quat[3], z2);
+        m[0][0] = _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(yy, zz)), scale[0]);
+        m[0][1] = _mm_mul_ps(_mm_add_ps(xy, wz), scale[0]);
+        m[0][2] = _mm_mul_ps(_mm_sub_ps(xz, wy), scale[0]);
+        m[1][0] = _mm_mul_ps(_mm_sub_ps(xy, wz), scale[1]);
+        m[1][1] = _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, zz)), scale[1]);
+        m[1][2] = _mm_mul_ps(_mm_add_ps(yz, wx), scale[1]);
+        m[2][0] = _mm_mul_ps(_mm_add_ps(xz, wy), scale[2]);
+        m[2][1] = _mm_mul_ps(_mm_sub_ps(yz, wx), scale[2]);
+        m[2][2] = _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, yy)), scale[2]);
+    }
+    
+    // Of the four candidates, column k of the matrix whose element (i, j) is
+    // 4 * q[i] * q[j], the one with the largest diagonal element (4 * q[k]^2)
+    // is best conditioned. That is the same pick as CreateQuat(Mat4)'s
+    // branches, made with compares and selects instead. The candidate is
+    // scaled by its own length rather than by 0.5 / sqrt(4 * q[k]^2), which
+    // only gives a unit quaternion for an orthonormal basis. The largest
+    // diagonal element is at least 1, since the four sum to 4, so the length
+    // is never zero.
+    static inline void DecomposeLanesSSE(__m128 (*m)[3], __m128* scale, __m128* quat)
+    {
+        __m128 zero = _mm_setzero_ps();
+        __m128 one = _mm_set1_ps(1.0f);
+        for (int c = 0; c < 3; ++c)
+        {
+            __m128 length_squared = _mm_mul_ps(m[c][0], m[c][0]);
+            length_squared = MultiplyAddSSE(m[c][1], m[c][1], length_squared);
+            length_squared = MultiplyAddSSE(m[c][2], m[c][2], length_squared);
+            scale[c] = _mm_sqrt_ps(length_squared);
+        }
+        __m128 determinant = _mm_mul_ps(m[0][0], _mm_sub_ps(_mm_mul_ps(m[1][1], m[2][2]), _mm_mul_ps(m[1][2], m[2][1])));
+        determinant = MultiplyAddSSE(m[0][1], _mm_sub_ps(_mm_mul_ps(m[1][2], m[2][0]), _mm_mul_ps(m[1][0], m[2][2])), determinant);
+        determinant = MultiplyAddSSE(m[0][2], _mm_sub_ps(_mm_mul_ps(m[1][0], m[2][1]), _mm_mul_ps(m[1][1], m[2][0])), determinant);
+        scale[0] = _mm_xor_ps(scale[0], _mm_and_ps(determinant, _mm_set1_ps(-0.0f)));
+        for (int c = 0; c < 3; ++c)
+        {
+            __m128 inverse = _mm_and_ps(_mm_cmpneq_ps(scale[c], zero), _mm_div_ps(one, scale[c]));
+            for (int r = 0; r < 3; ++r)
+            {
+                m[c][r] = _mm_mul_ps(m[c][r], inverse);
+            }
+        }
+        __m128 t[4] =
+        {
+            _mm_add_ps(one, _mm_sub_ps(_mm_sub_ps(m[0][0], m[1][1]), m[2][2])),
+            _mm_add_ps(one, _mm_sub_ps(_mm_sub_ps(m[1][1], m[0][0]), m[2][2])),
+            _mm_add_ps(one, _mm_sub_ps(_mm_sub_ps(m[2][2], m[0][0]), m[1][1])),
+            _mm_add_ps(one, _mm_add_ps(_mm_add_ps(m[0][0], m[1][1]), m[2][2]))
+        };
+        __m128 sum_12 = _mm_add_ps(m[1][2], m[2][1]);
+        __m128 sum_20 = _mm_add_ps(m[2][0], m[0][2]);
+        __m128 sum_01 = _mm_add_ps(m[0][1], m[1][0]);
+        __m128 difference_12 = _mm_sub_ps(m[1][2], m[2][1]);
+        __m128 difference_20 = _mm_sub_ps(m[2][0], m[0][2]);
+        __m128 difference_01 = _mm_sub_ps(m[0][1], m[1][0]);
+        __m128 candidates[3][4] =
+        {
+            {t[0], sum_01, sum_20, difference_12},
+            {sum_01, t[1], sum_12, difference_20},
+            {sum_20, sum_12, t[2], difference_01}
+        };
+        __m128 best = t[3];
+        quat[0] = difference_12;
+        quat[1] = difference_20;
+        quat[2] = difference_01;
+        quat[3] = t[3];
+        for (int k = 2; k >= 0; --k)
+        {
+            __m128 better = _mm_cmpgt_ps(t[k], best);
+            best = _mm_max_ps(t[k], best);
+            for (int j = 0; j < 4; ++j)
+            {
+                quat[j] = SelectSSE(better, candidates[k][j], quat[j]);
+            }
+        }
+        __m128 norm_squared = _mm_mul_ps(quat[0], quat[0]);
+        for (int j = 1; j < 4; ++j)
+        {
+            norm_squared = MultiplyAddSSE(quat[j], quat[j], norm_squared);
+        }
+        __m128 factor = _mm_div_ps(one, _mm_sqrt_ps(norm_squared));
+        factor = _mm_xor_ps(factor, _mm_and_ps(quat[3], _mm_set1_ps(-0.0f)));
+        for (int j = 0; j < 4; ++j)
+        {
+            quat[j] = _mm_mul_ps(quat[j], factor);
+        }
+    }
+    
+    // Transposes the four registers, storing the results stride Vec4s apart.
+    static inline void StoreTransposedSSE(__m128 a, __m128 b, __m128 c, __m128 d, Vec4* out, size_t stride)
+    {
+        _MM_TRANSPOSE4_PS(a, b, c, d);
+        out[0].data_sse = a;
+        out[stride].data_sse = b;
+        out[stride * 2].data_sse = c;
+        out[stride * 3].data_sse = d;
+    }
+    
+    // out points at the first column of a Mat4 or row of a Mat3x4, for a
+    // multiple of four count.
+    static inline void ComposeTRSBatchSSE(const Vec3* translations, const Quat* rotations, const Vec3* scales, Vec4* out, size_t count, bool affine)
+    {
+        const float* translation_data = translations->data;
+        const float* scale_data = scales->data;
+        size_t stride = affine ? 3 : 4;
+        __m128 zero = _mm_setzero_ps();
+        __m128 one = _mm_set1_ps(1.0f);
+        for (size_t i = 0; i < count; i += 4, translation_data += 12, scale_data += 12, out += stride * 4)
+        {
+            __m128 quat[4], translation[3], scale[3], m[3][3];
+            LoadQuatsSSE(rotations + i, quat[0], quat[1], quat[2], quat[3]);
+            DeinterleaveVec3SSE(_mm_loadu_ps(translation_data), _mm_loadu_ps(translation_data + 4), _mm_loadu_ps(translation_data + 8), translation[0], translation[1], translation[2]);
+            DeinterleaveVec3SSE(_mm_loadu_ps(scale_data), _mm_loadu_ps(scale_data + 4), _mm_loadu_ps(scale_data + 8), scale[0], scale[1], scale[2]);
+            ComposeLanesSSE(quat, scale, m);
+            if (affine)
+            {
+                for (int r = 0; r < 3; ++r)
+                {
+                    StoreTransposedSSE(m[0][r], m[1][r], m[2][r], translation[r], out + r, stride);
+                }
+            }
+            else
+            {
+                for (int c = 0; c < 3; ++c)
+                {
+                    StoreTransposedSSE(m[c][0], m[c][1], m[c][2], zero, out + c, stride);
+                }
+                StoreTransposedSSE(translation[0], translation[1], translation[2], one, out + 3, stride);
+            }
+        }
+    }
+    
+    static inline void DecomposeBatchSSE(const Mat4* mats, Vec3* translations, Quat* rotations, Vec3* scales, size_t count)
+    {
+        float* translation_data = translations->data;
+        float* scale_data = scales->data;
+        for (size_t i = 0; i < count; i += 4, translation_data += 12, scale_data += 12)
+        {
+            __m128 m[3][3], translation[3], scale[3], quat[4], a, b, c;
+            for (int j = 0; j < 4; ++j)
+            {
+                __m128 x = mats[i].data_sse[j];
+                __m128 y = mats[i + 1].data_sse[j];
+                __m128 z = mats[i + 2].data_sse[j];
+                __m128 w = mats[i + 3].data_sse[j];
+                _MM_TRANSPOSE4_PS(x, y, z, w);
+                __m128* column = (j < 3) ? m[j] : translation;
+                column[0] = x;
+                column[1] = y;
+                column[2] = z;
+            }
+            DecomposeLanesSSE(m, scale, quat);
+            InterleaveVec3SSE(translation[0], translation[1], translation[2], a, b, c);
+            _mm_storeu_ps(translation_data, a);
+            _mm_storeu_ps(translation_data + 4, b);
+            _mm_storeu_ps(translation_data + 8, c);
+            InterleaveVec3SSE(scale[0], scale[1], scale[2], a, b, c);
+            _mm_storeu_ps(scale_data, a);
+            _mm_storeu_ps(scale_data + 4, b);
+            _mm_storeu_ps(scale_data + 8, c);
+            _MM_TRANSPOSE4_PS(quat[0], quat[1], quat[2], quat[3]);
+            for (int j = 0; j < 4; ++j)
+            {
+                rotations[i + j].data_sse = quat[j];
+            }
+        }
+    }
+#endif
+    
+#ifdef GMATH_USE_NEON
+    static inline void Transpose4NEON(float32x4_t& a, float32x4_t& b, float32x4_t& c, float32x4_t& d)
+    {
+        float32x4x2_t ab = vtrnq_f32(a, b);
+        float32x4x2_t cd = vtrnq_f32(c, d);
+        a = vcombine_f32(vget_low_f32(ab.val[0]), vget_low_f32(cd.val[0]));
+        b = vcombine_f32(vget_low_f32(ab.val[1]), vget_low_f32(cd.val[1]));
+        c = vcombine_f32(vget_high_f32(ab.val[0]), vget_high_f32(cd.val[0]));
+        d = vcombine_f32(vget_high_f32(ab.val[1]), vget_high_f32(cd.val[1]));
+    }
+    
+    static inline void StoreTransposedNEON(float32x4_t a, float32x4_t b, float32x4_t c, float32x4_t d, Vec4* out, size_t stride)
+    {
+        Transpose4NEON(a, b, c, d);
+        out[0].data_neon = a;
+        out[stride].data_neon = b;
+        out[stride * 2].data_neon = c;
+        out[stride * 3].data_neon = d;
+    }
+    
+    // See ComposeLanesSSE and DecomposeLanesSSE.
+    static inline void ComposeLanesNEON(const float32x4_t* quat, const float32x4_t* scale, float32x4_t (*m)[3])
+    {
+        float32x4_t one = vdupq_n_f32(1.0f);
+        float32x4_t x2 = vaddq_f32(quat[0], quat[0]);
+        float32x4_t y2 = vaddq_f32(quat[1], quat[1]);
+        float32x4_t z2 = vaddq_f32(quat[2], quat[2]);
+        float32x4_t xx = vmulq_f32(quat[0], x2);
+        float32x4_t yy = vmulq_f32(quat[1], y2);
+        float32x4_t zz = vmulq_f32(quat[2], z2);
+        float32x4_t xy = vmulq_f32(quat[0], y2);
+        float32x4_t xz = vmulq_f32(quat[0], z2);
+        float32x4_t yz = vmulq_f32(quat[1], z2);
+        float32x4_t wx = vmulq_f32(quat[3], x2);
+        float32x4_t wy = vmulq_f32(quat[3], y2);
+        float32x4_t wz = vmulq_f32(quat[3], z2);
+        m[0][0] = vmulq_f32(vsubq_f32(one, vaddq_f32(yy, zz)), scale[0]);
+        m[0][1] = vmulq_f32(vaddq_f32(xy, wz), scale[0]);
+        m[0][2] = vmulq_f32(vsubq_f32(xz, wy), scale[0]);
+        m[1][0] = vmulq_f32(vsubq_f32(xy, wz), scale[1]);
+        m[1][1] = vmulq_f32(vsubq_f32(one, vaddq_f32(xx, zz)), scale[1]);
+        m[1][2] = vmulq_f32(vaddq_f32(yz, wx), scale[1]);
+        m[2][0] = vmulq_f32(vaddq_f32(xz, wy), scale[2]);
+        m[2][1] = vmulq_f32(vsubq_f32(yz, wx), scale[2]);
+        m[2][2] = vmulq_f32(vsubq_f32(one, vaddq_f32(xx, yy)), scale[2]);
+    }
+    
+    static inline void DecomposeLanesNEON(float32x4_t (*m)[3], float32x4_t* scale, float32x4_t* quat)
+    {
+        float32x4_t zero = vdupq_n_f32(0.0f);
+        float32x4_t one = vdupq_n_f32(1.0f);
+        uint32x4_t sign = vdupq_n_u32(0x80000000);
+        for (int c = 0; c < 3; ++c)
+        {
+            float32x4_t length_squared = vmulq_f32(m[c][0], m[c][0]);
+            length_squared = vfmaq_f32(length_squared, m[c][1], m[c][1]);
+            length_squared = vfmaq_f32(length_squared, m[c][2], m[c][2]);
+            scale[c] = vsqrtq_f32(length_squared);
+        }
+        float32x4_t determinant = vmulq_f32(m[0][0], vfmsq_f32(vmulq_f32(m[1][1], m[2][2]), m[1][2], m[2][1]));
+        determinant = vfmaq_f32(determinant, m[0][1], vfmsq_f32(vmulq_f32(m[1][2], m[2][0]), m[1][0], m[2][2]));
+        determinant = vfmaq_f32(determinant, m[0][2], vfmsq_f32(vmulq_f32(m[1][0], m[2][1]), m[1][1], m[2][0]));
+        scale[0] = vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(scale[0]), vandq_u32(vreinterpretq_u32_f32(determinant), sign)));
+        for (int c = 0; c < 3; ++c)
+        {
+            float32x4_t inverse = vbslq_f32(vceqq_f32(scale[c], zero), zero, vdivq_f32(one, scale[c]));
+            for (int r = 0; r < 3; ++r)
+            {
+                m[c][r] = vmulq_f32(m[c][r], inverse);
+            }
+        }
+        float32x4_t t[4] =
+        {
+            vaddq_f32(one, vsubq_f32(vsubq_f32(m[0][0], m[1][1]), m[2][2])),
+            vaddq_f32(one, vsubq_f32(vsubq_f32(m[1][1], m[0][0]), m[2][2])),
+            vaddq_f32(one, vsubq_f32(vsubq_f32(m[2][2], m[0][0]), m[1][1])),
+            vaddq_f32(one, vaddq_f32(vaddq_f32(m[0][0], m[1][1]), m[2][2]))
+        };
+        float32x4_t sum_12 = vaddq_f32(m[1][2], m[2][1]);
+        float32x4_t sum_20 = vaddq_f32(m[2][0], m[0][2]);
+        float32x4_t sum_01 = vaddq_f32(m[0][1], m[1][0]);
+        float32x4_t difference_12 = vsubq_f32(m[1][2], m[2][1]);
+        float32x4_t difference_20 = vsubq_f32(m[2][0], m[0][2]);
+        float32x4_t difference_01 = vsubq_f32(m[0][1], m[1][0]);
+        float32x4_t candidates[3][4] =
+        {
+            {t[0], sum_01, sum_20, difference_12},
+            {sum_01, t[1], sum_12, difference_20},
+            {sum_20, sum_12, t[2], difference_01}
+        };
+        float32x4_t best = t[3];
+        quat[0] = difference_12;
+        quat[1] = difference_20;
+        quat[2] = difference_01;
+        quat[3] = t[3];
+        for (int k = 2; k >= 0; --k)
+        {
+            uint32x4_t better = vcgtq_f32(t[k], best);
+            best = vmaxq_f32(t[k], best);
+            for (int j = 0; j < 4; ++j)
+            {
+                quat[j] = vbslq_f32(better, candidates[k][j], quat[j]);
+            }
+        }
+        float32x4_t norm_squared = vmulq_f32(quat[0], quat[0]);
+        for (int j = 1; j < 4; ++j)
+        {
+            norm_squared = vfmaq_f32(norm_squared, quat[j], quat[j]);
+        }
+        float32x4_t factor = vdivq_f32(one, vsqrtq_f32(norm_squared));
+        factor = vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(factor), vandq_u32(vreinterpretq_u32_f32(quat[3]), sign)));
+        for (int j = 0; j < 4; ++j)
+        {
+            quat[j] = vmulq_f32(quat[j], factor);
+        }
+    }
+    
+    static inline void ComposeTRSBatchNEON(const Vec3* translations, const Quat* rotations, const Vec3* scales, Vec4* out, size_t count, bool affine)
+    {
+        size_t stride = affine ? 3 : 4;
+        float32x4_t zero = vdupq_n_f32(0.0f);
+        float32x4_t one = vdupq_n_f32(1.0f);
+        for (size_t i = 0; i < count; i += 4, out += stride * 4)
+        {
+            float32x4x4_t quat = vld4q_f32(rotations[i].data);
+            float32x4x3_t translation = vld3q_f32(translations[i].data);
+            float32x4x3_t scale = vld3q_f32(scales[i].data);
+            float32x4_t m[3][3];
+            ComposeLanesNEON(quat.val, scale.val, m);
+            if (affine)
+            {
+                for (int r = 0; r < 3; ++r)
+                {
+                    StoreTransposedNEON(m[0][r], m[1][r], m[2][r], translation.val[r], out + r, stride);
+                }
+            }
+            else
+            {
+                for (int c = 0; c < 3; ++c)
+                {
+                    StoreTransposedNEON(m[c][0], m[c][1], m[c][2], zero, out + c, stride);
+                }
+                StoreTransposedNEON(translation.val[0], translation.val[1], translation.val[2], one, out + 3, stride);
+            }
+        }
+    }
+    
+    static inline void DecomposeBatchNEON(const Mat4* mats, Vec3* translations, Quat* rotations, Vec3* scales, size_t count)
+    {
+        for (size_t i = 0; i < count; i += 4)
+        {
+            float32x4_t m[3][3];
+            float32x4x3_t translation, scale;
+            float32x4x4_t quat;
+            for (int j = 0; j < 4; ++j)
+            {
+                float32x4_t x = mats[i].data_neon[j];
+                float32x4_t y = mats[i + 1].data_neon[j];
+                float32x4_t z = mats[i + 2].data_neon[j];
+                float32x4_t w = mats[i + 3].data_neon[j];
+                Transpose4NEON(x, y, z, w);
+                float32x4_t* column = (j < 3) ? m[j] : translation.val;
+                column[0] = x;
+                column[1] = y;
+                column[2] = z;
+            }
+            DecomposeLanesNEON(m, scale.val, quat.val);
+            vst3q_f32(translations[i].data, translation);
+            vst3q_f32(scales[i].data, scale);
+            vst4q_f32(rotations[i].data, quat);
+        }
+    }
+#endif
+    
+    Mat4 GMATH_CALL ComposeTRS(Vec3 translation, const Quat& rotation, Vec3 scale)
+    {
+        Mat4 result;
+#ifdef GMATH_USE_SSE
+        ComposeColumnsSSE(rotation.data_sse, _mm_setr_ps(scale.x, scale.y, scale.z, 0.0f), result.data_sse);
+        result.data_sse[3] = _mm_setr_ps(translation.x, translation.y, translation.z, 1.0f);
+#else
+        float x2 = rotation.x + rotation.x;
+        float y2 = rotation.y + rotation.y;
+        float z2 = rotation.z + rotation.z;
+        float xx = rotation.x * x2;
+        float yy = rotation.y * y2;
+        float zz = rotation.z * z2;
+        float xy = rotation.x * y2;
+        float xz = rotation.x * z2;
+        float yz = rotation.y * z2;
+        float wx = rotation.w * x2;
+        float wy = rotation.w * y2;
+        float wz = rotation.w * z2;
+        result[0] = CreateVec4((1.0f - (yy + zz)) * scale.x, (xy + wz) * scale.x, (xz - wy) * scale.x, 0.0f);
+        result[1] = CreateVec4((xy - wz) * scale.y, (1.0f - (xx + zz)) * scale.y, (yz + wx) * scale.y, 0.0f);
+        result[2] = CreateVec4((xz + wy) * scale.z, (yz - wx) * scale.z, (1.0f - (xx + yy)) * scale.z, 0.0f);
+        result[3] = CreateVec4(translation.x, translation.y, translation.z, 1.0f);
+#endif
+        return result;
+    }
+    
+    Mat3x4 GMATH_CALL ComposeTRSMat3x4(Vec3 translation, const Quat& rotation, Vec3 scale)
+    {
+        Mat3x4 result;
+#ifdef GMATH_USE_SSE
+        __m128 columns[4];
+        ComposeColumnsSSE(rotation.data_sse, _mm_setr_ps(scale.x, scale.y, scale.z, 0.0f), columns);
+        columns[3] = _mm_setr_ps(translation.x, translation.y, translation.z, 1.0f);
+        _MM_TRANSPOSE4_PS(columns[0], columns[1], columns[2], columns[3]);
+        result.data_sse[0] = columns[0];
+        result.data_sse[1] = columns[1];
+        result.data_sse[2] = columns[2];
+#else
+        Mat4 mat = ComposeTRS(translation, rotation, scale);
+        result[0] = CreateVec4(mat[0][0], mat[1][0], mat[2][0], translation.x);
+        result[1] = CreateVec4(mat[0][1], mat[1][1], mat[2][1], translation.y);
+        result[2] = CreateVec4(mat[0][2], mat[1][2], mat[2][2], translation.z);
+#endif
+        return result;
+    }
+    
+    void GMATH_CALL Decompose(const Mat4& mat, Vec3& translation, Quat& rotation, Vec3& scale)
+    {
+        GMATH_PROFILE_SCOPE(GMATH_PROFILE_DECOMPOSE, 1);
+        translation = mat[3].xyz;
+#ifdef GMATH_USE_SSE
+        // As in DecomposeLanesSSE, but with the matrix in its columns: t holds
+        // the four candidates' diagonal elements, and sum and difference the
+        // off-diagonal ones.
+        __m128 zero = _mm_setzero_ps();
+        __m128 one = _mm_set1_ps(1.0f);
+        __m128 sign = _mm_set1_ps(-0.0f);
+        __m128 mask = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+        __m128 columns[3] = {_mm_and_ps(mat.data_sse[0], mask), _mm_and_ps(mat.data_sse[1], mask), _mm_and_ps(mat.data_sse[2], mask)};
+        __m128 rows[4] = {columns[0], columns[1], columns[2], zero};
+        _MM_TRANSPOSE4_PS(rows[0], rows[1], rows[2], rows[3]);
+        __m128 length_squared = _mm_mul_ps(rows[0], rows[0]);
+        length_squared = MultiplyAddSSE(rows[1], rows[1], length_squared);
+        length_squared = MultiplyAddSSE(rows[2], rows[2], length_squared);
+        __m128 scales = _mm_sqrt_ps(length_squared);
+        __m128 determinant = _mm_mul_ps(columns[0], CrossSSE(columns[1], columns[2]));
+        determinant = _mm_add_ps(determinant, _mm_shuffle_ps(determinant, determinant, _MM_SHUFFLE(3, 3, 3, 1)));
+        determinant = _mm_add_ss(determinant, _mm_movehl_ps(determinant, determinant));
+        scales = _mm_xor_ps(scales, _mm_and_ps(_mm_and_ps(determinant, sign), _mm_castsi128_ps(_mm_setr_epi32(-1, 0, 0, 0))));
+        __m128 inverse = _mm_and_ps(_mm_cmpneq_ps(scales, zero), _mm_div_ps(one, scales));
+        for (int i = 0; i < 3; ++i)
+        {
+            rows[i] = _mm_mul_ps(rows[i], inverse);
+        }
+        columns[0] = _mm_mul_ps(columns[0], _mm_shuffle_ps(inverse, inverse, _MM_SHUFFLE(0, 0, 0, 0)));
+        columns[1] = _mm_mul_ps(columns[1], _mm_shuffle_ps(inverse, inverse, _MM_SHUFFLE(1, 1, 1, 1)));
+        columns[2] = _mm_mul_ps(columns[2], _mm_shuffle_ps(inverse, inverse, _MM_SHUFFLE(2, 2, 2, 2)));
+        __m128 sum = GatherOffDiagonalSSE(_mm_add_ps(columns[0], rows[0]), _mm_add_ps(columns[1], rows[1]), _mm_add_ps(columns[2], rows[2]));
+        __m128 difference = GatherOffDiagonalSSE(_mm_sub_ps(columns[0], rows[0]), _mm_sub_ps(columns[1], rows[1]), _mm_sub_ps(columns[2], rows[2]));
+        __m128 diagonal = _mm_shuffle_ps(_mm_shuffle_ps(rows[0], rows[1], _MM_SHUFFLE(1, 1, 0, 0)), rows[2], _MM_SHUFFLE(2, 2, 2, 0));
+        __m128 t = MultiplyAddSSE(_mm_shuffle_ps(diagonal, diagonal, _MM_SHUFFLE(0, 0, 0, 0)), _mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), one);
+        t = MultiplyAddSSE(_mm_shuffle_ps(diagonal, diagonal, _MM_SHUFFLE(1, 1, 1, 1)), _mm_setr_ps(-1.0f, 1.0f, -1.0f, 1.0f), t);
+        t = MultiplyAddSSE(_mm_shuffle_ps(diagonal, diagonal, _MM_SHUFFLE(2, 2, 2, 2)), _mm_setr_ps(-1.0f, -1.0f, 1.0f, 1.0f), t);
+        __m128 candidates[4] =
+        {
+            _mm_shuffle_ps(_mm_shuffle_ps(t, sum, _MM_SHUFFLE(2, 2, 0, 0)), _mm_shuffle_ps(sum, difference, _MM_SHUFFLE(0, 0, 1, 1)), _MM_SHUFFLE(2, 0, 2, 0)),
+            _mm_shuffle_ps(_mm_shuffle_ps(sum, t, _MM_SHUFFLE(1, 1, 2, 2)), _mm_shuffle_ps(sum, difference, _MM_SHUFFLE(1, 1, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0)),
+            _mm_shuffle_ps(_mm_shuffle_ps(sum, sum, _MM_SHUFFLE(0, 0, 0, 1)), _mm_shuffle_ps(t, difference, _MM_SHUFFLE(2, 2, 2, 2)), _MM_SHUFFLE(2, 0, 1, 0)),
+            _mm_shuffle_ps(difference, _mm_shuffle_ps(difference, t, _MM_SHUFFLE(3, 3, 2, 2)), _MM_SHUFFLE(2, 0, 1, 0))
+        };
+        __m128 t_splats[4] =
+        {
+            _mm_shuffle_ps(t, t, _MM_SHUFFLE(0, 0, 0, 0)),
+            _mm_shuffle_ps(t, t, _MM_SHUFFLE(1, 1, 1, 1)),
+            _mm_shuffle_ps(t, t, _MM_SHUFFLE(2, 2, 2, 2)),
+            _mm_shuffle_ps(t, t, _MM_SHUFFLE(3, 3, 3, 3))
+        };
+        __m128 best = t_splats[3];
+        __m128 quat = candidates[3];
+        for (int k = 2; k >= 0; --k)
+        {
+            quat = SelectSSE(_mm_cmpgt_ps(t_splats[k], best), candidates[k], quat);
+            best = _mm_max_ps(t_splats[k], best);
+        }
+        __m128 norm_squared = _mm_mul_ps(quat, quat);
+        norm_squared = _mm_add_ps(norm_squared, _mm_shuffle_ps(norm_squared, norm_squared, _MM_SHUFFLE(2, 3, 0, 1)));
+        norm_squared = _mm_add_ps(norm_squared, _mm_shuffle_ps(norm_squared, norm_squared, _MM_SHUFFLE(1, 0, 3, 2)));
+        __m128 factor = _mm_div_ps(one, _mm_sqrt_ps(norm_squared));
+        factor = _mm_xor_ps(factor, _mm_and_ps(_mm_shuffle_ps(quat, quat, _MM_SHUFFLE(3, 3, 3, 3)), sign));
+        rotation.data_sse = _mm_mul_ps(quat, factor);
+        scale = CreateVec3(_mm_cvtss_f32(scales), _mm_cvtss_f32(_mm_shuffle_ps(scales, scales, _MM_SHUFFLE(1, 1, 1, 1))), _mm_cvtss_f32(_mm_movehl_ps(scales, scales)));
+#else
+        Vec3 columns[3] = {mat[0].xyz, mat[1].xyz, mat[2].xyz};
+        float determinant = Dot(columns[0], Cross(columns[1], columns[2]));
+        scale = CreateVec3(Length(columns[0]), Length(columns[1]), Length(columns[2]));
+        scale.x = (determinant < 0.0f) ? -scale.x : scale.x;
+        for (int c = 0; c < 3; ++c)
+        {
+            columns[c] = columns[c] * ((scale[c] != 0.0f) ? 1.0f / scale[c] : 0.0f);
+        }
+        const Vec3* m = columns;
+        float t[4] =
+        {
+            1.0f + m[0][0] - m[1][1] - m[2][2],
+            1.0f + m[1][1] - m[0][0] - m[2][2],
+            1.0f + m[2][2] - m[0][0] - m[1][1],
+            1.0f + m[0][0] + m[1][1] + m[2][2]
+        };
+        Quat candidates[4] =
+        {
+            CreateQuat(t[0], m[0][1] + m[1][0], m[2][0] + m[0][2], m[1][2] - m[2][1]),
+            CreateQuat(m[0][1] + m[1][0], t[1], m[1][2] + m[2][1], m[2][0] - m[0][2]),
+            CreateQuat(m[2][0] + m[0][2], m[1][2] + m[2][1], t[2], m[0][1] - m[1][0]),
+            CreateQuat(m[1][2] - m[2][1], m[2][0] - m[0][2], m[0][1] - m[1][0], t[3])
+        };
+        int best = 3;
+        best = (t[2] > t[best]) ? 2 : best;
+        best = (t[1] > t[best]) ? 1 : best;
+        best = (t[0] > t[best]) ? 0 : best;
+        float factor = 1.0f / Sqrt(Dot(candidates[best], candidates[best]));
+        rotation = candidates[best] * ((candidates[best].w < 0.0f) ? -factor : factor);
+#endif
+    }
+    
+    void GMATH_CALL Decompose(const Mat3x4& affine, Vec3& translation, Quat& rotation, Vec3& scale)
+    {
+        Decompose(CreateMat4(affine), translation, rotation, scale);
+    }
+    
+#ifdef GMATH_IMPLEMENTATION
+    void GMATH_CALL ComposeTRSBatch(const Vec3* translations, const Quat* rotations, const Vec3* scales, Mat4* out, size_t count)
+    {
+        GMATH_PROFILE_SCOPE(GMATH_PROFILE_COMPOSE_TRS_BATCH, count);
+        size_t i = 0;
+#ifdef GMATH_USE_SSE
+        i = count & ~(size_t)3;
+        ComposeTRSBatchSSE(translations, rotations, scales, out->columns, i, false);
+#elif defined(GMATH_USE_NEON)
+        i = count & ~(size_t)3;
+        ComposeTRSBatchNEON(translations, rotations, scales, out->columns, i, false);
+#endif
+        for (; i < count; ++i)
+        {
+            out[i] = ComposeTRS(translations[i], rotations[i], scales[i]);
+        }
+    }
+    
+    void GMATH_CALL ComposeTRSBatch(const Vec3* translations, const Quat* rotations, const Vec3* scales, Mat3x4* out, size_t count)
+    {
+        GMATH_PROFILE_SCOPE(GMATH_PROFILE_COMPOSE_TRS_BATCH, count);
+        size_t i = 0;
+#ifdef GMATH_USE_SSE
+        i = count & ~(size_t)3;
+        ComposeTRSBatchSSE(translations, rotations, scales, out->rows, i, true);
+#elif defined(GMATH_USE_NEON)
+        i = count & ~(size_t)3;
+        ComposeTRSBatchNEON(translations, rotations, scales, out->rows, i, true);
+#endif
+        for (; i < count; ++i)
+        {
+            out[i] = ComposeTRSMat3x4(translations[i], rotations[i], scales[i]);
+        }
+    }
+    
+    void GMATH_CALL DecomposeBatch(const Mat4* mats, Vec3* translations, Quat* rotations, Vec3* scales, size_t count)
+    {
+        GMATH_PROFILE_SCOPE(GMATH_PROFILE_DECOMPOSE_BATCH, count);
+        size_t i = 0;
+#ifdef GMATH_USE_SSE
+        i = count & ~(size_t)3;
+        DecomposeBatchSSE(mats, translations, rotations, scales, i);
+#elif defined(GMATH_USE_NEON)
+        i = count & ~(size_t)3;
+        DecomposeBatchNEON(mats, translations, rotations, scales, i);
+#endif
+        for (; i < count; ++i)
+        {
+            Decompose(mats[i], translations[i], rotations[i], scales[i]);
+        }
+    }
+    
+    // Transform hierarchies.
+    
+    // A node starts a new level when its parent is in the level being filled.
+    // Roots can appear anywhere, since they depend on nothing.
+    size_t FindHierarchyLevels(const int32_t* parents, size_t count, size_t* level_starts)
+    {
+        size_t levels = 0;
+        if (count > 0) level_starts[levels++] = 0;
+        for (size_t i = 1; i < count; ++i)
+        {
+            if (parents[i] >= 0 && (size_t)parents[i] >= level_starts[levels - 1]) level_starts[levels++] = i;
+        }
+        level_starts[levels] = count;
+        return levels;
+    }
+    
+    void GMATH_CALL UpdateWorldTransforms(const int32_t* parents, const Mat4* locals, Mat4* worlds, uint8_t* dirty, size_t begin, size_t end)
+    {
+        GMATH_PROFILE_SCOPE(GMATH_PROFILE_UPDATE_WORLD_TRANSFORMS, end - begin);
+        for (size_t i = begin; i < end; ++i)
+        {
+            int32_t parent = parents[i];
+            if (dirty)
+            {
+                if (parent >= 0 && dirty[parent]) dirty[i] = 1;
+                else if (!dirty[i]) continue;
+            }
+            worlds[i] = parent < 0 ? locals[i] : worlds[parent] * locals[i];
+        }
+    }
+    
+    void GMATH_CALL UpdateWorldTransforms(const int32_t* parents, const Mat3x4* locals, Mat3x4* worlds, uint8_t* dirty, size_t begin, size_t end)
+    {
+        GMATH_PROFILE_SCOPE(GMATH_PROFILE_UPDATE_WORLD_TRANSFORMS, end - begin);
+        for (size_t i = begin; i < end; ++i)
+        {
+            int32_t parent = parents[i];
+            if (dirty)
+            {
+                if (parent >= 0 && dirty[parent]) dirty[i] = 1;
+                else if (!dirty[i]) continue;
+            }
+            worlds[i] = parent < 0 ? locals[i] : worlds[parent] * locals[i];
+        }
+    }
+#endif // GMATH_IMPLEMENTATION
+    
+    // Dual quaternion math.
+    
+    DualQuat GMATH_CALL CreateDualQuat(const Quat& rotation, Vec3 translation)
+    {
+        return {rotation, CreateQuat(translation.x, translation.y, translation.z, 0.0f) * rotation * 0.5f};
+    }
+    
+    DualQuat GMATH_CALL CreateDualQuat(const Mat4& rigid)
+    {
+        return CreateDualQuat(CreateQuat(rigid), rigid[3].xyz);
+    }
+    
+    DualQuat GMATH_CALL CreateDualQuat(const Mat3x4& rigid)
+    {
+        return CreateDualQuat(CreateQuat(rigid), CreateVec3(rigid[0][3], rigid[1][3], rigid[2][3]));
+    }
+    
+    Mat4 GMATH_CALL CreateMat4(const DualQuat& dual_quat)
+    {
+        return CreateMat4(CreateMat3x4(dual_quat));
+    }
+    
+    Mat3x4 GMATH_CALL CreateMat3x4(const DualQuat& dual_quat)
+    {
+        return CreateMat3x4(dual_quat.real, GetTranslation(dual_quat));
+    }
+    
+    DualQuat GMATH_CALL operator*(const DualQuat& a, const DualQuat& b)
+    {
+        return {a.real * b.real, a.real * b.dual + a.dual * b.real};
+    }
+    
+    DualQuat GMATH_CALL Normalize(const DualQuat& dual_quat)
+    {
+        float inv_length = 1.0f / Sqrt(Dot(dual_quat.real, dual_quat.real));
+        return {dual_quat.real * inv_length, dual_quat.dual * inv_length};
+    }
+    
+    // The vector part of 2 * dual * Invert(real), for a unit real.
+    static inline Vec3A DualQuatTranslation(const DualQuat& dual_quat)
+    {
+        Vec3A real = CreateVec3A(dual_quat.real);
+        Vec3A dual = CreateVec3A(dual_quat.dual);
+        return (dual * dual_quat.real.w - real * dual_quat.dual.w + Cross(real, dual)) * 2.0f;
+    }
+    
+    // v + 2 * cross(q, cross(q, v) + w * v), which is q * v * Invert(q) for a
+    // unit q.
+    static inline Vec3A RotateVec3A(const Quat& rotation, const Vec3A& vec)
+    {
+        Vec3A axis = CreateVec3A(rotation);
+        return vec + Cross(axis, Cross(axis, vec) + vec * rotation.w) * 2.0f;
+    }
+    
+    Vec3 GMATH_CALL GetTranslation(const DualQuat& dual_quat)
+    {
+        return DualQuatTranslation(dual_quat);
+    }
+    
+    Vec3 GMATH_CALL TransformPoint(const DualQuat& dual_quat, Vec3 point)
+    {
+        return RotateVec3A(dual_quat.real, CreateVec3A(point)) + DualQuatTranslation(dual_quat);
+    }
+    
+    Vec3 GMATH_CALL TransformDirection(const DualQuat& dual_quat, Vec3 direction)
+    {
+        return RotateVec3A(dual_quat.real, CreateVec3A(direction));
+    }
+    
+#ifdef GMATH_IMPLEMENTATION
+    // Blends a vertex's influences, unnormalized.
+    static inline DualQuat BlendDualQuats(const DualQuat* palette, const uint16_t* bones, const Vec4& weights)
+    {
+        const DualQuat& first = palette[bones[0]];
+        DualQuat result = {first.real * weights.x, first.dual * weights.x};
+        for (int j = 1; j < 4; ++j)
+        {
+            const DualQuat& bone = palette[bones[j]];
+            float weight = Dot(bone.real, first.real) < 0.0f ? -weights[j] : weights[j];
+            result.real = result.real + bone.real * weight;
+            result.dual = result.dual + bone.dual * weight;
+        }
+        return result;
+    }
+    
+#ifdef GMATH_USE_SSE
+    // BlendDualQuats, with the hemisphere test's dot product broadcast to
+    // every lane so that its sign bit can flip the weight.
+    static inline void BlendDualQuatSSE(const DualQuat* palette, const uint16_t* bones, const Vec4& weights, __m128& real, __m128& dual)
+    {
+        __m128 first = palette[bones[0]].real.data_sse;
+        __m128 weight = _mm_shuffle_ps(weights.data_sse, weights.data_sse, 0x00);
+        real = _mm_mul_ps(first, weight);
+        dual = _mm_mul_ps(palette[bones[0]].dual.data_sse, weight);
+        for (int j = 1; j < 4; ++j)
+        {
+            const DualQuat& bone = palette[bones[j]];
+            __m128 dot = _mm_mul_ps(bone.real.data_sse, first);
+            dot = _mm_add_ps(dot, _mm_shuffle_ps(dot, dot, _MM_SHUFFLE(2, 3, 0, 1)));
+            dot = _mm_add_ps(dot, _mm_shuffle_ps(dot, dot, _MM_SHUFFLE(1, 0, 3, 2)));
+            weight = _mm_xor_ps(_mm_set1_ps(weights[j]), _mm_and_ps(dot, _mm_set1_ps(-0.0f)));
+            real = MultiplyAddSSE(bone.real.data_sse, weight, real);
+            dual = MultiplyAddSSE(bone.dual.data_sse, weight, dual);
+        }
+    }
+#endif
+    
+#if defined(GMATH_USE_SSE) || defined(GMATH_USE_NEON)
+    // Blends four vertices' influences, then transposes the results into
+    // packets: the vector and w parts of the rotation and its dual.
+    static inline void BlendDualQuatsx4(const DualQuat* palette, const uint16_t* bones, const Vec4* weights, Vec3x4& real, Vec4& real_w, Vec3x4& dual, Vec4& dual_w)
+    {
+#ifdef GMATH_USE_SSE
+        __m128 r[4], d[4];
+        for (int i = 0; i < 4; ++i)
+        {
+            BlendDualQuatSSE(palette, bones + i * 4, weights[i], r[i], d[i]);
+        }
+        _MM_TRANSPOSE4_PS(r[0], r[1], r[2], r[3]);
+        _MM_TRANSPOSE4_PS(d[0], d[1], d[2], d[3]);
+        real.x.data_sse = r[0], real.y.data_sse = r[1], real.z.data_sse = r[2], real_w.data_sse = r[3];
+        dual.x.data_sse = d[0], dual.y.data_sse = d[1], dual.z.data_sse = d[2], dual_w.data_sse = d[3];
+#else
+        // The blends go through memory so that vld4q can transpose them.
+        Quat reals[4], duals[4];
+        for (int i = 0; i < 4; ++i)
+        {
+            DualQuat blend = BlendDualQuats(palette, bones + i * 4, weights[i]);
+            reals[i] = blend.real;
+            duals[i] = blend.dual;
+        }
+        float32x4x4_t r = vld4q_f32(reals[0].data);
+        float32x4x4_t d = vld4q_f32(duals[0].data);
+        real.x.data_neon = r.val[0], real.y.data_neon = r.val[1], real.z.data_neon = r.val[2], real_w.data_neon = r.val[3];
+        dual.x.data_neon = d.val[0], dual.y.data_neon = d.val[1], dual.z.data_neon = d.val[2], dual_w.data_neon = d.val[3];
+#endif
+    }
+#endif
+    
+    // Four vertices at a time, with the translation and rotation done on
+    // packets in the same way as for a single DualQuat.
+    void GMATH_CALL SkinVertices(const DualQuat* palette, const uint16_t* bones, const Vec4* weights, const Vec3* positions, const Vec3* normals, Vec3* out_positions, Vec3* out_normals, size_t count)
+    {
+        GMATH_PROFILE_SCOPE(GMATH_PROFILE_SKIN_VERTICES, count);
+        size_t i = 0;
+#if defined(GMATH_USE_SSE) || defined(GMATH_USE_NEON)
+        for (size_t end = count & ~(size_t)3; i < end; i += 4)
+        {
+            Vec3x4 real, dual;
+            Vec4 real_w, dual_w;
+            BlendDualQuatsx4(palette, bones + i * 4, weights + i, real, real_w, dual, dual_w);
+            // The translation and rotation terms are both quadratic in the
+            // blend, so normalizing it comes down to one scale per vertex.
+            Vec4 scale = 2.0f / (LengthSquared(real) + real_w * real_w);
+            Vec3x4 translation = (dual * real_w - real * dual_w + Cross(real, dual)) * scale;
+            Vec3x4 position = LoadVec3x4(positions + i);
+            position = position + Cross(real, Cross(real, position) + position * real_w) * scale + translation;
+            StoreVec3x4(position, out_positions + i);
+            if (normals)
+            {
+                Vec3x4 normal = LoadVec3x4(normals + i);
+                normal = normal + Cross(real, Cross(real, normal) + normal * real_w) * scale;
+                StoreVec3x4(normal, out_normals + i);
+            }
+        }
+#endif
+        for (; i < count; ++i)
+        {
+            DualQuat blend = Normalize(BlendDualQuats(palette, bones + i * 4, weights[i]));
+            out_positions[i] = TransformPoint(blend, positions[i]);
+            if (normals) out_normals[i] = TransformDirection(blend, normals[i]);
+        }
+    }
+#endif // GMATH_IMPLEMENTATION
+    
+    // Compressed storage.
+    
+#define GMATH_SQRT_2 1.41421356237f
+#define GMATH_SQRT_HALF 0.707106781187f
+    
+    // (2^bits - 1) / 2 for the 10 and 15 bit smallest three components, which
+    // are mapped from [-1 / sqrt(2), 1 / sqrt(2)] to [0, 2^bits - 1].
+#define GMATH_QUAT32_SCALE 511.5f
+#define GMATH_QUAT48_SCALE 16383.5f
+    
+    // Returns the index of the largest component, and quantizes the other
+    // three in order. The largest wins ties with later components, and its
+    // sign is flipped to positive along with the rest.
+    static inline int PackQuatComponents(const Quat& quat, float scale, unsigned packed[3])
+    {
+        int largest = 0;
+        for (int i = 1; i < 4; ++i)
+        {
+            if (Abs(quat.data[i]) > Abs(quat.data[largest])) largest = i;
+        }
+        float sign = quat.data[largest] < 0.0f ? -GMATH_SQRT_2 : GMATH_SQRT_2;
+        for (int i = 0, j = 0; i < 4; ++i)
+        {
+            if (i == largest) continue;
+            packed[j++] = (unsigned)(Clamp(quat.data[i] * sign, -1.0f, 1.0f) * scale + (scale + 0.5f));
+        }
+        return largest;
+    }
+    
+    static inline Quat UnpackQuatComponents(int largest, const unsigned packed[3], float scale)
+    {
+        Quat result;
+        float length_squared = 0.0f;
+        for (int i = 0, j = 0; i < 4; ++i)
+        {
+            if (i == largest) continue;
+            result.data[i] = (float)packed[j++] * (GMATH_SQRT_HALF / scale) - GMATH_SQRT_HALF;
+            length_squared += result.data[i] * result.data[i];
+        }
+        result.data[largest] = Sqrt(Max(1.0f - length_squared, 0.0f));
+        return result;
+    }
+    
+    uint32_t GMATH_CALL PackQuat32(const Quat& quat)
+    {
+        unsigned packed[3];
+        unsigned largest = (unsigned)PackQuatComponents(quat, GMATH_QUAT32_SCALE, packed);
+        return largest << 30 | packed[0] << 20 | packed[1] << 10 | packed[2];
+    }
+    
+    Quat GMATH_CALL UnpackQuat32(uint32_t packed)
+    {
+        unsigned components[3] = {packed >> 20 & 0x3ff, packed >> 10 & 0x3ff, packed & 0x3ff};
+        return UnpackQuatComponents((int)(packed >> 30), components, GMATH_QUAT32_SCALE);
+    }
+    
+    // The index is split between the top bits of the first two elements.
+    Quat48 GMATH_CALL PackQuat48(const Quat& quat)
+    {
+        unsigned packed[3];
+        unsigned largest = (unsigned)PackQuatComponents(quat, GMATH_QUAT48_SCALE, packed);
+        Quat48 result;
+        result.data[0] = (uint16_t)(packed[0] | (largest & 1) << 15);
+        result.data[1] = (uint16_t)(packed[1] | (largest >> 1) << 15);
+        result.data[2] = (uint16_t)packed[2];
+        return result;
+    }
+    
+    Quat GMATH_CALL UnpackQuat48(Quat48 packed)
+    {
+        unsigned components[3] = {packed.data[0] & 0x7fffu, packed.data[1] & 0x7fffu, packed.data[2] & 0x7fffu};
+        int largest = packed.data[0] >> 15 | (packed.data[1] >> 15) << 1;
+        return UnpackQuatComponents(largest, components, GMATH_QUAT48_SCALE);
+    }
+    
+    // Octahedral encoding projects the vector onto the octahedron
+    // |x| + |y| + |z| = 1 and folds the lower half over the upper, so x and y
+    // are enough to recover it. Each is rounded to the nearest of 65535 steps
+    // from -1 to 1.
+    uint32_t PackNormal(Vec3 normal)
+    {
+        float inverse = 1.0f / (Abs(normal.x) + Abs(normal.y) + Abs(normal.z));
+        float x = normal.x * inverse;
+        float y = normal.y * inverse;
+        if (normal.z < 0.0f)
+        {
+            float folded_x = BitsFloat(FloatBits(1.0f - Abs(y)) | (FloatBits(x) & 0x80000000u));
+            y = BitsFloat(FloatBits(1.0f - Abs(x)) | (FloatBits(y) & 0x80000000u));
+            x = folded_x;
+        }
+        x = Clamp(x, -1.0f, 1.0f) * 32767.0f;
+        y = Clamp(y, -1.0f, 1.0f) * 32767.0f;
+        int packed_x = (int)(x + BitsFloat(FloatBits(0.5f) | (FloatBits(x) & 0x80000000u)));
+        int packed_y = (int)(y + BitsFloat(FloatBits(0.5f) | (FloatBits(y) & 0x80000000u)));
+        return ((uint32_t)packed_x & 0xffffu) | (uint32_t)packed_y << 16;
+    }
+    
+    Vec3 UnpackNormal(uint32_t packed)
+    {
+        float x = Max((float)(int16_t)(packed & 0xffffu) * (1.0f / 32767.0f), -1.0f);
+        float y = Max((float)(int16_t)(packed >> 16) * (1.0f / 32767.0f), -1.0f);
+        float z = 1.0f - Abs(x) - Abs(y);
+        float fold = Max(-z, 0.0f);
+        x -= BitsFloat(FloatBits(fold) | (FloatBits(x) & 0x80000000u));
+        y -= BitsFloat(FloatBits(fold) | (FloatBits(y) & 0x80000000u));
+        float inverse = 1.0f / Sqrt(x * x + y * y + z * z);
+        return {x * inverse, y * inverse, z * inverse};
+    }
+    
+    // Fabian Giesen's conversions. Magnitudes from the largest half up round
+    // to infinity (NaNs stay NaNs), results which are denormal as halves are
+    // rounded by a float add which lines their mantissa up with the bottom of
+    // the float's, and the rest round to nearest even with integer math.
+    static inline uint16_t PackHalfBits(float val)
+    {
+        unsigned bits = FloatBits(val);
+        unsigned sign = bits & 0x80000000u;
+        bits ^= sign;
+        unsigned result;
+        if (bits >= 0x47800000u) result = bits > 0x7f800000u ? 0x7e00u : 0x7c00u;
+        else if (bits < 0x38800000u) result = FloatBits(BitsFloat(bits) + 0.5f) - 0x3f000000u;
+        else result = (bits + 0xc8000fffu + (bits >> 13 & 1)) >> 13;
+        return (uint16_t)(result | sign >> 16);
+    }
+    
+    static inline float UnpackHalfBits(uint16_t packed)
+    {
+        unsigned bits = (packed & 0x7fffu) << 13;
+        unsigned exponent = bits & 0x0f800000u;
+        bits += 0x38000000u;
+        if (exponent == 0x0f800000u) bits += 0x38000000u;
+        else if (exponent == 0) bits = FloatBits(BitsFloat(bits + 0x00800000u) - BitsFloat(0x38800000u));
+        return BitsFloat(bits | (packed & 0x8000u) << 16);
+    }
+    
+#ifdef GMATH_USE_SSE
+    // Converts a and b to halves, with a's in the low 64 bits of the result.
+    // Without F16C this is PackHalfBits on each lane.
+    static inline __m128i PackHalvesSSE(__m128 a, __m128 b)
+    {
+#ifdef GMATH_USE_F16C
+        return _mm_unpacklo_epi64(_mm_cvtps_ph(a, _MM_FROUND_TO_NEAREST_INT), _mm_cvtps_ph(b, _MM_FROUND_TO_NEAREST_INT));
+#else
+        __m128i halves[2];
+        __m128 vals[2] = {a, b};
+        for (int i = 0; i < 2; ++i)
+        {
+            __m128i bits = _mm_castps_si128(vals[i]);
+            __m128i sign = _mm_and_si128(bits, _mm_set1_epi32((int)0x80000000u));
+            bits = _mm_xor_si128(bits, sign);
+            __m128i overflow = _mm_cmpgt_epi32(bits, _mm_set1_epi32(0x477fffff));
+            __m128i nan = _mm_and_si128(_mm_cmpgt_epi32(bits, _mm_set1_epi32(0x7f800000)), _mm_set1_epi32(0x0200));
+            __m128i denormal = _mm_cmplt_epi32(bits, _mm_set1_epi32(0x38800000));
+            __m128i denormal_half = _mm_castps_si128(_mm_add_ps(_mm_castsi128_ps(bits), _mm_set1_ps(0.5f)));
+            denormal_half = _mm_sub_epi32(denormal_half, _mm_set1_epi32(0x3f000000));
+            __m128i odd = _mm_and_si128(_mm_srli_epi32(bits, 13), _mm_set1_epi32(1));
+            __m128i normal_half = _mm_add_epi32(_mm_add_epi32(bits, _mm_set1_epi32((int)0xc8000fffu)), odd);
+            normal_half = _mm_srli_epi32(normal_half, 13);
+            __m128i half = SelectSSE(denormal, denormal_half, normal_half);
+            half = SelectSSE(overflow, _mm_or_si128(_mm_set1_epi32(0x7c00), nan), half);
+            half = _mm_or_si128(half, _mm_srli_epi32(sign, 16));
+            // Sign extend, so the saturating pack leaves the bits alone.
+            halves[i] = _mm_srai_epi32(_mm_slli_epi32(half, 16), 16);
+        }
+        return _mm_packs_epi32(halves[0], halves[1]);
+#endif
+    }
+    
+    static inline void UnpackHalvesSSE(__m128i packed, __m128& a, __m128& b)
+    {
+#ifdef GMATH_USE_F16C
+        a = _mm_cvtph_ps(packed);
+        b = _mm_cvtph_ps(_mm_unpackhi_epi64(packed, packed));
+#else
+        __m128i halves[2] = {_mm_unpacklo_epi16(packed, _mm_setzero_si128()), _mm_unpackhi_epi16(packed, _mm_setzero_si128())};
+        __m128 vals[2];
+        for (int i = 0; i < 2; ++i)
+        {
+            __m128i bits = _mm_slli_epi32(_mm_and_si128(halves[i], _mm_set1_epi32(0x7fff)), 13);
+            __m128i exponent = _mm_and_si128(bits, _mm_set1_epi32(0x0f800000));
+            bits = _mm_add_epi32(bits, _mm_set1_epi32(0x38000000));
+            __m128i special = _mm_cmpeq_epi32(exponent, _mm_set1_epi32(0x0f800000));
+            bits = _mm_add_epi32(bits, _mm_and_si128(special, _mm_set1_epi32(0x38000000)));
+            __m128 denormal = _mm_sub_ps(_mm_castsi128_ps(_mm_add_epi32(bits, _mm_set1_epi32(0x00800000))), _mm_castsi128_ps(_mm_set1_epi32(0x38800000)));
+            __m128 zero = _mm_castsi128_ps(_mm_cmpeq_epi32(exponent, _mm_setzero_si128()));
+            __m128 val = SelectSSE(zero, denormal, _mm_castsi128_ps(bits));
+            __m128i sign = _mm_slli_epi32(_mm_and_si128(halves[i], _mm_set1_epi32(0x8000)), 16);
+            vals[i] = _mm_or_ps(val, _mm_castsi128_ps(sign));
+        }
+        a = vals[0];
+        b = vals[1];
+#endif
+    }
+#endif
+    
+    uint16_t PackHalf(float val)
+    {
+#if defined(GMATH_USE_F16C)
+        return (uint16_t)_mm_cvtsi128_si32(_mm_cvtps_ph(_mm_set_ss(val), _MM_FROUND_TO_NEAREST_INT));
+#elif defined(GMATH_USE_NEON)
+        return vget_lane_u16(vreinterpret_u16_f16(vcvt_f16_f32(vdupq_n_f32(val))), 0);
+#else
+        return PackHalfBits(val);
+#endif
+    }
+    
+    float UnpackHalf(uint16_t packed)
+    {
+#if defined(GMATH_USE_F16C)
+        return _mm_cvtss_f32(_mm_cvtph_ps(_mm_cvtsi32_si128(packed)));
+#elif defined(GMATH_USE_NEON)
+        return vgetq_lane_f32(vcvt_f32_f16(vreinterpret_f16_u16(vdup_n_u16(packed))), 0);
+#else
+        return UnpackHalfBits(packed);
+#endif
+    }
+    
+    Half4 GMATH_CALL PackHalf4(const Vec4& vec)
+    {
+        Half4 result;
+#ifdef GMATH_USE_SSE
+        _mm_storel_epi64((__m128i*)result.data, PackHalvesSSE(vec.data_sse, vec.data_sse));
+#elif defined(GMATH_USE_NEON)
+        vst1_u16(result.data, vreinterpret_u16_f16(vcvt_f16_f32(vec.data_neon)));
+#else
+        for (int i = 0; i < 4; ++i) result.data[i] = PackHalfBits(vec.data[i]);
+#endif
+        return result;
+    }
+    
+    Vec4 GMATH_CALL UnpackHalf4(Half4 packed)
+    {
+        Vec4 result;
+#ifdef GMATH_USE_SSE
+        __m128 unused;
+        UnpackHalvesSSE(_mm_loadl_epi64((const __m128i*)packed.data), result.data_sse, unused);
+#elif defined(GMATH_USE_NEON)
+        result.data_neon = vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(packed.data)));
+#else
+        for (int i = 0; i < 4; ++i) result.data[i] = UnpackHalfBits(packed.data[i]);
+#endif
+        return result;
+    }
+    
+    // Components are rounded to the nearest step by adding a half and
+    // truncating, as the batch versions do. The clamp comes after the add,
+    // since at 24 bits the largest step plus a half rounds up to 2^24. The
+    // product is its own statement so that the default -ffp-contract=on
+    // doesn't fuse it with the add: at 24 bits an FMA rounds differently to
+    // QuantizeBatch on about a quarter of the inputs.
+    IVec3 Quantize(Vec3 point, const AABB& bounds, int bits)
+    {
+        float steps = (float)((1 << bits) - 1);
+        Vec3 extent = bounds.max - bounds.min;
+        IVec3 result;
+        for (int i = 0; i < 3; ++i)
+        {
+            float scale = extent.data[i] > 0.0f ? steps / extent.data[i] : 0.0f;
+            float scaled = (point.data[i] - bounds.min.data[i]) * scale;
+            result.data[i] = (int)Clamp(scaled + 0.5f, 0.0f, steps);
+        }
+        return result;
+    }
+    
+    // In double, so that the result is only rounded once. At 24 bits a step
+    // is around a float ULP of the box, and rounding the step, the product
+    // and the sum in float each moved the result by up to a step or so.
+    Vec3 Dequantize(IVec3 quantized, const AABB& bounds, int bits)
+    {
+        double steps = (double)((1 << bits) - 1);
+        Vec3 result;
+        for (int i = 0; i < 3; ++i)
+        {
+            double step = ((double)bounds.max.data[i] - (double)bounds.min.data[i]) / steps;
+            result.data[i] = (float)((double)bounds.min.data[i] + (double)quantized.data[i] * step);
+        }
+        return result;
+    }
+    
+#ifdef GMATH_IMPLEMENTATION
+#ifdef GMATH_USE_SSE
+    // PackQuatComponents on four quaternions, one per lane.
+    static inline void PackQuatsSSE(const Quat* in, float scale, __m128i& largest, __m128i packed[3])
+    {
+        __m128 x, y, z, w;
+        LoadQuatsSSE(in, x, y, z, w);
+        __m128 sign_mask = _mm_set1_ps(-0.0f);
+        __m128 max = _mm_andnot_ps(sign_mask, x);
+        __m128 greater = _mm_cmpgt_ps(_mm_andnot_ps(sign_mask, y), max);
+        max = SelectSSE(greater, _mm_andnot_ps(sign_mask, y), max);
+        largest = _mm_and_si128(_mm_castps_si128(greater), _mm_set1_epi32(1));
+        greater = _mm_cmpgt_ps(_mm_andnot_ps(sign_mask, z), max);
+        max = SelectSSE(greater, _mm_andnot_ps(sign_mask, z), max);
+        largest = SelectSSE(_mm_castps_si128(greater), _mm_set1_epi32(2), largest);
+        greater = _mm_cmpgt_ps(_mm_andnot_ps(sign_mask, w), max);
+        largest = SelectSSE(_mm_castps_si128(greater), _mm_set1_epi32(3), largest);
+        // The components before the largest stay in place, and those after it
+        // move down one.
+        __m128 after_x = _mm_castsi128_ps(_mm_cmpgt_epi32(largest, _mm_setzero_si128()));
+        __m128 after_y = _mm_castsi128_ps(_mm_cmpgt_epi32(largest, _mm_set1_epi32(1)));
+        __m128 after_z = _mm_castsi128_ps(_mm_cmpeq_epi32(largest, _mm_set1_epi32(3)));
+        __m128 largest_val = SelectSSE(after_z, w, SelectSSE(after_y, z, SelectSSE(after_x, y, x)));
+        __m128 sign = _mm_and_ps(largest_val, sign_mask);
+        __m128 components[3] = {SelectSSE(after_x, x, y), SelectSSE(after_y, y, z), SelectSSE(after_z, z, w)};
+        for (int i = 0; i < 3; ++i)
+        {
+            __m128 val = _mm_mul_ps(_mm_xor_ps(components[i], sign), _mm_set1_ps(GMATH_SQRT_2));
+            val = _mm_min_ps(_mm_max_ps(val, _mm_set1_ps(-1.0f)), _mm_set1_ps(1.0f));
+            packed[i] = _mm_cvttps_epi32(MultiplyAddSSE(val, _mm_set1_ps(scale), _mm_set1_ps(scale + 0.5f)));
+        }
+    }
+    
+    static inline void UnpackQuatsSSE(__m128i largest, const __m128i packed[3], float scale, Quat* out)
+    {
+        __m128 components[3];
+        for (int i = 0; i < 3; ++i)
+        {
+            components[i] = MultiplyAddSSE(_mm_cvtepi32_ps(packed[i]), _mm_set1_ps(GMATH_SQRT_HALF / scale), _mm_set1_ps(-GMATH_SQRT_HALF));
+        }
+        __m128 length_squared = _mm_mul_ps(components[0], components[0]);
+        length_squared = MultiplyAddSSE(components[1], components[1], length_squared);
+        length_squared = MultiplyAddSSE(components[2], components[2], length_squared);
+        __m128 largest_val = _mm_sqrt_ps(_mm_max_ps(_mm_sub_ps(_mm_set1_ps(1.0f), length_squared), _mm_setzero_ps()));
+        __m128 after_x = _mm_castsi128_ps(_mm_cmpgt_epi32(largest, _mm_setzero_si128()));
+        __m128 after_y = _mm_castsi128_ps(_mm_cmpgt_epi32(largest, _mm_set1_epi32(1)));
+        __m128 after_z = _mm_castsi128_ps(_mm_cmpeq_epi32(largest, _mm_set1_epi32(3)));
+        __m128 x = SelectSSE(after_x, components[0], largest_val);
+        __m128 y = SelectSSE(after_y, components[1], SelectSSE(after_x, largest_val, components[0]));
+        __m128 z = SelectSSE(after_z, components[2], SelectSSE(after_y, largest_val, components[1]));
+        __m128 w = SelectSSE(after_z, largest_val, components[2]);
+        _MM_TRANSPOSE4_PS(x, y, z, w);
+        _mm_storeu_ps(out[0].data, x);
+        _mm_storeu_ps(out[1].data, y);
+        _mm_storeu_ps(out[2].data, z);
+        _mm_storeu_ps(out[3].data, w);
+    }
+#endif
+    
+#ifdef GMATH_USE_NEON
+    // See PackQuatsSSE.
+    static inline void PackQuatsNEON(const Quat* in, float scale, uint32x4_t& largest, uint32x4_t packed[3])
+    {
+        float32x4x4_t quats = vld4q_f32(in->data);
+        float32x4_t max = vabsq_f32(quats.val[0]);
+        uint32x4_t greater = vcgtq_f32(vabsq_f32(quats.val[1]), max);
+        max = vbslq_f32(greater, vabsq_f32(quats.val[1]), max);
+        largest = vandq_u32(greater, vdupq_n_u32(1));
+        greater = vcgtq_f32(vabsq_f32(quats.val[2]), max);
+        max = vbslq_f32(greater, vabsq_f32(quats.val[2]), max);
+        largest = vbslq_u32(greater, vdupq_n_u32(2), largest);
+        greater = vcgtq_f32(vabsq_f32(quats.val[3]), max);
+        largest = vbslq_u32(greater, vdupq_n_u32(3), largest);
+        uint32x4_t after_x = vcgtq_u32(largest, vdupq_n_u32(0));
+        uint32x4_t after_y = vcgtq_u32(largest, vdupq_n_u32(1));
+        uint32x4_t after_z = vceqq_u32(largest, vdupq_n_u32(3));
+        float32x4_t largest_val = vbslq_f32(after_z, quats.val[3], vbslq_f32(after_y, quats.val[2], vbslq_f32(after_x, quats.val[1], quats.val[0])));
+        uint32x4_t sign = vandq_u32(vreinterpretq_u32_f32(largest_val), vdupq_n_u32(0x80000000u));
+        float32x4_t components[3] = {vbslq_f32(after_x, quats.val[0], quats.val[1]), vbslq_f32(after_y, quats.val[1], quats.val[2]), vbslq_f32(after_z, quats.val[2], quats.val[3])};
+        for (int i = 0; i < 3; ++i)
+        {
+            float32x4_t val = vmulq_n_f32(vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(components[i]), sign)), GMATH_SQRT_2);
+            val = vminq_f32(vmaxq_f32(val, vdupq_n_f32(-1.0f)), vdupq_n_f32(1.0f));
+            packed[i] = vcvtq_u32_f32(vfmaq_n_f32(vdupq_n_f32(scale + 0.5f), val, scale));
+        }
+    }
+    
+    static inline void UnpackQuatsNEON(uint32x4_t largest, const uint32x4_t packed[3], float scale, Quat* out)
+    {
+        float32x4_t components[3];
+        for (int i = 0; i < 3; ++i)
+        {
+            components[i] = vfmaq_n_f32(vdupq_n_f32(-GMATH_SQRT_HALF), vcvtq_f32_u32(packed[i]), GMATH_SQRT_HALF / scale);
+        }
+        float32x4_t length_squared = vmulq_f32(components[0], components[0]);
+        length_squared = vfmaq_f32(length_squared, components[1], components[1]);
+        length_squared = vfmaq_f32(length_squared, components[2], components[2]);
+        float32x4_t largest_val = vsqrtq_f32(vmaxq_f32(vsubq_f32(vdupq_n_f32(1.0f), length_squared), vdupq_n_f32(0.0f)));
+        uint32x4_t after_x = vcgtq_u32(largest, vdupq_n_u32(0));
+        uint32x4_t after_y = vcgtq_u32(largest, vdupq_n_u32(1));
+        uint32x4_t after_z = vceqq_u32(largest, vdupq_n_u32(3));
+        float32x4x4_t quats;
+        quats.val[0] = vbslq_f32(after_x, components[0], largest_val);
+        quats.val[1] = vbslq_f32(after_y, components[1], vbslq_f32(after_x, largest_val, components[0]));
+        quats.val[2] = vbslq_f32(after_z, components[2], vbslq_f32(after_y, largest_val, components[1]));
+        quats.val[3] = vbslq_f32(after_z, largest_val, components[2]);
+        vst4q_f32(out->data, quats);
+    }
+#endif
+    
+    void GMATH_CALL PackQuat32Batch(const Quat* in, uint32_t* out, size_t count)
+    {
+        GMATH_PROFILE_SCOPE(GMATH_PROFILE_PACK_BATCH, count);
+        size_t i = 0;
+#ifdef GMATH_USE_SSE
+        i = count & ~(size_t)3;
+        for (size_t block = 0; block < i; block += 4)
+        {
+            __m128i largest, packed[3];
+            PackQuatsSSE(in + block, GMATH_QUAT32_SCALE, largest, packed);
+            __m128i result = _mm_or_si128(_mm_slli_epi32(largest, 30), _mm_slli_epi32(packed[0], 20));
+            result = _mm_or_si128(result, _mm_or_si128(_mm_slli_epi32(packed[1], 10), packed[2]));
+            _mm_storeu_si128((__m128i*)(out + block), result);
+        }
+#elif defined(GMATH_USE_NEON)
+        i = count & ~(size_t)3;
+        for (size_t block = 0; block < i; block += 4)
+        {
+            uint32x4_t largest, packed[3];
+            PackQuatsNEON(in + block, GMATH_QUAT32_SCALE, largest, packed);
+            uint32x4_t result = vorrq_u32(vshlq_n_u32(largest, 30), vshlq_n_u32(packed[0], 20));
+            result = vorrq_u32(result, vorrq_u32(vshlq_n_u32(packed[1], 10), packed[2]));
+            vst1q_u32(out + block, result);
+        }
+#endif
+        for (; i < count; ++i) out[i] = PackQuat32(in[i]);
+    }
+    
+    void GMATH_CALL UnpackQuat32Batch(const uint32_t* in, Quat* out, size_t count)
+    {
+        GMATH_PROFILE_SCOPE(GMATH_PROFILE_UNPACK_BATCH, count);
+        size_t i = 0;
+#ifdef GMATH_USE_SSE
+        i = count & ~(size_t)3;
+        for (size_t block = 0; block < i; block += 4)
+        {
+            __m128i bits = _mm_loadu_si128((const __m128i*)(in + block));
+            __m128i mask = _mm_set1_epi32(0x3ff);
+            __m128i packed[3] = {_mm_and_si128(_mm_srli_epi32(bits, 20), mask), _mm_and_si128(_mm_srli_epi32(bits, 10), mask), _mm_and_si128(bits, mask)};
+            UnpackQuatsSSE(_mm_srli_epi32(bits, 30), packed, GMATH_QUAT32_SCALE, out + block);
+        }
+#elif defined(GMATH_USE_NEON)
+        i = count & ~(size_t)3;
+        for (size_t block = 0; block < i; block += 4)
+        {
+            uint32x4_t bits = vld1q_u32(in + block);
+            uint32x4_t mask = vdupq_n_u32(0x3ff);
+            uint32x4_t packed[3] = {vandq_u32(vshrq_n_u32(bits, 20), mask), vandq_u32(vshrq_n_u32(bits, 10), mask), vandq_u32(bits, mask)};
+            UnpackQuatsNEON(vshrq_n_u32(bits, 30), packed, GMATH_QUAT32_SCALE, out + block);
+        }
+#endif
+        for (; i < count; ++i) out[i] = UnpackQuat32(in[i]);
+    }
+    
+    // Four Quat48s are twelve interleaved 16 bit elements, which widen to the
+    // same layout as four packed Vec3s, so the Vec3 shuffles apply.
+    void GMATH_CALL PackQuat48Batch(const Quat* in, Quat48* out, size_t count)
+    {
+        GMATH_PROFILE_SCOPE(GMATH_PROFILE_PACK_BATCH, count);
+        size_t i = 0;
+#ifdef GMATH_USE_SSE
+        i = count & ~(size_t)3;
+        for (size_t block = 0; block < i; block += 4)
+        {
+            __m128i largest, packed[3];
+            PackQuatsSSE(in + block, GMATH_QUAT48_SCALE, largest, packed);
+            packed[0] = _mm_or_si128(packed[0], _mm_slli_epi32(_mm_and_si128(largest, _mm_set1_epi32(1)), 15));
+            packed[1] = _mm_or_si128(packed[1], _mm_slli_epi32(_mm_srli_epi32(largest, 1), 15));
+            __m128 a, b, c;
+            InterleaveVec3SSE(_mm_castsi128_ps(packed[0]), _mm_castsi128_ps(packed[1]), _mm_castsi128_ps(packed[2]), a, b, c);
+            // Sign extend, so the saturating packs leave the bits alone.
+            __m128i first = _mm_srai_epi32(_mm_slli_epi32(_mm_castps_si128(a), 16), 16);
+            __m128i second = _mm_srai_epi32(_mm_slli_epi32(_mm_castps_si128(b), 16), 16);
+            __m128i third = _mm_srai_epi32(_mm_slli_epi32(_mm_castps_si128(c), 16), 16);
+            _mm_storeu_si128((__m128i*)(out + block), _mm_packs_epi32(first, second));
+            _mm_storel_epi64((__m128i*)((char*)(out + block) + 16), _mm_packs_epi32(third, third));
+        }
+#elif defined(GMATH_USE_NEON)
+        i = count & ~(size_t)3;
+        for (size_t block = 0; block < i; block += 4)
+        {
+            uint32x4_t largest, packed[3];
+            PackQuatsNEON(in + block, GMATH_QUAT48_SCALE, largest, packed);
+            packed[0] = vorrq_u32(packed[0], vshlq_n_u32(vandq_u32(largest, vdupq_n_u32(1)), 15));
+            packed[1] = vorrq_u32(packed[1], vshlq_n_u32(vshrq_n_u32(largest, 1), 15));
+            uint16x4x3_t result;
+            for (int j = 0; j < 3; ++j) result.val[j] = vmovn_u32(packed[j]);
+            vst3_u16(out[block].data, result);
+        }
+#endif
+        for (; i < count; ++i) out[i] = PackQuat48(in[i]);
+    }
+    
+    void GMATH_CALL UnpackQuat48Batch(const Quat48* in, Quat* out, size_t count)
+    {
+        GMATH_PROFILE_SCOPE(GMATH_PROFILE_UNPACK_BATCH, count);
+        size_t i = 0;
+#ifdef GMATH_USE_SSE
+        i = count & ~(size_t)3;
+        for (size_t block = 0; block < i; block += 4)
+        {
+            __m128i low = _mm_loadu_si128((const __m128i*)(in + block));
+            __m128i high = _mm_loadl_epi64((const __m128i*)((const char*)(in + block) + 16));
+            __m128 x, y, z;
+            DeinterleaveVec3SSE(_mm_castsi128_ps(_mm_unpacklo_epi16(low, _mm_setzero_si128())), _mm_castsi128_ps(_mm_unpackhi_epi16(low, _mm_setzero_si128())),
+                                _mm_castsi128_ps(_mm_unpacklo_epi16(high, _mm_setzero_si128())), x, y, z);
+            __m128i packed[3] = {_mm_castps_si128(x), _mm_castps_si128(y), _mm_castps_si128(z)};
+            __m128i largest = _mm_or_si128(_mm_srli_epi32(packed[0], 15), _mm_slli_epi32(_mm_srli_epi32(packed[1], 15), 1));
+            packed[0] = _mm_and_si128(packed[0], _mm_set1_epi32(0x7fff));
+            packed[1] = _mm_and_si128(packed[1], _mm_set1_epi32(0x7fff));
+            UnpackQuatsSSE(largest, packed, GMATH_QUAT48_SCALE, out + block);
+        }
+#elif defined(GMATH_USE_NEON)
+        i = count & ~(size_t)3;
+        for (size_t block = 0; block < i; block += 4)
+        {
+            uint16x4x3_t bits = vld3_u16(in[block].data);
+            uint32x4_t packed[3] = {vmovl_u16(bits.val[0]), vmovl_u16(bits.val[1]), vmovl_u16(bits.val[2])};
+            uint32x4_t largest = vorrq_u32(vshrq_n_u32(packed[0], 15), vshlq_n_u32(vshrq_n_u32(packed[1], 15), 1));
+            packed[0] = vandq_u32(packed[0], vdupq_n_u32(0x7fff));
+            packed[1] = vandq_u32(packed[1], vdupq_n_u32(0x7fff));
+            UnpackQuatsNEON(largest, packed, GMATH_QUAT48_SCALE, out + block);
+        }
+#endif
+        for (; i < count; ++i) out[i] = UnpackQuat48(in[i]);
+    }
+    
+#ifdef GMATH_USE_SSE
+    // Copies the sign of b onto a.
+    static inline __m128 CopySignSSE(__m128 a, __m128 b)
+    {
+        __m128 sign_mask = _mm_set1_ps(-0.0f);
+        return _mm_or_ps(_mm_andnot_ps(sign_mask, a), _mm_and_ps(sign_mask, b));
+    }
+#endif
+    
+#ifdef GMATH_USE_NEON
+    static inline float32x4_t CopySignNEON(float32x4_t a, float32x4_t b)
+    {
+        return vbslq_f32(vdupq_n_u32(0x80000000u), b, a);
+    }
+#endif
+    
+    void GMATH_CALL PackNormalBatch(const Vec3* in, uint32_t* out, size_t count)
+    {
+        GMATH_PROFILE_SCOPE(GMATH_PROFILE_PACK_BATCH, count);
+        size_t i = 0;
+#ifdef GMATH_USE_SSE
+        __m128 sign_mask = _mm_set1_ps(-0.0f);
+        i = count & ~(size_t)3;
+        for (size_t block = 0; block < i; block += 4)
+        {
+            Vec3x4 normals = LoadVec3x4(in + block);
+            __m128 abs_x = _mm_andnot_ps(sign_mask, normals.x.data_sse);
+            __m128 abs_y = _mm_andnot_ps(sign_mask, normals.y.data_sse);
+            __m128 abs_z = _mm_andnot_ps(sign_mask, normals.z.data_sse);
+            __m128 inverse = _mm_div_ps(_mm_set1_ps(1.0f), _mm_add_ps(_mm_add_ps(abs_x, abs_y), abs_z));
+            __m128 x = _mm_mul_ps(normals.x.data_sse, inverse);
+            __m128 y = _mm_mul_ps(normals.y.data_sse, inverse);
+            __m128 lower = _mm_cmplt_ps(normals.z.data_sse, _mm_setzero_ps());
+            __m128 folded_x = CopySignSSE(_mm_sub_ps(_mm_set1_ps(1.0f), _mm_andnot_ps(sign_mask, y)), x);
+            __m128 folded_y = CopySignSSE(_mm_sub_ps(_mm_set1_ps(1.0f), _mm_andnot_ps(sign_mask, x)), y);
+            x = SelectSSE(lower, folded_x, x);
+            y = SelectSSE(lower, folded_y, y);
+            x = _mm_mul_ps(_mm_min_ps(_mm_max_ps(x, _mm_set1_ps(-1.0f)), _mm_set1_ps(1.0f)), _mm_set1_ps(32767.0f));
+            y = _mm_mul_ps(_mm_min_ps(_mm_max_ps(y, _mm_set1_ps(-1.0f)), _mm_set1_ps(1.0f)), _mm_set1_ps(32767.0f));
+            __m128i packed_x = _mm_cvttps_epi32(_mm_add_ps(x, CopySignSSE(_mm_set1_ps(0.5f), x)));
+            __m128i packed_y = _mm_cvttps_epi32(_mm_add_ps(y, CopySignSSE(_mm_set1_ps(0.5f), y)));
+            __m128i result = _mm_or_si128(_mm_and_si128(packed_x, _mm_set1_epi32(0xffff)), _mm_slli_epi32(packed_y, 16));
+            _mm_storeu_si128((__m128i*)(out + block), result);
+        }
+#elif defined(GMATH_USE_NEON)
+        i = count & ~(size_t)3;
+        for (size_t block = 0; block < i; block += 4)
+        {
+            float32x4x3_t normals = vld3q_f32(in[block].data);
+            float32x4_t sum = vaddq_f32(vaddq_f32(vabsq_f32(normals.val[0]), vabsq_f32(normals.val[1])), vabsq_f32(normals.val[2]));
+            float32x4_t inverse = vdivq_f32(vdupq_n_f32(1.0f), sum);
+            float32x4_t x = vmulq_f32(normals.val[0], inverse);
+            float32x4_t y = vmulq_f32(normals.val[1], inverse);
+            uint32x4_t lower = vcltq_f32(normals.val[2], vdupq_n_f32(0.0f));
+            float32x4_t folded_x = CopySignNEON(vsubq_f32(vdupq_n_f32(1.0f), vabsq_f32(y)), x);
+            float32x4_t folded_y = CopySignNEON(vsubq_f32(vdupq_n_f32(1.0f), vabsq_f32(x)), y);
+            x = vbslq_f32(lower, folded_x, x);
+            y = vbslq_f32(lower, folded_y, y);
+            x = vmulq_n_f32(vminq_f32(vmaxq_f32(x, vdupq_n_f32(-1.0f)), vdupq_n_f32(1.0f)), 32767.0f);
+            y = vmulq_n_f32(vminq_f32(vmaxq_f32(y, vdupq_n_f32(-1.0f)), vdupq_n_f32(1.0f)), 32767.0f);
+            int32x4_t packed_x = vcvtq_s32_f32(vaddq_f32(x, CopySignNEON(vdupq_n_f32(0.5f), x)));
+            int32x4_t packed_y = vcvtq_s32_f32(vaddq_f32(y, CopySignNEON(vdupq_n_f32(0.5f), y)));
+            uint32x4_t result = vorrq_u32(vandq_u32(vreinterpretq_u32_s32(packed_x), vdupq_n_u32(0xffff)), vshlq_n_u32(vreinterpretq_u32_s32(packed_y), 16));
+            vst1q_u32(out + block, result);
+        }
+#endif
+        for (; i < count; ++i) out[i] = PackNormal(in[i]);
+    }
+    
+    void GMATH_CALL UnpackNormalBatch(const uint32_t* in, Vec3* out, size_t count)
+    {
+        GMATH_PROFILE_SCOPE(GMATH_PROFILE_UNPACK_BATCH, count);
+        size_t i = 0;
+#ifdef GMATH_USE_SSE
+        __m128 sign_mask = _mm_set1_ps(-0.0f);
+        i = count & ~(size_t)3;
+        for (size_t block = 0; block < i; block += 4)
+        {
+            __m128i bits = _mm_loadu_si128((const __m128i*)(in + block));
+            __m128 x = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_slli_epi32(bits, 16), 16));
+            __m128 y = _mm_cvtepi32_ps(_mm_srai_epi32(bits, 16));
+            x = _mm_max_ps(_mm_mul_ps(x, _mm_set1_ps(1.0f / 32767.0f)), _mm_set1_ps(-1.0f));
+            y = _mm_max_ps(_mm_mul_ps(y, _mm_set1_ps(1.0f / 32767.0f)), _mm_set1_ps(-1.0f));
+            __m128 z = _mm_sub_ps(_mm_sub_ps(_mm_set1_ps(1.0f), _mm_andnot_ps(sign_mask, x)), _mm_andnot_ps(sign_mask, y));
+            __m128 fold = _mm_max_ps(_mm_sub_ps(_mm_setzero_ps(), z), _mm_setzero_ps());
+            x = _mm_sub_ps(x, CopySignSSE(fold, x));
+            y = _mm_sub_ps(y, CopySignSSE(fold, y));
+            __m128 length_squared = MultiplyAddSSE(z, z, MultiplyAddSSE(y, y, _mm_mul_ps(x, x)));
+            __m128 inverse = _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(length_squared));
+            Vec3x4 normals;
+            normals.x.data_sse = _mm_mul_ps(x, inverse);
+            normals.y.data_sse = _mm_mul_ps(y, inverse);
+            normals.z.data_sse = _mm_mul_ps(z, inverse);
+            StoreVec3x4(normals, out + block);
+        }
+#elif defined(GMATH_USE_NEON)
+        i = count & ~(size_t)3;
+        for (size_t block = 0; block < i; block += 4)
+        {
+            int32x4_t bits = vreinterpretq_s32_u32(vld1q_u32(in + block));
+            float32x4_t x = vcvtq_f32_s32(vshrq_n_s32(vshlq_n_s32(bits, 16), 16));
+            float32x4_t y = vcvtq_f32_s32(vshrq_n_s32(bits, 16));
+            x = vmaxq_f32(vmulq_n_f32(x, 1.0f / 32767.0f), vdupq_n_f32(-1.0f));
+            y = vmaxq_f32(vmulq_n_f32(y, 1.0f / 32767.0f), vdupq_n_f32(-1.0f));
+            float32x4_t z = vsubq_f32(vsubq_f32(vdupq_n_f32(1.0f), vabsq_f32(x)), vabsq_f32(y));
+            float32x4_t fold = vmaxq_f32(vnegq_f32(z), vdupq_n_f32(0.0f));
+            x = vsubq_f32(x, CopySignNEON(fold, x));
+            y = vsubq_f32(y, CopySignNEON(fold, y));
+            float32x4_t length_squared = vfmaq_f32(vfmaq_f32(vmulq_f32(x, x), y, y), z, z);
+            float32x4_t inverse = vdivq_f32(vdupq_n_f32(1.0f), vsqrtq_f32(length_squared));
+            float32x4x3_t normals;
+            normals.val[0] = vmulq_f32(x, inverse);
+            normals.val[1] = vmulq_f32(y, inverse);
+            normals.val[2] = vmulq_f32(z, inverse);
+            vst3q_f32(out[block].data, normals);
+        }
+#endif
+        for (; i < count; ++i) out[i] = UnpackNormal(in[i]);
+    }
+    
+    // Two Half4s per iteration, count being even. The AVX versions convert
+    // eight floats with one F16C instruction.
+#ifdef GMATH_USE_SSE
+    static inline void PackHalf4sSSE(const Vec4* in, Half4* out, size_t count)
+    {
+        for (size_t block = 0; block < count; block += 2)
+        {
+            __m128i result = PackHalvesSSE(_mm_loadu_ps(in[block].data), _mm_loadu_ps(in[block + 1].data));
+            _mm_storeu_si128((__m128i*)(out + block), result);
+        }
+    }
+    
+    static inline void UnpackHalf4sSSE(const Half4* in, Vec4* out, size_t count)
+    {
+        for (size_t block = 0; block < count; block += 2)
+        {
+            __m128 a, b;
+            UnpackHalvesSSE(_mm_loadu_si128((const __m128i*)(in + block)), a, b);
+            _mm_storeu_ps(out[block].data, a);
+            _mm_storeu_ps(out[block + 1].data, b);
+        }
+    }
+#endif
+    
+#if defined(GMATH_AVX_KERNELS) && (defined(GMATH_USE_F16C) || defined(GMATH_DISPATCH_AVX))
+#define GMATH_HALF_AVX_KERNELS 1
+    static inline GMATH_TARGET_AVX void PackHalf4sAVX(const Vec4* in, Half4* out, size_t count)
+    {
+        for (size_t block = 0; block < count; block += 2)
+        {
+            __m128i result = _mm256_cvtps_ph(_mm256_loadu_ps(in[block].data), _MM_FROUND_TO_NEAREST_INT);
+            _mm_storeu_si128((__m128i*)(out + block), result);
+        }
+    }
+    
+    static inline GMATH_TARGET_AVX void UnpackHalf4sAVX(const Half4* in, Vec4* out, size_t count)
+    {
+        for (size_t block = 0; block < count; block += 2)
+        {
+            _mm256_storeu_ps(out[block].data, _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)(in + block))));
+        }
+    }
+#endif
+    
+    void GMATH_CALL PackHalf4Batch(const Vec4* in, Half4* out, size_t count)
+    {
+        GMATH_PROFILE_SCOPE(GMATH_PROFILE_PACK_BATCH, count);
+        size_t i = 0;
+#if defined(GMATH_HALF_AVX_KERNELS)
+        i = count & ~(size_t)1;
+        if (UseAVX()) PackHalf4sAVX(in, out, i);
+        else PackHalf4sSSE(in, out, i);
+#elif defined(GMATH_USE_SSE)
+        i = count & ~(size_t)1;
+        PackHalf4sSSE(in, out, i);
+#elif defined(GMATH_USE_NEON)
+        i = count & ~(size_t)1;
+        for (size_t block = 0; block < i; block += 2)
+        {
+            float16x8_t result = vcvt_high_f16_f32(vcvt_f16_f32(vld1q_f32(in[block].data)), vld1q_f32(in[block + 1].data));
+            vst1q_u16(out[block].data, vreinterpretq_u16_f16(result));
+        }
+#endif
+        for (; i < count; ++i) out[i] = PackHalf4(in[i]);
+    }
+    
+    void GMATH_CALL UnpackHalf4Batch(const Half4* in, Vec4* out, size_t count)
+    {
+        GMATH_PROFILE_SCOPE(GMATH_PROFILE_UNPACK_BATCH, count);
+        size_t i = 0;
+#if defined(GMATH_HALF_AVX_KERNELS)
+        i = count & ~(size_t)1;
+        if (UseAVX()) UnpackHalf4sAVX(in, out, i);
+        else UnpackHalf4sSSE(in, out, i);
+#elif defined(GMATH_USE_SSE)
+        i = count & ~(size_t)1;
+        UnpackHalf4sSSE(in, out, i);
+#elif defined(GMATH_USE_NEON)
+        i = count & ~(size_t)1;
+        for (size_t block = 0; block < i; block += 2)
+        {
+            float16x8_t halves = vreinterpretq_f16_u16(vld1q_u16(in[block].data));
+            vst1q_f32(out[block].data, vcvt_f32_f16(vget_low_f16(halves)));
+            vst1q_f32(out[block + 1].data, vcvt_high_f32_f16(halves));
+        }
+#endif
+        for (; i < count; ++i) out[i] = UnpackHalf4(in[i]);
+    }
+    
+    // IVec3s have the same layout as Vec3s, so the packed Vec3 loads and
+    // stores move them too. The multiply and add stay separate, not fused, to
+    // round the same way as Quantize.
+    void GMATH_CALL QuantizeBatch(const Vec3* in, IVec3* out, size_t count, const AABB& bounds, int bits)
+    {
+        GMATH_PROFILE_SCOPE(GMATH_PROFILE_PACK_BATCH, count);
+        size_t i = 0;
+#if defined(GMATH_USE_SSE) || defined(GMATH_USE_NEON)
+        float steps = (float)((1 << bits) - 1);
+        Vec3 extent = bounds.max - bounds.min;
+        Vec4 min[3], scale[3];
+        for (int j = 0; j < 3; ++j)
+        {
+            min[j] = CreateVec4(bounds.min.data[j]);
+            scale[j] = CreateVec4(extent.data[j] > 0.0f ? steps / extent.data[j] : 0.0f);
+        }
+        i = count & ~(size_t)3;
+        for (size_t block = 0; block < i; block += 4)
+        {
+#ifdef GMATH_USE_SSE
+            Vec3x4 points = LoadVec3x4(in + block);
+            __m128 quantized[3];
+            for (int j = 0; j < 3; ++j)
+            {
+                __m128 val = _mm_add_ps(_mm_mul_ps(_mm_sub_ps(points.data[j].data_sse, min[j].data_sse), scale[j].data_sse), _mm_set1_ps(0.5f));
+                val = _mm_min_ps(_mm_max_ps(val, _mm_setzero_ps()), _mm_set1_ps(steps));
+                quantized[j] = _mm_castsi128_ps(_mm_cvttps_epi32(val));
+            }
+            __m128 a, b, c;
+            InterleaveVec3SSE(quantized[0], quantized[1], quantized[2], a, b, c);
+            _mm_storeu_ps((float*)out[block].data, a);
+            _mm_storeu_ps((float*)out[block].data + 4, b);
+            _mm_storeu_ps((float*)out[block].data + 8, c);
+#else
+            float32x4x3_t points = vld3q_f32(in[block].data);
+            int32x4x3_t quantized;
+            for (int j = 0; j < 3; ++j)
+            {
+                float32x4_t val = vaddq_f32(vmulq_f32(vsubq_f32(points.val[j], min[j].data_neon), scale[j].data_neon), vdupq_n_f32(0.5f));
+                val = vminq_f32(vmaxq_f32(val, vdupq_n_f32(0.0f)), vdupq_n_f32(steps));
+                quantized.val[j] = vcvtq_s32_f32(val);
+            }
+            vst3q_s32(out[block].data, quantized);
+#endif
+        }
+#endif
+        for (; i < count; ++i) out[i] = Quantize(in[i], bounds, bits);
+    }
+    
+    void GMATH_CALL DequantizeBatch(const IVec3* in, Vec3* out, size_t count, const AABB& bounds, int bits)
+    {
+        GMATH_PROFILE_SCOPE(GMATH_PROFILE_UNPACK_BATCH, count);
+        size_t i = 0;
+#if defined(GMATH_USE_SSE) || defined(GMATH_USE_NEON)
+        // Two lanes at a time in double, as Dequantize does.
+        double steps = (double)((1 << bits) - 1);
+        double min[3], step[3];
+        for (int j = 0; j < 3; ++j)
+        {
+            min[j] = (double)bounds.min.data[j];
+            step[j] = ((double)bounds.max.data[j] - min[j]) / steps;
+        }
+        i = count & ~(size_t)3;
+        for (size_t block = 0; block < i; block += 4)
+        {
+#ifdef GMATH_USE_SSE
+            Vec3x4 points = LoadVec3x4((const Vec3*)(in + block));
+            for (int j = 0; j < 3; ++j)
+            {
+                __m128i val = _mm_castps_si128(points.data[j].data_sse);
+                __m128d low = _mm_add_pd(_mm_mul_pd(_mm_cvtepi32_pd(val), _mm_set1_pd(step[j])), _mm_set1_pd(min[j]));
+                __m128d high = _mm_add_pd(_mm_mul_pd(_mm_cvtepi32_pd(_mm_unpackhi_epi64(val, val)), _mm_set1_pd(step[j])), _mm_set1_pd(min[j]));
+                points.data[j].data_sse = _mm_movelh_ps(_mm_cvtpd_ps(low), _mm_cvtpd_ps(high));
+            }
+            StoreVec3x4(points, out + block);
+#else
+            int32x4x3_t quantized = vld3q_s32(in[block].data);
+            float32x4x3_t points;
+            for (int j = 0; j < 3; ++j)
+            {
+                float64x2_t low = vcvtq_f64_s64(vmovl_s32(vget_low_s32(quantized.val[j])));
+                float64x2_t high = vcvtq_f64_s64(vmovl_high_s32(quantized.val[j]));
+                low = vaddq_f64(vmulq_f64(low, vdupq_n_f64(step[j])), vdupq_n_f64(min[j]));
+                high = vaddq_f64(vmulq_f64(high, vdupq_n_f64(step[j])), vdupq_n_f64(min[j]));
+                points.val[j] = vcvt_high_f32_f64(vcvt_f32_f64(low), high);
+            }
+            vst3q_f32(out[block].data, points);
+#endif
+        }
+#endif
+        for (; i < count; ++i) out[i] = Dequantize(in[i], bounds, bits);
+    }
+#endif // GMATH_IMPLEMENTATION
+    
+    // Double precision math. With AVX each DVec4 is a single register, with
+    // SSE2 or NEON two, holding (x, y) and (z, w). The types have no __m256d
+    // member, which would make them 32 byte aligned only in AVX builds, so the
+    // AVX paths use unaligned loads and stores on the double arrays.
+    
+#ifdef GMATH_USE_AVX
+    static inline double DotAVX(__m256d a, __m256d b)
+    {
+        __m256d product = _mm256_mul_pd(a, b);
+        __m128d sum = _mm_add_pd(_mm256_castpd256_pd128(product), _mm256_extractf128_pd(product, 1));
+        return _mm_cvtsd_f64(_mm_add_sd(sum, _mm_unpackhi_pd(sum, sum)));
+    }
+#elif defined(GMATH_USE_SSE)
+    static inline double DotSSE(const __m128d* a, const __m128d* b)
+    {
+        __m128d sum = MultiplyAddSSE(a[1], b[1], _mm_mul_pd(a[0], b[0]));
+        return _mm_cvtsd_f64(_mm_add_sd(sum, _mm_unpackhi_pd(sum, sum)));
+    }
+#endif
+    
+#ifdef GMATH_USE_NEON
+    static inline float64x2_t SetNEON(double x, double y)
+    {
+        double values[2] = {x, y};
+        return vld1q_f64(values);
+    }
+    
+    static inline double DotNEON(const float64x2_t* a, const float64x2_t* b)
+    {
+        return vaddvq_f64(vfmaq_f64(vmulq_f64(a[0], b[0]), a[1], b[1]));
+    }
+#endif
+    
+    static inline double SqrtDouble(double val)
+    {
+#ifdef GMATH_USE_SSE
+        __m128d in = _mm_set_sd(val);
+        return _mm_cvtsd_f64(_mm_sqrt_sd(in, in));
+#elif defined(GMATH_USE_NEON)
+        return vgetq_lane_f64(vsqrtq_f64(vdupq_n_f64(val)), 0);
+#else
+        return GMATH_DSQRT(val);
+#endif
+    }
+    
+    double Dot(DVec3 a, DVec3 b)
+    {
+        return a.x * b.x + a.y * b.y + a.z * b.z;
+    }
+    
+    DVec3 DCross(DVec3 a, DVec3 b)
+    {
+        return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+    }
+    
+    double LengthSquared(DVec3 vec)
+    {
+        return Dot(vec, vec);
+    }
+    
+    double Length(DVec3 vec)
+    {
+        return SqrtDouble(Dot(vec, vec));
+    }
+    
+    DVec3 Normalize(DVec3 vec)
+    {
+        return vec / Length(vec);
+    }
+    
+    DVec4 GMATH_CALL CreateDVec4(double fill)
+    {
+        return CreateDVec4(fill, fill, fill, fill);
+    }
+    
+    DVec4 GMATH_CALL CreateDVec4(DVec3 xyz, double w)
+    {
+        return CreateDVec4(xyz.x, xyz.y, xyz.z, w);
+    }
+    
+    DVec4 GMATH_CALL CreateDVec4(double x, double y, double z, double w)
+    {
+        DVec4 vec;
+#ifdef GMATH_USE_AVX
+        _mm256_storeu_pd(vec.data, _mm256_setr_pd(x, y, z, w));
+#elif defined(GMATH_USE_SSE)
+        vec.data_sse[0] = _mm_setr_pd(x, y);
+        vec.data_sse[1] = _mm_setr_pd(z, w);
+#elif defined(GMATH_USE_NEON)
+        vec.data_neon[0] = SetNEON(x, y);
+        vec.data_neon[1] = SetNEON(z, w);
+#else
+        vec = {x, y, z, w};
+#endif
+        return vec;
+    }
+    
+    DVec4 GMATH_CALL CreateDVec4(const Vec4& vec)
+    {
+        DVec4 result;
+#ifdef GMATH_USE_AVX
+        _mm256_storeu_pd(result.data, _mm256_cvtps_pd(vec.data_sse));
+#elif defined(GMATH_USE_SSE)
+        result.data_sse[0] = _mm_cvtps_pd(vec.data_sse);
+        result.data_sse[1] = _mm_cvtps_pd(_mm_movehl_ps(vec.data_sse, vec.data_sse));
+#elif defined(GMATH_USE_NEON)
+        result.data_neon[0] = vcvt_f64_f32(vget_low_f32(vec.data_neon));
+        result.data_neon[1] = vcvt_high_f64_f32(vec.data_neon);
+#else
+        result = {vec.x, vec.y, vec.z, vec.w};
+#endif
+        return result;
+    }
+    
+    Vec4 GMATH_CALL CreateVec4(const DVec4& vec)
+    {
+        Vec4 result;
+#ifdef GMATH_USE_AVX
+        result.data_sse = _mm256_cvtpd_ps(_mm256_loadu_pd(vec.data));
+#elif defined(GMATH_USE_SSE)
+        result.data_sse = _mm_movelh_ps(_mm_cvtpd_ps(vec.data_sse[0]), _mm_cvtpd_ps(vec.data_sse[1]));
+#elif defined(GMATH_USE_NEON)
+        result.data_neon = vcvt_high_f32_f64(vcvt_f32_f64(vec.data_neon[0]), vec.data_neon[1]);
+#else
+        result = {(float)vec.x, (float)vec.y, (float)vec.z, (float)vec.w};
+#endif
+        return result;
+    }
+    
+    DVec4 GMATH_CALL operator+(const DVec4& a, const DVec4& b)
+    {
+        DVec4 result;
+#ifdef GMATH_USE_AVX
+        _mm256_storeu_pd(result.data, _mm256_add_pd(_mm256_loadu_pd(a.data), _mm256_loadu_pd(b.data)));
+#elif defined(GMATH_USE_SSE)
+        result.data_sse[0] = _mm_add_pd(a.data_sse[0], b.data_sse[0]);
+        result.data_sse[1] = _mm_add_pd(a.data_sse[1], b.data_sse[1]);
+#elif defined(GMATH_USE_NEON)
+        result.data_neon[0] = vaddq_f64(a.data_neon[0], b.data_neon[0]);
+        result.data_neon[1] = vaddq_f64(a.data_neon[1], b.data_neon[1]);
+#else
+        for (int i = 0; i < 4; ++i) result[i] = a[i] + b[i];
+#endif
+        return result;
+    }
+    
+    DVec4 GMATH_CALL operator-(const DVec4& a, const DVec4& b)
+    {
+        DVec4 result;
+#ifdef GMATH_USE_AVX
+        _mm256_storeu_pd(result.data, _mm256_sub_pd(_mm256_loadu_pd(a.data), _mm256_loadu_pd(b.data)));
+#elif defined(GMATH_USE_SSE)
+        result.data_sse[0] = _mm_sub_pd(a.data_sse[0], b.data_sse[0]);
+        result.data_sse[1] = _mm_sub_pd(a.data_sse[1], b.data_sse[1]);
+#elif defined(GMATH_USE_NEON)
+        result.data_neon[0] = vsubq_f64(a.data_neon[0], b.data_neon[0]);
+        result.data_neon[1] = vsubq_f64(a.data_neon[1], b.data_neon[1]);
+#else
+        for (int i = 0; i < 4; ++i) result[i] = a[i] - b[i];
+#endif
+        return result;
+    }
+    
+    DVec4 GMATH_CALL operator*(const DVec4& a, const DVec4& b)
+    {
+        DVec4 result;
+#ifdef GMATH_USE_AVX
+        _mm256_storeu_pd(result.data, _mm256_mul_pd(_mm256_loadu_pd(a.data), _mm256_loadu_pd(b.data)));
+#elif defined(GMATH_USE_SSE)
+        result.data_sse[0] = _mm_mul_pd(a.data_sse[0], b.data_sse[0]);
+        result.data_sse[1] = _mm_mul_pd(a.data_sse[1], b.data_sse[1]);
+#elif defined(GMATH_USE_NEON)
+        result.data_neon[0] = vmulq_f64(a.data_neon[0], b.data_neon[0]);
+        result.data_neon[1] = vmulq_f64(a.data_neon[1], b.data_neon[1]);
+#else
+        for (int i = 0; i < 4; ++i) result[i] = a[i] * b[i];
+#endif
+        return result;
+    }
+    
+    DVec4 GMATH_CALL operator*(const DVec4& a, double b)
+    {
+        DVec4 result;
+#ifdef GMATH_USE_AVX
+        _mm256_storeu_pd(result.data, _mm256_mul_pd(_mm256_loadu_pd(a.data), _mm256_set1_pd(b)));
+#elif defined(GMATH_USE_SSE)
+        __m128d scalar = _mm_set1_pd(b);
+        result.data_sse[0] = _mm_mul_pd(a.data_sse[0], scalar);
+        result.data_sse[1] = _mm_mul_pd(a.data_sse[1], scalar);
+#elif defined(GMATH_USE_NEON)
+        result.data_neon[0] = vmulq_n_f64(a.data_neon[0], b);
+        result.data_neon[1] = vmulq_n_f64(a.data_neon[1], b);
+#else
+        for (int i = 0; i < 4; ++i) result[i] = a[i] * b;
+#endif
+        return result;
+    }
+    
+    DVec4 GMATH_CALL operator*(double a, const DVec4& b)
+    {
+        return b * a;
+    }
+    
+    DVec4 GMATH_CALL operator/(const DVec4& a, double b)
+    {
+        DVec4 result;
+#ifdef GMATH_USE_AVX
+        _mm256_storeu_pd(result.data, _mm256_div_pd(_mm256_loadu_pd(a.data), _mm256_set1_pd(b)));
+#elif defined(GMATH_USE_SSE)
+        __m128d scalar = _mm_set1_pd(b);
+        result.data_sse[0] = _mm_div_pd(a.data_sse[0], scalar);
+        result.data_sse[1] = _mm_div_pd(a.data_sse[1], scalar);
+#elif defined(GMATH_USE_NEON)
+        float64x2_t scalar = vdupq_n_f64(b);
+        result.data_neon[0] = vdivq_f64(a.data_neon[0], scalar);
+        result.data_neon[1] = vdivq_f64(a.data_neon[1], scalar);
+#else
+        for (int i = 0; i < 4; ++i) result[i] = a[i] / b;
+#endif
+        return result;
+    }
+    
+    double GMATH_CALL Dot(const DVec4& a, const DVec4& b)
+    {
+#ifdef GMATH_USE_AVX
+        return DotAVX(_mm256_loadu_pd(a.data), _mm256_loadu_pd(b.data));
+#elif defined(GMATH_USE_SSE)
+        return DotSSE(a.data_sse, b.data_sse);
+#elif defined(GMATH_USE_NEON)
+        return DotNEON(a.data_neon, b.data_neon);
+#else
+        return (a.x * b.x + a.y * b.y) + (a.z * b.z + a.w * b.w);
+#endif
+    }
+    
+    // Double precision quaternion math.
+    
+    DQuat GMATH_CALL CreateDQuat(double x, double y, double z, double w)
+    {
+        DQuat quat;
+#ifdef GMATH_USE_AVX
+        _mm256_storeu_pd(quat.data, _mm256_setr_pd(x, y, z, w));
+#elif defined(GMATH_USE_SSE)
+        quat.data_sse[0] = _mm_setr_pd(x, y);
+        quat.data_sse[1] = _mm_setr_pd(z, w);
+#elif defined(GMATH_USE_NEON)
+        quat.data_neon[0] = SetNEON(x, y);
+        quat.data_neon[1] = SetNEON(z, w);
+#else
+        quat.x = x;
+        quat.y = y;
+        quat.z = z;
+        quat.w = w;
+#endif
+        return quat;
+    }
+    
+    DQuat GMATH_CALL CreateDQuat(const Quat& quat)
+    {
+        DQuat result;
+#ifdef GMATH_USE_AVX
+        _mm256_storeu_pd(result.data, _mm256_cvtps_pd(quat.data_sse));
+#elif defined(GMATH_USE_SSE)
+        result.data_sse[0] = _mm_cvtps_pd(quat.data_sse);
+        result.data_sse[1] = _mm_cvtps_pd(_mm_movehl_ps(quat.data_sse, quat.data_sse));
+#elif defined(GMATH_USE_NEON)
+        result.data_neon[0] = vcvt_f64_f32(vget_low_f32(quat.data_neon));
+        result.data_neon[1] = vcvt_high_f64_f32(quat.data_neon);
+#else
+        result = CreateDQuat(quat.x, quat.y, quat.z, quat.w);
+#endif
+        return result;
+    }
+    
+    Quat GMATH_CALL CreateQuat(const DQuat& quat)
+    {
+        Quat result;
+#ifdef GMATH_USE_AVX
+        result.data_sse = _mm256_cvtpd_ps(_mm256_loadu_pd(quat.data));
+#elif defined(GMATH_USE_SSE)
+        result.data_sse = _mm_movelh_ps(_mm_cvtpd_ps(quat.data_sse[0]), _mm_cvtpd_ps(quat.data_sse[1]));
+#elif defined(GMATH_USE_NEON)
+        result.data_neon = vcvt_high_f32_f64(vcvt_f32_f64(quat.data_neon[0]), quat.data_neon[1]);
+#else
+        result = {(float)quat.x, (float)quat.y, (float)quat.z, (float)quat.w};
+#endif
+        return result;
+    }
+    
+    DQuat GMATH_CALL operator+(const DQuat& a, const DQuat& b)
+    {
+        DQuat result;
+#ifdef GMATH_USE_AVX
+        _mm256_storeu_pd(result.data, _mm256_add_pd(_mm256_loadu_pd(a.data), _mm256_loadu_pd(b.data)));
+#elif defined(GMATH_USE_SSE)
+        result.data_sse[0] = _mm_add_pd(a.data_sse[0], b.data_sse[0]);
+        result.data_sse[1] = _mm_add_pd(a.data_sse[1], b.data_sse[1]);
+#elif defined(GMATH_USE_NEON)
+        result.data_neon[0] = vaddq_f64(a.data_neon[0], b.data_neon[0]);
+        result.data_neon[1] = vaddq_f64(a.data_neon[1], b.data_neon[1]);
+#else
+        for (int i = 0; i < 4; ++i) result.data[i] = a.data[i] + b.data[i];
+#endif
+        return result;
+    }
+    
+    DQuat GMATH_CALL operator-(const DQuat& a, const DQuat& b)
+    {
+        DQuat result;
+#ifdef GMATH_USE_AVX
+        _mm256_storeu_pd(result.data, _mm256_sub_pd(_mm256_loadu_pd(a.data), _mm256_loadu_pd(b.data)));
+#elif defined(GMATH_USE_SSE)
+        result.data_sse[0] = _mm_sub_pd(a.data_sse[0], b.data_sse[0]);
+        result.data_sse[1] = _mm_sub_pd(a.data_sse[1], b.data_sse[1]);
+#elif defined(GMATH_USE_NEON)
+        result.data_neon[0] = vsubq_f64(a.data_neon[0], b.data_neon[0]);
+        result.data_neon[1] = vsubq_f64(a.data_neon[1], b.data_neon[1]);
+#else
+        for (int i = 0; i < 4; ++i) result.data[i] = a.data[i] - b.data[i];
+#endif
+        return result;
+    }
+    
+    DQuat GMATH_CALL operator*(const DQuat& a, double b)
+    {
+        DQuat result;
+#ifdef GMATH_USE_AVX
+        _mm256_storeu_pd(result.data, _mm256_mul_pd(_mm256_loadu_pd(a.data), _mm256_set1_pd(b)));
+#elif defined(GMATH_USE_SSE)
+        __m128d scalar = _mm_set1_pd(b);
+        result.data_sse[0] = _mm_mul_pd(a.data_sse[0], scalar);
+        result.data_sse[1] = _mm_mul_pd(a.data_sse[1], scalar);
+#elif defined(GMATH_USE_NEON)
+        result.data_neon[0] = vmulq_n_f64(a.data_neon[0], b);
+        result.data_neon[1] = vmulq_n_f64(a.data_neon[1], b);
+#else
+        for (int i = 0; i < 4; ++i) result.data[i] = a.data[i] * b;
+#endif
+        return result;
+    }
+    
+    // The same Hamilton product as the float operator*: each component of a
+    // scales b with its elements permuted and some of them negated. With SSE2
+    // and NEON the permutations are half swaps, so b's halves are swapped once
+    // up front.
+    DQuat GMATH_CALL operator*(const DQuat& a, const DQuat& b)
+    {
+        DQuat result;
+#ifdef GMATH_USE_AVX
+        __m256d b_lanes = _mm256_loadu_pd(b.data);
+        __m256d term_x = _mm256_xor_pd(_mm256_permute4x64_pd(b_lanes, _MM_SHUFFLE(0, 1, 2, 3)), _mm256_setr_pd(0.0, -0.0, 0.0, -0.0));
+        __m256d term_y = _mm256_xor_pd(_mm256_permute4x64_pd(b_lanes, _MM_SHUFFLE(1, 0, 3, 2)), _mm256_setr_pd(0.0, 0.0, -0.0, -0.0));
+        __m256d term_z = _mm256_xor_pd(_mm256_permute4x64_pd(b_lanes, _MM_SHUFFLE(2, 3, 0, 1)), _mm256_setr_pd(-0.0, 0.0, 0.0, -0.0));
+        __m256d product = _mm256_mul_pd(_mm256_set1_pd(a.w), b_lanes);
+        product = _mm256_fmadd_pd(_mm256_set1_pd(a.x), term_x, product);
+        product = _mm256_fmadd_pd(_mm256_set1_pd(a.y), term_y, product);
+        _mm256_storeu_pd(result.data, _mm256_fmadd_pd(_mm256_set1_pd(a.z), term_z, product));
+#elif defined(GMATH_USE_SSE)
+        __m128d xy = b.data_sse[0];
+        __m128d zw = b.data_sse[1];
+        __m128d yx = _mm_shuffle_pd(xy, xy, 1);
+        __m128d wz = _mm_shuffle_pd(zw, zw, 1);
+        __m128d negate_high = _mm_setr_pd(0.0, -0.0);
+        __m128d negate_low = _mm_setr_pd(-0.0, 0.0);
+        __m128d negate_both = _mm_set1_pd(-0.0);
+        __m128d scalar = _mm_set1_pd(a.w);
+        __m128d low = _mm_mul_pd(scalar, xy);
+        __m128d high = _mm_mul_pd(scalar, zw);
+        scalar = _mm_set1_pd(a.x);
+        low = MultiplyAddSSE(scalar, _mm_xor_pd(wz, negate_high), low);
+        high = MultiplyAddSSE(scalar, _mm_xor_pd(yx, negate_high), high);
+        scalar = _mm_set1_pd(a.y);
+        low = MultiplyAddSSE(scalar, zw, low);
+        high = MultiplyAddSSE(scalar, _mm_xor_pd(xy, negate_both), high);
+        scalar = _mm_set1_pd(a.z);
+        result.data_sse[0] = MultiplyAddSSE(scalar, _mm_xor_pd(yx, negate_low), low);
+        result.data_sse[1] = MultiplyAddSSE(scalar, _mm_xor_pd(wz, negate_high), high);
+#elif defined(GMATH_USE_NEON)
+        float64x2_t xy = b.data_neon[0];
+        float64x2_t zw = b.data_neon[1];
+        float64x2_t yx = vextq_f64(xy, xy, 1);
+        float64x2_t wz = vextq_f64(zw, zw, 1);
+        float64x2_t wz_signed = vmulq_f64(wz, SetNEON(1.0, -1.0));
+        float64x2_t low = vmulq_n_f64(xy, a.w);
+        float64x2_t high = vmulq_n_f64(zw, a.w);
+        low = vfmaq_n_f64(low, wz_signed, a.x);
+        high = vfmaq_n_f64(high, vmulq_f64(yx, SetNEON(1.0, -1.0)), a.x);
+        low = vfmaq_n_f64(low, zw, a.y);
+        high = vfmsq_f64(high, xy, vdupq_n_f64(a.y));
+        result.data_neon[0] = vfmaq_n_f64(low, vmulq_f64(yx, SetNEON(-1.0, 1.0)), a.z);
+        result.data_neon[1] = vfmaq_n_f64(high, wz_signed, a.z);
+#else
+        result.x = a.x * b.w + a.y * b.z - a.z * b.y + a.w * b.x;
+        result.y = -a.x * b.z + a.y * b.w + a.z * b.x + a.w * b.y;
+        result.z = a.x * b.y - a.y * b.x + a.z * b.w + a.w * b.z;
+        result.w = -a.x * b.x - a.y * b.y - a.z * b.z + a.w * b.w;
+#endif
+        return result;
+    }
+    
+    double GMATH_CALL Dot(const DQuat& a, const DQuat& b)
+    {
+#ifdef GMATH_USE_AVX
+        return DotAVX(_mm256_loadu_pd(a.data), _mm256_loadu_pd(b.data));
+#elif defined(GMATH_USE_SSE)
+        return DotSSE(a.data_sse, b.data_sse);
+#elif defined(GMATH_USE_NEON)
+        return DotNEON(a.data_neon, b.data_neon);
+#else
+        return (a.x * b.x + a.y * b.y) + (a.z * b.z + a.w * b.w);
+#endif
+    }
+    
+    DQuat GMATH_CALL Normalize(const DQuat& quat)
+    {
+        return quat * (1.0 / SqrtDouble(Dot(quat, quat)));
+    }
+    
+    DQuat GMATH_CALL Invert(const DQuat& quat)
+    {
+        return CreateDQuat(-quat.x, -quat.y, -quat.z, quat.w) * (1.0 / Dot(quat, quat));
+    }
+    
+    // Double precision matrix math.
+    
+    DMat4 GMATH_CALL CreateDMat4(const DQuat& quat)
+    {
+        DMat4 mat;
+        double xx = quat.x * quat.x;
+        double yy = quat.y * quat.y;
+        double zz = quat.z * quat.z;
+        double xy = quat.x * quat.y;
+        double xz = quat.x * quat.z;
+        double yz = quat.y * quat.z;
+        double wx = quat.w * quat.x;
+        double wy = quat.w * quat.y;
+        double wz = quat.w * quat.z;
+        mat[0] = CreateDVec4(1.0 - 2.0 * (yy + zz), 2.0 * (xy + wz), 2.0 * (xz - wy), 0.0);
+        mat[1] = CreateDVec4(2.0 * (xy - wz), 1.0 - 2.0 * (xx + zz), 2.0 * (yz + wx), 0.0);
+        mat[2] = CreateDVec4(2.0 * (xz + wy), 2.0 * (yz - wx), 1.0 - 2.0 * (xx + yy), 0.0);
+        mat[3] = CreateDVec4(0.0, 0.0, 0.0, 1.0);
+        return mat;
+    }
+    
+    DMat4 GMATH_CALL CreateDMat4(const Mat4& mat)
+    {
+        DMat4 result;
+        for (int i = 0; i < 4; ++i) result[i] = CreateDVec4(mat[i]);
+        return result;
+    }
+    
+    Mat4 GMATH_CALL CreateMat4(const DMat4& mat)
+    {
+        Mat4 result;
+        for (int i = 0; i < 4; ++i) result[i] = CreateVec4(mat[i]);
+        return result;
+    }
+    
+#ifdef GMATH_USE_AVX
+    static inline __m256d LinearCombineAVX(const DVec4& left, const DMat4& right)
+    {
+        __m256d result;
+        result = _mm256_mul_pd(_mm256_set1_pd(left.x), _mm256_loadu_pd(right.columns[0].data));
+        result = _mm256_fmadd_pd(_mm256_set1_pd(left.y), _mm256_loadu_pd(right.columns[1].data), result);
+        result = _mm256_fmadd_pd(_mm256_set1_pd(left.z), _mm256_loadu_pd(right.columns[2].data), result);
+        result = _mm256_fmadd_pd(_mm256_set1_pd(left.w), _mm256_loadu_pd(right.columns[3].data), result);
+        return result;
+    }
+#elif defined(GMATH_USE_SSE)
+    static inline void LinearCombineSSE(const DVec4& left, const DMat4& right, DVec4& result)
+    {
+        for (int i = 0; i < 2; ++i)
+        {
+            __m128d half = _mm_mul_pd(_mm_set1_pd(left.x), right.columns[0].data_sse[i]);
+            half = MultiplyAddSSE(_mm_set1_pd(left.y), right.columns[1].data_sse[i], half);
+            half = MultiplyAddSSE(_mm_set1_pd(left.z), right.columns[2].data_sse[i], half);
+            result.data_sse[i] = MultiplyAddSSE(_mm_set1_pd(left.w), right.columns[3].data_sse[i], half);
+        }
+    }
+#elif defined(GMATH_USE_NEON)
+    static inline void LinearCombineNEON(const DVec4& left, const DMat4& right, DVec4& result)
+    {
+        for (int i = 0; i < 2; ++i)
+        {
+            float64x2_t half = vmulq_n_f64(right.columns[0].data_neon[i], left.x);
+            half = vfmaq_n_f64(half, right.columns[1].data_neon[i], left.y);
+            half = vfmaq_n_f64(half, right.columns[2].data_neon[i], left.z);
+            result.data_neon[i] = vfmaq_n_f64(half, right.columns[3].data_neon[i], left.w);
+        }
+    }
+#endif
+    
+    DMat4 GMATH_CALL operator*(const DMat4& a, const DMat4& b)
+    {
+        DMat4 result;
+        for (int i = 0; i < 4; ++i)
+        {
+#ifdef GMATH_USE_AVX
+            _mm256_storeu_pd(result.columns[i].data, LinearCombineAVX(b.columns[i], a));
+#elif defined(GMATH_USE_SSE)
+            LinearCombineSSE(b.columns[i], a, result.columns[i]);
+#elif defined(GMATH_USE_NEON)
+            LinearCombineNEON(b.columns[i], a, result.columns[i]);
+#else
+            for (int j = 0; j < 4; ++j)
+            {
+                result[i][j] = a[0][j] * b[i][0] + a[1][j] * b[i][1] + a[2][j] * b[i][2] + a[3][j] * b[i][3];
+            }
+#endif
+        }
+        return result;
+    }
+    
+    DVec4 GMATH_CALL operator*(const DMat4& mat, const DVec4& vec)
+    {
+        DVec4 result;
+#ifdef GMATH_USE_AVX
+        _mm256_storeu_pd(result.data, LinearCombineAVX(vec, mat));
+#elif defined(GMATH_USE_SSE)
+        LinearCombineSSE(vec, mat, result);
+#elif defined(GMATH_USE_NEON)
+        LinearCombineNEON(vec, mat, result);
+#else
+        for (int i = 0; i < 4; ++i)
+        {
+            result[i] = mat[0][i] * vec[0] + mat[1][i] * vec[1] + mat[2][i] * vec[2] + mat[3][i] * vec[3];
+        }
+#endif
+        return result;
+    }
+    
+    DVec3 GMATH_CALL TransformPoint(const DMat4& mat, DVec3 point)
+    {
+        return (mat * CreateDVec4(point, 1.0)).xyz;
+    }
+    
+    DVec3 GMATH_CALL TransformDirection(const DMat4& mat, DVec3 direction)
+    {
+        return (mat * CreateDVec4(direction, 0.0)).xyz;
+    }
+    
+    // Camera relative rendering.
+    
+    Vec3 MakeRelative(DVec3 point, DVec3 origin)
+    {
+        return CreateVec3(point - origin);
+    }
+    
+    Mat4 GMATH_CALL MakeRelative(const DMat4& transform, DVec3 origin)
+    {
+        Mat4 result = CreateMat4(transform);
+        result[3].xyz = CreateVec3(transform[3].xyz - origin * transform[3].w);
+        return result;
+    }
+    
+#ifdef GMATH_IMPLEMENTATION
+    // Four DVec3s are twelve doubles, which convert to exactly three registers
+    // of floats, so the points are handled in their packed layout. The origin
+    // is repeated to line up with them (x y z x | y z x y | z x y z).
+#ifdef GMATH_USE_SSE
+    static inline void MakeRelativeSSE(const DVec3* points, DVec3 origin, Vec3* out, size_t count)
+    {
+        __m128d origins[3] = {_mm_setr_pd(origin.x, origin.y), _mm_setr_pd(origin.z, origin.x), _mm_setr_pd(origin.y, origin.z)};
+        for (size_t block = 0; block < count; block += 4)
+        {
+            const double* in = points[block].data;
+            float* dest = out[block].data;
+            for (int j = 0; j < 3; ++j)
+            {
+                __m128 low = _mm_cvtpd_ps(_mm_sub_pd(_mm_loadu_pd(in + j * 4), origins[(j * 2) % 3]));
+                __m128 high = _mm_cvtpd_ps(_mm_sub_pd(_mm_loadu_pd(in + j * 4 + 2), origins[(j * 2 + 1) % 3]));
+                _mm_storeu_ps(dest + j * 4, _mm_movelh_ps(low, high));
+            }
+        }
+    }
+#endif
+    
+#ifdef GMATH_AVX_KERNELS
+    static inline GMATH_TARGET_AVX void MakeRelativeAVX(const DVec3* points, DVec3 origin, Vec3* out, size_t count)
+    {
+        __m256d origin_0 = _mm256_setr_pd(origin.x, origin.y, origin.z, origin.x);
+        __m256d origin_1 = _mm256_setr_pd(origin.y, origin.z, origin.x, origin.y);
+        __m256d origin_2 = _mm256_setr_pd(origin.z, origin.x, origin.y, origin.z);
+        for (size_t block = 0; block < count; block += 4)
+        {
+            const double* in = points[block].data;
+            float* dest = out[block].data;
+            _mm_storeu_ps(dest, _mm256_cvtpd_ps(_mm256_sub_pd(_mm256_loadu_pd(in), origin_0)));
+            _mm_storeu_ps(dest + 4, _mm256_cvtpd_ps(_mm256_sub_pd(_mm256_loadu_pd(in + 4), origin_1)));
+            _mm_storeu_ps(dest + 8, _mm256_cvtpd_ps(_mm256_sub_pd(_mm256_loadu_pd(in + 8), origin_2)));
+        }
+    }
+#endif
+    
+    void GMATH_CALL MakeRelativeBatch(const DVec3* points, DVec3 origin, Vec3* out, size_t count)
+    {
+        size_t i = 0;
+#if defined(GMATH_AVX_KERNELS)
+        i = count & ~(size_t)3;
+        if (UseAVX()) MakeRelativeAVX(points, origin, out, i);
+        else MakeRelativeSSE(points, origin, out, i);
+#elif defined(GMATH_USE_SSE)
+        i = count & ~(size_t)3;
+        MakeRelativeSSE(points, origin, out, i);
+#elif defined(GMATH_USE_NEON)
+        float64x2_t origins[3] = {SetNEON(origin.x, origin.y), SetNEON(origin.z, origin.x), SetNEON(origin.y, origin.z)};
+        i = count & ~(size_t)3;
+        for (size_t block = 0; block < i; block += 4)
+        {
+            const double* in = points[block].data;
+            float* dest = out[block].data;
+            for (int j = 0; j < 3; ++j)
+            {
+                float32x2_t low = vcvt_f32_f64(vsubq_f64(vld1q_f64(in + j * 4), origins[(j * 2) % 3]));
+                float32x4_t both = vcvt_high_f32_f64(low, vsubq_f64(vld1q_f64(in + j * 4 + 2), origins[(j * 2 + 1) % 3]));
+                vst1q_f32(dest + j * 4, both);
+            }
+        }
+#endif
+        for (; i < count; ++i) out[i] = MakeRelative(points[i], origin);
+    }
+#endif // GMATH_IMPLEMENTATION
+    
+    // Integer vector math. SSE2 lacks a few of the 32 bit integer operations
+    // (multiply, min, max and abs come with SSE4.1), so those are emulated
+    // unless AVX is enabled.
+    
+#ifdef GMATH_USE_SSE
+    static inline __m128i MultiplySSE(__m128i a, __m128i b)
+    {
+#ifdef GMATH_USE_AVX
+        return _mm_mullo_epi32(a, b);
+#else
+        __m128i even = _mm_mul_epu32(a, b);
+        __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+        return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+#endif
+    }
+    
+    // The truncated quotient of two 32 bit integers is exact in double
+    // precision (it is never within 2^-31 of an integer without being one),
+    // and so is the remainder a - q * b. Remainders with the opposite sign to
+    // b are then moved into b's range.
+    static inline __m128i ModSSE(__m128i a, __m128i b)
+    {
+        __m128i remainder;
+#ifdef GMATH_USE_AVX
+        __m256d a_wide = _mm256_cvtepi32_pd(a);
+        __m256d b_wide = _mm256_cvtepi32_pd(b);
+        __m256d quotient = _mm256_round_pd(_mm256_div_pd(a_wide, b_wide), _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+        remainder = _mm256_cvttpd_epi32(_mm256_fnmadd_pd(quotient, b_wide, a_wide));
+#else
+        __m128d a_low = _mm_cvtepi32_pd(a);
+        __m128d b_low = _mm_cvtepi32_pd(b);
+        __m128d a_high = _mm_cvtepi32_pd(_mm_shuffle_epi32(a, _MM_SHUFFLE(3, 2, 3, 2)));
+        __m128d b_high = _mm_cvtepi32_pd(_mm_shuffle_epi32(b, _MM_SHUFFLE(3, 2, 3, 2)));
+        __m128d quotient_low = _mm_cvtepi32_pd(_mm_cvttpd_epi32(_mm_div_pd(a_low, b_low)));
+        __m128d quotient_high = _mm_cvtepi32_pd(_mm_cvttpd_epi32(_mm_div_pd(a_high, b_high)));
+        __m128i remainder_low = _mm_cvttpd_epi32(_mm_sub_pd(a_low, _mm_mul_pd(quotient_low, b_low)));
+        __m128i remainder_high = _mm_cvttpd_epi32(_mm_sub_pd(a_high, _mm_mul_pd(quotient_high, b_high)));
+        remainder = _mm_unpacklo_epi64(remainder_low, remainder_high);
+        // INT_MIN / -1 = 2^31 doesn't convert back to an int, so b = -1 (which
+        // always leaves 0) is masked out. The AVX and NEON quotients stay in
+        // double and get 0 anyway.
+        remainder = _mm_andnot_si128(_mm_cmpeq_epi32(b, _mm_set1_epi32(-1)), remainder);
+#endif
+        __m128i opposite = _mm_srai_epi32(_mm_xor_si128(remainder, b), 31);
+        __m128i wrap = _mm_andnot_si128(_mm_cmpeq_epi32(remainder, _mm_setzero_si128()), opposite);
+        return _mm_add_epi32(remainder, _mm_and_si128(wrap, b));
+    }
+#endif
+    
+#ifdef GMATH_USE_NEON
+    static inline int32x4_t ModNEON(int32x4_t a, int32x4_t b)
+    {
+        float64x2_t a_low = vcvtq_f64_s64(vmovl_s32(vget_low_s32(a)));
+        float64x2_t b_low = vcvtq_f64_s64(vmovl_s32(vget_low_s32(b)));
+        float64x2_t a_high = vcvtq_f64_s64(vmovl_high_s32(a));
+        float64x2_t b_high = vcvtq_f64_s64(vmovl_high_s32(b));
+        float64x2_t quotient_low = vrndq_f64(vdivq_f64(a_low, b_low));
+        float64x2_t quotient_high = vrndq_f64(vdivq_f64(a_high, b_high));
+        int32x2_t remainder_low = vmovn_s64(vcvtq_s64_f64(vfmsq_f64(a_low, quotient_low, b_low)));
+        int32x4_t remainder = vmovn_high_s64(remainder_low, vcvtq_s64_f64(vfmsq_f64(a_high, quotient_high, b_high)));
+        uint32x4_t wrap = vandq_u32(vtstq_s32(remainder, remainder), vcltq_s32(veorq_s32(remainder, b), vdupq_n_s32(0)));
+        return vaddq_s32(remainder, vandq_s32(vreinterpretq_s32_u32(wrap), b));
+    }
+#endif
+    
+    IVec4 GMATH_CALL CreateIVec4(int fill)
+    {
+        IVec4 vec;
+#ifdef GMATH_USE_SSE
+        vec.data_sse = _mm_set1_epi32(fill);
+#elif defined(GMATH_USE_NEON)
+        vec.data_neon = vdupq_n_s32(fill);
+#else
+        vec = {fill, fill, fill, fill};
+#endif
+        return vec;
+    }
+    
+    IVec4 GMATH_CALL CreateIVec4(IVec3 xyz, int w)
+    {
+        return CreateIVec4(xyz.x, xyz.y, xyz.z, w);
+    }
+    
+    IVec4 GMATH_CALL CreateIVec4(int x, int y, int z, int w)
+    {
+        IVec4 vec;
+#ifdef GMATH_USE_SSE
+        vec.data_sse = _mm_setr_epi32(x, y, z, w);
+#else
+        vec = {x, y, z, w};
+#endif
+        return vec;
+    }
+    
+    IVec4 GMATH_CALL operator-(const IVec4& vec)
+    {
+        IVec4 result;
+#ifdef GMATH_USE_SSE
+        result.data_sse = _mm_sub_epi32(_mm_setzero_si128(), vec.data_sse);
+#elif defined(GMATH_USE_NEON)
+        result.data_neon = vnegq_s32(vec.data_neon);
+#else
+        result = {-vec.x, -vec.y, -vec.z, -vec.w};
+#endif
+        return result;
+    }
+    
+    IVec4 GMATH_CALL operator+(const IVec4& a, const IVec4& b)
+    {
+        IVec4 result;
+#ifdef GMATH_USE_SSE
+        result.data_sse = _mm_add_epi32(a.data_sse, b.data_sse);
+#elif defined(GMATH_USE_NEON)
+        result.data_neon = vaddq_s32(a.data_neon, b.data_neon);
+#else
+        result = {a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w};
+#endif
+        return result;
+    }
+    
+    IVec4 GMATH_CALL operator-(const IVec4& a, const IVec4& b)
+    {
+        IVec4 result;
+#ifdef GMATH_USE_SSE
+        result.data_sse = _mm_sub_epi32(a.data_sse, b.data_sse);
+#elif defined(GMATH_USE_NEON)
+        result.data_neon = vsubq_s32(a.data_neon, b.data_neon);
+#else
+        result = {a.x - b.x, a.y - b.y, a.z - b.z, a.w - b.w};
+#endif
+        return result;
+    }
+    
+    IVec4 GMATH_CALL operator*(const IVec4& a, const IVec4& b)
+    {
+        IVec4 result;
+#ifdef GMATH_USE_SSE
+        result.data_sse = MultiplySSE(a.data_sse, b.data_sse);
+#elif defined(GMATH_USE_NEON)
+        result.data_neon = vmulq_s32(a.data_neon, b.data_neon);
+#else
+        result = {a.x * b.x, a.y * b.y, a.z * b.z, a.w * b.w};
+#endif
+        return result;
+    }
+    
+    IVec4 GMATH_CALL operator+(const IVec4& a, int b)
+    {
+        return a + CreateIVec4(b);
+    }
+    
+    IVec4 GMATH_CALL operator-(const IVec4& a, int b)
+    {
+        return a - CreateIVec4(b);
+    }
+    
+    IVec4 GMATH_CALL operator*(const IVec4& a, int b)
+    {
+        return a * CreateIVec4(b);
+    }
+    
+    IVec4 GMATH_CALL operator&(const IVec4& a, const IVec4& b)
+    {
+        IVec4 result;
+#ifdef GMATH_USE_SSE
+        result.data_sse = _mm_and_si128(a.data_sse, b.data_sse);
+#elif defined(GMATH_USE_NEON)
+        result.data_neon = vandq_s32(a.data_neon, b.data_neon);
+#else
+        result = {a.x & b.x, a.y & b.y, a.z & b.z, a.w & b.w};
+#endif
+        return result;
+    }
+    
+    IVec4 GMATH_CALL operator|(const IVec4& a, const IVec4& b)
+    {
+        IVec4 result;
+#ifdef GMATH_USE_SSE
+        result.data_sse = _mm_or_si128(a.data_sse, b.data_sse);
+#elif defined(GMATH_USE_NEON)
+        result.data_neon = vorrq_s32(a.data_neon, b.data_neon);
+#else
+        result = {a.x | b.x, a.y | b.y, a.z | b.z, a.w | b.w};
+#endif
+        return result;
+    }
+    
+    IVec4 GMATH_CALL operator^(const IVec4& a, const IVec4& b)
+    {
+        IVec4 result;
+#ifdef GMATH_USE_SSE
+        result.data_sse = _mm_xor_si128(a.data_sse, b.data_sse);
+#elif defined(GMATH_USE_NEON)
+        result.data_neon = veorq_s32(a.data_neon, b.data_neon);
+#else
+        result = {a.x ^ b.x, a.y ^ b.y, a.z ^ b.z, a.w ^ b.w};
+#endif
+        return result;
+    }
+    
+    IVec4 GMATH_CALL operator<<(const IVec4& a, int shift)
+    {
+        IVec4 result;
+#ifdef GMATH_USE_SSE
+        result.data_sse = _mm_sll_epi32(a.data_sse, _mm_cvtsi32_si128(shift));
+#elif defined(GMATH_USE_NEON)
+        result.data_neon = vshlq_s32(a.data_neon, vdupq_n_s32(shift));
+#else
+        for (int i = 0; i < 4; ++i) result[i] = (int)((unsigned)a[i] << shift);
+#endif
+        return result;
+    }
+    
+    IVec4 GMATH_CALL operator>>(const IVec4& a, int shift)
+    {
+        IVec4 result;
+#ifdef GMATH_USE_SSE
+        result.data_sse = _mm_sra_epi32(a.data_sse, _mm_cvtsi32_si128(shift));
+#elif defined(GMATH_USE_NEON)
+        result.data_neon = vshlq_s32(a.data_neon, vdupq_n_s32(-shift));
+#else
+        for (int i = 0; i < 4; ++i) result[i] = a[i] >> shift;
+#endif
+        return result;
+    }
+    
+    bool GMATH_CALL operator==(const IVec4& a, const IVec4& b)
+    {
+#ifdef GMATH_USE_SSE
+        return _mm_movemask_epi8(_mm_cmpeq_epi32(a.data_sse, b.data_sse)) == 0xffff;
+#elif defined(GMATH_USE_NEON)
+        return vminvq_u32(vceqq_s32(a.data_neon, b.data_neon)) != 0;
+#else
+        return a.x == b.x && a.y == b.y && a.z == b.z && a.w == b.w;
+#endif
+    }
+    
+    IVec4 GMATH_CALL Min(const IVec4& a, const IVec4& b)
+    {
+        IVec4 result;
+#if defined(GMATH_USE_AVX)
+        result.data_sse = _mm_min_epi32(a.data_sse, b.data_sse);
+#elif defined(GMATH_USE_SSE)
+        result.data_sse = SelectSSE(_mm_cmpgt_epi32(a.data_sse, b.data_sse), b.data_sse, a.data_sse);
+#elif defined(GMATH_USE_NEON)
+        result.data_neon = vminq_s32(a.data_neon, b.data_neon);
+#else
+        for (int i = 0; i < 4; ++i) result[i] = GMATH_MIN(a[i], b[i]);
+#endif
+        return result;
+    }
+    
+    IVec4 GMATH_CALL Max(const IVec4& a, const IVec4& b)
+    {
+        IVec4 result;
+#if defined(GMATH_USE_AVX)
+        result.data_sse = _mm_max_epi32(a.data_sse, b.data_sse);
+#elif defined(GMATH_USE_SSE)
+        result.data_sse = SelectSSE(_mm_cmpgt_epi32(a.data_sse, b.data_sse), a.data_sse, b.data_sse);
+#elif defined(GMATH_USE_NEON)
+        result.data_neon = vmaxq_s32(a.data_neon, b.data_neon);
+#else
+        for (int i = 0; i < 4; ++i) result[i] = GMATH_MAX(a[i], b[i]);
+#endif
+        return result;
+    }
+    
+    IVec4 GMATH_CALL Abs(const IVec4& vec)
+    {
+        IVec4 result;
+#if defined(GMATH_USE_AVX)
+        result.data_sse = _mm_abs_epi32(vec.data_sse);
+#elif defined(GMATH_USE_SSE)
+        __m128i sign = _mm_srai_epi32(vec.data_sse, 31);
+        result.data_sse = _mm_sub_epi32(_mm_xor_si128(vec.data_sse, sign), sign);
+#elif defined(GMATH_USE_NEON)
+        result.data_neon = vabsq_s32(vec.data_neon);
+#else
+        for (int i = 0; i < 4; ++i) result[i] = GMATH_ABS(vec[i]);
+#endif
+        return result;
+    }
+    
+    IVec4 GMATH_CALL Mod(const IVec4& a, const IVec4& b)
+    {
+        IVec4 result;
+#ifdef GMATH_USE_SSE
+        result.data_sse = ModSSE(a.data_sse, b.data_sse);
+#elif defined(GMATH_USE_NEON)
+        result.data_neon = ModNEON(a.data_neon, b.data_neon);
+#else
+        for (int i = 0; i < 4; ++i) result[i] = Mod(a[i], b[i]);
+#endif
+        return result;
+    }
+    
+    IVec4 GMATH_CALL Mod(const IVec4& a, int b)
+    {
+        return Mod(a, CreateIVec4(b));
+    }
+    
+    IVec4 GMATH_CALL CreateIVec4(const Vec4& vec)
+    {
+        IVec4 result;
+#ifdef GMATH_USE_SSE
+        result.data_sse = _mm_cvttps_epi32(vec.data_sse);
+#elif defined(GMATH_USE_NEON)
+        result.data_neon = vcvtq_s32_f32(vec.data_neon);
+#else
+        result = {(int)vec.x, (int)vec.y, (int)vec.z, (int)vec.w};
+#endif
+        return result;
+    }
+    
+    Vec4 GMATH_CALL CreateVec4(const IVec4& vec)
+    {
+        Vec4 result;
+#ifdef GMATH_USE_SSE
+        result.data_sse = _mm_cvtepi32_ps(vec.data_sse);
+#elif defined(GMATH_USE_NEON)
+        result.data_neon = vcvtq_f32_s32(vec.data_neon);
+#else
+        result = {(float)vec.x, (float)vec.y, (float)vec.z, (float)vec.w};
+#endif
+        return result;
+    }
+    
+    // Values past the int range saturate and NaN gives 0, as NEON's
+    // conversion does, rather than leaving them to the cast.
+    static inline int FloorToIntScalar(float val)
+    {
+        if (!(val > -2147483648.0f))
+        {
+            return val == val ? (int)0x80000000u : 0;
+        }
+        if (val >= 2147483648.0f)
+        {
+            return 0x7fffffff;
+        }
+        int truncated = (int)val;
+        return (float)truncated > val ? truncated - 1 : truncated;
+    }
+    
+    IVec4 GMATH_CALL FloorToInt(const Vec4& vec)
+    {
+        IVec4 result;
+#ifdef GMATH_USE_SSE
+        // Truncation rounds negative values up, so step those back by one
+        // (adding the all ones mask) wherever that moved them. Out of range
+        // lanes convert to INT_MIN: the clamp at -2^31 keeps the step from
+        // wrapping those below, flipping every bit makes those above INT_MAX,
+        // and NaN lanes are masked to 0, matching FloorToIntScalar and NEON.
+        __m128 val = _mm_max_ps(vec.data_sse, _mm_set1_ps(-2147483648.0f));
+        __m128i truncated = _mm_cvttps_epi32(val);
+        __m128 moved_up = _mm_cmpgt_ps(_mm_cvtepi32_ps(truncated), val);
+        __m128i floor = _mm_add_epi32(truncated, _mm_castps_si128(moved_up));
+        floor = _mm_xor_si128(floor, _mm_castps_si128(_mm_cmpge_ps(val, _mm_set1_ps(2147483648.0f))));
+        result.data_sse = _mm_and_si128(floor, _mm_castps_si128(_mm_cmpord_ps(vec.data_sse, vec.data_sse)));
+#elif defined(GMATH_USE_NEON)
+        result.data_neon = vcvtmq_s32_f32(vec.data_neon);
+#else
+        for (int i = 0; i < 4; ++i) result[i] = FloorToIntScalar(vec[i]);
+#endif
+        return result;
+    }
+    
+    // IVec3 SoA packet math. IVec3s have the same layout as Vec3s, so the
+    // packed loads and stores reuse the Vec3 shuffles.
+    
+    IVec3x4 GMATH_CALL LoadIVec3x4(const IVec3* in)
+    {
+        IVec3x4 result;
+#ifdef GMATH_USE_SSE
+        Vec3x4 points = LoadVec3x4((const Vec3*)in);
+        for (int i = 0; i < 3; ++i) result.data[i].data_sse = _mm_castps_si128(points.data[i].data_sse);
+#elif defined(GMATH_USE_NEON)
+        int32x4x3_t lanes = vld3q_s32(in->data);
+        for (int i = 0; i < 3; ++i) result.data[i].data_neon = lanes.val[i];
+#else
+        for (int i = 0; i < 4; ++i) result.Set(i, in[i]);
+#endif
+        return result;
+    }
+    
+    void GMATH_CALL StoreIVec3x4(IVec3x4 packet, IVec3* out)
+    {
+#ifdef GMATH_USE_SSE
+        Vec3x4 points;
+        for (int i = 0; i < 3; ++i) points.data[i].data_sse = _mm_castsi128_ps(packet.data[i].data_sse);
+        StoreVec3x4(points, (Vec3*)out);
+#elif defined(GMATH_USE_NEON)
+        int32x4x3_t lanes;
+        for (int i = 0; i < 3; ++i) lanes.val[i] = packet.data[i].data_neon;
+        vst3q_s32(out->data, lanes);
+#else
+        for (int i = 0; i < 4; ++i) out[i] = packet.Get(i);
+#endif
+    }
+    
+    IVec3x4 GMATH_CALL operator+(IVec3x4 a, IVec3x4 b)
+    {
+        IVec3x4 result;
+        for (int i = 0; i < 3; ++i) result.data[i] = a.data[i] + b.data[i];
+        return result;
+    }
+    
+    IVec3x4 GMATH_CALL operator-(IVec3x4 a, IVec3x4 b)
+    {
+        IVec3x4 result;
+        for (int i = 0; i < 3; ++i) result.data[i] = a.data[i] - b.data[i];
+        return result;
+    }
+    
+    IVec3x4 GMATH_CALL operator*(IVec3x4 a, IVec3x4 b)
+    {
+        IVec3x4 result;
+        for (int i = 0; i < 3; ++i) result.data[i] = a.data[i] * b.data[i];
+        return result;
+    }
+    
+    IVec3x4 GMATH_CALL operator*(IVec3x4 a, int b)
+    {
+        IVec3x4 result;
+        IVec4 scalar = CreateIVec4(b);
+        for (int i = 0; i < 3; ++i) result.data[i] = a.data[i] * scalar;
+        return result;
+    }
+    
+    IVec3x4 GMATH_CALL Min(IVec3x4 a, IVec3x4 b)
+    {
+        IVec3x4 result;
+        for (int i = 0; i < 3; ++i) result.data[i] = Min(a.data[i], b.data[i]);
+        return result;
+    }
+    
+    IVec3x4 GMATH_CALL Max(IVec3x4 a, IVec3x4 b)
+    {
+        IVec3x4 result;
+        for (int i = 0; i < 3; ++i) result.data[i] = Max(a.data[i], b.data[i]);
+        return result;
+    }
+    
+    IVec3x4 GMATH_CALL Mod(IVec3x4 a, IVec3 b)
+    {
+        IVec3x4 result;
+        for (int i = 0; i < 3; ++i) result.data[i] = Mod(a.data[i], b[i]);
+        return result;
+    }
+    
+    IVec3x4 GMATH_CALL CreateIVec3x4(Vec3x4 packet)
+    {
+        IVec3x4 result;
+        for (int i = 0; i < 3; ++i) result.data[i] = CreateIVec4(packet.data[i]);
+        return result;
+    }
+    
+    IVec3x4 GMATH_CALL FloorToInt(Vec3x4 packet)
+    {
+        IVec3x4 result;
+        for (int i = 0; i < 3; ++i) result.data[i] = FloorToInt(packet.data[i]);
+        return result;
+    }
+    
+    Vec3x4 GMATH_CALL CreateVec3x4(IVec3x4 packet)
+    {
+        Vec3x4 result;
+        for (int i = 0; i < 3; ++i) result.data[i] = CreateVec4(packet.data[i]);
+        return result;
+    }
+    
+    // Morton codes. Each spread moves the bits of a coordinate apart by
+    // doubling the distance between groups of them, a standard bit trick; the
+    // compacts undo it. The SIMD versions are the same steps on four lanes.
+    
+    static inline uint32_t SpreadBits2(uint32_t val)
+    {
+        val &= 0x0000ffff;
+        val = (val | (val << 8)) & 0x00ff00ff;
+        val = (val | (val << 4)) & 0x0f0f0f0f;
+        val = (val | (val << 2)) & 0x33333333;
+        val = (val | (val << 1)) & 0x55555555;
+        return val;
+    }
+    
+    static inline uint32_t CompactBits2(uint32_t val)
+    {
+        val &= 0x55555555;
+        val = (val | (val >> 1)) & 0x33333333;
+        val = (val | (val >> 2)) & 0x0f0f0f0f;
+        val = (val | (val >> 4)) & 0x00ff00ff;
+        val = (val | (val >> 8)) & 0x0000ffff;
+        return val;
+    }
+    
+    static inline uint32_t SpreadBits3(uint32_t val)
+    {
+        val &= 0x000003ff;
+        val = (val | (val << 16)) & 0x030000ff;
+        val = (val | (val << 8)) & 0x0300f00f;
+        val = (val | (val << 4)) & 0x030c30c3;
+        val = (val | (val << 2)) & 0x09249249;
+        return val;
+    }
+    
+    static inline uint32_t CompactBits3(uint32_t val)
+    {
+        val &= 0x09249249;
+        val = (val | (val >> 2)) & 0x030c30c3;
+        val = (val | (val >> 4)) & 0x0300f00f;
+        val = (val | (val >> 8)) & 0x030000ff;
+        val = (val | (val >> 16)) & 0x000003ff;
+        return val;
+    }
+    
+#ifdef GMATH_USE_SSE
+    static inline __m128i SpreadBits3SSE(__m128i val)
+    {
+        val = _mm_and_si128(val, _mm_set1_epi32(0x000003ff));
+        val = _mm_and_si128(_mm_or_si128(val, _mm_slli_epi32(val, 16)), _mm_set1_epi32(0x030000ff));
+        val = _mm_and_si128(_mm_or_si128(val, _mm_slli_epi32(val, 8)), _mm_set1_epi32(0x0300f00f));
+        val = _mm_and_si128(_mm_or_si128(val, _mm_slli_epi32(val, 4)), _mm_set1_epi32(0x030c30c3));
+        val = _mm_and_si128(_mm_or_si128(val, _mm_slli_epi32(val, 2)), _mm_set1_epi32(0x09249249));
+        return val;
+    }
+    
+    static inline __m128i CompactBits3SSE(__m128i val)
+    {
+        val = _mm_and_si128(val, _mm_set1_epi32(0x09249249));
+        val = _mm_and_si128(_mm_or_si128(val, _mm_srli_epi32(val, 2)), _mm_set1_epi32(0x030c30c3));
+        val = _mm_and_si128(_mm_or_si128(val, _mm_srli_epi32(val, 4)), _mm_set1_epi32(0x0300f00f));
+        val = _mm_and_si128(_mm_or_si128(val, _mm_srli_epi32(val, 8)), _mm_set1_epi32(0x030000ff));
+        val = _mm_and_si128(_mm_or_si128(val, _mm_srli_epi32(val, 16)), _mm_set1_epi32(0x000003ff));
+        return val;
+    }
+#endif
+    
+#ifdef GMATH_USE_NEON
+    static inline uint32x4_t SpreadBits3NEON(uint32x4_t val)
+    {
+        val = vandq_u32(val, vdupq_n_u32(0x000003ff));
+        val = vandq_u32(vorrq_u32(val, vshlq_n_u32(val, 16)), vdupq_n_u32(0x030000ff));
+        val = vandq_u32(vorrq_u32(val, vshlq_n_u32(val, 8)), vdupq_n_u32(0x0300f00f));
+        val = vandq_u32(vorrq_u32(val, vshlq_n_u32(val, 4)), vdupq_n_u32(0x030c30c3));
+        val = vandq_u32(vorrq_u32(val, vshlq_n_u32(val, 2)), vdupq_n_u32(0x09249249));
+        return val;
+    }
+    
+    static inline uint32x4_t CompactBits3NEON(uint32x4_t val)
+    {
+        val = vandq_u32(val, vdupq_n_u32(0x09249249));
+        val = vandq_u32(vorrq_u32(val, vshrq_n_u32(val, 2)), vdupq_n_u32(0x030c30c3));
+        val = vandq_u32(vorrq_u32(val, vshrq_n_u32(val, 4)), vdupq_n_u32(0x0300f00f));
+        val = vandq_u32(vorrq_u32(val, vshrq_n_u32(val, 8)), vdupq_n_u32(0x030000ff));
+        val = vandq_u32(vorrq_u32(val, vshrq_n_u32(val, 16)), vdupq_n_u32(0x000003ff));
+        return val;
+    }
+#endif
+    
+    uint32_t EncodeMorton(IVec2 coords)
+    {
+        return SpreadBits2((uint32_t)coords.x) | (SpreadBits2((uint32_t)coords.y) << 1);
+    }
+    
+    uint32_t EncodeMorton(IVec3 coords)
+    {
+        return SpreadBits3((uint32_t)coords.x) | (SpreadBits3((uint32_t)coords.y) << 1) | (SpreadBits3((uint32_t)coords.z) << 2);
+    }
+    
+    IVec2 DecodeMorton2(uint32_t code)
+    {
+        return {(int)CompactBits2(code), (int)CompactBits2(code >> 1)};
+    }
+    
+    IVec3 DecodeMorton3(uint32_t code)
+    {
+        return {(int)CompactBits3(code), (int)CompactBits3(code >> 1), (int)CompactBits3(code >> 2)};
+    }
+    
+    IVec4 GMATH_CALL EncodeMorton(IVec3x4 coords)
+    {
+        IVec4 result;
+#ifdef GMATH_USE_SSE
+        __m128i code = SpreadBits3SSE(coords.x.data_sse);
+        code = _mm_or_si128(code, _mm_slli_epi32(SpreadBits3SSE(coords.y.data_sse), 1));
+        result.data_sse = _mm_or_si128(code, _mm_slli_epi32(SpreadBits3SSE(coords.z.data_sse), 2));
+#elif defined(GMATH_USE_NEON)
+        uint32x4_t code = SpreadBits3NEON(vreinterpretq_u32_s32(coords.x.data_neon));
+        code = vorrq_u32(code, vshlq_n_u32(SpreadBits3NEON(vreinterpretq_u32_s32(coords.y.data_neon)), 1));
+        code = vorrq_u32(code, vshlq_n_u32(SpreadBits3NEON(vreinterpretq_u32_s32(coords.z.data_neon)), 2));
+        result.data_neon = vreinterpretq_s32_u32(code);
+#else
+        for (int i = 0; i < 4; ++i) result[i] = (int)EncodeMorton(coords.Get(i));
+#endif
+        return result;
+    }
+    
+    IVec3x4 GMATH_CALL DecodeMorton3(const IVec4& codes)
+    {
+        IVec3x4 result;
+#ifdef GMATH_USE_SSE
+        result.x.data_sse = CompactBits3SSE(codes.data_sse);
+        result.y.data_sse = CompactBits3SSE(_mm_srli_epi32(codes.data_sse, 1));
+        result.z.data_sse = CompactBits3SSE(_mm_srli_epi32(codes.data_sse, 2));
+#elif defined(GMATH_USE_NEON)
+        uint32x4_t code = vreinterpretq_u32_s32(codes.data_neon);
+        result.x.data_neon = vreinterpretq_s32_u32(CompactBits3NEON(code));
+        result.y.data_neon = vreinterpretq_s32_u32(CompactBits3NEON(vshrq_n_u32(code, 1)));
+        result.z.data_neon = vreinterpretq_s32_u32(CompactBits3NEON(vshrq_n_u32(code, 2)));
+#else
+        for (int i = 0; i < 4; ++i) result.Set(i, DecodeMorton3((uint32_t)codes[i]));
+#endif
+        return result;
+    }
+    
+#ifdef GMATH_IMPLEMENTATION
+    void GMATH_CALL EncodeMortonBatch(const IVec3* in, uint32_t* out, size_t count)
+    {
+        size_t i = 0;
+#if defined(GMATH_USE_SSE) || defined(GMATH_USE_NEON)
+        i = count & ~(size_t)3;
+        for (size_t block = 0; block < i; block += 4)
+        {
+            IVec4 codes = EncodeMorton(LoadIVec3x4(in + block));
+#ifdef GMATH_USE_SSE
+            _mm_storeu_si128((__m128i*)(out + block), codes.data_sse);
+#else
+            vst1q_u32(out + block, vreinterpretq_u32_s32(codes.data_neon));
+#endif
+        }
+#endif
+        for (; i < count; ++i) out[i] = EncodeMorton(in[i]);
+    }
+    
+    void GMATH_CALL DecodeMortonBatch(const uint32_t* in, IVec3* out, size_t count)
+    {
+        size_t i = 0;
+#if defined(GMATH_USE_SSE) || defined(GMATH_USE_NEON)
+        i = count & ~(size_t)3;
+        for (size_t block = 0; block < i; block += 4)
+        {
+            IVec4 codes;
+#ifdef GMATH_USE_SSE
+            codes.data_sse = _mm_loadu_si128((const __m128i*)(in + block));
+#else
+            codes.data_neon = vreinterpretq_s32_u32(vld1q_u32(in + block));
+#endif
+            StoreIVec3x4(DecodeMorton3(codes), out + block);
+        }
+#endif
+        for (; i < count; ++i) out[i] = DecodeMorton3(in[i]);
+    }
+#endif // GMATH_IMPLEMENTATION
+    
+    // The same tricks for 21 bits in 64, and on two lanes of 64 bits.
+    
+    static inline uint64_t SpreadBits3x64(uint64_t val)
+    {
+        val &= 0x00000000001fffffull;
+        val = (val | (val << 32)) & 0x001f00000000ffffull;
+        val = (val | (val << 16)) & 0x001f0000ff0000ffull;
+        val = (val | (val << 8)) & 0x100f00f00f00f00full;
+        val = (val | (val << 4)) & 0x10c30c30c30c30c3ull;
+        val = (val | (val << 2)) & 0x1249249249249249ull;
+        return val;
+    }
+    
+    static inline uint64_t CompactBits3x64(uint64_t val)
+    {
+        val &= 0x1249249249249249ull;
+        val = (val | (val >> 2)) & 0x10c30c30c30c30c3ull;
+        val = (val | (val >> 4)) & 0x100f00f00f00f00full;
+        val = (val | (val >> 8)) & 0x001f0000ff0000ffull;
+        val = (val | (val >> 16)) & 0x001f00000000ffffull;
+        val = (val | (val >> 32)) & 0x00000000001fffffull;
+        return val;
+    }
+    
+#ifdef GMATH_USE_SSE
+    static inline __m128i SpreadBits3x64SSE(__m128i val)
+    {
+        val = _mm_and_si128(val, _mm_set1_epi64x(0x00000000001fffffll));
+        val = _mm_and_si128(_mm_or_si128(val, _mm_slli_epi64(val, 32)), _mm_set1_epi64x(0x001f00000000ffffll));
+        val = _mm_and_si128(_mm_or_si128(val, _mm_slli_epi64(val, 16)), _mm_set1_epi64x(0x001f0000ff0000ffll));
+        val = _mm_and_si128(_mm_or_si128(val, _mm_slli_epi64(val, 8)), _mm_set1_epi64x(0x100f00f00f00f00fll));
+        val = _mm_and_si128(_mm_or_si128(val, _mm_slli_epi64(val, 4)), _mm_set1_epi64x(0x10c30c30c30c30c3ll));
+        val = _mm_and_si128(_mm_or_si128(val, _mm_slli_epi64(val, 2)), _mm_set1_epi64x(0x1249249249249249ll));
+        return val;
+    }
+    
+    static inline __m128i CompactBits3x64SSE(__m128i val)
+    {
+        val = _mm_and_si128(val, _mm_set1_epi64x(0x1249249249249249ll));
+        val = _mm_and_si128(_mm_or_si128(val, _mm_srli_epi64(val, 2)), _mm_set1_epi64x(0x10c30c30c30c30c3ll));
+        val = _mm_and_si128(_mm_or_si128(val, _mm_srli_epi64(val, 4)), _mm_set1_epi64x(0x100f00f00f00f00fll));
+        val = _mm_and_si128(_mm_or_si128(val, _mm_srli_epi64(val, 8)), _mm_set1_epi64x(0x001f0000ff0000ffll));
+        val = _mm_and_si128(_mm_or_si128(val, _mm_srli_epi64(val, 16)), _mm_set1_epi64x(0x001f00000000ffffll));
+        val = _mm_and_si128(_mm_or_si128(val, _mm_srli_epi64(val, 32)), _mm_set1_epi64x(0x00000000001fffffll));
+        return val;
+    }
+    
+    // Codes two cells, whose components are in the low halves of x, y and z.
+    static inline __m128i EncodeMorton64SSE(__m128i x, __m128i y, __m128i z)
+    {
+        __m128i code = SpreadBits3x64SSE(x);
+        code = _mm_or_si128(code, _mm_slli_epi64(SpreadBits3x64SSE(y), 1));
+        return _mm_or_si128(code, _mm_slli_epi64(SpreadBits3x64SSE(z), 2));
+    }
+    
+    // Packs the low halves of the 64 bit lanes of a and b into four.
+    static inline __m128i NarrowLanesSSE(__m128i a, __m128i b)
+    {
+        return _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b), _MM_SHUFFLE(2, 0, 2, 0)));
+    }
+#endif
+    
+#ifdef GMATH_USE_NEON
+    static inline uint64x2_t SpreadBits3x64NEON(uint64x2_t val)
+    {
+        val = vandq_u64(val, vdupq_n_u64(0x00000000001fffffull));
+        val = vandq_u64(vorrq_u64(val, vshlq_n_u64(val, 32)), vdupq_n_u64(0x001f00000000ffffull));
+        val = vandq_u64(vorrq_u64(val, vshlq_n_u64(val, 16)), vdupq_n_u64(0x001f0000ff0000ffull));
+        val = vandq_u64(vorrq_u64(val, vshlq_n_u64(val, 8)), vdupq_n_u64(0x100f00f00f00f00full));
+        val = vandq_u64(vorrq_u64(val, vshlq_n_u64(val, 4)), vdupq_n_u64(0x10c30c30c30c30c3ull));
+        val = vandq_u64(vorrq_u64(val, vshlq_n_u64(val, 2)), vdupq_n_u64(0x1249249249249249ull));
+        return val;
+    }
+    
+    static inline uint64x2_t CompactBits3x64NEON(uint64x2_t val)
+    {
+        val = vandq_u64(val, vdupq_n_u64(0x1249249249249249ull));
+        val = vandq_u64(vorrq_u64(val, vshrq_n_u64(val, 2)), vdupq_n_u64(0x10c30c30c30c30c3ull));
+        val = vandq_u64(vorrq_u64(val, vshrq_n_u64(val, 4)), vdupq_n_u64(0x100f00f00f00f00full));
+        val = vandq_u64(vorrq_u64(val, vshrq_n_u64(val, 8)), vdupq_n_u64(0x001f0000ff0000ffull));
+        val = vandq_u64(vorrq_u64(val, vshrq_n_u64(val, 16)), vdupq_n_u64(0x001f00000000ffffull));
+        val = vandq_u64(vorrq_u64(val, vshrq_n_u64(val, 32)), vdupq_n_u64(0x00000000001fffffull));
+        return val;
+    }
+    
+    static inline uint64x2_t EncodeMorton64NEON(uint32x2_t x, uint32x2_t y, uint32x2_t z)
+    {
+        uint64x2_t code = SpreadBits3x64NEON(vmovl_u32(x));
+        code = vorrq_u64(code, vshlq_n_u64(SpreadBits3x64NEON(vmovl_u32(y)), 1));
+        return vorrq_u64(code, vshlq_n_u64(SpreadBits3x64NEON(vmovl_u32(z)), 2));
+    }
+    
+    // Decodes one component of four codes, shifted down to bit 0.
+    static inline int32x4_t CompactBits3x64NEON(uint64x2_t a, uint64x2_t b)
+    {
+        return vreinterpretq_s32_u32(vcombine_u32(vmovn_u64(CompactBits3x64NEON(a)), vmovn_u64(CompactBits3x64NEON(b))));
+    }
+#endif
+    
+    uint64_t EncodeMorton64(IVec3 coords)
+    {
+        return SpreadBits3x64((uint32_t)coords.x) | (SpreadBits3x64((uint32_t)coords.y) << 1) | (SpreadBits3x64((uint32_t)coords.z) << 2);
+    }
+    
+    IVec3 DecodeMorton64(uint64_t code)
+    {
+        return {(int)CompactBits3x64(code), (int)CompactBits3x64(code >> 1), (int)CompactBits3x64(code >> 2)};
+    }
+    
+#ifdef GMATH_IMPLEMENTATION
+    void GMATH_CALL EncodeMorton64Batch(const IVec3* in, uint64_t* out, size_t count)
+    {
+        size_t i = 0;
+#if defined(GMATH_USE_SSE) || defined(GMATH_USE_NEON)
+        i = count & ~(size_t)3;
+        for (size_t block = 0; block < i; block += 4)
+        {
+            IVec3x4 coords = LoadIVec3x4(in + block);
+#ifdef GMATH_USE_SSE
+            __m128i zero = _mm_setzero_si128();
+            __m128i low = EncodeMorton64SSE(_mm_unpacklo_epi32(coords.x.data_sse, zero), _mm_unpacklo_epi32(coords.y.data_sse, zero), _mm_unpacklo_epi32(coords.z.data_sse, zero));
+            __m128i high = EncodeMorton64SSE(_mm_unpackhi_epi32(coords.x.data_sse, zero), _mm_unpackhi_epi32(coords.y.data_sse, zero), _mm_unpackhi_epi32(coords.z.data_sse, zero));
+            _mm_storeu_si128((__m128i*)(out + block), low);
+            _mm_storeu_si128((__m128i*)(out + block + 2), high);
+#else
+            uint32x4_t x = vreinterpretq_u32_s32(coords.x.data_neon);
+            uint32x4_t y = vreinterpretq_u32_s32(coords.y.data_neon);
+            uint32x4_t z = vreinterpretq_u32_s32(coords.z.data_neon);
+            vst1q_u64(out + block, EncodeMorton64NEON(vget_low_u32(x), vget_low_u32(y), vget_low_u32(z)));
+            vst1q_u64(out + block + 2, EncodeMorton64NEON(vget_high_u32(x), vget_high_u32(y), vget_high_u32(z)));
+#endif
+        }
+#endif
+        for (; i < count; ++i) out[i] = EncodeMorton64(in[i]);
+    }
+    
+    void GMATH_CALL DecodeMorton64Batch(const uint64_t* in, IVec3* out, size_t count)
+    {
+        size_t i = 0;
+#if defined(GMATH_USE_SSE) || defined(GMATH_USE_NEON)
+        i = count & ~(size_t)3;
+        for (size_t block = 0; block < i; block += 4)
+        {
+            IVec3x4 coords;
+#ifdef GMATH_USE_SSE
+            __m128i low = _mm_loadu_si128((const __m128i*)(in + block));
+            __m128i high = _mm_loadu_si128((const __m128i*)(in + block + 2));
+            for (int j = 0; j < 3; ++j)
+            {
+                coords.data[j].data_sse = NarrowLanesSSE(CompactBits3x64SSE(low), CompactBits3x64SSE(high));
+                low = _mm_srli_epi64(low, 1);
+                high = _mm_srli_epi64(high, 1);
+            }
+#else
+            uint64x2_t low = vld1q_u64(in + block);
+            uint64x2_t high = vld1q_u64(in + block + 2);
+            coords.x.data_neon = CompactBits3x64NEON(low, high);
+            coords.y.data_neon = CompactBits3x64NEON(vshrq_n_u64(low, 1), vshrq_n_u64(high, 1));
+            coords.z.data_neon = CompactBits3x64NEON(vshrq_n_u64(low, 2), vshrq_n_u64(high, 2));
+#endif
+            StoreIVec3x4(coords, out + block);
+        }
+#endif
+        for (; i < count; ++i) out[i] = DecodeMorton64(in[i]);
+    }
+    
+    // Arenas.
+    
+    Arena CreateArena(void* memory, size_t capacity)
+    {
+        Arena arena;
+        arena.memory = (uint8_t*)memory;
+        arena.capacity = capacity;
+        arena.used = 0;
+        arena.peak = 0;
+        arena.allocation = 0;
+        return arena;
+    }
+    
+    // Over-allocated so the block can start on a cache line.
+    Arena CreateArena(size_t capacity)
+    {
+        void* allocation = GMATH_MALLOC(capacity + 63);
+        if (!allocation) return CreateArena(0, 0);
+        Arena arena = CreateArena((void*)(((uintptr_t)allocation + 63) & ~(uintptr_t)63), capacity);
+        arena.allocation = allocation;
+        return arena;
+    }
+    
+    void DestroyArena(Arena& arena)
+    {
+        if (arena.allocation) GMATH_FREE(arena.allocation);
+        arena = CreateArena(0, 0);
+    }
+    
+    // The address is aligned, rather than the offset, so memory supplied by
+    // the caller needn't be aligned itself.
+    void* ArenaAllocate(Arena& arena, size_t size, size_t alignment)
+    {
+        uintptr_t base = (uintptr_t)arena.memory;
+        uintptr_t start = (base + arena.used + alignment - 1) & ~(uintptr_t)(alignment - 1);
+        size_t offset = (size_t)(start - base);
+        if (offset > arena.capacity || size > arena.capacity - offset) return 0;
+        arena.used = offset + size;
+        if (arena.used > arena.peak) arena.peak = arena.used;
+        return (void*)start;
+    }
+    
+    size_t GetArenaMark(const Arena& arena)
+    {
+        return arena.used;
+    }
+    
+    void RewindArena(Arena& arena, size_t mark)
+    {
+        if (mark < arena.used) arena.used = mark;
+    }
+    
+    void ResetArena(Arena& arena)
+    {
+        arena.used = 0;
+    }
+    
+    // Frees the thread's arena when the thread exits.
+    struct ThreadArena
+    {
+        Arena arena;
+        ThreadArena() {arena = CreateArena((size_t)GMATH_THREAD_ARENA_SIZE);}
+        ~ThreadArena() {DestroyArena(arena);}
+    };
+    
+    Arena& GetThreadArena()
+    {
+        static thread_local ThreadArena thread_arena;
+        return thread_arena.arena;
+    }
+    
+    static inline void* ArenaAllocateArray(Arena& arena, size_t count, size_t element_size)
+    {
+        if (count > (size_t)-1 / element_size) return 0;
+        return ArenaAllocate(arena, count * element_size);
+    }
+    
+    Vec3* AllocateVec3s(Arena& arena, size_t count)
+    {
+        return (Vec3*)ArenaAllocateArray(arena, count, sizeof(Vec3));
+    }
+    
+    Vec4* AllocateVec4s(Arena& arena, size_t count)
+    {
+        return (Vec4*)ArenaAllocateArray(arena, count, sizeof(Vec4));
+    }
+    
+    Quat* AllocateQuats(Arena& arena, size_t count)
+    {
+        return (Quat*)ArenaAllocateArray(arena, count, sizeof(Quat));
+    }
+    
+    Mat4* AllocateMat4s(Arena& arena, size_t count)
+    {
+        return (Mat4*)ArenaAllocateArray(arena, count, sizeof(Mat4));
+    }
+    
+    Mat3x4* AllocateMat3x4s(Arena& arena, size_t count)
+    {
+        return (Mat3x4*)ArenaAllocateArray(arena, count, sizeof(Mat3x4));
+    }
+    
+    Vec3x4* AllocateVec3x4s(Arena& arena, size_t count)
+    {
+        return (Vec3x4*)ArenaAllocateArray(arena, count, sizeof(Vec3x4));
+    }
+#endif // GMATH_IMPLEMENTATION
+    
+    // Grid cells and sorting.
+    
+    IVec3 GetGridCell(Vec3 point, Vec3 origin, float cell_size)
+    {
+        float scale = 1.0f / cell_size;
+        IVec3 result;
+        for (int i = 0; i < 3; ++i)
+        {
+            result.data[i] = FloorToIntScalar((point.data[i] - origin.data[i]) * scale);
+        }
+        return result;
+    }
+    
+#ifdef GMATH_IMPLEMENTATION
+    void GMATH_CALL GetGridCellsBatch(const Vec3* in, IVec3* out, size_t count, Vec3 origin, float cell_size)
+    {
+        size_t i = 0;
+#ifdef GMATH_USE_SSE
+        Vec3x4 corner = CreateVec3x4(origin);
+        float scale = 1.0f / cell_size;
+        i = count & ~(size_t)3;
+        for (size_t block = 0; block < i; block += 4)
+        {
+            StoreIVec3x4(FloorToInt((LoadVec3x4(in + block) - corner) * scale), out + block);
+        }
+#elif defined(GMATH_USE_NEON)
+        float32x4_t scale = vdupq_n_f32(1.0f / cell_size);
+        i = count & ~(size_t)3;
+        for (size_t block = 0; block < i; block += 4)
+        {
+            float32x4x3_t points = vld3q_f32(in[block].data);
+            int32x4x3_t cells;
+            for (int j = 0; j < 3; ++j) cells.val[j] = vcvtmq_s32_f32(vmulq_f32(vsubq_f32(points.val[j], vdupq_n_f32(origin.data[j])), scale));
+            vst3q_s32(out[block].data, cells);
+        }
+#endif
+        for (; i < count; ++i) out[i] = GetGridCell(in[i], origin, cell_size);
+    }
+    
+    // Least significant digit first: one pass over the keys counts every
+    // digit, and each pass then scatters them from one array to the other.
+    // A digit all of the keys share would leave them where they are.
+    void RadixSort(uint32_t* keys, uint32_t* values, size_t count, uint32_t* scratch_keys, uint32_t* scratch_values)
+    {
+        size_t counts[4][256] = {};
+        for (size_t i = 0; i < count; ++i)
+        {
+            for (int pass = 0; pass < 4; ++pass) ++counts[pass][(keys[i] >> (pass * 8)) & 0xff];
+        }
+        uint32_t* from_keys = keys;
+        uint32_t* from_values = values;
+        uint32_t* to_keys = scratch_keys;
+        uint32_t* to_values = scratch_values;
+        for (int pass = 0; pass < 4 && count > 0; ++pass)
+        {
+            int shift = pass * 8;
+            size_t* offsets = counts[pass];
+            if (offsets[(from_keys[0] >> shift) & 0xff] == count) continue;
+            size_t offset = 0;
+            for (int digit = 0; digit < 256; ++digit)
+            {
+                size_t digit_count = offsets[digit];
+                offsets[digit] = offset;
+                offset += digit_count;
+            }
+            for (size_t i = 0; i < count; ++i)
+            {
+                size_t slot = offsets[(from_keys[i] >> shift) & 0xff]++;
+                to_keys[slot] = from_keys[i];
+                if (values) to_values[slot] = from_values[i];
+            }
+            uint32_t* swap_keys = from_keys;
+            uint32_t* swap_values = from_values;
+            from_keys = to_keys;
+            from_values = to_values;
+            to_keys = swap_keys;
+            to_values = swap_values;
+        }
+        if (from_keys == keys) return;
+        for (size_t i = 0; i < count; ++i) keys[i] = from_keys[i];
+        if (values) for (size_t i = 0; i < count; ++i) values[i] = from_values[i];
+    }
+    
+    void RadixSort(uint64_t* keys, uint32_t* values, size_t count, uint64_t* scratch_keys, uint32_t* scratch_values)
+    {
+        size_t counts[8][256] = {};
+        for (size_t i = 0; i < count; ++i)
+        {
+            for (int pass = 0; pass < 8; ++pass) ++counts[pass][(keys[i] >> (pass * 8)) & 0xff];
+        }
+        uint64_t* from_keys = keys;
+        uint32_t* from_values = values;
+        uint64_t* to_keys = scratch_keys;
+        uint32_t* to_values = scratch_values;
+        for (int pass = 0; pass < 8 && count > 0; ++pass)
+        {
+            int shift = pass * 8;
+            size_t* offsets = counts[pass];
+            if (offsets[(from_keys[0] >> shift) & 0xff] == count) continue;
+            size_t offset = 0;
+            for (int digit = 0; digit < 256; ++digit)
+            {
+                size_t digit_count = offsets[digit];
+                offsets[digit] = offset;
+                offset += digit_count;
+            }
+            for (size_t i = 0; i < count; ++i)
+            {
+                size_t slot = offsets[(from_keys[i] >> shift) & 0xff]++;
+                to_keys[slot] = from_keys[i];
+                if (values) to_values[slot] = from_values[i];
+            }
+            uint64_t* swap_keys = from_keys;
+            uint32_t* swap_values = from_values;
+            from_keys = to_keys;
+            from_values = to_values;
+            to_keys = swap_keys;
+            to_values = swap_values;
+        }
+        if (from_keys == keys) return;
+        for (size_t i = 0; i < count; ++i) keys[i] = from_keys[i];
+        if (values) for (size_t i = 0; i < count; ++i) values[i] = from_values[i];
+    }
+    
+    // The codes are made a block at a time, through a small buffer of cells
+    // on the stack.
+    bool GMATH_CALL SortByMorton(const Vec3* positions, size_t count, const AABB& bounds, uint32_t* order, Vec3* sorted)
+    {
+        Arena& arena = GetThreadArena();
+        size_t mark = GetArenaMark(arena);
+        uint32_t* codes = (uint32_t*)ArenaAllocateArray(arena, count, 3 * sizeof(uint32_t));
+        void* allocation = 0;
+        if (!codes && count > 0)
+        {
+            if (count > (size_t)-1 / (3 * sizeof(uint32_t))) return false;
+            allocation = GMATH_MALLOC(count * 3 * sizeof(uint32_t));
+            if (!allocation) return false;
+            codes = (uint32_t*)allocation;
+        }
+        IVec3 cells[256];
+        for (size_t block = 0; block < count; block += 256)
+        {
+            size_t block_count = count - block < 256 ? count - block : 256;
+            QuantizeBatch(positions + block, cells, block_count, bounds, 10);
+            EncodeMortonBatch(cells, codes + block, block_count);
+        }
+        for (size_t i = 0; i < count; ++i) order[i] = (uint32_t)i;
+        RadixSort(codes, order, count, codes + count, codes + 2 * count);
+        if (sorted)
+        {
+            for (size_t i = 0; i < count; ++i) sorted[i] = positions[order[i]];
+        }
+        if (allocation) GMATH_FREE(allocation);
+        else RewindArena(arena, mark);
+        return true;
+    }
+    
+    // Spatial hashing.
+    
+    // The three arrays share one allocation, starts first.
+    SpatialHash CreateSpatialHash(float cell_size, uint32_t capacity, uint32_t table_size)
+    {
+        SpatialHash hash;
+        uint32_t size = 1;
+        uint32_t wanted = table_size ? table_size : capacity;
+        while (size < wanted && size < 0x80000000u) size <<= 1;
+        hash.allocation = GMATH_MALLOC(((size_t)size + 1 + 2 * (size_t)capacity) * sizeof(uint32_t));
+        hash.starts = (uint32_t*)hash.allocation;
+        hash.indices = hash.allocation ? hash.starts + size + 1 : 0;
+        hash.buckets = hash.allocation ? hash.indices + capacity : 0;
+        hash.cell_size = cell_size;
+        hash.table_size = hash.allocation ? size : 0;
+        hash.capacity = hash.allocation ? capacity : 0;
+        hash.count = 0;
+        if (hash.allocation)
+        {
+            for (uint32_t i = 0; i <= size; ++i) hash.starts[i] = 0;
+        }
+        return hash;
+    }
+    
+    void DestroySpatialHash(SpatialHash& hash)
+    {
+        if (hash.allocation) GMATH_FREE(hash.allocation);
+        hash.allocation = 0;
+        hash.starts = 0;
+        hash.indices = 0;
+        hash.buckets = 0;
+        hash.table_size = 0;
+        hash.capacity = 0;
+        hash.count = 0;
+    }
+#endif // GMATH_IMPLEMENTATION
+    
+    // The large primes of Teschner et al., "Optimized Spatial Hashing for
+    // Collision Detection of Deformable Objects".
+#define GMATH_HASH_PRIME_X 73856093
+#define GMATH_HASH_PRIME_Y 19349663
+#define GMATH_HASH_PRIME_Z 83492791
+    
+    uint32_t HashCell(IVec3 cell, uint32_t table_size)
+    {
+        uint32_t hash = ((uint32_t)cell.x * GMATH_HASH_PRIME_X) ^ ((uint32_t)cell.y * GMATH_HASH_PRIME_Y) ^ ((uint32_t)cell.z * GMATH_HASH_PRIME_Z);
+        return hash & (table_size - 1);
+    }
+    
+#ifdef GMATH_IMPLEMENTATION
+    // The cells are found a block at a time, and hashed four at a time; the
+    // buckets are then counted and the counts turned into the ends of the
+    // ranges. Filling the ranges from their ends, going backwards through the
+    // points, leaves each in increasing order and each start at its beginning.
+    bool GMATH_CALL BuildSpatialHash(SpatialHash& hash, const Vec3* positions, size_t count)
+    {
+        if (!hash.allocation || count > hash.capacity) return false;
+#if defined(GMATH_USE_SSE) || defined(GMATH_USE_NEON)
+        IVec4 primes[3] = {CreateIVec4(GMATH_HASH_PRIME_X), CreateIVec4(GMATH_HASH_PRIME_Y), CreateIVec4(GMATH_HASH_PRIME_Z)};
+        IVec4 mask = CreateIVec4((int)(hash.table_size - 1));
+#endif
+        IVec3 cells[256];
+        for (size_t block = 0; block < count; block += 256)
+        {
+            size_t block_count = count - block < 256 ? count - block : 256;
+            uint32_t* buckets = hash.buckets + block;
+            GetGridCellsBatch(positions + block, cells, block_count, Vec3::Zero, hash.cell_size);
+            size_t i = 0;
+#if defined(GMATH_USE_SSE) || defined(GMATH_USE_NEON)
+            i = block_count & ~(size_t)3;
+            for (size_t group = 0; group < i; group += 4)
+            {
+                IVec3x4 packet = LoadIVec3x4(cells + group);
+                IVec4 hashes = ((packet.x * primes[0]) ^ (packet.y * primes[1]) ^ (packet.z * primes[2])) & mask;
+#ifdef GMATH_USE_SSE
+                _mm_storeu_si128((__m128i*)(buckets + group), hashes.data_sse);
+#else
+                vst1q_u32(buckets + group, vreinterpretq_u32_s32(hashes.data_neon));
+#endif
+            }
+#endif
+            for (; i < block_count; ++i) buckets[i] = HashCell(cells[i], hash.table_size);
+        }
+        uint32_t* starts = hash.starts;
+        for (uint32_t bucket = 0; bucket <= hash.table_size; ++bucket) starts[bucket] = 0;
+        for (size_t i = 0; i < count; ++i) ++starts[hash.buckets[i]];
+        uint32_t total = 0;
+        for (uint32_t bucket = 0; bucket <= hash.table_size; ++bucket)
+        {
+            total += starts[bucket];
+            starts[bucket] = total;
+        }
+        for (size_t i = count; i > 0; --i) hash.indices[--starts[hash.buckets[i - 1]]] = (uint32_t)(i - 1);
+        hash.count = (uint32_t)count;
+        return true;
+    }
+#endif // GMATH_IMPLEMENTATION
+    
+    void FindCell(const SpatialHash& hash, IVec3 cell, uint32_t& begin, uint32_t& end)
+    {
+        uint32_t bucket = HashCell(cell, hash.table_size);
+        begin = hash.starts[bucket];
+        end = hash.starts[bucket + 1];
+    }
+    
+#ifdef GMATH_IMPLEMENTATION
+    // Baked data.
+    
+    size_t GetBakedElementSize(uint32_t type)
+    {
+        switch (type)
+        {
+            case GMATH_BAKED_BYTES: return 1;
+            case GMATH_BAKED_FLOAT: return sizeof(float);
+            case GMATH_BAKED_VEC3: return sizeof(Vec3);
+            case GMATH_BAKED_VEC4: return sizeof(Vec4);
+            case GMATH_BAKED_QUAT: return sizeof(Quat);
+            case GMATH_BAKED_MAT4: return sizeof(Mat4);
+            case GMATH_BAKED_MAT3X4: return sizeof(Mat3x4);
+            case GMATH_BAKED_VEC3X4: return sizeof(Vec3x4);
+            case GMATH_BAKED_QUAT32: return sizeof(uint32_t);
+            case GMATH_BAKED_QUAT48: return sizeof(Quat48);
+            case GMATH_BAKED_HALF4: return sizeof(Half4);
+            case GMATH_BAKED_IVEC3: return sizeof(IVec3);
+        }
+        return 0;
+    }
+    
+    static inline size_t AlignBakedOffset(size_t offset)
+    {
+        return (offset + GMATH_BAKED_ALIGNMENT - 1) & ~(size_t)(GMATH_BAKED_ALIGNMENT - 1);
+    }
+    
+    static inline void CopyBakedBytes(uint8_t* out, const uint8_t* in, size_t size)
+    {
+        for (size_t i = 0; i < size; ++i) out[i] = in[i];
+    }
+    
+    size_t WriteBaked(void* out, const BakedSection* sections, const void* const* data, uint32_t section_count)
+    {
+        size_t offset = sizeof(BakedHeader) + sizeof(BakedSection) * section_count;
+        uint8_t* bytes = (uint8_t*)out;
+        BakedSection* out_sections = (BakedSection*)(bytes + sizeof(BakedHeader));
+        for (uint32_t i = 0; i < section_count; ++i)
+        {
+            size_t section_size = (size_t)sections[i].count * GetBakedElementSize(sections[i].type);
+            offset = AlignBakedOffset(offset);
+            if (out)
+            {
+                out_sections[i] = sections[i];
+                out_sections[i].offset = offset;
+                CopyBakedBytes(bytes + offset, (const uint8_t*)data[i], section_size);
+            }
+            offset += section_size;
+        }
+        if (out)
+        {
+            BakedHeader* header = (BakedHeader*)out;
+            header->magic = GMATH_BAKED_MAGIC;
+            header->version = GMATH_BAKED_VERSION;
+            header->endian_tag = GMATH_BAKED_ENDIAN_TAG;
+            header->section_count = section_count;
+            header->reserved = 0;
+            header->size = offset;
+        }
+        return offset;
+    }
+    
+    bool OpenBaked(BakedFile& file, const void* data, size_t size)
+    {
+        const BakedHeader* header = (const BakedHeader*)data;
+        file.data = 0;
+        file.size = 0;
+        file.sections = 0;
+        file.section_count = 0;
+        if (!data || ((uintptr_t)data & 15) || size < sizeof(BakedHeader)) return false;
+        if (header->magic != GMATH_BAKED_MAGIC || header->version != GMATH_BAKED_VERSION) return false;
+        if (header->endian_tag != GMATH_BAKED_ENDIAN_TAG || header->size > size) return false;
+        // The recorded size must hold the header and the section table, before
+        // either is subtracted from it or read.
+        size = (size_t)header->size;
+        if (size < sizeof(BakedHeader)) return false;
+        if (header->section_count > (size - sizeof(BakedHeader)) / sizeof(BakedSection)) return false;
+        if (size < sizeof(BakedHeader) + (size_t)header->section_count * sizeof(BakedSection)) return false;
+        
+        const BakedSection* sections = (const BakedSection*)(header + 1);
+        for (uint32_t i = 0; i < header->section_count; ++i)
+        {
+            size_t element_size = GetBakedElementSize(sections[i].type);
+            uint64_t offset = sections[i].offset;
+            if (!element_size || (offset & (GMATH_BAKED_ALIGNMENT - 1)) || offset > size) return false;
+            if (sections[i].count > (size - offset) / element_size) return false;
+        }
+        file.data = (const uint8_t*)data;
+        file.size = size;
+        file.sections = sections;
+        file.section_count = header->section_count;
+        return true;
+    }
+    
+    const BakedSection* FindBakedSection(const BakedFile& file, uint32_t id)
+    {
+        for (uint32_t i = 0; i < file.section_count; ++i)
+        {
+            if (file.sections[i].id == id) return &file.sections[i];
+        }
+        return 0;
+    }
+    
+    const void* GetBakedData(const BakedFile& file, uint32_t id, uint32_t type, size_t& count)
+    {
+        const BakedSection* section = FindBakedSection(file, id);
+        count = 0;
+        if (!section || section->type != type) return 0;
+        count = (size_t)section->count;
+        return file.data + section->offset;
+    }
+    
+    const float* GetBakedFloats(const BakedFile& file, uint32_t id, size_t& count)
+    {
+        return (const float*)GetBakedData(file, id, GMATH_BAKED_FLOAT, count);
+    }
+    
+    const Vec3* GetBakedVec3s(const BakedFile& file, uint32_t id, size_t& count)
+    {
+        return (const Vec3*)GetBakedData(file, id, GMATH_BAKED_VEC3, count);
+    }
+    
+    const Vec4* GetBakedVec4s(const BakedFile& file, uint32_t id, size_t& count)
+    {
+        return (const Vec4*)GetBakedData(file, id, GMATH_BAKED_VEC4, count);
+    }
+    
+    const Quat* GetBakedQuats(const BakedFile& file, uint32_t id, size_t& count)
+    {
+        return (const Quat*)GetBakedData(file, id, GMATH_BAKED_QUAT, count);
+    }
+    
+    const Mat4* GetBakedMat4s(const BakedFile& file, uint32_t id, size_t& count)
+    {
+        return (const Mat4*)GetBakedData(file, id, GMATH_BAKED_MAT4, count);
+    }
+    
+    const Mat3x4* GetBakedMat3x4s(const BakedFile& file, uint32_t id, size_t& count)
+    {
+        return (const Mat3x4*)GetBakedData(file, id, GMATH_BAKED_MAT3X4, count);
+    }
+    
+    const Vec3x4* GetBakedVec3x4s(const BakedFile& file, uint32_t id, size_t& count)
+    {
+        return (const Vec3x4*)GetBakedData(file, id, GMATH_BAKED_VEC3X4, count);
+    }
+    
+    const uint32_t* GetBakedQuat32s(const BakedFile& file, uint32_t id, size_t& count)
+    {
+        return (const uint32_t*)GetBakedData(file, id, GMATH_BAKED_QUAT32, count);
+    }
+    
+    const Quat48* GetBakedQuat48s(const BakedFile& file, uint32_t id, size_t& count)
+    {
+        return (const Quat48*)GetBakedData(file, id, GMATH_BAKED_QUAT48, count);
+    }
+    
+    const Half4* GetBakedHalf4s(const BakedFile& file, uint32_t id, size_t& count)
+    {
+        return (const Half4*)GetBakedData(file, id, GMATH_BAKED_HALF4, count);
+    }
+    
+    const IVec3* GetBakedIVec3s(const BakedFile& file, uint32_t id, size_t& count)
+    {
+        return (const IVec3*)GetBakedData(file, id, GMATH_BAKED_IVEC3, count);
+    }
+    
+    // Parallel execution.
+    
+#ifndef GMATH_NO_THREADS
+    struct ThreadPool
+    {
+        std::thread* workers;
+        uint32_t worker_count;
+        std::mutex run_mutex; // Held for a whole run, so callers take turns.
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::condition_variable finished;
+        ParallelTask task;
+        void* task_data;
+        size_t task_count;
+        std::atomic<size_t> next_task;
+        uint32_t busy_workers;
+        uint64_t generation;
+        bool quit;
+    };
+    
+    // The pool whose tasks this thread is running, if any.
+    static thread_local ThreadPool* g_current_pool;
+    
+    static inline void RunPoolTasks(ThreadPool& pool)
+    {
+        for (size_t index = pool.next_task.fetch_add(1); index < pool.task_count; index = pool.next_task.fetch_add(1))
+        {
+            pool.task(pool.task_data, index);
+        }
+    }
+    
+    // Every worker joins every run (the caller waits for all of them), so none
+    // can miss a generation.
+    static void RunPoolWorker(ThreadPool* pool)
+    {
+        g_current_pool = pool;
+        uint64_t generation = 0;
+        std::unique_lock<std::mutex> lock(pool->mutex);
+        for (;;)
+        {
+            while (pool->generation == generation && !pool->quit) pool->wake.wait(lock);
+            if (pool->quit) return;
+            generation = pool->generation;
+            lock.unlock();
+            RunPoolTasks(*pool);
+            lock.lock();
+            if (--pool->busy_workers == 0) pool->finished.notify_one();
+        }
+    }
+    
+    static void RunThreadPool(void* context, ParallelTask task, void* task_data, size_t task_count)
+    {
+        ThreadPool* pool = (ThreadPool*)context;
+        if (g_current_pool == pool)
+        {
+            for (size_t i = 0; i < task_count; ++i) task(task_data, i);
+            return;
+        }
+        std::lock_guard<std::mutex> run_lock(pool->run_mutex);
+        {
+            std::lock_guard<std::mutex> lock(pool->mutex);
+            pool->task = task;
+            pool->task_data = task_data;
+            pool->task_count = task_count;
+            pool->next_task.store(0);
+            pool->busy_workers = pool->worker_count;
+            pool->generation++;
+        }
+        pool->wake.notify_all();
+        ThreadPool* previous_pool = g_current_pool;
+        g_current_pool = pool;
+        RunPoolTasks(*pool);
+        g_current_pool = previous_pool;
+        std::unique_lock<std::mutex> lock(pool->mutex);
+        while (pool->busy_workers) pool->finished.wait(lock);
+    }
+#endif
+    
+    Executor CreateThreadPool(uint32_t threads)
+    {
+        Executor executor = {0, 0, 1};
+#ifndef GMATH_NO_THREADS
+        if (!threads) threads = std::thread::hardware_concurrency();
+        if (threads <= 1) return executor;
+        ThreadPool* pool = new ThreadPool;
+        pool->worker_count = threads - 1;
+        pool->task = 0;
+        pool->task_data = 0;
+        pool->task_count = 0;
+        pool->next_task.store(0);
+        pool->busy_workers = 0;
+        pool->generation = 0;
+        pool->quit = false;
+        pool->workers = new std::thread[pool->worker_count];
+        for (uint32_t i = 0; i < pool->worker_count; ++i) pool->workers[i] = std::thread(RunPoolWorker, pool);
+        executor.run = RunThreadPool;
+        executor.context = pool;
+        executor.threads = threads;
+#else
+        (void)threads;
+#endif
+        return executor;
+    }
+    
+    void DestroyThreadPool(Executor& executor)
+    {
+#ifndef GMATH_NO_THREADS
+        ThreadPool* pool = (ThreadPool*)executor.context;
+        if (pool && executor.run == RunThreadPool)
+        {
+            {
+                std::lock_guard<std::mutex> lock(pool->mutex);
+                pool->quit = true;
+            }
+            pool->wake.notify_all();
+            for (uint32_t i = 0; i < pool->worker_count; ++i) pool->workers[i].join();
+            delete[] pool->workers;
+            delete pool;
+        }
+#endif
+        executor.run = 0;
+        executor.context = 0;
+        executor.threads = 1;
+    }
+    
+    // Chunk 0 is [0, head + chunk), and chunk i > 0 [head + i * chunk,
+    // head + (i + 1) * chunk), cut short at count.
+    struct ParallelJob
+    {
+        ParallelRange function;
+        void* data;
+        size_t count;
+        size_t head;
+        size_t chunk;
+    };
+    
+    static void RunParallelChunk(void* task_data, size_t index)
+    {
+        const ParallelJob& job = *(const ParallelJob*)task_data;
+        size_t begin = index ? job.head + index * job.chunk : 0;
+        size_t end = job.head + (index + 1) * job.chunk;
+        job.function(job.data, begin, end < job.count ? end : job.count);
+    }
+    
+    // Splits [0, count) into about four chunks per thread, each a multiple of
+    // granularity elements long, with the boundaries head elements in.
+    static inline void SplitParallel(const Executor& executor, size_t count, size_t granularity, size_t head, ParallelRange function, void* data)
+    {
+        if (!count) return;
+        size_t chunks = executor.run ? (size_t)executor.threads * 4 : 1;
+        size_t chunk = (count + chunks - 1) / chunks;
+        if (chunk < GMATH_PARALLEL_MIN_CHUNK) chunk = GMATH_PARALLEL_MIN_CHUNK;
+        chunk = (chunk + granularity - 1) / granularity * granularity;
+        if (!executor.run || count <= head + chunk)
+        {
+            function(data, 0, count);
+            return;
+        }
+        ParallelJob job = {function, data, count, head, chunk};
+        executor.run(executor.context, RunParallelChunk, &job, (count - head + chunk - 1) / chunk);
+    }
+    
+    // The fewest elements filling whole cache lines, and at least 8.
+    static inline size_t GetParallelGranularity(size_t element_size)
+    {
+        size_t a = element_size, b = 64;
+        while (b)
+        {
+            size_t remainder = a % b;
+            a = b;
+            b = remainder;
+        }
+        size_t granularity = 64 / a;
+        return granularity < 8 ? 8 : granularity;
+    }
+    
+    // The index of the first element starting a cache line, or 0 if none do.
+    static inline size_t GetParallelHead(const void* out, size_t element_size, size_t granularity)
+    {
+        for (size_t i = 0; i < granularity; ++i)
+        {
+            if ((((uintptr_t)out + i * element_size) & 63) == 0) return i;
+        }
+        return 0;
+    }
+    
+    void ParallelFor(const Executor& executor, size_t count, const void* out, size_t element_size, ParallelRange function, void* data)
+    {
+        size_t granularity = GetParallelGranularity(element_size);
+        SplitParallel(executor, count, granularity, GetParallelHead(out, element_size, granularity), function, data);
+    }
+    
+    // The batch functions whose only arrays are in and out, through one
+    // signature; params points at whatever else they take.
+    typedef void (*ParallelArrayKernel)(const void* params, const void* in, void* out, size_t count);
+    
+    struct ParallelArrayJob
+    {
+        ParallelArrayKernel kernel;
+        const void* params;
+        const uint8_t* in;
+        uint8_t* out;
+        size_t in_size;
+        size_t out_size;
+    };
+    
+    static void RunParallelArray(void* data, size_t begin, size_t end)
+    {
+        const ParallelArrayJob& job = *(const ParallelArrayJob*)data;
+        job.kernel(job.params, job.in + begin * job.in_size, job.out + begin * job.out_size, end - begin);
+    }
+    
+    static inline void ParallelArray(const Executor& executor, ParallelArrayKernel kernel, const void* params, const void* in, size_t in_size, void* out, size_t out_size, size_t count)
+    {
+        ParallelArrayJob job = {kernel, params, (const uint8_t*)in, (uint8_t*)out, in_size, out_size};
+        ParallelFor(executor, count, out, out_size, RunParallelArray, &job);
+    }
+    
+    struct NormalizeParams
+    {
+        float tolerance;
+        int accuracy;
+    };
+    
+    struct QuantizeParams
+    {
+        const AABB* bounds;
+        int bits;
+    };
+    
+    struct GridParams
+    {
+        Vec3 origin;
+        float cell_size;
+    };
+    
+    static void TransformVec4sKernel(const void* params, const void* in, void* out, size_t count)
+    {
+        TransformVec4s(*(const Mat4*)params, (const Vec4*)in, (Vec4*)out, count);
+    }
+    
+    void GMATH_CALL TransformVec4s(const Executor& executor, const Mat4& mat, const Vec4* in, Vec4* out, size_t count)
+    {
+        ParallelArray(executor, TransformVec4sKernel, &mat, in, sizeof(Vec4), out, sizeof(Vec4), count);
+    }
+    
+    static void TransformPointsKernel(const void* params, const void* in, void* out, size_t count)
+    {
+        TransformPoints(*(const Mat4*)params, (const Vec3*)in, (Vec3*)out, count);
+    }
+    
+    void GMATH_CALL TransformPoints(const Executor& executor, const Mat4& mat, const Vec3* in, Vec3* out, size_t count)
+    {
+        ParallelArray(executor, TransformPointsKernel, &mat, in, sizeof(Vec3), out, sizeof(Vec3), count);
+    }
+    
+    static void TransformDirectionsKernel(const void* params, const void* in, void* out, size_t count)
+    {
+        TransformDirections(*(const Mat4*)params, (const Vec3*)in, (Vec3*)out, count);
+    }
+    
+    void GMATH_CALL TransformDirections(const Executor& executor, const Mat4& mat, const Vec3* in, Vec3* out, size_t count)
+    {
+        ParallelArray(executor, TransformDirectionsKernel, &mat, in, sizeof(Vec3), out, sizeof(Vec3), count);
+    }
+    
+    static void SafeNormalizeVec2sKernel(const void* params, const void* in, void* out, size_t count)
+    {
+        const NormalizeParams& normalize = *(const NormalizeParams*)params;
+        SafeNormalizeBatch((const Vec2*)in, (Vec2*)out, count, normalize.tolerance, normalize.accuracy);
+    }
+    
+    static void SafeNormalizeVec3sKernel(const void* params, const void* in, void* out, size_t count)
+    {
+        const NormalizeParams& normalize = *(const NormalizeParams*)params;
+        SafeNormalizeBatch((const Vec3*)in, (Vec3*)out, count, normalize.tolerance, normalize.accuracy);
+    }
+    
+    static void SafeNormalizeVec4sKernel(const void* params, const void* in, void* out, size_t count)
+    {
+        const NormalizeParams& normalize = *(const NormalizeParams*)params;
+        SafeNormalizeBatch((const Vec4*)in, (Vec4*)out, count, normalize.tolerance, normalize.accuracy);
+    }
+    
+    static void SafeNormalizeQuatsKernel(const void* params, const void* in, void* out, size_t count)
+    {
+        const NormalizeParams& normalize = *(const NormalizeParams*)params;
+        SafeNormalizeBatch((const Quat*)in, (Quat*)out, count, normalize.tolerance, normalize.accuracy);
+    }
+    
+    void GMATH_CALL NormalizeBatch(const Executor& executor, const Vec2* in, Vec2* out, size_t count, int accuracy)
+    {
+        SafeNormalizeBatch(executor, in, out, count, 0.0f, accuracy);
+    }
+    
+    void GMATH_CALL NormalizeBatch(const Executor& executor, const Vec3* in, Vec3* out, size_t count, int accuracy)
+    {
+        SafeNormalizeBatch(executor, in, out, count, 0.0f, accuracy);
+    }
+    
+    void GMATH_CALL NormalizeBatch(const Executor& executor, const Vec4* in, Vec4* out, size_t count, int accuracy)
+    {
+        SafeNormalizeBatch(executor, in, out, count, 0.0f, accuracy);
+    }
+    
+    void GMATH_CALL NormalizeBatch(const Executor& executor, const Quat* in, Quat* out, size_t count, int accuracy)
+    {
+        SafeNormalizeBatch(executor, in, out, count, 0.0f, accuracy);
+    }
+    
+    void GMATH_CALL SafeNormalizeBatch(const Executor& executor, const Vec2* in, Vec2* out, size_t count, float tolerance, int accuracy)
+    {
+        NormalizeParams params = {tolerance, accuracy};
+        ParallelArray(executor, SafeNormalizeVec2sKernel, &params, in, sizeof(Vec2), out, sizeof(Vec2), count);
+    }
+    
+    void GMATH_CALL SafeNormalizeBatch(const Executor& executor, const Vec3* in, Vec3* out, size_t count, float tolerance, int accuracy)
+    {
+        NormalizeParams params = {tolerance, accuracy};
+        ParallelArray(executor, SafeNormalizeVec3sKernel, &params, in, sizeof(Vec3), out, sizeof(Vec3), count);
+    }
+    
+    void GMATH_CALL SafeNormalizeBatch(const Executor& executor, const Vec4* in, Vec4* out, size_t count, float tolerance, int accuracy)
+    {
+        NormalizeParams params = {tolerance, accuracy};
+        ParallelArray(executor, SafeNormalizeVec4sKernel, &params, in, sizeof(Vec4), out, sizeof(Vec4), count);
+    }
+    
+    void GMATH_CALL SafeNormalizeBatch(const Executor& executor, const Quat* in, Quat* out, size_t count, float tolerance, int accuracy)
+    {
+        NormalizeParams params = {tolerance, accuracy};
+        ParallelArray(executor, SafeNormalizeQuatsKernel, &params, in, sizeof(Quat), out, sizeof(Quat), count);
+    }
+    
+    static void PackQuat32BatchKernel(const void* params, const void* in, void* out, size_t count)
+    {
+        (void)params;
+        PackQuat32Batch((const Quat*)in, (uint32_t*)out, count);
+    }
+    
+    void GMATH_CALL PackQuat32Batch(const Executor& executor, const Quat* in, uint32_t* out, size_t count)
+    {
+        ParallelArray(executor, PackQuat32BatchKernel, 0, in, sizeof(Quat), out, sizeof(uint32_t), count);
+    }
+    
+    static void UnpackQuat32BatchKernel(const void* params, const void* in, void* out, size_t count)
+    {
+        (void)params;
+        UnpackQuat32Batch((const uint32_t*)in, (Quat*)out, count);
+    }
+    
+    void GMATH_CALL UnpackQuat32Batch(const Executor& executor, const uint32_t* in, Quat* out, size_t count)
+    {
+        ParallelArray(executor, UnpackQuat32BatchKernel, 0, in, sizeof(uint32_t), out, sizeof(Quat), count);
+    }
+    
+    static void PackQuat48BatchKernel(const void* params, const void* in, void* out, size_t count)
+    {
+        (void)params;
+        PackQuat48Batch((const Quat*)in, (Quat48*)out, count);
+    }
+    
+    void GMATH_CALL PackQuat48Batch(const Executor& executor, const Quat* in, Quat48* out, size_t count)
+    {
+        ParallelArray(executor, PackQuat48BatchKernel, 0, in, sizeof(Quat), out, sizeof(Quat48), count);
+    }
+    
+    static void UnpackQuat48BatchKernel(const void* params, const void* in, void* out, size_t count)
+    {
+        (void)params;
+        UnpackQuat48Batch((const Quat48*)in, (Quat*)out, count);
+    }
+    
+    void GMATH_CALL UnpackQuat48Batch(const Executor& executor, const Quat48* in, Quat* out, size_t count)
+    {
+        ParallelArray(executor, UnpackQuat48BatchKernel, 0, in, sizeof(Quat48), out, sizeof(Quat), count);
+    }
+    
+    static void PackNormalBatchKernel(const void* params, const void* in, void* out, size_t count)
+    {
+        (void)params;
+        PackNormalBatch((const Vec3*)in, (uint32_t*)out, count);
+    }
+    
+    void GMATH_CALL PackNormalBatch(const Executor& executor, const Vec3* in, uint32_t* out, size_t count)
+    {
+        ParallelArray(executor, PackNormalBatchKernel, 0, in, sizeof(Vec3), out, sizeof(uint32_t), count);
+    }
+    
+    static void UnpackNormalBatchKernel(const void* params, const void* in, void* out, size_t count)
+    {
+        (void)params;
+        UnpackNormalBatch((const uint32_t*)in, (Vec3*)out, count);
+    }
+    
+    void GMATH_CALL UnpackNormalBatch(const Executor& executor, const uint32_t* in, Vec3* out, size_t count)
+    {
+        ParallelArray(executor, UnpackNormalBatchKernel, 0, in, sizeof(uint32_t), out, sizeof(Vec3), count);
+    }
+    
+    static void PackHalf4BatchKernel(const void* params, const void* in, void* out, size_t count)
+    {
+        (void)params;
+        PackHalf4Batch((const Vec4*)in, (Half4*)out, count);
+    }
+    
+    void GMATH_CALL PackHalf4Batch(const Executor& executor, const Vec4* in, Half4* out, size_t count)
+    {
+        ParallelArray(executor, PackHalf4BatchKernel, 0, in, sizeof(Vec4), out, sizeof(Half4), count);
+    }
+    
+    static void UnpackHalf4BatchKernel(const void* params, const void* in, void* out, size_t count)
+    {
+        (void)params;
+        UnpackHalf4Batch((const Half4*)in, (Vec4*)out, count);
+    }
+    
+    void GMATH_CALL UnpackHalf4Batch(const Executor& executor, const Half4* in, Vec4* out, size_t count)
+    {
+        ParallelArray(executor, UnpackHalf4BatchKernel, 0, in, sizeof(Half4), out, sizeof(Vec4), count);
+    }
+    
+    static void QuantizeBatchKernel(const void* params, const void* in, void* out, size_t count)
+    {
+        const QuantizeParams& quantize = *(const QuantizeParams*)params;
+        QuantizeBatch((const Vec3*)in, (IVec3*)out, count, *quantize.bounds, quantize.bits);
+    }
+    
+    void GMATH_CALL QuantizeBatch(const Executor& executor, const Vec3* in, IVec3* out, size_t count, const AABB& bounds, int bits)
+    {
+        QuantizeParams params = {&bounds, bits};
+        ParallelArray(executor, QuantizeBatchKernel, &params, in, sizeof(Vec3), out, sizeof(IVec3), count);
+    }
+    
+    static void DequantizeBatchKernel(const void* params, const void* in, void* out, size_t count)
+    {
+        const QuantizeParams& quantize = *(const QuantizeParams*)params;
+        DequantizeBatch((const IVec3*)in, (Vec3*)out, count, *quantize.bounds, quantize.bits);
+    }
+    
+    void GMATH_CALL DequantizeBatch(const Executor& executor, const IVec3* in, Vec3* out, size_t count, const AABB& bounds, int bits)
+    {
+        QuantizeParams params = {&bounds, bits};
+        ParallelArray(executor, DequantizeBatchKernel, &params, in, sizeof(IVec3), out, sizeof(Vec3), count);
+    }
+    
+    static void EncodeMortonBatchKernel(const void* params, const void* in, void* out, size_t count)
+    {
+        (void)params;
+        EncodeMortonBatch((const IVec3*)in, (uint32_t*)out, count);
+    }
+    
+    void GMATH_CALL EncodeMortonBatch(const Executor& executor, const IVec3* in, uint32_t* out, size_t count)
+    {
+        ParallelArray(executor, EncodeMortonBatchKernel, 0, in, sizeof(IVec3), out, sizeof(uint32_t), count);
+    }
+    
+    static void DecodeMortonBatchKernel(const void* params, const void* in, void* out, size_t count)
+    {
+        (void)params;
+        DecodeMortonBatch((const uint32_t*)in, (IVec3*)out, count);
+    }
+    
+    void GMATH_CALL DecodeMortonBatch(const Executor& executor, const uint32_t* in, IVec3* out, size_t count)
+    {
+        ParallelArray(executor, DecodeMortonBatchKernel, 0, in, sizeof(uint32_t), out, sizeof(IVec3), count);
+    }
+    
+    static void EncodeMorton64BatchKernel(const void* params, const void* in, void* out, size_t count)
+    {
+        (void)params;
+        EncodeMorton64Batch((const IVec3*)in, (uint64_t*)out, count);
+    }
+    
+    void GMATH_CALL EncodeMorton64Batch(const Executor& executor, const IVec3* in, uint64_t* out, size_t count)
+    {
+        ParallelArray(executor, EncodeMorton64BatchKernel, 0, in, sizeof(IVec3), out, sizeof(uint64_t), count);
+    }
+    
+    static void DecodeMorton64BatchKernel(const void* params, const void* in, void* out, size_t count)
+    {
+        (void)params;
+        DecodeMorton64Batch((const uint64_t*)in, (IVec3*)out, count);
+    }
+    
+    void GMATH_CALL DecodeMorton64Batch(const Executor& executor, const uint64_t* in, IVec3* out, size_t count)
+    {
+        ParallelArray(executor, DecodeMorton64BatchKernel, 0, in, sizeof(uint64_t), out, sizeof(IVec3), count);
+    }
+    
+    static void GetGridCellsBatchKernel(const void* params, const void* in, void* out, size_t count)
+    {
+        const GridParams& grid = *(const GridParams*)params;
+        GetGridCellsBatch((const Vec3*)in, (IVec3*)out, count, grid.origin, grid.cell_size);
+    }
+    
+    void GMATH_CALL GetGridCellsBatch(const Executor& executor, const Vec3* in, IVec3* out, size_t count, Vec3 origin, float cell_size)
+    {
+        GridParams params = {origin, cell_size};
+        ParallelArray(executor, GetGridCellsBatchKernel, &params, in, sizeof(Vec3), out, sizeof(IVec3), count);
+    }
+    
+    static void MakeRelativeBatchKernel(const void* params, const void* in, void* out, size_t count)
+    {
+        MakeRelativeBatch((const DVec3*)in, *(const DVec3*)params, (Vec3*)out, count);
+    }
+    
+    void GMATH_CALL MakeRelativeBatch(const Executor& executor, const DVec3* points, DVec3 origin, Vec3* out, size_t count)
+    {
+        ParallelArray(executor, MakeRelativeBatchKernel, &origin, points, sizeof(DVec3), out, sizeof(Vec3), count);
+    }
+    
+    struct BlendQuatsJob
+    {
+        const Quat* a;
+        const Quat* b;
+        const float* t;
+        Quat* out;
+    };
+    
+    static void RunSlerpBatch(void* data, size_t begin, size_t end)
+    {
+        const BlendQuatsJob& job = *(const BlendQuatsJob*)data;
+        SlerpBatch(job.a + begin, job.b + begin, job.t + begin, job.out + begin, end - begin);
+    }
+    
+    static void RunNlerpBatch(void* data, size_t begin, size_t end)
+    {
+        const BlendQuatsJob& job = *(const BlendQuatsJob*)data;
+        NlerpBatch(job.a + begin, job.b + begin, job.t + begin, job.out + begin, end - begin);
+    }
+    
+    void GMATH_CALL SlerpBatch(const Executor& executor, const Quat* a, const Quat* b, const float* t, Quat* out, size_t count)
+    {
+        BlendQuatsJob job = {a, b, t, out};
+        ParallelFor(executor, count, out, sizeof(Quat), RunSlerpBatch, &job);
+    }
+    
+    void GMATH_CALL NlerpBatch(const Executor& executor, const Quat* a, const Quat* b, const float* t, Quat* out, size_t count)
+    {
+        BlendQuatsJob job = {a, b, t, out};
+        ParallelFor(executor, count, out, sizeof(Quat), RunNlerpBatch, &job);
+    }
+    
+    struct ComposeTRSJob
+    {
+        const Vec3* translations;
+        const Quat* rotations;
+        const Vec3* scales;
+        void* out;
+    };
+    
+    static void RunComposeTRSBatch(void* data, size_t begin, size_t end)
+    {
+        const ComposeTRSJob& job = *(const ComposeTRSJob*)data;
+        ComposeTRSBatch(job.translations + begin, job.rotations + begin, job.scales + begin, (Mat4*)job.out + begin, end - begin);
+    }
+    
+    static void RunComposeTRSBatchMat3x4(void* data, size_t begin, size_t end)
+    {
+        const ComposeTRSJob& job = *(const ComposeTRSJob*)data;
+        ComposeTRSBatch(job.translations + begin, job.rotations + begin, job.scales + begin, (Mat3x4*)job.out + begin, end - begin);
+    }
+    
+    void GMATH_CALL ComposeTRSBatch(const Executor& executor, const Vec3* translations, const Quat* rotations, const Vec3* scales, Mat4* out, size_t count)
+    {
+        ComposeTRSJob job = {translations, rotations, scales, out};
+        ParallelFor(executor, count, out, sizeof(Mat4), RunComposeTRSBatch, &job);
+    }
+    
+    void GMATH_CALL ComposeTRSBatch(const Executor& executor, const Vec3* translations, const Quat* rotations, const Vec3* scales, Mat3x4* out, size_t count)
+    {
+        ComposeTRSJob job = {translations, rotations, scales, out};
+        ParallelFor(executor, count, out, sizeof(Mat3x4), RunComposeTRSBatchMat3x4, &job);
+    }
+    
+    // Of the three arrays written, the chunks start on cache lines of
+    // translations; rotations and scales can share a line at each boundary.
+    struct DecomposeJob
+    {
+        const Mat4* mats;
+        Vec3* translations;
+        Quat* rotations;
+        Vec3* scales;
+    };
+    
+    static void RunDecomposeBatch(void* data, size_t begin, size_t end)
+    {
+        const DecomposeJob& job = *(const DecomposeJob*)data;
+        DecomposeBatch(job.mats + begin, job.translations + begin, job.rotations + begin, job.scales + begin, end - begin);
+    }
+    
+    void GMATH_CALL DecomposeBatch(const Executor& executor, const Mat4* mats, Vec3* translations, Quat* rotations, Vec3* scales, size_t count)
+    {
+        DecomposeJob job = {mats, translations, rotations, scales};
+        ParallelFor(executor, count, translations, sizeof(Vec3), RunDecomposeBatch, &job);
+    }
+    
+    struct SkinVerticesJob
+    {
+        const DualQuat* palette;
+        const uint16_t* bones;
+        const Vec4* weights;
+        const Vec3* positions;
+        const Vec3* normals;
+        Vec3* out_positions;
+        Vec3* out_normals;
+    };
+    
+    static void RunSkinVertices(void* data, size_t begin, size_t end)
+    {
+        const SkinVerticesJob& job = *(const SkinVerticesJob*)data;
+        const Vec3* normals = job.normals ? job.normals + begin : 0;
+        Vec3* out_normals = job.out_normals ? job.out_normals + begin : 0;
+        SkinVertices(job.palette, job.bones + begin * 4, job.weights + begin, job.positions + begin, normals, job.out_positions + begin, out_normals, end - begin);
+    }
+    
+    void GMATH_CALL SkinVertices(const Executor& executor, const DualQuat* palette, const uint16_t* bones, const Vec4* weights, const Vec3* positions, const Vec3* normals, Vec3* out_positions, Vec3* out_normals, size_t count)
+    {
+        SkinVerticesJob job = {palette, bones, weights, positions, normals, out_positions, out_normals};
+        ParallelFor(executor, count, out_positions, sizeof(Vec3), RunSkinVertices, &job);
+    }
+    
+    // The visibility masks are written a 32 bit word at a time, so the chunks
+    // are whole cache lines of words: multiples of 512 elements.
+    struct CullJob
+    {
+        const Frustum* frustum;
+        const void* volumes;
+        uint32_t* visible;
+    };
+    
+    static void RunCullSpheres(void* data, size_t begin, size_t end)
+    {
+        const CullJob& job = *(const CullJob*)data;
+        CullSpheres(*job.frustum, (const Sphere*)job.volumes + begin, end - begin, job.visible + begin / 32);
+    }
+    
+    static void RunCullAABBs(void* data, size_t begin, size_t end)
+    {
+        const CullJob& job = *(const CullJob*)data;
+        CullAABBs(*job.frustum, (const AABB*)job.volumes + begin, end - begin, job.visible + begin / 32);
+    }
+    
+    void GMATH_CALL CullSpheres(const Executor& executor, const Frustum& frustum, const Sphere* spheres, size_t count, uint32_t* visible)
+    {
+        CullJob job = {&frustum, spheres, visible};
+        SplitParallel(executor, count, 512, 32 * GetParallelHead(visible, sizeof(uint32_t), 16), RunCullSpheres, &job);
+    }
+    
+    void GMATH_CALL CullAABBs(const Executor& executor, const Frustum& frustum, const AABB* boxes, size_t count, uint32_t* visible)
+    {
+        CullJob job = {&frustum, boxes, visible};
+        SplitParallel(executor, count, 512, 32 * GetParallelHead(visible, sizeof(uint32_t), 16), RunCullAABBs, &job);
+    }
+    
+    // Each level is a ParallelFor of its own, with begin and end counted from
+    // the start of the level.
+    struct WorldTransformsJob
+    {
+        const int32_t* parents;
+        const void* locals;
+        void* worlds;
+        uint8_t* dirty;
+        size_t level_start;
+    };
+    
+    static void RunUpdateWorldTransforms(void* data, size_t begin, size_t end)
+    {
+        const WorldTransformsJob& job = *(const WorldTransformsJob*)data;
+        UpdateWorldTransforms(job.parents, (const Mat4*)job.locals, (Mat4*)job.worlds, job.dirty, job.level_start + begin, job.level_start + end);
+    }
+    
+    static void RunUpdateWorldTransformsMat3x4(void* data, size_t begin, size_t end)
+    {
+        const WorldTransformsJob& job = *(const WorldTransformsJob*)data;
+        UpdateWorldTransforms(job.parents, (const Mat3x4*)job.locals, (Mat3x4*)job.worlds, job.dirty, job.level_start + begin, job.level_start + end);
+    }
+    
+    void GMATH_CALL UpdateWorldTransforms(const Executor& executor, const int32_t* parents, const Mat4* locals, Mat4* worlds, uint8_t* dirty, const size_t* level_starts, size_t levels)
+    {
+        WorldTransformsJob job = {parents, locals, worlds, dirty, 0};
+        for (size_t level = 0; level < levels; ++level)
+        {
+            job.level_start = level_starts[level];
+            ParallelFor(executor, level_starts[level + 1] - job.level_start, worlds + job.level_start, sizeof(Mat4), RunUpdateWorldTransforms, &job);
+        }
+    }
+    
+    void GMATH_CALL UpdateWorldTransforms(const Executor& executor, const int32_t* parents, const Mat3x4* locals, Mat3x4* worlds, uint8_t* dirty, const size_t* level_starts, size_t levels)
+    {
+        WorldTransformsJob job = {parents, locals, worlds, dirty, 0};
+        for (size_t level = 0; level < levels; ++level)
+        {
+            job.level_start = level_starts[level];
+            ParallelFor(executor, level_starts[level + 1] - job.level_start, worlds + job.level_start, sizeof(Mat3x4), RunUpdateWorldTransformsMat3x4, &job);
+        }
+    }
+    
+    // Printing.
+    
+#ifdef GMATH_USE_IOSTREAM
+    std::ostream& operator<<(std::ostream& a, IVec2 b) {return a << "(" << b.x << ", " << b.y << ")";}
+    
+    std::ostream& operator<<(std::ostream& a, IVec3 b) {return a << "(" << b.x << ", " << b.y << ", " << b.z << ")";}
+    
+    std::ostream& operator<<(std::ostream& a, const IVec4& b)
+    {
+        return a << "(" << b.x << ", " << b.y << ", " << b.z << ", " << b.w << ")";
+    }
+    
+    std::ostream& operator<<(std::ostream& a, Vec2 b) {return a << "(" << b.x << ", " << b.y << ")";}
+    
+    std::ostream& operator<<(std::ostream& a, Vec3 b)
+    {
+        return a << "(" << b.x << ", " << b.y << ", " << b.z << ")";
+    }
+    
+    std::ostream& operator<<(std::ostream& a, Vec4 b)
+    {
+        return a << "(" << b.x << ", " << b.y << ", " << b.z << ", " << b.w << ")";
+    }
+    
+    std::ostream& operator<<(std::ostream& a, Vec3A b)
+    {
+        return a << "(" << b.x << ", " << b.y << ", " << b.z << ")";
+    }
+    
+    std::ostream& operator<<(std::ostream& a, const Mat4& b)
+    {
+        for (int i = 0; i < 4; ++i)
+        {
+            a << "| " << b[0][i] << ", " << b[1][i] << ", " << b[2][i] << ", " << b[3][i] << " |" << std::endl;
+        }
+        return a;
+    }
+    
+    std::ostream& operator<<(std::ostream& a, Quat b)
+    {
+        return a << "(" << b.x << ", " << b.y << ", " << b.z << ", " << b.w << ")";
+    }
+    
+    std::ostream& operator<<(std::ostream& a, const Mat3x4& b)
+    {
+        for (int i = 0; i < 3; ++i)
+        {
+            a << "| " << b[i][0] << ", " << b[i][1] << ", " << b[i][2] << ", " << b[i][3] << " |" << std::endl;
+        }
+        return a;
+    }
+    
+    std::ostream& operator<<(std::ostream& a, const DualQuat& b)
+    {
+        return a << "(" << b.real << ", " << b.dual << ")";
+    }
+    
+    std::ostream& operator<<(std::ostream& a, DVec2 b) {return a << "(" << b.x << ", " << b.y << ")";}
+    
+    std::ostream& operator<<(std::ostream& a, DVec3 b)
+    {
+        return a << "(" << b.x << ", " << b.y << ", " << b.z << ")";
+    }
+    
+    std::ostream& operator<<(std::ostream& a, const DVec4& b)
+    {
+        return a << "(" << b.x << ", " << b.y << ", " << b.z << ", " << b.w << ")";
+    }
+    
+    std::ostream& operator<<(std::ostream& a, const DQuat& b)
+    {
+        return a << "(" << b.x << ", " << b.y << ", " << b.z << ", " << b.w << ")";
+    }
+    
+    std::ostream& operator<<(std::ostream& a, const DMat4& b)
+    {
+        for (int i = 0; i < 4; ++i)
+        {
+            a << "| " << b[0][i] << ", " << b[1][i] << ", " << b[2][i] << ", " << b[3][i] << " |" << std::endl;
+        }
+        return a;
+    }
+#endif
+#endif // GMATH_IMPLEMENTATION
+    
+#ifdef GMATH_USE_NAMESPACE
+};
+#endif
+#endif // GMATH_INLINE_H
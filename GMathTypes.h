@@ -0,0 +1,19 @@
+/*
+================================================================================
+
+The GMath types, constants and declarations, without the inline definitions
+GMath.h adds. Including this instead of GMath.h in headers that only pass GMath
+values around (and in precompiled headers shared by such files) saves parsing
+those definitions. A file that calls an inline function still needs GMath.h,
+and will fail to link without it.
+
+================================================================================
+*/
+
+#ifndef GMATH_TYPES_ONLY
+#define GMATH_TYPES_ONLY
+#include "GMath.h"
+#undef GMATH_TYPES_ONLY
+#else
+#include "GMath.h"
+#endif
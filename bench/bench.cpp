@@ -0,0 +1,587 @@
+/*
+================================================================================
+
+GMath micro-benchmarks.
+
+Times the hot operations in whichever configuration GMath.h is compiled in, so
+the same file is built once per SIMD tier (see the Makefile in this directory)
+and the outputs compared side by side.
+
+Every operation is measured two ways:
+
+- Latency: a dependent chain, where each call takes the previous result as
+input. This is what a transform hierarchy or an iterative solver sees.
+
+- Throughput: a batch of independent inputs, so the CPU can overlap calls. This
+is what a skinning or culling loop sees.
+
+Both are reported in nanoseconds per operation (best of several runs), along
+with the throughput in millions of operations per second.
+
+================================================================================
+*/
+
+// BENCH_LIBRARY builds link the implementation from libgmath.a instead.
+#ifndef BENCH_LIBRARY
+#define GMATH_IMPLEMENTATION
+#endif
+#include "../GMath.h"
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace GMath;
+
+static const int kChainLength = 1 << 18;
+static const int kBatchSize = 1024;
+static const int kBatchRepeats = 256;
+static const int kRuns = 5;
+
+// Results are written here so the compiler can't discard the work.
+static volatile float g_sink;
+
+static double NowNs()
+{
+    using namespace std::chrono;
+    return (double)duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+template <typename Function>
+static double BestNsPerOp(Function function, double ops)
+{
+    double best = 0.0;
+    for (int run = 0; run < kRuns; ++run)
+    {
+        double start = NowNs();
+        function();
+        double elapsed = (NowNs() - start) / ops;
+        if (run == 0 || elapsed < best) best = elapsed;
+    }
+    return best;
+}
+
+static void Report(const char* name, double latency, double throughput)
+{
+    if (latency > 0.0) printf("%-32s %12.2f %12.2f %12.1f\n", name, latency, throughput, 1000.0 / throughput);
+    else printf("%-32s %12s %12.2f %12.1f\n", name, "-", throughput, 1000.0 / throughput);
+}
+
+template <typename Chain, typename Batch>
+static void Run(const char* name, Chain chain, Batch batch)
+{
+    double latency = BestNsPerOp(chain, (double)kChainLength);
+    double throughput = BestNsPerOp(batch, (double)kBatchSize * kBatchRepeats);
+    Report(name, latency, throughput);
+}
+
+// For the array kernels, which have no meaningful dependent form.
+template <typename Batch>
+static void RunBatch(const char* name, Batch batch)
+{
+    Report(name, 0.0, BestNsPerOp(batch, (double)kBatchSize * kBatchRepeats));
+}
+
+static float Random(float min, float max)
+{
+    return min + (max - min) * ((float)rand() / (float)RAND_MAX);
+}
+
+static Vec3 RandomVec3()
+{
+    return CreateVec3(Random(-1.0f, 1.0f), Random(-1.0f, 1.0f), Random(-1.0f, 1.0f));
+}
+
+static Quat RandomQuat()
+{
+    return Normalize(CreateQuat(Random(-1.0f, 1.0f), Random(-1.0f, 1.0f), Random(-1.0f, 1.0f), Random(-1.0f, 1.0f)));
+}
+
+static Mat4 RandomRigid()
+{
+    return CreateTranslationMatrix(RandomVec3()) * CreateMat4(RandomQuat());
+}
+
+// Inputs live in static arrays, so the batches stream through the same memory
+// every repeat and stay in cache.
+static Mat4 g_mats_a[kBatchSize];
+static Mat4 g_mats_b[kBatchSize];
+static Mat4 g_mats_out[kBatchSize];
+static Mat3x4 g_affines_a[kBatchSize];
+static Mat3x4 g_affines_b[kBatchSize];
+static Mat3x4 g_affines_out[kBatchSize];
+static Vec4 g_vec4s[kBatchSize];
+static Vec4 g_vec4s_out[kBatchSize];
+static Vec3 g_vec3s[kBatchSize];
+static Vec3 g_vec3s_out[kBatchSize];
+static Mat4 g_inverses_out[8];
+static Frustum g_frustums_out[4];
+static Vec3A g_vec3as[kBatchSize];
+static Vec3A g_vec3as_out[kBatchSize];
+static Quat g_quats_a[kBatchSize];
+static Quat g_quats_b[kBatchSize];
+static Quat g_quats_out[kBatchSize];
+static float g_floats[kBatchSize];
+static float g_alphas[kBatchSize];
+static Vec4 g_float_lanes[kBatchSize / 4];
+static float g_floats_out[kBatchSize];
+static Sphere g_spheres[kBatchSize];
+static AABB g_aabbs[kBatchSize];
+static uint32_t g_visible[kBatchSize / 32];
+static Ray g_rays[kBatchSize];
+static AABBx4 g_aabbx4s[kBatchSize / 4];
+static Rayx4 g_rayx4s[kBatchSize / 4];
+static AABB g_aabbs_out[kBatchSize];
+static int g_masks_out[kBatchSize];
+static int32_t g_parents[kBatchSize];
+static uint8_t g_dirty[kBatchSize];
+static DualQuat g_palette[64];
+static Mat4 g_palette_mats[64];
+static uint16_t g_bones[kBatchSize * 4];
+static Vec4 g_weights[kBatchSize];
+static Vec3 g_normals[kBatchSize];
+static Vec3 g_normals_out[kBatchSize];
+static uint32_t g_packed[kBatchSize];
+static Quat48 g_quat48s[kBatchSize];
+static Half4 g_half4s[kBatchSize];
+static IVec3 g_ivec3s[kBatchSize];
+static IVec4 g_ivec4s_a[kBatchSize];
+static IVec4 g_ivec4s_b[kBatchSize];
+static IVec4 g_ivec4s_out[kBatchSize];
+static uint32_t g_codes[kBatchSize];
+static IVec3 g_ivec3s_out[kBatchSize];
+static uint64_t g_codes64[kBatchSize];
+static uint32_t g_sort_keys[kBatchSize];
+static uint32_t g_sort_values[kBatchSize];
+static uint32_t g_sort_scratch[2][kBatchSize];
+static DMat4 g_dmats_a[kBatchSize];
+static DMat4 g_dmats_b[kBatchSize];
+static DMat4 g_dmats_out[kBatchSize];
+static DVec4 g_dvec4s[kBatchSize];
+static DVec4 g_dvec4s_out[kBatchSize];
+static DVec3 g_dvec3s[kBatchSize];
+static DQuat g_dquats_a[kBatchSize];
+static DQuat g_dquats_b[kBatchSize];
+static DQuat g_dquats_out[kBatchSize];
+static const AABB g_bounds = {{-1.0f, -1.0f, -1.0f}, {1.0f, 1.0f, 1.0f}};
+
+// Calls through these are never inlined, so the "(call)" rows measure what a
+// call costs when the compiler decides not to inline one (as it often does
+// across translation units): mostly how the arguments are passed.
+static Mat4 (GMATH_CALL* volatile g_multiply_mat4)(const Mat4&, const Mat4&) = &operator*;
+static Vec4 (GMATH_CALL* volatile g_multiply_vec4)(const Mat4&, const Vec4&) = &operator*;
+static Mat4 (GMATH_CALL* volatile g_inverse)(const Mat4&) = &Inverse;
+
+static void Setup()
+{
+    srand(1234);
+    for (int i = 0; i < kBatchSize; ++i)
+    {
+        g_mats_a[i] = RandomRigid();
+        g_mats_b[i] = RandomRigid();
+        g_affines_a[i] = CreateMat3x4(g_mats_a[i]);
+        g_affines_b[i] = CreateMat3x4(g_mats_b[i]);
+        g_vec3s[i] = RandomVec3();
+        g_vec4s[i] = CreateVec4(g_vec3s[i], 1.0f);
+        g_vec3as[i] = CreateVec3A(g_vec3s[i]);
+        g_quats_a[i] = RandomQuat();
+        g_quats_b[i] = RandomQuat();
+        g_floats[i] = Random(-1.0f, 1.0f);
+        g_alphas[i] = Random(0.0f, 1.0f);
+        g_float_lanes[i / 4][i % 4] = g_floats[i];
+        Vec3 extent = CreateVec3(Random(0.0f, 0.1f), Random(0.0f, 0.1f), Random(0.0f, 0.1f));
+        g_spheres[i] = {g_vec3s[i], Random(0.0f, 0.1f)};
+        g_aabbs[i] = {g_vec3s[i] - extent, g_vec3s[i] + extent};
+        g_rays[i] = {RandomVec3() * 2.0f, RandomVec3()};
+        // A four way tree, which is breadth first.
+        g_parents[i] = i == 0 ? -1 : (i - 1) / 4;
+        for (int j = 0; j < 4; ++j) g_bones[i * 4 + j] = (uint16_t)(rand() % 64);
+        g_weights[i] = CreateVec4(0.4f, 0.3f, 0.2f, 0.1f);
+        g_normals[i] = Normalize(RandomVec3());
+        g_packed[i] = PackQuat32(g_quats_a[i]);
+        g_quat48s[i] = PackQuat48(g_quats_a[i]);
+        g_half4s[i] = PackHalf4(g_vec4s[i]);
+        g_ivec3s[i] = Quantize(g_vec3s[i], g_bounds, 16);
+        g_ivec4s_a[i] = CreateIVec4(rand() - RAND_MAX / 2, rand() - RAND_MAX / 2, rand() - RAND_MAX / 2, rand() - RAND_MAX / 2);
+        g_ivec4s_b[i] = CreateIVec4(rand() % 64 + 1, rand() % 64 + 1, rand() % 64 + 1, rand() % 64 + 1);
+        g_codes[i] = EncodeMorton(g_ivec3s[i]);
+        g_codes64[i] = EncodeMorton64(g_ivec3s[i]);
+        g_dmats_a[i] = CreateDMat4(g_mats_a[i]);
+        g_dmats_b[i] = CreateDMat4(g_mats_b[i]);
+        g_dvec4s[i] = CreateDVec4(g_vec4s[i]);
+        g_dvec3s[i] = CreateDVec3(g_vec3s[i]) + CreateDVec3(1.0e7, 0.0, -1.0e7);
+        g_dquats_a[i] = CreateDQuat(g_quats_a[i]);
+        g_dquats_b[i] = CreateDQuat(g_quats_b[i]);
+    }
+    for (int i = 0; i < 64; ++i)
+    {
+        g_palette_mats[i] = g_mats_a[i];
+        g_palette[i] = CreateDualQuat(g_mats_a[i]);
+    }
+    for (int i = 0; i < kBatchSize / 4; ++i)
+    {
+        g_aabbx4s[i] = LoadAABBx4(g_aabbs + i * 4);
+        g_rayx4s[i] = LoadRayx4(g_rays + i * 4);
+    }
+}
+
+int main()
+{
+    Setup();
+#if defined(GMATH_USE_AVX)
+    const char* tier = "SSE + AVX2/FMA";
+#elif defined(GMATH_DISPATCH_AVX)
+    const char* tier = (GetCPUFeatures() & GMATH_CPU_AVX2) ? "SSE, AVX2 batch kernels picked at run time" : "SSE, no AVX2 at run time";
+#elif defined(GMATH_USE_SSE)
+    const char* tier = "SSE";
+#elif defined(GMATH_USE_NEON)
+    const char* tier = "NEON";
+#else
+    const char* tier = "scalar";
+#endif
+    printf("GMath benchmarks (%s)\n\n", tier);
+    printf("%-32s %12s %12s %12s\n", "operation", "latency ns", "thruput ns", "Mops/s");
+    
+    // The chains feed each result back in through a rotation (or a blend with
+    // a fixed input), so the values stay bounded however long they run.
+    Mat4 step = g_mats_a[0];
+    Quat step_quat = g_quats_a[0];
+    DMat4 dstep = g_dmats_a[0];
+    DQuat dstep_quat = g_dquats_a[0];
+    // Looks at the unit cube the bounds are scattered through from just
+    // outside it, so some of them are culled by each plane.
+    Frustum frustum = CreateFrustum(CreatePerspectiveMatrix(60.0f, 1.5f, 0.1f, 2.5f) *
+        CreateLookAtMatrix(CreateVec3(0.0f, 0.0f, -1.5f), CreateVec3(0.0f, 0.0f, 0.0f), CreateVec3(0.0f, 1.0f, 0.0f)));
+    
+    Run("Mat4 * Mat4",
+        [&]{Mat4 m = g_mats_b[0]; for (int i = 0; i < kChainLength; ++i) m = m * step; g_sink = m[3][0];},
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) for (int i = 0; i < kBatchSize; ++i) g_mats_out[i] = g_mats_a[i] * g_mats_b[i]; g_sink = g_mats_out[0][0][0];});
+    Run("Mat4 * Vec4",
+        [&]{Vec4 v = g_vec4s[0]; for (int i = 0; i < kChainLength; ++i) v = step * v; g_sink = v.x;},
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) for (int i = 0; i < kBatchSize; ++i) g_vec4s_out[i] = step * g_vec4s[i]; g_sink = g_vec4s_out[0].x;});
+    Run("Mat4 * Mat4 (call)",
+        [&]{Mat4 m = g_mats_b[0]; for (int i = 0; i < kChainLength; ++i) m = g_multiply_mat4(m, step); g_sink = m[3][0];},
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) for (int i = 0; i < kBatchSize; ++i) g_mats_out[i] = g_multiply_mat4(g_mats_a[i], g_mats_b[i]); g_sink = g_mats_out[0][0][0];});
+    Run("Mat4 * Vec4 (call)",
+        [&]{Vec4 v = g_vec4s[0]; for (int i = 0; i < kChainLength; ++i) v = g_multiply_vec4(step, v); g_sink = v.x;},
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) for (int i = 0; i < kBatchSize; ++i) g_vec4s_out[i] = g_multiply_vec4(step, g_vec4s[i]); g_sink = g_vec4s_out[0].x;});
+    // Per-object model-view-projection of a vertex, with the matrices
+    // multiplied out left to right, and applied one by one through a chain.
+    Mat4 proj = CreatePerspectiveMatrix(60.0f, 1.5f, 0.1f, 100.0f);
+    RunBatch("proj * view * model * v",
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) for (int i = 0; i < kBatchSize; ++i) g_vec4s_out[i] = proj * step * g_mats_a[i] * g_vec4s[i]; g_sink = g_vec4s_out[0].x;});
+    RunBatch("Chain(proj) * view * model * v",
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) for (int i = 0; i < kBatchSize; ++i) g_vec4s_out[i] = Chain(proj) * step * g_mats_a[i] * g_vec4s[i]; g_sink = g_vec4s_out[0].x;});
+    RunBatch("a * s + b * t - c (Vec4)",
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) for (int i = 1; i < kBatchSize; ++i) g_vec4s_out[i] = g_vec4s[i] * 0.5f + g_vec4s[i - 1] * 0.25f - step[0]; g_sink = g_vec4s_out[1].x;});
+    RunBatch("MultiplyAdd chain (Vec4)",
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) for (int i = 1; i < kBatchSize; ++i) g_vec4s_out[i] = MultiplyAdd(g_vec4s[i], 0.5f, MultiplyAdd(g_vec4s[i - 1], 0.25f, -step[0])); g_sink = g_vec4s_out[1].x;});
+    Run("DMat4 * DMat4",
+        [&]{DMat4 m = g_dmats_b[0]; for (int i = 0; i < kChainLength; ++i) m = m * dstep; g_sink = (float)m[3][0];},
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) for (int i = 0; i < kBatchSize; ++i) g_dmats_out[i] = g_dmats_a[i] * g_dmats_b[i]; g_sink = (float)g_dmats_out[0][0][0];});
+    Run("DMat4 * DVec4",
+        [&]{DVec4 v = g_dvec4s[0]; for (int i = 0; i < kChainLength; ++i) v = dstep * v; g_sink = (float)v.x;},
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) for (int i = 0; i < kBatchSize; ++i) g_dvec4s_out[i] = dstep * g_dvec4s[i]; g_sink = (float)g_dvec4s_out[0].x;});
+    RunBatch("TransformVec4s",
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) TransformVec4s(step, g_vec4s, g_vec4s_out, kBatchSize); g_sink = g_vec4s_out[0].x;});
+    RunBatch("TransformPoints",
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) TransformPoints(step, g_vec3s, g_vec3s_out, kBatchSize); g_sink = g_vec3s_out[0].x;});
+    // One array of all the repeats, across a pool of one thread per core.
+    {
+        const size_t count = (size_t)kBatchSize * kBatchRepeats;
+        Vec3* points = (Vec3*)malloc(count * sizeof(Vec3));
+        Vec3* points_out = (Vec3*)malloc(count * sizeof(Vec3));
+        for (size_t i = 0; i < count; ++i) points[i] = g_vec3s[i % kBatchSize];
+        Executor pool = CreateThreadPool();
+        RunBatch("TransformPoints, one array",
+            [&]{TransformPoints(step, points, points_out, count); g_sink = points_out[0].x;});
+        RunBatch("TransformPoints, thread pool",
+            [&]{TransformPoints(pool, step, points, points_out, count); g_sink = points_out[0].x;});
+        DestroyThreadPool(pool);
+        free(points_out);
+        free(points);
+    }
+    RunBatch("MakeRelativeBatch",
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) MakeRelativeBatch(g_dvec3s, g_dvec3s[0], g_vec3s_out, kBatchSize); g_sink = g_vec3s_out[1].x;});
+    RunBatch("CullSpheres",
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) CullSpheres(frustum, g_spheres, kBatchSize, g_visible); g_sink = (float)g_visible[0];});
+    RunBatch("CullAABBs",
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) CullAABBs(frustum, g_aabbs, kBatchSize, g_visible); g_sink = (float)g_visible[0];});
+    RunBatch("Intersect(Ray, AABB)",
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) for (int i = 0; i < kBatchSize; ++i) g_masks_out[i] = Intersect(g_rays[i], g_aabbs[i], g_floats_out[i]); g_sink = g_floats_out[0];});
+    RunBatch("Intersect(Ray, AABBx4) per box",
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) for (int i = 0; i < kBatchSize / 4; ++i) g_masks_out[i] = Intersect(g_rays[i], g_aabbx4s[i], g_vec4s_out[i]); g_sink = g_vec4s_out[0].x;});
+    RunBatch("Intersect(Rayx4, AABB) per ray",
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) for (int i = 0; i < kBatchSize / 4; ++i) g_masks_out[i] = Intersect(g_rayx4s[i], g_aabbs[i], g_vec4s_out[i]); g_sink = g_vec4s_out[0].x;});
+    // A moving camera's matrices, their inverses and its frustum rebuilt from
+    // scratch, versus updating a cached Camera.
+    Camera camera = CreateCamera(g_vec3s[0], CreateVec3(0.0f, 0.0f, 0.0f), CreateVec3(0.0f, 1.0f, 0.0f), 60.0f, 1.5f, 0.1f, 100.0f);
+    RunBatch("Camera matrices from scratch",
+        [&]{
+            for (int r = 0; r < kBatchRepeats; ++r)
+            {
+                for (int i = 0; i < kBatchSize; ++i)
+                {
+                    Mat4 view = CreateLookAtMatrix(g_vec3s[i], CreateVec3(0.0f, 0.0f, 0.0f), CreateVec3(0.0f, 1.0f, 0.0f));
+                    Mat4 projection = CreatePerspectiveMatrix(60.0f, 1.5f, 0.1f, 100.0f);
+                    Mat4 view_projection = projection * view;
+                    g_mats_out[i] = Inverse(view_projection);
+                    g_inverses_out[i % 4] = InverseRigid(view);
+                    g_inverses_out[4 + i % 4] = Inverse(projection);
+                    g_frustums_out[i % 4] = CreateFrustum(view_projection);
+                }
+            }
+            g_sink = g_mats_out[0][0][0] + g_inverses_out[0][0][0] + g_inverses_out[4][0][0] + g_frustums_out[0].planes[0].x;
+        });
+    RunBatch("UpdateCamera, eye moved",
+        [&]{
+            for (int r = 0; r < kBatchRepeats; ++r)
+            {
+                for (int i = 0; i < kBatchSize; ++i)
+                {
+                    SetCameraLookAt(camera, g_vec3s[i], CreateVec3(0.0f, 0.0f, 0.0f), CreateVec3(0.0f, 1.0f, 0.0f));
+                    UpdateCamera(camera);
+                }
+            }
+            g_sink = camera.inverse_view_projection[0][0];
+        });
+    RunBatch("UpdateCamera, unchanged",
+        [&]{
+            for (int r = 0; r < kBatchRepeats; ++r)
+            {
+                for (int i = 0; i < kBatchSize; ++i)
+                {
+                    SetCameraPerspective(camera, 60.0f, 1.5f, 0.1f, 100.0f);
+                    UpdateCamera(camera);
+                }
+            }
+            g_sink = camera.inverse_view_projection[0][0];
+        });
+    // Per-frame scratch for a batch transform, taken from the heap versus the
+    // thread's arena.
+    RunBatch("Scratch Vec4s from malloc",
+        [&]{
+            for (int r = 0; r < kBatchRepeats; ++r)
+            {
+                Vec4* scratch = (Vec4*)malloc(sizeof(Vec4) * kBatchSize);
+                TransformVec4s(step, g_vec4s, scratch, kBatchSize);
+                g_sink = scratch[r].x;
+                free(scratch);
+            }
+        });
+    RunBatch("Scratch Vec4s from thread arena",
+        [&]{
+            for (int r = 0; r < kBatchRepeats; ++r)
+            {
+                Arena& arena = GetThreadArena();
+                size_t mark = GetArenaMark(arena);
+                Vec4* scratch = AllocateVec4s(arena, kBatchSize);
+                TransformVec4sAligned(step, g_vec4s, scratch, kBatchSize);
+                g_sink = scratch[r].x;
+                RewindArena(arena, mark);
+            }
+        });
+    Run("TransformAABB(Mat4)",
+        [&]{AABB box = g_aabbs[0]; for (int i = 0; i < kChainLength; ++i) box = TransformAABB(step, box); g_sink = box.min.x;},
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) for (int i = 0; i < kBatchSize; ++i) g_aabbs_out[i] = TransformAABB(g_mats_a[i], g_aabbs[i]); g_sink = g_aabbs_out[0].min.x;});
+    RunBatch("UpdateWorldTransforms(Mat4)",
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) UpdateWorldTransforms(g_parents, g_mats_a, g_mats_out, nullptr, 0, kBatchSize); g_sink = g_mats_out[0][0][0];});
+    RunBatch("UpdateWorldTransforms(Mat3x4)",
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) UpdateWorldTransforms(g_parents, g_affines_a, g_affines_out, nullptr, 0, kBatchSize); g_sink = g_affines_out[0][0][0];});
+    // Every node is visited, but only one of the four subtrees below the root
+    // (about a quarter of the nodes) is recomputed.
+    RunBatch("UpdateWorldTransforms, 1/4 dirty",
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) {memset(g_dirty, 0, sizeof(g_dirty)); g_dirty[1] = 1; UpdateWorldTransforms(g_parents, g_affines_a, g_affines_out, g_dirty, 0, kBatchSize);} g_sink = g_affines_out[0][0][0];});
+    RunBatch("SkinVertices, 4 bones",
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) SkinVertices(g_palette, g_bones, g_weights, g_vec3s, g_normals, g_vec3s_out, g_normals_out, kBatchSize); g_sink = g_vec3s_out[0].x;});
+    // The Mat4 linear blend skinning loop it replaces, for comparison.
+    RunBatch("Mat4 linear blend, 4 bones",
+        [&]{
+            for (int r = 0; r < kBatchRepeats; ++r)
+            {
+                for (int i = 0; i < kBatchSize; ++i)
+                {
+                    const uint16_t* bones = g_bones + i * 4;
+                    const Vec4& weights = g_weights[i];
+                    Mat4 blend = g_palette_mats[bones[0]] * weights.x + g_palette_mats[bones[1]] * weights.y +
+                                 g_palette_mats[bones[2]] * weights.z + g_palette_mats[bones[3]] * weights.w;
+                    g_vec3s_out[i] = (blend * CreateVec4(g_vec3s[i], 1.0f)).xyz;
+                    g_normals_out[i] = (blend * CreateVec4(g_normals[i], 0.0f)).xyz;
+                }
+            }
+            g_sink = g_vec3s_out[0].x;
+        });
+    RunBatch("PackQuat32Batch",
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) PackQuat32Batch(g_quats_a, g_packed, kBatchSize); g_sink = (float)g_packed[0];});
+    RunBatch("UnpackQuat32Batch",
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) UnpackQuat32Batch(g_packed, g_quats_out, kBatchSize); g_sink = g_quats_out[0].x;});
+    RunBatch("PackQuat48Batch",
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) PackQuat48Batch(g_quats_a, g_quat48s, kBatchSize); g_sink = (float)g_quat48s[0].data[0];});
+    RunBatch("UnpackQuat48Batch",
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) UnpackQuat48Batch(g_quat48s, g_quats_out, kBatchSize); g_sink = g_quats_out[0].x;});
+    RunBatch("PackNormalBatch",
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) PackNormalBatch(g_normals, g_packed, kBatchSize); g_sink = (float)g_packed[0];});
+    RunBatch("UnpackNormalBatch",
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) UnpackNormalBatch(g_packed, g_normals_out, kBatchSize); g_sink = g_normals_out[0].x;});
+    RunBatch("PackHalf4Batch",
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) PackHalf4Batch(g_vec4s, g_half4s, kBatchSize); g_sink = (float)g_half4s[0].data[0];});
+    RunBatch("UnpackHalf4Batch",
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) UnpackHalf4Batch(g_half4s, g_vec4s_out, kBatchSize); g_sink = g_vec4s_out[0].x;});
+    RunBatch("QuantizeBatch, 16 bits",
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) QuantizeBatch(g_vec3s, g_ivec3s, kBatchSize, g_bounds, 16); g_sink = (float)g_ivec3s[0].x;});
+    RunBatch("DequantizeBatch, 16 bits",
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) DequantizeBatch(g_ivec3s, g_vec3s_out, kBatchSize, g_bounds, 16); g_sink = g_vec3s_out[0].x;});
+    RunBatch("Mod(IVec4)",
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) for (int i = 0; i < kBatchSize; ++i) g_ivec4s_out[i] = Mod(g_ivec4s_a[i], g_ivec4s_b[i]); g_sink = (float)g_ivec4s_out[0].x;});
+    // The same remainders one int at a time, for comparison.
+    RunBatch("Mod(int) x 4",
+        [&]{
+            for (int r = 0; r < kBatchRepeats; ++r)
+            {
+                for (int i = 0; i < kBatchSize; ++i)
+                {
+                    for (int j = 0; j < 4; ++j) g_ivec4s_out[i][j] = Mod(g_ivec4s_a[i][j], g_ivec4s_b[i][j]);
+                }
+            }
+            g_sink = (float)g_ivec4s_out[0].x;
+        });
+    RunBatch("EncodeMortonBatch",
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) EncodeMortonBatch(g_ivec3s, g_codes, kBatchSize); g_sink = (float)g_codes[0];});
+    RunBatch("DecodeMortonBatch",
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) DecodeMortonBatch(g_codes, g_ivec3s_out, kBatchSize); g_sink = (float)g_ivec3s_out[0].x;});
+    RunBatch("EncodeMorton64Batch",
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) EncodeMorton64Batch(g_ivec3s, g_codes64, kBatchSize); g_sink = (float)g_codes64[0];});
+    RunBatch("DecodeMorton64Batch",
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) DecodeMorton64Batch(g_codes64, g_ivec3s_out, kBatchSize); g_sink = (float)g_ivec3s_out[0].x;});
+    RunBatch("GetGridCellsBatch",
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) GetGridCellsBatch(g_vec3s, g_ivec3s_out, kBatchSize, Vec3::Zero, 0.2f); g_sink = (float)g_ivec3s_out[0].x;});
+    // The keys are copied back in every repeat, so each sort starts unsorted.
+    RunBatch("RadixSort, 30 bit keys",
+        [&]{
+            for (int r = 0; r < kBatchRepeats; ++r)
+            {
+                for (int i = 0; i < kBatchSize; ++i) {g_sort_keys[i] = g_codes[i]; g_sort_values[i] = (uint32_t)i;}
+                RadixSort(g_sort_keys, g_sort_values, kBatchSize, g_sort_scratch[0], g_sort_scratch[1]);
+            }
+            g_sink = (float)g_sort_values[0];
+        });
+    RunBatch("SortByMorton",
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) SortByMorton(g_vec3s, kBatchSize, g_bounds, g_sort_values, g_vec3s_out); g_sink = g_vec3s_out[0].x;});
+    SpatialHash hash = CreateSpatialHash(0.2f, kBatchSize);
+    RunBatch("BuildSpatialHash",
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) BuildSpatialHash(hash, g_vec3s, kBatchSize); g_sink = (float)hash.indices[0];});
+    DestroySpatialHash(hash);
+    Run("Transpose(Mat4)",
+        [&]{Mat4 m = g_mats_a[0]; for (int i = 0; i < kChainLength; ++i) m = Transpose(m); g_sink = m[1][0];},
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) for (int i = 0; i < kBatchSize; ++i) g_mats_out[i] = Transpose(g_mats_a[i]); g_sink = g_mats_out[0][1][0];});
+    Run("Inverse(Mat4)",
+        [&]{Mat4 m = g_mats_a[0]; for (int i = 0; i < kChainLength; ++i) m = Inverse(m); g_sink = m[3][0];},
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) for (int i = 0; i < kBatchSize; ++i) g_mats_out[i] = Inverse(g_mats_a[i]); g_sink = g_mats_out[0][3][0];});
+    Run("Inverse(Mat4) (call)",
+        [&]{Mat4 m = g_mats_a[0]; for (int i = 0; i < kChainLength; ++i) m = g_inverse(m); g_sink = m[3][0];},
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) for (int i = 0; i < kBatchSize; ++i) g_mats_out[i] = g_inverse(g_mats_a[i]); g_sink = g_mats_out[0][3][0];});
+    Run("InverseRigid(Mat4)",
+        [&]{Mat4 m = g_mats_a[0]; for (int i = 0; i < kChainLength; ++i) m = InverseRigid(m); g_sink = m[3][0];},
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) for (int i = 0; i < kBatchSize; ++i) g_mats_out[i] = InverseRigid(g_mats_a[i]); g_sink = g_mats_out[0][3][0];});
+    Run("Mat3x4 * Mat3x4",
+        [&]{Mat3x4 m = g_affines_b[0]; Mat3x4 s = g_affines_a[0]; for (int i = 0; i < kChainLength; ++i) m = m * s; g_sink = m[0][3];},
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) for (int i = 0; i < kBatchSize; ++i) g_affines_out[i] = g_affines_a[i] * g_affines_b[i]; g_sink = g_affines_out[0][0][0];});
+    Run("Quat * Quat",
+        [&]{Quat q = g_quats_b[0]; for (int i = 0; i < kChainLength; ++i) q = q * step_quat; g_sink = q.x;},
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) for (int i = 0; i < kBatchSize; ++i) g_quats_out[i] = g_quats_a[i] * g_quats_b[i]; g_sink = g_quats_out[0].x;});
+    Run("DQuat * DQuat",
+        [&]{DQuat q = g_dquats_b[0]; for (int i = 0; i < kChainLength; ++i) q = q * dstep_quat; g_sink = (float)q.x;},
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) for (int i = 0; i < kBatchSize; ++i) g_dquats_out[i] = g_dquats_a[i] * g_dquats_b[i]; g_sink = (float)g_dquats_out[0].x;});
+    Run("Slerp(Quat)",
+        [&]{Quat q = g_quats_b[0]; for (int i = 0; i < kChainLength; ++i) q = Slerp(q, g_quats_a[i & 7], 0.5f); g_sink = q.x;},
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) for (int i = 0; i < kBatchSize; ++i) g_quats_out[i] = Slerp(g_quats_a[i], g_quats_b[i], 0.3f); g_sink = g_quats_out[0].x;});
+    RunBatch("SlerpBatch",
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) SlerpBatch(g_quats_a, g_quats_b, g_alphas, g_quats_out, kBatchSize); g_sink = g_quats_out[0].x;});
+    Run("Lerp(Quat)",
+        [&]{Quat q = g_quats_b[0]; for (int i = 0; i < kChainLength; ++i) q = Lerp(q, g_quats_a[i & 7], 0.5f); g_sink = q.x;},
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) for (int i = 0; i < kBatchSize; ++i) g_quats_out[i] = Lerp(g_quats_a[i], g_quats_b[i], 0.3f); g_sink = g_quats_out[0].x;});
+    RunBatch("NlerpBatch",
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) NlerpBatch(g_quats_a, g_quats_b, g_alphas, g_quats_out, kBatchSize); g_sink = g_quats_out[0].x;});
+    Run("CreateQuat(Mat4)",
+        [&]{Mat4 m = g_mats_a[0]; Quat q = {}; for (int i = 0; i < kChainLength; ++i) {m[3][0] = q.x; q = CreateQuat(m);} g_sink = q.x;},
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) for (int i = 0; i < kBatchSize; ++i) g_quats_out[i] = CreateQuat(g_mats_a[i]); g_sink = g_quats_out[0].x;});
+    Run("CreateMat4(Quat)",
+        [&]{Quat q = g_quats_a[0]; Mat4 m; for (int i = 0; i < kChainLength; ++i) {m = CreateMat4(q); q.w += m[3][0];} g_sink = m[0][0];},
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) for (int i = 0; i < kBatchSize; ++i) g_mats_out[i] = CreateMat4(g_quats_a[i]); g_sink = g_mats_out[0][0][0];});
+    Run("ComposeTRS",
+        [&]{Quat q = g_quats_a[0]; Mat4 m; for (int i = 0; i < kChainLength; ++i) {m = ComposeTRS(g_vec3s[i & 7], q, g_normals[i & 7]); q.w += m[3][0];} g_sink = m[0][0];},
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) for (int i = 0; i < kBatchSize; ++i) g_mats_out[i] = ComposeTRS(g_vec3s[i], g_quats_a[i], g_normals[i]); g_sink = g_mats_out[0][0][0];});
+    RunBatch("ComposeTRSBatch(Mat4)",
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) ComposeTRSBatch(g_vec3s, g_quats_a, g_normals, g_mats_out, kBatchSize); g_sink = g_mats_out[0][0][0];});
+    RunBatch("ComposeTRSBatch(Mat3x4)",
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) ComposeTRSBatch(g_vec3s, g_quats_a, g_normals, g_affines_out, kBatchSize); g_sink = g_affines_out[0][0][0];});
+    Run("Decompose(Mat4)",
+        [&]{Mat4 m = g_mats_a[0]; Vec3 t, s; Quat q = {}; for (int i = 0; i < kChainLength; ++i) {m[3][0] = q.x; Decompose(m, t, q, s);} g_sink = q.x + s.x;},
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) for (int i = 0; i < kBatchSize; ++i) Decompose(g_mats_a[i], g_vec3s_out[i], g_quats_out[i], g_normals_out[i]); g_sink = g_quats_out[0].x;});
+    RunBatch("DecomposeBatch",
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) DecomposeBatch(g_mats_a, g_vec3s_out, g_quats_out, g_normals_out, kBatchSize); g_sink = g_quats_out[0].x;});
+    Run("Dot(Vec4)",
+        [&]{float s = 0.0f; Vec4 w = CreateVec4(0.125f); for (int i = 0; i < kChainLength; ++i) s = Dot(g_vec4s[i & 7] + s, w); g_sink = s;},
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) for (int i = 0; i < kBatchSize; ++i) g_floats_out[i] = Dot(g_vec4s[i], g_vec4s[i ^ 1]); g_sink = g_floats_out[0];});
+    Run("Normalize(Vec4)",
+        [&]{Vec4 v = g_vec4s[0]; for (int i = 0; i < kChainLength; ++i) v = Normalize(v + g_vec4s[i & 7]); g_sink = v.x;},
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) for (int i = 0; i < kBatchSize; ++i) g_vec4s_out[i] = Normalize(g_vec4s[i]); g_sink = g_vec4s_out[0].x;});
+    Run("FastNormalize(Vec4)",
+        [&]{Vec4 v = g_vec4s[0]; for (int i = 0; i < kChainLength; ++i) v = FastNormalize(v + g_vec4s[i & 7]); g_sink = v.x;},
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) for (int i = 0; i < kBatchSize; ++i) g_vec4s_out[i] = FastNormalize(g_vec4s[i]); g_sink = g_vec4s_out[0].x;});
+    Run("Normalize(Vec3)",
+        [&]{Vec3 v = g_vec3s[0]; for (int i = 0; i < kChainLength; ++i) v = Normalize(v + g_vec3s[i & 7]); g_sink = v.x;},
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) for (int i = 0; i < kBatchSize; ++i) g_vec3s_out[i] = Normalize(g_vec3s[i]); g_sink = g_vec3s_out[0].x;});
+    // Reading v.x after the loop makes GCC spill the Vec3A chains through the
+    // stack every iteration, so these sink a Dot instead.
+    Run("Normalize(Vec3A)",
+        [&]{Vec3A v = g_vec3as[0]; for (int i = 0; i < kChainLength; ++i) v = Normalize(v + g_vec3as[i & 7]); g_sink = Dot(v, v);},
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) for (int i = 0; i < kBatchSize; ++i) g_vec3as_out[i] = Normalize(g_vec3as[i]); g_sink = g_vec3as_out[0].x;});
+    Run("Cross(Vec3)",
+        [&]{Vec3 v = g_vec3s[0]; for (int i = 0; i < kChainLength; ++i) v = Cross(v, g_vec3s[i & 7]); g_sink = v.x;},
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) for (int i = 0; i < kBatchSize; ++i) g_vec3s_out[i] = Cross(g_vec3s[i], g_vec3s[i ^ 1]); g_sink = g_vec3s_out[0].x;});
+    Run("Cross(Vec3A)",
+        [&]{Vec3A v = g_vec3as[0]; for (int i = 0; i < kChainLength; ++i) v = Cross(v, g_vec3as[i & 7]); g_sink = Dot(v, v);},
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) for (int i = 0; i < kBatchSize; ++i) g_vec3as_out[i] = Cross(g_vec3as[i], g_vec3as[i ^ 1]); g_sink = g_vec3as_out[0].x;});
+    Run("TransformPoint(Mat4, Vec3A)",
+        [&]{Vec3A v = g_vec3as[0]; for (int i = 0; i < kChainLength; ++i) v = TransformPoint(step, v); g_sink = Dot(v, v);},
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) for (int i = 0; i < kBatchSize; ++i) g_vec3as_out[i] = TransformPoint(step, g_vec3as[i]); g_sink = g_vec3as_out[0].x;});
+    // Packet throughput is per Vec3, so it compares directly with the line above.
+    RunBatch("Normalize(Vec3x4) per Vec3",
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) for (int i = 0; i < kBatchSize; i += 4) StoreVec3x4(Normalize(LoadVec3x4(g_vec3s + i)), g_vec3s_out + i); g_sink = g_vec3s_out[0].x;});
+    RunBatch("NormalizeBatch(Vec3), exact",
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) NormalizeBatch(g_vec3s, g_vec3s_out, kBatchSize); g_sink = g_vec3s_out[0].x;});
+    RunBatch("NormalizeBatch(Vec3), refined",
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) NormalizeBatch(g_vec3s, g_vec3s_out, kBatchSize, GMATH_NORMALIZE_REFINED); g_sink = g_vec3s_out[0].x;});
+    RunBatch("NormalizeBatch(Vec3), estimate",
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) NormalizeBatch(g_vec3s, g_vec3s_out, kBatchSize, GMATH_NORMALIZE_ESTIMATE); g_sink = g_vec3s_out[0].x;});
+    RunBatch("NormalizeBatch(Vec4), refined",
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) NormalizeBatch(g_vec4s, g_vec4s_out, kBatchSize, GMATH_NORMALIZE_REFINED); g_sink = g_vec4s_out[0].x;});
+    
+    // The scalar functions go through <math.h> unless built with
+    // GMATH_FAST_TRIG (bench_fast), the Vec4 versions always use the GMath
+    // polynomials. Vec4 throughput is per lane.
+    Run("Sin(float)",
+        [&]{float s = 0.0f; for (int i = 0; i < kChainLength; ++i) s = Sin(s + g_floats[i & 7]); g_sink = s;},
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) for (int i = 0; i < kBatchSize; ++i) g_floats_out[i] = Sin(g_floats[i]); g_sink = g_floats_out[0];});
+    Run("SinCos(float)",
+        [&]{float s = 0.0f, c = 0.0f; for (int i = 0; i < kChainLength; ++i) SinCos(s + c + g_floats[i & 7], s, c); g_sink = s;},
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) for (int i = 0; i < kBatchSize; i += 2) SinCos(g_floats[i], g_floats_out[i], g_floats_out[i + 1]); g_sink = g_floats_out[0];});
+    RunBatch("Sin(Vec4) per lane",
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) for (int i = 0; i < kBatchSize / 4; ++i) g_vec4s_out[i] = Sin(g_float_lanes[i]); g_sink = g_vec4s_out[0].x;});
+    Run("ACos(float)",
+        [&]{float s = 0.0f; for (int i = 0; i < kChainLength; ++i) s = ACos(s * 0.25f + g_floats[i & 7] * 0.5f); g_sink = s;},
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) for (int i = 0; i < kBatchSize; ++i) g_floats_out[i] = ACos(g_floats[i]); g_sink = g_floats_out[0];});
+    RunBatch("ACos(Vec4) per lane",
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) for (int i = 0; i < kBatchSize / 4; ++i) g_vec4s_out[i] = ACos(g_float_lanes[i]); g_sink = g_vec4s_out[0].x;});
+    Run("Exp(float)",
+        [&]{float s = 0.0f; for (int i = 0; i < kChainLength; ++i) s = Exp(g_floats[i & 7] - s * 0.5f); g_sink = s;},
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) for (int i = 0; i < kBatchSize; ++i) g_floats_out[i] = Exp(g_floats[i]); g_sink = g_floats_out[0];});
+    RunBatch("Exp(Vec4) per lane",
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) for (int i = 0; i < kBatchSize / 4; ++i) g_vec4s_out[i] = Exp(g_float_lanes[i]); g_sink = g_vec4s_out[0].x;});
+    Run("Log(float)",
+        [&]{float s = 1.0f; for (int i = 0; i < kChainLength; ++i) s = Log(s + 2.0f + g_floats[i & 7]); g_sink = s;},
+        [&]{for (int r = 0; r < kBatchRepeats; ++r) for (int i = 0; i < kBatchSize; ++i) g_floats_out[i] = Log(g_floats[i] + 2.0f); g_sink = g_floats_out[0];});
+    return 0;
+}
@@ -0,0 +1,14 @@
+/*
+================================================================================
+
+The compiled part of GMath, for builds that link it as a library rather than
+defining GMATH_IMPLEMENTATION in one of their own files. Build this file with
+the same GMath options as the rest of the program (see GMath.h), and with LTO
+if the batch and setup functions defined here should be inlined into their
+callers as well. bench/Makefile's lib target is an example.
+
+================================================================================
+*/
+
+#define GMATH_IMPLEMENTATION
+#include "GMath.h"